@@ -23,6 +23,7 @@ CBackground background;
 CBackground::CBackground()
 {
   bkTexture = NULL;
+  m_cacheValid = false;
 }
 
 CBackground::~CBackground()
@@ -44,6 +45,8 @@ void CBackground::resetBackground(void)
 
   altMap.clear();
   bkNames.clear();
+
+  m_cacheValid = false;
 }
 
 bool CBackground::loadBackground(QString name)
@@ -141,6 +144,8 @@ bool CBackground::loadBackground(QString name)
     }
   }
 
+  m_cacheValid = false;
+
   if (!makeHorizon(&pts, altHorizon))
   {
     if (!bkTexture || bkTexture->isNull())
@@ -385,6 +390,118 @@ int CBackground::split(radec_t *triangle, double top, double bottom, radec_t *ou
   return c;
 }
 
+////////////////////////////////////////////////////////////////////////////
+void CBackground::aaToWorld(double azm, double alt, double jd, SKVECTOR *out)
+////////////////////////////////////////////////////////////////////////////
+{
+  radec_t rd;
+  SKPOINT pt;
+
+  cAstro.convAA2RDRef(azm, alt, &rd.Ra, &rd.Dec);
+  trfRaDecToPointCorrectFromTo(&rd, &pt, jd, JD2000);
+
+  *out = pt.w;
+}
+
+// rebuild J2000 horizon mesh and label anchors when time, location or refraction changed
+/////////////////////////////////////////////////////////////////
+void CBackground::updateHorizonCache(const mapView_t *mapView)
+/////////////////////////////////////////////////////////////////
+{
+  if (m_cacheValid &&
+      m_cacheJD == mapView->jd &&
+      m_cacheLST == cAstro.m_lst &&
+      m_cacheLat == cAstro.m_geoLat &&
+      m_cacheRefraction == cAstro.m_useAtmRefraction &&
+      m_cacheTemp == cAstro.m_geoTemp &&
+      m_cachePress == cAstro.m_geoPress)
+  {
+    return;
+  }
+
+  m_cacheValid = true;
+  m_cacheJD = mapView->jd;
+  m_cacheLST = cAstro.m_lst;
+  m_cacheLat = cAstro.m_geoLat;
+  m_cacheRefraction = cAstro.m_useAtmRefraction;
+  m_cacheTemp = cAstro.m_geoTemp;
+  m_cachePress = cAstro.m_geoPress;
+
+  m_horVertices.clear();
+  m_horPolygons.clear();
+  m_horLabels.clear();
+
+  for (int d = 0; d < 360; d++)
+  {
+    int     d1 = (d + 1) % 360;
+    radec_t aa[4];
+
+    aa[0].Ra = D2R(d);
+    aa[0].Dec = altHorizon[d];
+
+    aa[1].Ra = D2R(d + 1);
+    aa[1].Dec = altHorizon[d1];
+
+    aa[2].Ra = D2R(d + 1);
+    aa[2].Dec = -R90;
+
+    aa[3].Ra = D2R(d);
+    aa[3].Dec = -R90;
+
+    double step = 45;
+
+    for (int y = 90; y > -90; y -= step)
+    {
+      int clippedCount;
+      radec_t clipped[MAX_POLYGON_PTS];
+
+      clippedCount = split(aa, D2R(y), D2R(y - step), clipped);
+      if (clippedCount == 0)
+      {
+        continue;
+      }
+
+      bkPolygon_t poly;
+
+      poly.first = m_horVertices.count();
+      poly.count = clippedCount;
+
+      for (int i = 0; i < clippedCount; i++)
+      {
+        SKVECTOR v;
+
+        aaToWorld(clipped[i].Ra, clipped[i].Dec, mapView->jd, &v);
+        m_horVertices.append(v);
+      }
+      m_horPolygons.append(poly);
+    }
+  }
+
+  for (int i = 0; i < bkNames.count(); i++)
+  {
+    SKVECTOR v[2];
+    double btm = altHorizon[(int)bkNames[i].azm];
+
+    aaToWorld(D2R(bkNames[i].azm), btm, mapView->jd, &v[0]);
+    aaToWorld(D2R(bkNames[i].azm), btm + D2R(3), mapView->jd, &v[1]);
+
+    m_horLabels.append(v[0]);
+    m_horLabels.append(v[1]);
+  }
+
+  for (int azm = 0; azm < 360; azm += 45)
+  {
+    SKVECTOR v[2];
+    double btm = altHorizon[azm];
+
+    aaToWorld(D2R(azm), btm, mapView->jd, &v[0]);
+    aaToWorld(D2R(azm), btm + D2R(1.5), mapView->jd, &v[1]);
+
+    m_horLabels.append(v[0]);
+    m_horLabels.append(v[1]);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 void CBackground::renderHorizonBk(mapView_t *mapView, CSkPainter *p, QImage *pImg)
 //////////////////////////////////////////////////////////////////////////////////
@@ -401,74 +518,45 @@ void CBackground::renderHorizonBk(mapView_t *mapView, CSkPainter *p, QImage *pIm
   color.setAlpha(g_skSet.map.hor.alpha);
   setSetFont(FONT_HORIZON, p);
 
-  if (isValid)
-  {
-    for (int d = 0; d < 360; d++)
-    {
-      int     d1 = (d + 1) % 360;      
-      radec_t aa[4];
-      SKPOINT pt[12];
-
-      aa[0].Ra = D2R(d);
-      aa[0].Dec = altHorizon[d];
+  updateHorizonCache(mapView);
 
-      aa[1].Ra = D2R(d + 1);
-      aa[1].Dec = altHorizon[d1];
+  const SKVECTOR *vertices = m_horVertices.constData();
+  SKPOINT         pt[MAX_POLYGON_PTS];
 
-      aa[2].Ra = D2R(d + 1);
-      aa[2].Dec = -R90;
-
-      aa[3].Ra = D2R(d);
-      aa[3].Dec = -R90;
+  for (int i = 0; isValid && i < m_horPolygons.count(); i++)
+  {
+    const bkPolygon_t &poly = m_horPolygons[i];
 
-      double step = 45;
+    for (int v = 0; v < poly.count; v++)
+    {
+      pt[v].w = vertices[poly.first + v];
+    }
 
-      for (int y = 90; y > -90; y -= step)
-      {
-        int clippedCount;
-        radec_t clipped[MAX_POLYGON_PTS];
+    if (!SKPLANEClipPolygonToFrustum(trfGetFrustum(), pt, poly.count, newPts, newCount))
+    {
+      continue;
+    }
 
-        clippedCount = split(aa, D2R(y), D2R(y - step), clipped);
-        if (clippedCount == 0)
-        {
-          continue;
-        }
+    for (int t = 0; t < newCount; t++)
+    {
+      trfProjectPointNoCheck(&newPts[t]);
+    }
 
-        for (int i = 0; i < clippedCount; i++)
-        {
-          radec_t rd;
+    scanRender.resetScanPoly(pImg->width(), pImg->height());
 
-          cAstro.convAA2RDRef(clipped[i].Ra, clipped[i].Dec, &rd.Ra, &rd.Dec);
-          trfRaDecToPointCorrectFromTo(&rd, &pt[i], mapView->jd, JD2000);
-        }
+    for (int t = 0; t < newCount; t++)
+    {
+      int t1 = (t + 1) % newCount;
+      scanRender.scanLine(newPts[t].sx, newPts[t].sy, newPts[t1].sx, newPts[t1].sy);
+    }
 
-        if (SKPLANEClipPolygonToFrustum(trfGetFrustum(), pt, clippedCount, newPts, newCount))
-        {
-          for (int t = 0; t < newCount; t++)
-          {
-            trfProjectPointNoCheck(&newPts[t]);
-          }
-
-          scanRender.resetScanPoly(pImg->width(), pImg->height());
-
-          for (int t = 0; t < newCount; t++)
-          {
-            int t1 = (t + 1) % newCount;
-            scanRender.scanLine(newPts[t].sx, newPts[t].sy, newPts[t1].sx, newPts[t1].sy);
-          }
-
-          if (color.alpha() == 255)
-          {
-            scanRender.renderPolygon(color, pImg);
-          }
-          else
-          {
-            scanRender.renderPolygonAlpha(color, pImg);
-            //p->drawLine(newPts[0].sx, newPts[0].sy, newPts[1].sx, newPts[1].sy);
-            //p->drawLine(newPts[1].sx, newPts[1].sy, newPts[2].sx, newPts[2].sy);
-          }
-        }
-      }
+    if (color.alpha() == 255)
+    {
+      scanRender.renderPolygon(color, pImg);
+    }
+    else
+    {
+      scanRender.renderPolygonAlpha(color, pImg);
     }
   }
 
@@ -512,45 +600,27 @@ void CBackground::renderHorizonBk(mapView_t *mapView, CSkPainter *p, QImage *pIm
 
   for (int i = 0; i < bkNames.count(); i++)
   {
-    radec_t aa;
-    radec_t rd;
     SKPOINT pt1;
     SKPOINT pt2;
-    double btm = altHorizon[(int)bkNames[i].azm];
-
-    aa.Ra = D2R(bkNames[i].azm);
-    aa.Dec = btm;
-    cAstro.convAA2RDRef(aa.Ra, aa.Dec, &rd.Ra, &rd.Dec);
-    trfRaDecToPointCorrectFromTo(&rd, &pt1, mapView->jd, JD2000);
 
-    aa.Ra = D2R(bkNames[i].azm);
-    aa.Dec = btm + D2R(3);
-    cAstro.convAA2RDRef(aa.Ra, aa.Dec, &rd.Ra, &rd.Dec);
-    trfRaDecToPointCorrectFromTo(&rd, &pt2, mapView->jd, JD2000);
+    pt1.w = m_horLabels[i * 2];
+    pt2.w = m_horLabels[i * 2 + 1];
 
     drawText(&pt1, &pt2, bkNames[i].name, p);
   }
 
   if (g_skSet.map.hor.showDirections)
   {
-    int azm[] = {0, 45, 90, 135, 180, 225, 270, 315};
     QString azmText[] = {QObject::tr("N"), QObject::tr("NE"), QObject::tr("E"), QObject::tr("SE"), QObject::tr("S"), QObject::tr("SW"), QObject::tr("W"), QObject::tr("NW")};
+    int     first = bkNames.count() * 2;
+
     for (int i = 0; i < 8; i++)
     {
-      radec_t aa;
-      radec_t rd;
       SKPOINT pt1;
       SKPOINT pt2;
-      double btm = altHorizon[(int)azm[i]];
-
-      aa.Ra = D2R(azm[i]);
-      aa.Dec = btm;
-      cAstro.convAA2RDRef(aa.Ra, aa.Dec, &rd.Ra, &rd.Dec);
-      trfRaDecToPointCorrectFromTo(&rd, &pt1, mapView->jd, JD2000);
 
-      aa.Dec = btm + D2R(1.5);
-      cAstro.convAA2RDRef(aa.Ra, aa.Dec, &rd.Ra, &rd.Dec);
-      trfRaDecToPointCorrectFromTo(&rd, &pt2, mapView->jd, JD2000);
+      pt1.w = m_horLabels[first + i * 2];
+      pt2.w = m_horLabels[first + i * 2 + 1];
 
       drawText(&pt1, &pt2, azmText[i], p);
     }
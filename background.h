@@ -27,6 +27,12 @@ typedef struct
   QString name;
 } bkNames_t;
 
+typedef struct
+{
+  int first;   // index to vertex buffer
+  int count;
+} bkPolygon_t;
+
 class CBackground
 {
 public:
@@ -53,6 +59,20 @@ private:
   int splitY(int countIn, radec_t *in, double y, double side, radec_t *out);
   void intersect(double y, radec_t &v1, radec_t &v2, radec_t *out);
   void renderTexture(mapView_t *mapView, CSkPainter *p, QImage *pImg);
+  void updateHorizonCache(const mapView_t *mapView);
+  void aaToWorld(double azm, double alt, double jd, SKVECTOR *out);
+
+  // horizon geometry converted to J2000 (depends on jd, location and refraction only)
+  QVector <SKVECTOR>    m_horVertices;
+  QVector <bkPolygon_t> m_horPolygons;
+  QVector <SKVECTOR>    m_horLabels;    // bottom/top pairs (names first, then directions)
+  bool                  m_cacheValid;
+  double                m_cacheJD;
+  double                m_cacheLST;
+  double                m_cacheLat;
+  double                m_cacheTemp;
+  double                m_cachePress;
+  bool                  m_cacheRefraction;
 };
 
 extern CBackground background;
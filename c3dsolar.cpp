@@ -6,6 +6,7 @@
 #include <QPrintDialog>
 #include <QPrinter>
 #include <QPrintPreviewDialog>
+#include "clazyload.h"
 
 bool g_comAstChanged = false;
 
@@ -24,6 +25,9 @@ C3DSolar::C3DSolar(mapView_t *view, QWidget *parent, bool isComet, int index) :
   QDialog(parent),
   ui(new Ui::C3DSolar)
 {
+  g_lazyAsteroids.ensure();
+  g_lazyComets.ensure();
+
   ui->setupUi(this);
 
   ui->frame->setView(view, true);
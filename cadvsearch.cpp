@@ -8,6 +8,7 @@
 #include "gcvs.h"
 
 #include "csearch.h"
+#include "clazyload.h"
 
 static int lastRadio = 0;
 
@@ -135,6 +136,9 @@ void CAdvSearch::on_lineEdit_textChanged(const QString &)
 
 void CAdvSearch::slotRadioChange()
 {
+  g_lazyAsteroids.ensure();
+  g_lazyComets.ensure();
+
   QStringList list;
 
   ui->lineEdit->removeWords();  
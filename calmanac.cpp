@@ -0,0 +1,265 @@
+#include "calmanac.h"
+#include "skcore.h"
+#include "mapobj.h"
+#include "vsop87.h"
+
+#include <QThreadPool>
+
+extern bool g_useJPLEphem;
+extern int  g_ephType;
+extern int  g_ephMoonType;
+extern bool g_geocentric;
+
+CAlmanac g_almanac;
+
+typedef struct
+{
+  double lon, lat, alt, tz;
+  double temp, press, deltaT;
+  qint32 tempType, deltaTAlg, refraction;
+  qint32 ephType, ephMoonType, useJPL, geocentric;
+  qint64 day;                               // local day number
+} almanacKey_t;
+
+////////////////////////////////////////////////////////////////////////////////////////
+static void alCompute(const mapView_t *view, double start, int parts, almanacDay_t *day)
+////////////////////////////////////////////////////////////////////////////////////////
+{
+  CAstro    astro;
+  CRts      rts;
+  mapView_t v = *view;
+
+  // day plots and low precision RTS do not need the full series
+  astro.setAccuracy(VSOP87_ACC_10SEC);
+  rts.setLowPrec();
+  rts.setAstro(&astro);
+
+  day->jd = start;
+  day->parts = parts;
+
+  if (parts & AL_HOURLY)
+  {
+    for (int h = 0; h < AL_HOURS; h++)
+    {
+      v.jd = start + h / (double)AL_HOURS;
+      astro.setParam(&v);
+
+      for (int p = 0; p < PT_PLANET_COUNT; p++)
+      {
+        orbit_t o;
+
+        astro.calcPlanet(p, &o);
+        day->alt[p][h] = o.lAlt;
+      }
+    }
+  }
+
+  if (parts & AL_PHASE)
+  {
+    orbit_t o;
+
+    v.jd = start;
+    astro.setParam(&v);
+    astro.calcPlanet(PT_MOON, &o);
+    day->moonPhase = o.phase;
+  }
+
+  v.jd = start + 0.5;
+
+  if (parts & AL_NOON)
+  {
+    astro.setParam(&v);
+    astro.calcPlanet(PT_MOON, &day->moon);
+    astro.calcPlanet(PT_SUN, &day->sun);
+  }
+
+  if (parts & AL_RTS)
+  {
+    rts.calcOrbitRTS(&day->rts[AL_MOON], PT_MOON, MO_PLANET, &v);
+    rts.calcOrbitRTS(&day->rts[AL_SUN], PT_SUN, MO_PLANET, &v);
+  }
+}
+
+class CAlmanacTask : public QRunnable
+{
+public:
+  CAlmanacTask(const mapView_t *view, const QList <double> &days, const QList <int> &parts, const QList <QByteArray> &keys) :
+    m_view(*view), m_days(days), m_parts(parts), m_keys(keys)
+  {
+  }
+
+  void run()
+  {
+    int                    count = m_days.count();
+    QVector <almanacDay_t> out(count);
+    almanacDay_t          *data = out.data();
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < count; i++)
+    {
+      alCompute(&m_view, m_days.at(i), m_parts.at(i), &data[i]);
+    }
+
+    g_almanac.store(m_keys, out);
+    QMetaObject::invokeMethod(&g_almanac, "slotReady", Qt::QueuedConnection);
+  }
+
+private:
+  mapView_t          m_view;
+  QList <double>     m_days;
+  QList <int>        m_parts;
+  QList <QByteArray> m_keys;
+};
+
+/////////////////////////////////////
+CAlmanac::CAlmanac(QObject *parent) :
+  QObject(parent)
+/////////////////////////////////////
+{
+}
+
+/////////////////////////////////////////////////////////////
+QByteArray CAlmanac::key(const mapView_t *view, double jd)
+/////////////////////////////////////////////////////////////
+{
+  almanacKey_t k;
+
+  memset(&k, 0, sizeof(k));
+
+  k.lon = view->geo.lon;
+  k.lat = view->geo.lat;
+  k.alt = view->geo.alt;
+  k.tz = view->geo.tz;
+  k.temp = view->geo.temp;
+  k.press = view->geo.press;
+  k.deltaT = view->deltaT;
+  k.tempType = view->geo.tempType;
+  k.deltaTAlg = view->deltaTAlg;
+  k.refraction = view->geo.useAtmRefraction;
+  k.ephType = g_ephType;
+  k.ephMoonType = g_ephMoonType;
+  k.useJPL = g_useJPLEphem;
+  k.geocentric = g_geocentric;
+  k.day = (qint64)floor(jd + view->geo.tz - 0.5);
+
+  return QByteArray((const char *)&k, sizeof(k));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// schedules the parts (AL_xxx) of the days (from the day of jd) that are not
+// computed yet
+void CAlmanac::request(const mapView_t *view, double jd, int days, int parts)
+//////////////////////////////////////////////////////////////////////////////
+{
+  QList <double>     list;
+  QList <int>        need;
+  QList <QByteArray> keys;
+  double             start = getStartOfDay(jd, view->geo.tz);
+
+  QMutexLocker locker(&m_mutex);
+
+  for (int i = 0; i < days; i++)
+  {
+    QByteArray k = key(view, start + i);
+    int        have = m_pending.value(k, 0);
+
+    if (m_cache.contains(k))
+    {
+      have |= m_cache[k].parts;
+    }
+
+    if ((parts & ~have) == 0)
+    {
+      continue;
+    }
+
+    m_pending[k] = have | parts;
+    keys.append(k);
+    need.append(parts & ~have);
+    list.append(start + i);
+  }
+
+  if (list.count() > 0)
+  {
+    QThreadPool::globalInstance()->start(new CAlmanacTask(view, list, need, keys));
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// false when the parts are not computed yet
+bool CAlmanac::get(const mapView_t *view, double jd, int parts, almanacDay_t *day)
+//////////////////////////////////////////////////////////////////////////////////
+{
+  QByteArray   k = key(view, jd);
+  QMutexLocker locker(&m_mutex);
+
+  QHash <QByteArray, almanacDay_t>::const_iterator it = m_cache.constFind(k);
+
+  if (it == m_cache.constEnd() || (it.value().parts & parts) != parts)
+  {
+    return false;
+  }
+
+  *day = it.value();
+
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+void CAlmanac::store(const QList<QByteArray> &keys, const QVector<almanacDay_t> &days)
+/////////////////////////////////////////////////////////////////////////////////////
+{
+  QMutexLocker locker(&m_mutex);
+
+  if (m_cache.count() + keys.count() > AL_CACHE_DAYS)
+  {
+    m_cache.clear();
+  }
+
+  for (int i = 0; i < keys.count(); i++)
+  {
+    const almanacDay_t &d = days[i];
+    QHash <QByteArray, almanacDay_t>::iterator it = m_cache.find(keys[i]);
+
+    if (it == m_cache.end())
+    {
+      m_cache.insert(keys[i], d);
+    }
+    else
+    { // merge with the parts computed before
+      almanacDay_t &c = it.value();
+
+      if (d.parts & AL_HOURLY) memcpy(c.alt, d.alt, sizeof(c.alt));
+      if (d.parts & AL_PHASE) c.moonPhase = d.moonPhase;
+      if (d.parts & AL_NOON)
+      {
+        c.moon = d.moon;
+        c.sun = d.sun;
+      }
+      if (d.parts & AL_RTS)
+      {
+        c.rts[AL_MOON] = d.rts[AL_MOON];
+        c.rts[AL_SUN] = d.rts[AL_SUN];
+      }
+      c.parts |= d.parts;
+    }
+
+    int pending = m_pending.value(keys[i], 0) & ~d.parts;
+
+    if (pending == 0)
+    {
+      m_pending.remove(keys[i]);
+    }
+    else
+    {
+      m_pending[keys[i]] = pending;
+    }
+  }
+}
+
+/////////////////////////////
+void CAlmanac::slotReady()
+/////////////////////////////
+{
+  emit sigReady();
+}
@@ -0,0 +1,65 @@
+#ifndef CALMANAC_H
+#define CALMANAC_H
+
+#include <QtCore>
+
+#include "castro.h"
+#include "cmapview.h"
+#include "crts.h"
+
+#define AL_HOURS          24
+#define AL_CACHE_DAYS     1024
+
+#define AL_MOON           0
+#define AL_SUN            1
+
+// computed parts of the day
+#define AL_HOURLY         1                 // alt
+#define AL_PHASE          2                 // moonPhase
+#define AL_NOON           4                 // moon, sun
+#define AL_RTS            8                 // rts
+
+typedef struct
+{
+  double   jd;                              // start of the local day
+  int      parts;                           // AL_HOURLY, AL_PHASE, ... computed
+  float    alt[PT_PLANET_COUNT][AL_HOURS];  // altitude at the start of each hour (rad)
+  double   moonPhase;                       // at the start of the day
+  orbit_t  moon;                            // at local noon
+  orbit_t  sun;
+  rts_t    rts[2];                          // AL_MOON, AL_SUN (low precision)
+} almanacDay_t;
+
+// Day data for the planner dialogs. Computed in the background once per
+// location, settings and day, only the parts the caller asks for.
+// sigReady() is emitted when requested days are done.
+class CAlmanac : public QObject
+{
+  Q_OBJECT
+
+  friend class CAlmanacTask;
+
+public:
+  explicit CAlmanac(QObject *parent = 0);
+
+  void request(const mapView_t *view, double jd, int days, int parts);
+  bool get(const mapView_t *view, double jd, int parts, almanacDay_t *day);
+
+signals:
+  void sigReady();
+
+private slots:
+  void slotReady();
+
+private:
+  QByteArray key(const mapView_t *view, double jd);
+  void store(const QList <QByteArray> &keys, const QVector <almanacDay_t> &days);
+
+  QMutex                            m_mutex;
+  QHash <QByteArray, almanacDay_t>  m_cache;
+  QHash <QByteArray, int>           m_pending;  // parts being computed
+};
+
+extern CAlmanac g_almanac;
+
+#endif // CALMANAC_H
@@ -2,11 +2,15 @@
 #include "ui_castcomsearch.h"
 #include "casterdlg.h"
 #include "ccomdlg.h"
+#include "clazyload.h"
 
 CAstComSearch::CAstComSearch(QWidget *parent, double jd, bool isComet) :
   QDialog(parent),
   ui(new Ui::CAstComSearch)
 {
+  g_lazyAsteroids.ensure();
+  g_lazyComets.ensure();
+
   ui->setupUi(this);
   m_bComet = isComet;
 
@@ -11,6 +11,7 @@
 #include "skprogressdialog.h"
 
 #include <QProgressDialog>
+#include "clazyload.h"
 
 extern bool g_comAstChanged;
 extern bool g_forcedRecalculate;
@@ -23,6 +24,9 @@ extern MainWindow *pcMainWnd;
 QString curAsteroidCatName;
 QList   <asteroid_t> tAsteroids;
 
+static CNameIndex astIndex;
+static bool       astIndexValid = false;
+
 static double  minJD = __DBL_MAX__;
 static double  maxJD = __DBL_MIN__;
 
@@ -133,9 +137,9 @@ static double caclHGMag(double h, double g, double rp, double rho, double rsn)
 }
 
 
-////////////////////////////////////////////////////////////////////////////
-static void astSolve2(asteroid_t *a, double jdt, bool lightCorrected = true)
-////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void astSolve2(const asteroid_t *a, orbit_t *orbit, CAstro *astro, const orbit_t *sun, double jdt, bool lightCorrected)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
   double ea = 0;
   double xe = 0;
@@ -153,7 +157,7 @@ static void astSolve2(asteroid_t *a, double jdt, bool lightCorrected = true)
     double M = a->M + delta;
 
     rangeDbl(&M, MPI2);
-    double E = cAstro.solveKepler(a->e, M);
+    double E = astro->solveKepler(a->e, M);
     rangeDbl(&E, MPI2);
 
     double xv = a->a * (cos(E) - a->e);
@@ -172,63 +176,63 @@ static void astSolve2(asteroid_t *a, double jdt, bool lightCorrected = true)
     rh[1] = r * ( sin(n) * cos(v + p) + cos(n) * sin(v + p) * cos(a->inc));
     rh[2] = r * ( sin(v + p) * sin(a->inc));
 
-    a->orbit.hRect[0] = rh[0];
-    a->orbit.hRect[1] = rh[1];
-    a->orbit.hRect[2] = rh[2];
+    orbit->hRect[0] = rh[0];
+    orbit->hRect[1] = rh[1];
+    orbit->hRect[2] = rh[2];
 
-    a->orbit.hLon = atan2(rh[1], rh[0]);
-    a->orbit.hLat = atan2(rh[2], sqrt(rh[0] * rh[0] + rh[1] * rh[1]));
-    rangeDbl(&a->orbit.hLon, MPI2);
+    orbit->hLon = atan2(rh[1], rh[0]);
+    orbit->hLat = atan2(rh[2], sqrt(rh[0] * rh[0] + rh[1] * rh[1]));
+    rangeDbl(&orbit->hLon, MPI2);
 
     // geocentric ecl. J2000.0
-    double xg = rh[0] + xs;
-    double yg = rh[1] + ys;
-    double zg = rh[2] + zs;
+    double xg = rh[0] + sun->sRectJ2000[0];
+    double yg = rh[1] + sun->sRectJ2000[1];
+    double zg = rh[2] + sun->sRectJ2000[2];
 
     // geocentric pos eq. J2000.0
-    ea = cAstro.getEclObl(JD2000);
+    ea = astro->getEclObl(JD2000);
     xe = xg;
     ye = yg * cos(ea) - zg * sin(ea);
     ze = yg * sin(ea) + zg * cos(ea);
 
-    a->orbit.r = r;
-    a->orbit.R = sqrt(xg * xg + yg * yg + zg *zg);
+    orbit->r = r;
+    orbit->R = sqrt(xg * xg + yg * yg + zg *zg);
 
-    a->orbit.light = SECTODAY(a->orbit.R * AU1 / LSPEED);
+    orbit->light = SECTODAY(orbit->R * AU1 / LSPEED);
 
-    jdt -= a->orbit.light;
+    jdt -= orbit->light;
   }
 
-  double R = a->orbit.R;
+  double R = orbit->R;
 
-  a->orbit.gRD.Ra  = atan2(ye, xe);
-  a->orbit.gRD.Dec = atan2(ze, sqrt(xe * xe + ye * ye));
-  rangeDbl(&a->orbit.gRD.Ra, MPI2);
+  orbit->gRD.Ra  = atan2(ye, xe);
+  orbit->gRD.Dec = atan2(ze, sqrt(xe * xe + ye * ye));
+  rangeDbl(&orbit->gRD.Ra, MPI2);
 
-  precess(&a->orbit.gRD.Ra, &a->orbit.gRD.Dec, JD2000, jdt);
+  precess(&orbit->gRD.Ra, &orbit->gRD.Dec, JD2000, jdt);
 
-  a->orbit.lRD.Ra  = a->orbit.gRD.Ra;
-  a->orbit.lRD.Dec = a->orbit.gRD.Dec;
+  orbit->lRD.Ra  = orbit->gRD.Ra;
+  orbit->lRD.Dec = orbit->gRD.Dec;
 
-  a->orbit.mag = caclHGMag(a->H, a->G, r, R, sunOrbit.r);
+  orbit->mag = caclHGMag(a->H, a->G, r, R, sun->r);
 
   double gLon, gLat, gSunLon, gSunLat;
 
-  cAstro.convRD2Ecl(a->orbit.gRD.Ra, a->orbit.gRD.Dec, &gLon, &gLat);
-  cAstro.convRD2Ecl(sunOrbit.gRD.Ra, sunOrbit.gRD.Dec, &gSunLon, &gSunLat);
+  astro->convRD2Ecl(orbit->gRD.Ra, orbit->gRD.Dec, &gLon, &gLat);
+  astro->convRD2Ecl(sun->gRD.Ra, sun->gRD.Dec, &gSunLon, &gSunLat);
 
-  a->orbit.elongation = CAstro::calcElongation(gSunLon, gLon, gLat);
+  orbit->elongation = CAstro::calcElongation(gSunLon, gLon, gLat);
 
-  a->orbit.sx = 0;
-  a->orbit.sy = 0;
-  a->orbit.PA = 0;
+  orbit->sx = 0;
+  orbit->sy = 0;
+  orbit->PA = 0;
 
-  a->orbit.phase = 1;
+  orbit->phase = 1;
 
-  cAstro.calcParallax(&a->orbit);
+  astro->calcParallax(orbit);
 
-  cAstro.convRD2AARef(a->orbit.lRD.Ra, a->orbit.lRD.Dec,
-                     &a->orbit.lAzm, &a->orbit.lAlt);
+  astro->convRD2AARef(orbit->lRD.Ra, orbit->lRD.Dec,
+                      &orbit->lAzm, &orbit->lAlt);
 }
 
 
@@ -253,7 +257,16 @@ void astSolve(asteroid_t *a, double jdt, bool lightCorrected)
   }
 
   a->lastJD = jdt;
-  astSolve2(a, jdt, lightCorrected);
+  astSolve2(a, &a->orbit, &cAstro, &sunOrbit, jdt, lightCorrected);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void astSolve(const asteroid_t *a, double jdt, CAstro *astro, const orbit_t *sun, orbit_t *out, bool lightCorrected)
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// reentrant version (sun = astro->calcPlanet(PT_EARTH, sun, true, true, false))
+{
+  astSolve2(a, out, astro, sun, jdt, lightCorrected);
 }
 
 
@@ -261,6 +274,8 @@ void astSolve(asteroid_t *a, double jdt, bool lightCorrected)
 void astRender(CSkPainter *p, mapView_t *view, float maxMag)
 ////////////////////////////////////////////////////////////
 {
+  g_lazyAsteroids.ensure();
+
   if (tAsteroids.count() == 0)
     return;
 
@@ -323,9 +338,13 @@ void astRender(CSkPainter *p, mapView_t *view, float maxMag)
 bool astLoad(QString fileName)
 //////////////////////////////
 {
+  g_lazyAsteroids.ensure();
+
   if (fileName.isEmpty())
     return(false);
 
+  astNameIndexChanged();
+
   SkFile       f(fileName);
   QTextStream s(&f);
 
@@ -434,6 +453,8 @@ QString astCreateLine(asteroid_t *a)
 bool astSave(QString fileName, QWidget *parent)
 ///////////////////////////////////////////////
 {
+  g_lazyAsteroids.ensure();
+
   if (tAsteroids.count() == 0)
   {
     curAsteroidCatName = "";
@@ -474,15 +495,47 @@ bool astSave(QString fileName, QWidget *parent)
 void astClear(void)
 ///////////////////
 {
+  g_lazyAsteroids.ensure();
+
   tAsteroids.clear();
+  astNameIndexChanged();
   curAsteroidCatName = "";
 }
 
+////////////////////////////////////
+const CNameIndex *astNameIndex(void)
+////////////////////////////////////
+{
+  g_lazyAsteroids.ensure();
+
+  if (!astIndexValid || astIndex.count() != tAsteroids.count())
+  {
+    astIndex.clear();
+    for (int i = 0; i < tAsteroids.count(); i++)
+    {
+      astIndex.add(tAsteroids[i].name, i);
+    }
+    astIndex.build();
+    astIndexValid = true;
+  }
+
+  return &astIndex;
+}
+
+//////////////////////////////
+void astNameIndexChanged(void)
+//////////////////////////////
+{
+  astIndexValid = false;
+}
+
 
 CAsterDlg::CAsterDlg(QWidget *parent) :
   QDialog(parent),
   ui(new Ui::CAsterDlg)
 {
+  g_lazyAsteroids.ensure();
+
   cSaveQuest = tr("Save current catalogue to disc?");
 
   ui->setupUi(this);
@@ -526,6 +579,8 @@ void CAsterDlg::changeEvent(QEvent *e)
 void CAsterDlg::updateDlg()
 ///////////////////////////
 {
+  astNameIndexChanged();
+
   setWindowTitle(tr("Asteroids ") + curAsteroidCatName);
 
   ui->lineEdit_2->setText(QString("%1").arg(tAsteroids.count()));
@@ -28,6 +28,7 @@
 #include "cmapview.h"
 #include "cskpainter.h"
 #include "transform.h"
+#include "cnameindex.h"
 
 #define  AST_ZOOM     D2R(2)
 
@@ -56,7 +57,10 @@ void astRender(CSkPainter *p, mapView_t *view, float maxMag);
 bool astSave(QString fileName, QWidget *parent);
 bool astLoad(QString fileName);
 void astSolve(asteroid_t *a, double jdt, bool lightCorrected = true);
+void astSolve(const asteroid_t *a, double jdt, CAstro *astro, const orbit_t *sun, orbit_t *out, bool lightCorrected = true);
 void astClear(void);
+const CNameIndex *astNameIndex(void);
+void astNameIndexChanged(void);
 
 double unpackMPCDate(QString str);
 
@@ -113,6 +113,14 @@ static double poleDec[][2] = { { DEG2RAD(63.87), 0 },                  // PT_SUN
 CAstro::CAstro()
 ////////////////
 {
+  m_dtCacheJD = -1;
+  m_dtCacheValue = -1;
+  m_dtCacheAlg = -1;
+
+  m_refTemp = -CM_UNDEF;
+  m_refPress = -CM_UNDEF;
+
+  m_accuracy = VSOP87_ACC_FULL;
 }
 
 /*
@@ -313,14 +321,10 @@ double CAstro::calcDeltaT(double jd)
 { // http://www.staff.science.uu.nl/~gent0113/deltat/deltat_old.htm
   double dT = CM_UNDEF;
 
-  static double lastJD = -1;
-  static double value = -1;
-  static int    lastAlg = -1;
-
-  if (m_deltaTAlg == lastAlg &&
-      lastJD == jd)
+  if (m_deltaTAlg == m_dtCacheAlg &&
+      m_dtCacheJD == jd)
   {
-    return(value);
+    return(m_dtCacheValue);
   }
 
   // table
@@ -355,11 +359,11 @@ double CAstro::calcDeltaT(double jd)
     dT = deltaTEspMeeus06(jd);
   }
 
-  value = SECTODAY(dT);
-  lastJD = jd;
-  lastAlg = m_deltaTAlg;
+  m_dtCacheValue = SECTODAY(dT);
+  m_dtCacheJD = jd;
+  m_dtCacheAlg = m_deltaTAlg;
 
-  return(value);
+  return(m_dtCacheValue);
 }
 
 
@@ -708,25 +712,21 @@ double CAstro::getAtmRef(double alt)
 {
   double y, y0, D0, N, D;
   double ar;
-  static double sTemp = -CM_UNDEF;
-  static double sPress = -CM_UNDEF;
-  static double PP1;
-  static double P, Q;
 
   if (!m_useAtmRefraction)
   {
     return 0;
   }
 
-  if (sTemp != m_geoTemp || sPress != m_geoPress)
+  if (m_refTemp != m_geoTemp || m_refPress != m_geoPress)
   {
-    sTemp = m_geoTemp;
-    sPress = m_geoPress;
+    m_refTemp = m_geoTemp;
+    m_refPress = m_geoPress;
 
-    PP1 = D2R(0.00452) * m_geoPress;
+    m_refPP1 = D2R(0.00452) * m_geoPress;
 
-    P = (m_geoPress - 80.0) / 930.0;
-    Q = 4.8e-3 * (m_geoTemp - 10.0);
+    m_refP = (m_geoPress - 80.0) / 930.0;
+    m_refQ = 4.8e-3 * (m_geoTemp - 10.0);
   }
 
   if ((alt < -D2R(2.0)) || (alt >= R90))
@@ -734,7 +734,7 @@ double CAstro::getAtmRef(double alt)
 
   if (alt > D2R(15.0))
   {
-    D = PP1 / ((273.0 + m_geoTemp) * tan(alt));
+    D = m_refPP1 / ((273.0 + m_geoTemp) * tan(alt));
     return(D);
   }
 
@@ -754,7 +754,7 @@ double CAstro::getAtmRef(double alt)
   {
     N = y + (7.31 / (y + 4.4));
     N = 1.0 / tan(D2R(N));
-    D = N * P / (60.0 + Q * (N + 39.0));
+    D = N * m_refP / (60.0 + m_refQ * (N + 39.0));
     N = y - y0;
     y0 = D - D0 - N; // denominator of derivative
 
@@ -1209,7 +1209,7 @@ int CAstro::calcPlanetPolar(int planet, double jd, double *data)
         return EPT_PLAN404;
 
       case EPT_VSOP87:
-        vsop87(planet, jd, data);
+        vsop87(planet, jd, data, m_accuracy);
         return EPT_VSOP87;
     }
   }
@@ -136,6 +136,7 @@ class CAstro : public QObject
     CAstro();
 
     void setParam(const mapView_t *view);
+    void setAccuracy(double accuracy) { m_accuracy = accuracy; } // VSOP87_ACC_xxx (call before setParam())
 
     void convRD2AANoRef(double ra, double dec, double *azm, double *alt);
     void convRD2AARef(double ra, double dec, double *azm, double *alt, double r = 0);
@@ -212,6 +213,18 @@ class CAstro : public QObject
 protected:
     orbit_t m_sunOrbit;
 
+    // per instance caches (one CAstro per thread)
+    double m_dtCacheJD;
+    double m_dtCacheValue;
+    int    m_dtCacheAlg;
+
+    double m_refTemp;
+    double m_refPress;
+    double m_refPP1;
+    double m_refP, m_refQ;
+
+    double m_accuracy;  // VSOP87 target accuracy (rad)
+
     int calcPlanetPolar(int planet, double jd, double *data);
 
     void solveMoon(orbit_t *o);
@@ -10,6 +10,7 @@
 #include "cscanrender.h"
 #include "skprogressdialog.h"
 #include "astcomdowntypedlg.h"
+#include "clazyload.h"
 
 extern bool g_comAstChanged;
 extern bool g_onPrinterBW;
@@ -21,6 +22,9 @@ extern MainWindow *pcMainWnd;
 QString curCometCatName;
 QList   <comet_t> tComets;
 
+static CNameIndex comIndex;
+static bool       comIndexValid = false;
+
 static double  minJD = __DBL_MAX__;
 static double  maxJD = __DBL_MIN__;
 
@@ -162,16 +166,16 @@ static void solveCometHyperbolic(comet_t *com, double dt, double &r, double &v)
   rangeDbl(&v, MPI2);
 }
 
-/////////////////////////////////////////////////////////////////////////
-static bool comSolve2(comet_t *a, double jdt, bool lightCorrected = true)
-/////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static bool comSolve2(const comet_t *a, orbit_t *orbit, CAstro *astro, const orbit_t *sun, double jdt, bool lightCorrected)
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
   double R = 0, r = 0, v = 0;
   double xe = 0;
   double ye = 0;
   double ze = 0;
   double rh[3] = {0,0,0};
-  double ea2000 = cAstro.getEclObl(JD2000);
+  double ea2000 = astro->getEclObl(JD2000);
 
   // NOTE: komety a asteroidy maji uz deltaT v sobe
   double t = (jdt - a->perihelionDate);
@@ -203,38 +207,38 @@ static bool comSolve2(comet_t *a, double jdt, bool lightCorrected = true)
     rh[2] = r * ( sin(v + p) * sin(a->i));
 
     // helio eqt. J2000.0
-    a->orbit.hRect[0] = rh[0];
-    a->orbit.hRect[1] = rh[1];
-    a->orbit.hRect[2] = rh[2];
+    orbit->hRect[0] = rh[0];
+    orbit->hRect[1] = rh[1];
+    orbit->hRect[2] = rh[2];
 
-    a->orbit.hLon = atan2(rh[1], rh[0]);
-    a->orbit.hLat = atan2(rh[2], sqrt(rh[0] * rh[0] + rh[1] * rh[1]));
-    rangeDbl(&a->orbit.hLon, MPI2);
+    orbit->hLon = atan2(rh[1], rh[0]);
+    orbit->hLat = atan2(rh[2], sqrt(rh[0] * rh[0] + rh[1] * rh[1]));
+    rangeDbl(&orbit->hLon, MPI2);
 
     // geocentric ecl. J2000.0
-    double xg = rh[0] + xs;
-    double yg = rh[1] + ys;
-    double zg = rh[2] + zs;
+    double xg = rh[0] + sun->sRectJ2000[0];
+    double yg = rh[1] + sun->sRectJ2000[1];
+    double zg = rh[2] + sun->sRectJ2000[2];
 
     // geocentric eq. J2000.0    
     xe = xg;
     ye = yg * cos(ea2000) - zg * sin(ea2000);
     ze = yg * sin(ea2000) + zg * cos(ea2000);
 
-    a->orbit.r = r;
-    a->orbit.R = sqrt(xg * xg + yg * yg + zg *zg);
-    R = a->orbit.R;
+    orbit->r = r;
+    orbit->R = sqrt(xg * xg + yg * yg + zg *zg);
+    R = orbit->R;
 
-    a->orbit.light = SECTODAY(a->orbit.R * AU1 / LSPEED);
-    t -= a->orbit.light;
+    orbit->light = SECTODAY(orbit->R * AU1 / LSPEED);
+    t -= orbit->light;
   }
 
   // from skychart sw
-  double D = ((qMax(0.0, 1 - log(a->orbit.r)) / qMax(1.0, a->H - 2.0)) * 30.0 / a->orbit.R) * 60;
-  double L = qMax(0.0, 1. - log(a->orbit.r)) / pow(qMax(1.0, (double)a->H), 1.5);
+  double D = ((qMax(0.0, 1 - log(orbit->r)) / qMax(1.0, a->H - 2.0)) * 30.0 / orbit->R) * 60;
+  double L = qMax(0.0, 1. - log(orbit->r)) / pow(qMax(1.0, (double)a->H), 1.5);
 
-  a->orbit.params[2] = D;
-  a->orbit.params[3] = L * AU1;
+  orbit->params[2] = D;
+  orbit->params[3] = L * AU1;
 
   double d = 1 / sqrt(POW2(rh[0]) + POW2(rh[1]) + POW2(rh[2]));
   double nsx = rh[0] * d;
@@ -245,44 +249,44 @@ static bool comSolve2(comet_t *a, double jdt, bool lightCorrected = true)
   double ty = rh[1] + nsy * L;
   double tz = rh[2] + nsz * L;
 
-  tx += xs;
-  ty += ys;
-  tz += zs;
+  tx += sun->sRectJ2000[0];
+  ty += sun->sRectJ2000[1];
+  tz += sun->sRectJ2000[2];
 
   double txe = tx;
   double tye = ty * cos(ea2000) - tz * sin(ea2000);
   double tze = ty * sin(ea2000) + tz * cos(ea2000);
 
   // tail end ra/dec
-  a->orbit.params[0] = atan2(tye, txe);
-  a->orbit.params[1] = atan2(tze, sqrt(txe * txe + tye * tye));
+  orbit->params[0] = atan2(tye, txe);
+  orbit->params[1] = atan2(tze, sqrt(txe * txe + tye * tye));
 
-  a->orbit.gRD.Ra  = atan2(ye, xe);
-  a->orbit.gRD.Dec = atan2(ze, sqrt(xe * xe + ye * ye));
-  rangeDbl(&a->orbit.gRD.Ra, MPI2);
+  orbit->gRD.Ra  = atan2(ye, xe);
+  orbit->gRD.Dec = atan2(ze, sqrt(xe * xe + ye * ye));
+  rangeDbl(&orbit->gRD.Ra, MPI2);
 
-  precess(&a->orbit.gRD.Ra, &a->orbit.gRD.Dec, JD2000, jdt);
-  precess(&a->orbit.params[0], &a->orbit.params[1], JD2000, jdt);
+  precess(&orbit->gRD.Ra, &orbit->gRD.Dec, JD2000, jdt);
+  precess(&orbit->params[0], &orbit->params[1], JD2000, jdt);
 
-  a->orbit.mag = a->H + 5 * log10(a->orbit.R) + 2.5 * a->G * log10(a->orbit.r);
+  orbit->mag = a->H + 5 * log10(orbit->R) + 2.5 * a->G * log10(orbit->r);
 
   double gLon, gLat, gSunLon, gSunLat;
 
-  cAstro.convRD2Ecl(a->orbit.gRD.Ra, a->orbit.gRD.Dec, &gLon, &gLat);
-  cAstro.convRD2Ecl(sunOrbit.gRD.Ra, sunOrbit.gRD.Dec, &gSunLon, &gSunLat);
+  astro->convRD2Ecl(orbit->gRD.Ra, orbit->gRD.Dec, &gLon, &gLat);
+  astro->convRD2Ecl(sun->gRD.Ra, sun->gRD.Dec, &gSunLon, &gSunLat);
 
-  a->orbit.elongation = CAstro::calcElongation(gSunLon, gLon, gLat);
+  orbit->elongation = CAstro::calcElongation(gSunLon, gLon, gLat);
 
-  a->orbit.sx = 0;
-  a->orbit.sy = 0;
+  orbit->sx = 0;
+  orbit->sy = 0;
 
-  a->orbit.phase = 1;
+  orbit->phase = 1;
 
   #pragma omp critical
   {
-    cAstro.calcParallax(&a->orbit);
-    cAstro.convRD2AARef(a->orbit.lRD.Ra, a->orbit.lRD.Dec,
-                       &a->orbit.lAzm, &a->orbit.lAlt);
+    astro->calcParallax(orbit);
+    astro->convRD2AARef(orbit->lRD.Ra, orbit->lRD.Dec,
+                       &orbit->lAzm, &orbit->lAlt);
   }
 
   return(true);
@@ -311,13 +315,24 @@ bool comSolve(comet_t *a, double jdt, bool lightCorrected)
 
   a->lastJD = jdt;
 
-  return(comSolve2(a, jdt, lightCorrected));
+  return(comSolve2(a, &a->orbit, &cAstro, &sunOrbit, jdt, lightCorrected));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool comSolve(const comet_t *a, double jdt, CAstro *astro, const orbit_t *sun, orbit_t *out, bool lightCorrected)
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// reentrant version (sun = astro->calcPlanet(PT_EARTH, sun, true, true, false))
+{
+  return(comSolve2(a, out, astro, sun, jdt, lightCorrected));
 }
 
 ////////////////////////////////////////////////////////////
 void comRender(CSkPainter *p, mapView_t *view, float maxMag)
 ////////////////////////////////////////////////////////////
 {
+  g_lazyComets.ensure();
+
   if (tComets.count() == 0)
     return;
 
@@ -591,9 +606,13 @@ void comRender(CSkPainter *p, mapView_t *view, float maxMag)
 bool comLoad(QString fileName)
 //////////////////////////////
 {
+  g_lazyComets.ensure();
+
   if (fileName.isEmpty())
     return(false);
 
+  comNameIndexChanged();
+
   SkFile       f(fileName);
   QTextStream s(&f);
 
@@ -717,6 +736,8 @@ QString comCreateLine(comet_t *a)
 bool comSave(QString fileName, QWidget *parent)
 ///////////////////////////////////////////////
 {
+  g_lazyComets.ensure();
+
   if (tComets.count() == 0)
   {
     curCometCatName = "";
@@ -757,15 +778,47 @@ bool comSave(QString fileName, QWidget *parent)
 void comClear(void)
 ///////////////////
 {
+  g_lazyComets.ensure();
+
   tComets.clear();
+  comNameIndexChanged();
   curCometCatName = "";
 }
 
+////////////////////////////////////
+const CNameIndex *comNameIndex(void)
+////////////////////////////////////
+{
+  g_lazyComets.ensure();
+
+  if (!comIndexValid || comIndex.count() != tComets.count())
+  {
+    comIndex.clear();
+    for (int i = 0; i < tComets.count(); i++)
+    {
+      comIndex.add(tComets[i].name, i);
+    }
+    comIndex.build();
+    comIndexValid = true;
+  }
+
+  return &comIndex;
+}
+
+//////////////////////////////
+void comNameIndexChanged(void)
+//////////////////////////////
+{
+  comIndexValid = false;
+}
+
 
 CComDlg::CComDlg(QWidget *parent) :
   QDialog(parent),
   ui(new Ui::CComDlg)
 {
+  g_lazyComets.ensure();
+
   cSaveQuest = tr("Save current catalogue to disc?");
 
   ui->setupUi(this);
@@ -809,6 +862,8 @@ void CComDlg::changeEvent(QEvent *e)
 void CComDlg::updateDlg()
 ///////////////////////////
 {
+  comNameIndexChanged();
+
   setWindowTitle(tr("Comets ") + curCometCatName);
 
   ui->lineEdit_2->setText(QString("%1").arg(tComets.count()));
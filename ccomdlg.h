@@ -28,6 +28,7 @@
 #include "cmapview.h"
 #include "cskpainter.h"
 #include "transform.h"
+#include "cnameindex.h"
 
 #define  COM_ZOOM     D2R(2)
 
@@ -54,7 +55,10 @@ void comRender(CSkPainter *p, mapView_t *view, float maxMag);
 bool comSave(QString fileName, QWidget *parent);
 bool comLoad(QString fileName);
 bool comSolve(comet_t *a, double jdt, bool lightCorrected = true);
+bool comSolve(const comet_t *a, double jdt, CAstro *astro, const orbit_t *sun, orbit_t *out, bool lightCorrected = true);
 void comClear(void);
+const CNameIndex *comNameIndex(void);
+void comNameIndexChanged(void);
 
 double unpackMPCDate(QString str);
 
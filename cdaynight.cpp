@@ -4,6 +4,50 @@
 #include "castro.h"
 #include "cskpainter.h"
 
+///////////////////////////////////////////////////////
+// shade alpha indexed by sin(sun altitude)
+static void buildShadeLut(int *lut, bool smooth)
+///////////////////////////////////////////////////////
+{
+  // twilight band limits and alpha
+  const double alt[4] = {0, -6, -12, -18};
+  const int    shade[5] = {0, 64, 120, 180, 255};
+  const double aa = 0.25; // band edge width (deg.)
+
+  for (int i = 0; i < SHD_LUT; i++)
+  {
+    double h = RAD2DEG(asin(CLAMP(i / (double)(SHD_LUT - 1) * 2 - 1, -1, 1)));
+    double v;
+
+    if (smooth)
+    {
+      if (h >= alt[0])
+        v = shade[0];
+      else
+      if (h <= alt[3])
+        v = shade[4];
+      else
+      {
+        int b = (int)(-h / 6);
+
+        v = LERP((alt[b] - h) / 6, (b == 0) ? shade[0] : shade[b + 1], shade[b + 2]);
+      }
+    }
+    else
+    {
+      v = shade[0];
+      for (int b = 0; b < 4; b++)
+      {
+        double f = CLAMP((alt[b] + aa * 0.5 - h) / aa, 0, 1);
+
+        v += f * (shade[b + 1] - shade[b]);
+      }
+    }
+
+    lut[i] = qBound(0, (int)(v + 0.5), 255);
+  }
+}
+
 ////////////////////////////////////////
 CDayNight::CDayNight(QWidget *parent, mapView_t *view) :
   QDialog(parent),
@@ -20,7 +64,36 @@ CDayNight::CDayNight(QWidget *parent, mapView_t *view) :
   m_day = new QImage("../data/maps/earth_day.jpg");
   m_night = new QImage("../data/maps/earth_night.jpg");
   m_img = new QImage(m_day->width(), m_day->height(), QImage::Format_ARGB32_Premultiplied);
-  m_shade = new QImage(SHD_X, SHD_Y, QImage::Format_ARGB32_Premultiplied);
+  m_dayStripJD = CM_UNDEF;
+
+  buildShadeLut(m_shadeLut[0], false);
+  buildShadeLut(m_shadeLut[1], true);
+
+  // pixel centers, lon -180..180, lat 90..-90
+  int w = m_img->width();
+  int h = m_img->height();
+
+  m_colCos.resize(w);
+  m_colSin.resize(w);
+  for (int x = 0; x < w; x++)
+  {
+    double lon = (x + 0.5) / w * MPI2 - MPI;
+
+    m_colCos[x] = cos(lon);
+    m_colSin[x] = sin(lon);
+  }
+
+  m_rowCos.resize(h);
+  m_rowSin.resize(h);
+  for (int y = 0; y < h; y++)
+  {
+    double lat = R90 - (y + 0.5) / h * MPI;
+
+    m_rowCos[y] = cos(lat);
+    m_rowSin[y] = sin(lat);
+  }
+
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(slotAnimate()));
 
   updateMap();
 }
@@ -32,7 +105,6 @@ CDayNight::~CDayNight()
   delete m_day;
   delete m_night;
   delete m_img;
-  delete m_shade;
 
   delete ui;
 }
@@ -94,24 +166,33 @@ void CDayNight::paintEvent(QPaintEvent *)
 
   rc2.adjust(1, 1, 0, -1);
 
-  double jdStep = 1 / 24.0;
-  mapView_t    view;
+  p.setRenderHint(QPainter::SmoothPixmapTransform, true);
+  p.drawImage(rc2, m_dayStrip);
+}
+
+
+///////////////////////////////////////
+// sun altitude at observer per hour
+void CDayNight::updateDayStrip()
+///////////////////////////////////////
+{
+  double       jd = getStartOfDay(m_jd, m_view.geo.tz);
+  mapView_t    view = m_view;
   CAstro       ast;
   orbit_t      sun;
 
-  view = m_view;  
-  double jd = getStartOfDay(m_jd, view.geo.tz);
-
-  QImage img(24, 1, QImage::Format_ARGB32);
-  img.fill(Qt::blue);
+  if (jd == m_dayStripJD)
+  {
+    return;
+  }
 
-  p.setRenderHint(QPainter::SmoothPixmapTransform, true);
+  m_dayStripJD = jd;
+  m_dayStrip = QImage(24, 1, QImage::Format_ARGB32);
 
   for (int i = 0; i < 24; i++)
   {
-    view.jd = jd;
+    view.jd = jd + i / 24.0;
     ast.setParam(&view);
-    ast.sunEphemerid_Fast(&sun);
     ast.calcPlanet(PT_SUN, &sun);
 
     int c;
@@ -131,28 +212,10 @@ void CDayNight::paintEvent(QPaintEvent *)
     else
       c = 250;
 
-    img.setPixel(i, 0, QColor(c, c, c).rgba());
-    jd += jdStep;
+    m_dayStrip.setPixel(i, 0, QColor(c, c, c).rgba());
   }
-
-  p.drawImage(rc2, img);
 }
 
-
-///////////////////////////////////////////////////////////////////////////////
-double CDayNight::getDistance(double lon, double lat, double lon2, double lat2)
-///////////////////////////////////////////////////////////////////////////////
-{
-  double dLat = (lat2 - lat);
-  double dLon = (lon2 - lon);
-  double a = POW2(sin(dLat / 2)) +
-                  cos((lat)) * cos((lat2)) *
-                  POW2(sin(dLon / 2));
-  double c = 2 * atan2(sqrt(a), sqrt(1 - a));
-  return(c);
-}
-
-
 ///////////////////////////
 void CDayNight::updateMap()
 ///////////////////////////
@@ -181,77 +244,53 @@ void CDayNight::updateMap()
 
   rangeDbl(&sLon, R360);
 
-  for (int y = 0; y < SHD_Y; y++)
+  updateDayStrip();
+
+  // sin(alt) = sin(lat) sin(dec) + cos(lat) cos(dec) cos(lon - sLon)
+  int          w = m_img->width();
+  int          h = m_img->height();
+  const int   *lut = m_shadeLut[ui->checkBox->isChecked() ? 1 : 0];
+  float        cosSLon = cos(sLon);
+  float        sinSLon = sin(sLon);
+  float        sinDec = sin(sLat);
+  float        cosDec = cos(sLat);
+  QVector <float> colCos(w);
+  float       *cc = colCos.data();
+  const float *colCosLon = m_colCos.constData();
+  const float *colSinLon = m_colSin.constData();
+  const float *rowSinLat = m_rowSin.constData();
+  const float *rowCosLat = m_rowCos.constData();
+  const float  lutScale = 0.5f * (SHD_LUT - 1);
+  uchar       *bits = m_img->bits();
+  int          bpl = m_img->bytesPerLine();
+
+  for (int x = 0; x < w; x++)
   {
-    QRgb *data = (QRgb *)m_shade->bits() + y * SHD_X;
-    double lat = y * (180 / (double)SHD_Y) - 90.0;
-    for (int x = 0; x < SHD_X; x++)
-    {
-      double lon = x * (360 / (double)SHD_X) - 180.0;
-
-      double d = getDistance(sLon, sLat, DEG2RAD(lon), DEG2RAD(-lat));
-      int    i;
-
-      if (d > DEG2RAD(90 + 18))
-        i = 255;      
-      else
-      if (d > DEG2RAD(90 + 12))
-        i = 180;
-      else
-      if (d > DEG2RAD(90 + 6))
-        i = 120;
-      else
-      if (d > DEG2RAD(90))
-        i = 64;      
-      else
-        i = 0;
-
-      *data = QColor(0, 0, 0, i).rgba();
-      data++;
-    }
+    cc[x] = colCosLon[x] * cosSLon + colSinLon[x] * sinSLon;
   }
 
-  QImage b;
-  if (ui->checkBox->isChecked())
-  {
-    b = blurredImage(*m_shade, 6, true);
-  }
-  else
+  #pragma omp parallel for schedule(static)
+  for (int y = 0; y < h; y++)
   {
-    b = *m_shade;
-  }
-
-  float qx = 0;
-  float qy = 0;
-
-  float addx = SHD_X / (float)m_img->width();
-  float addy = SHD_Y / (float)m_img->height();
+    float       rs = rowSinLat[y] * sinDec;
+    float       rc = rowCosLat[y] * cosDec;
+    QRgb       *data = (QRgb *)(bits + y * bpl);
+    const QRgb *day = (const QRgb *)m_day->constScanLine(y);
+    const QRgb *night = (const QRgb *)m_night->constScanLine(y);
 
-  for (int y = 0; y < m_img->height(); y++)
-  {
-    const QRgb *pb = (QRgb *)b.bits() + (int)qy * b.width();
-    QRgb *data = (QRgb *)m_img->bits() + y * m_img->width();
-    const QRgb *day = (QRgb *)m_day->bits() + y * m_day->width();
-    const QRgb *night = (QRgb *)m_night->bits() + y * m_night->width();
-    qx = 0;
-    for (int x = 0; x < m_img->width(); x++)
+    for (int x = 0; x < w; x++)
     {
-      QColor n = *night;
-      QColor d = *day;
-
-      float f = ((*(pb + (int)qx) >> 24) & 0xff) / 256.f;
-
-      *data = QColor(LERP(f, d.red(), n.red()),
-                     LERP(f, d.green(), n.green()),
-                     LERP(f, d.blue(), n.blue())).rgb();
-
-      night++;
-      day++;
-      data++;
-
-      qx += addx;
+      int i = (int)((rs + rc * cc[x] + 1.0f) * lutScale + 0.5f);
+      int f = lut[qBound(0, i, SHD_LUT - 1)];
+      int g = 256 - f;
+      QRgb d = day[x];
+      QRgb n = night[x];
+
+      data[x] = 0xff000000 |
+                (((qRed(d) * g + qRed(n) * f) >> 8) << 16) |
+                (((qGreen(d) * g + qGreen(n) * f) >> 8) << 8) |
+                ((qBlue(d) * g + qBlue(n) * f) >> 8);
     }
-    qy += addy;
   }
 
   CSkPainter p;
@@ -405,3 +444,21 @@ void CDayNight::on_checkBox_toggled(bool checked)
 {
   updateMap();
 }
+
+/////////////////////////////////////////////////////
+void CDayNight::on_checkBox_2_toggled(bool checked)
+/////////////////////////////////////////////////////
+{
+  if (checked)
+    m_timer.start(SHD_ANIM_MS);
+  else
+    m_timer.stop();
+}
+
+///////////////////////////////
+void CDayNight::slotAnimate()
+///////////////////////////////
+{
+  m_jd += SHD_ANIM_STEP;
+  updateMap();
+}
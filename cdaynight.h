@@ -26,8 +26,9 @@
 #include "skcore.h"
 #include "cmapview.h"
 
-#define SHD_X     512
-#define SHD_Y     256
+#define SHD_LUT       4096                 // sin(sun altitude) -> shade
+#define SHD_ANIM_MS   40
+#define SHD_ANIM_STEP (5 / 24.0 / 60.0)    // days per frame
 
 namespace Ui {
 class CDayNight;
@@ -46,12 +47,20 @@ protected:
   void changeEvent(QEvent *e);
   void paintEvent(QPaintEvent *);
   void updateMap(void);
-  double getDistance(double lon, double lat, double lon2, double lat2);
+  void updateDayStrip(void);
 
   QImage *m_day;
   QImage *m_night;
   QImage *m_img;
-  QImage *m_shade;
+  QImage  m_dayStrip;
+  double  m_dayStripJD;
+
+  int               m_shadeLut[2][SHD_LUT];   // banded, smooth
+  QVector <float>   m_colCos;
+  QVector <float>   m_colSin;
+  QVector <float>   m_rowCos;
+  QVector <float>   m_rowSin;
+  QTimer            m_timer;
 
   mapView_t  m_view;
 
@@ -84,6 +93,10 @@ private slots:
 
   void on_checkBox_toggled(bool checked);
 
+  void on_checkBox_2_toggled(bool checked);
+
+  void slotAnimate();
+
 private:
   Ui::CDayNight *ui;
 };
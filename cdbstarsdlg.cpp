@@ -23,119 +23,128 @@ CDbStarsDlg::CDbStarsDlg(QWidget *parent, double yr) :
   m_model->setHeaderData(5, Qt::Horizontal, tr("P.A."));
   m_model->setHeaderData(6, Qt::Horizontal, tr("Desc."));
 
-  SkFile f("../data/double_stars/double_stars.dat");
+  loadList(tList, yr);
 
-  if (f.open(SkFile::ReadOnly | SkFile::Text))
+  for (int i = 0; i < tList.count(); i++)
   {
-    int i = 0;
-    while (!f.atEnd())
-    {
-      QString    str = f.readLine();
-      QStringList list;
-
-      if (str.startsWith("#"))
-        continue;
-
-      list = str.split("|");
-      if (list.count() != 4)
-        continue;
-
-      dblStar_t dbl;
+    const dblStar_t &dbl = tList[i];
+
+    QStandardItem *item = new QStandardItem;
+    item->setText(dbl.name);
+    item->setData((qint64)&tList[i]);
+    m_model->setItem(i, 0, item);
+
+    int con = constWhatConstel(dbl.rd1.Ra, dbl.rd1.Dec, JD2000);
+    item = new QStandardItem;
+    item->setText(constGetName(con, 0));
+    item->setData(constGetName(con, 0));
+    m_model->setItem(i, 1, item);
+
+    item = new QStandardItem;
+    item->setText(getStrMag(dbl.mag1));
+    item->setData(dbl.mag1);
+    m_model->setItem(i, 2, item);
+
+    item = new QStandardItem;
+    item->setText(getStrMag(dbl.mag2));
+    item->setData(dbl.mag2);
+    m_model->setItem(i, 3, item);
+
+    item = new QStandardItem;
+    item->setText(QString("%1\"").arg(3600.0 * R2D(dbl.sep), 0, 'f', 1));
+    item->setData(dbl.sep);
+    m_model->setItem(i, 4, item);
+
+    item = new QStandardItem;
+    item->setText(QString("%1°").arg((int)R2D(dbl.pa)));
+    item->setData(dbl.pa);
+    m_model->setItem(i, 5, item);
+
+    item = new QStandardItem;
+    item->setText(dbl.desc);
+    m_model->setItem(i, 6, item);
+  }
 
-      dbl.name = list.at(0).simplified();
-      dbl.desc = list.at(3).simplified();
+  ui->treeView->setModel(m_proxy);
+  ui->treeView->setRootIsDecorated(false);
+  ui->treeView->header()->resizeSection(0, 150);
+  ui->treeView->header()->resizeSection(1, 60);
+  ui->treeView->header()->resizeSection(2, 80);
+  ui->treeView->header()->resizeSection(3, 80);
+  ui->treeView->header()->resizeSection(4, 80);
+  ui->treeView->header()->resizeSection(5, 80);
+  ui->treeView->header()->resizeSection(6, 150);
+  ui->treeView->setSortingEnabled(true);
+}
 
-      int tyc1[3];
-      int tyc2[3];
+CDbStarsDlg::~CDbStarsDlg()
+{
+  delete m_model;
+  delete m_proxy;
+  delete ui;
+}
 
-      getTYC(list.at(1), tyc1);
-      getTYC(list.at(2), tyc2);
+/////////////////////////////////////////////////////////////
+// load double star list (positions at epoch yr)
+void CDbStarsDlg::loadList(QList<dblStar_t> &list, double yr)
+/////////////////////////////////////////////////////////////
+{
+  SkFile f("../data/double_stars/double_stars.dat");
 
-      tychoStar_t *t1 = cTYC.findTYCStar(tyc1);
-      tychoStar_t *t2 = cTYC.findTYCStar(tyc2);
+  if (!f.open(SkFile::ReadOnly | SkFile::Text))
+  {
+    return;
+  }
 
-      if (t1 && t2)
-      {
-        dbl.mag1 = cTYC.getVisMag(t1);
-        dbl.mag2 = cTYC.getVisMag(t2);
+  while (!f.atEnd())
+  {
+    QString    str = f.readLine();
+    QStringList items;
 
-        dbl.tyc[0] = t1->tyc1;
-        dbl.tyc[1] = t1->tyc2;
-        dbl.tyc[2] = t1->tyc3;
+    if (str.startsWith("#"))
+      continue;
 
-        radec_t rd1;
-        radec_t rd2;
+    items = str.split("|");
+    if (items.count() != 4)
+      continue;
 
-        cTYC.getStarPos(rd1, t1, yr);
-        cTYC.getStarPos(rd2, t2, yr);
+    dblStar_t dbl;
 
-        float sep = anSep(rd1.Ra, rd1.Dec, rd2.Ra, rd2.Dec);
-        float pa = trfGetPosAngle(rd2.Ra, rd2.Dec, rd1.Ra, rd1.Dec);
-        getRDCenter(&dbl.rd, &rd1, &rd2);
-        dbl.sep = sep;
+    dbl.name = items.at(0).simplified();
+    dbl.desc = items.at(3).simplified();
 
-        tList.append(dbl);
+    int tyc1[3];
+    int tyc2[3];
 
-        QStandardItem *item = new QStandardItem;
-        item->setText(dbl.name);
-        item->setData((qint64)&tList[i]);
-        m_model->setItem(i, 0, item);
+    getTYC(items.at(1), tyc1);
+    getTYC(items.at(2), tyc2);
 
-        int con = constWhatConstel(t1->rd.Ra, t1->rd.Dec, JD2000);
-        item = new QStandardItem;
-        item->setText(constGetName(con, 0));
-        item->setData(constGetName(con, 0));
-        m_model->setItem(i, 1, item);
+    tychoStar_t *t1 = cTYC.findTYCStar(tyc1);
+    tychoStar_t *t2 = cTYC.findTYCStar(tyc2);
 
-        item = new QStandardItem;
-        item->setText(getStrMag(dbl.mag1));
-        item->setData(dbl.mag1);
-        m_model->setItem(i, 2, item);
+    if (t1 && t2)
+    {
+      dbl.mag1 = cTYC.getVisMag(t1);
+      dbl.mag2 = cTYC.getVisMag(t2);
 
-        item = new QStandardItem;
-        item->setText(getStrMag(dbl.mag2));
-        item->setData(dbl.mag2);
-        m_model->setItem(i, 3, item);
+      dbl.tyc[0] = t1->tyc1;
+      dbl.tyc[1] = t1->tyc2;
+      dbl.tyc[2] = t1->tyc3;
 
-        item = new QStandardItem;
-        item->setText(QString("%1\"").arg(3600.0 * R2D(sep), 0, 'f', 1));
-        item->setData(sep);
-        m_model->setItem(i, 4, item);
+      radec_t rd1;
+      radec_t rd2;
 
-        item = new QStandardItem;
-        item->setText(QString("%1°").arg((int)R2D(pa)));
-        item->setData(pa);
-        m_model->setItem(i, 5, item);
+      cTYC.getStarPos(rd1, t1, yr);
+      cTYC.getStarPos(rd2, t2, yr);
 
-        item = new QStandardItem;
-        item->setText(dbl.desc);
-        m_model->setItem(i, 6, item);
+      dbl.rd1 = t1->rd;
+      dbl.sep = anSep(rd1.Ra, rd1.Dec, rd2.Ra, rd2.Dec);
+      dbl.pa = trfGetPosAngle(rd2.Ra, rd2.Dec, rd1.Ra, rd1.Dec);
+      getRDCenter(&dbl.rd, &rd1, &rd2);
 
-        i++;
-      }
-      else
-      {
-      }
+      list.append(dbl);
     }
   }
-
-  ui->treeView->setModel(m_proxy);
-  ui->treeView->setRootIsDecorated(false);
-  ui->treeView->header()->resizeSection(0, 150);
-  ui->treeView->header()->resizeSection(1, 60);
-  ui->treeView->header()->resizeSection(2, 80);
-  ui->treeView->header()->resizeSection(3, 80);
-  ui->treeView->header()->resizeSection(4, 80);
-  ui->treeView->header()->resizeSection(5, 80);
-  ui->treeView->header()->resizeSection(6, 150);
-  ui->treeView->setSortingEnabled(true);
-}
-
-CDbStarsDlg::~CDbStarsDlg()
-{
-  delete m_model;
-  delete m_proxy;
-  delete ui;
 }
 
 ///////////////////////////////////////////////
@@ -34,7 +34,9 @@ typedef struct
   QString name;
   QString desc;
   radec_t rd;
+  radec_t rd1;     // primary J2000 position
   double  sep;
+  float   pa;
   float   mag1;
   float   mag2;
   int     tyc[3];
@@ -69,9 +71,11 @@ public:
   double m_fov;
   mapObj_t m_mapObj;
 
+  static void loadList(QList <dblStar_t> &list, double yr);
+
 protected:
   QList <dblStar_t> tList;
-  void getTYC(QString str, int *out);
+  static void getTYC(QString str, int *out);
   MyProxyDblModel* m_proxy;
   QStandardItemModel *m_model;
 
@@ -716,7 +716,9 @@ void CDrawing::setTelescopePos(drawing_t *drawing)
   if (drawing && drawing->telescopeLink && g_pTelePlugin && pcMapView->m_lastTeleRaDec.Ra != CM_UNDEF)
   { // draw telescope pos.
     radec_t rd;
-    precess(&pcMapView->m_lastTeleRaDec, &rd, pcMapView->m_mapView.jd, JD2000);
+    radec_t tele = g_teleState.isValid() ? g_teleState.position() : pcMapView->m_lastTeleRaDec;
+
+    precess(&tele, &rd, pcMapView->m_mapView.jd, JD2000);
     drawing->rd = rd;
   }
 }
@@ -122,9 +122,29 @@ void CDso::load()
   }
   free(dsoNames);
 
+  // create name index (same order as the old linear search)
+  m_nameIndex.clear();
+  for (qint32 i = 0; i < dsoHead.numDso; i++)
+  {
+    const QStringList &names = namesMap[dso[i].nameOffs];
+
+    for (int j = 0; j < qMin(names.count(), 20); j++)
+    {
+      m_nameIndex.add(names[j], i);
+    }
+  }
+
   loadShapes();
   loadNames();
 
+  m_commonIndex.clear();
+  for (int c = 0; c < tDsoCommonNames.count(); c++)
+  {
+    m_commonIndex.add(tDsoCommonNames[c].commonName, c);
+  }
+
+  m_nameIndex.build();
+
   //qDebug() << getCatalogue(&dso[dsoHead.numDso - 10]);
 }
 
@@ -331,41 +351,31 @@ int CDso::findDSO(char *pszName, dso_t **pDso, int &index)
   if (pszName[0] == '\0')
     return(-1);
 
-  for (qint32 i = 0; i < dsoHead.numDso; i++)
+  foreach (int id, m_nameIndex.find(pszName))
   {
-    for (int j = 0; j < 20; j++)
+    if (compareName(m_nameIndex.name(id).toLatin1().data(), pszName))
     {
-      QString pName = getName(&dso[i], j);
-      if (pName.length() == 0)
-      {
-        break;
-      }
-      if (compareName(pName.toLatin1().data(), pszName))
-      {
-        *pDso = &dso[i];
-        index = i;
-        return(i);
-      }
+      int i = m_nameIndex.data(id);
+
+      *pDso = &dso[i];
+      index = i;
+      return(i);
     }
   }
 
-  for (int c = 0; c < tDsoCommonNames.count(); c++)
+  foreach (int c, m_commonIndex.find(pszName))
   {
     if (tDsoCommonNames[c].commonName.compare(pszName, Qt::CaseInsensitive) == 0)
     {
-      for (qint32 i = 0; i < dsoHead.numDso; i++)
+      foreach (int id, m_nameIndex.find(tDsoCommonNames[c].catName))
       {
-        for (int j = 0; j < 20; j++)
+        if (compareName(m_nameIndex.name(id).toLatin1().data(), tDsoCommonNames[c].catName))
         {
-          QString pName = getName(&dso[i], j);
-          if (pName.length() == 0)
-            break;
-          if (compareName(pName.toLatin1().data(), tDsoCommonNames[c].catName))
-          {
-            *pDso = &dso[i];
-            index = i;
-            return(i);
-          }
+          int i = m_nameIndex.data(id);
+
+          *pDso = &dso[i];
+          index = i;
+          return(i);
         }
       }
     }
@@ -384,11 +394,11 @@ int CDso::findDSOFirstName(char *pszName)
 
   name.remove(" ");
 
-  for (qint32 i = 0; i < dsoHead.numDso; i++)
+  foreach (int id, m_nameIndex.find(name))
   {
-    QString pName = getName(&dso[i], 0);
+    int i = m_nameIndex.data(id);
 
-    if (pName.compare(name, Qt::CaseInsensitive) == 0)
+    if (getName(&dso[i], 0).compare(name, Qt::CaseInsensitive) == 0)
     {
       return(i);
     }
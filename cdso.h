@@ -27,6 +27,7 @@
 #include "cmapview.h"
 #include "cskpainter.h"
 #include "cshape.h"
+#include "cnameindex.h"
 
 #define NUM_DSO_SEG_Y    24
 #define NUM_DSO_SEG_X    48
@@ -58,6 +59,7 @@ class CDso : public QObject
     int renderObj(SKPOINT *pt, dso_t *pDso, mapView_t *mapView, bool addToList = true, double opacity = 1);
     int  findDSO(char *pszName, dso_t **pDso, int &index);
     int  findDSOFirstName(char *pszName);
+    const CNameIndex *nameIndex() { return &m_nameIndex; }
     QString getTypeName(int type, bool &ok);
     QString getCatalogue(dso_t *pDso);
     QString getCatalogue(int index);
@@ -109,6 +111,9 @@ private:
     QPen             m_pen;
     int              m_lastSize;
 
+    CNameIndex       m_nameIndex;      // all dso names -> dso index
+    CNameIndex       m_commonIndex;    // common names -> tDsoCommonNames index
+
     void loadNames();
     void loadShapes();
 };
@@ -0,0 +1,411 @@
+#include "cephengine.h"
+#include "skcore.h"
+#include "mapobj.h"
+#include "precess.h"
+
+////////////////////////////////////////////////////////////////////////
+CEphEngine::CEphEngine(const mapView_t *view, const ephParams_t &params)
+////////////////////////////////////////////////////////////////////////
+{
+  m_view = *view;
+  m_params = params;
+  m_columns = params.columns.toVector();
+  m_end = false;
+  m_error = false;
+
+  // the catalogues may change while running
+  if (m_params.type == MO_COMET)
+  {
+    m_comet = tComets[m_params.obj];
+  }
+  else
+  if (m_params.type == MO_ASTER)
+  {
+    m_aster = tAsteroids[m_params.obj];
+  }
+}
+
+////////////////////////
+void CEphEngine::stop()
+////////////////////////
+{
+  m_end = true;
+}
+
+//////////////////////////////////
+bool CEphEngine::isError() const
+//////////////////////////////////
+{
+  return m_error;
+}
+
+/////////////////////////////////
+bool CEphEngine::isMoon() const
+/////////////////////////////////
+{
+  return m_params.type == MO_PLANET && m_params.obj == PT_MOON;
+}
+
+///////////////////////////////////////////
+QVector<double> CEphEngine::takeValues()
+///////////////////////////////////////////
+{
+  QVector <double> values = m_values;
+
+  m_values.clear();
+
+  return values;
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+QString CEphEngine::formatValue(int column, double value, double tz, bool isMoon)
+///////////////////////////////////////////////////////////////////////////////////
+{
+  switch (column)
+  {
+    case 0:
+      return QString::number(value, 'f', 6);
+
+    case 1:
+      return getStrDate(value, tz);
+
+    case 2:
+      return getStrTime(value, tz);
+
+    case 3:
+      return getStrMag(value);
+
+    case 4:
+      return QString::number(value, 'f', 3);
+
+    case 5:
+      return QString::number(R2D(value), 'f', 1) + "°";
+
+    case 6:
+    case 7:
+      return QString::number(value, 'f', 2) + "\"";
+
+    case 8:
+    case 10:
+    case 12:
+      return getStrRA(value);
+
+    case 9:
+    case 11:
+    case 13:
+    case 14:
+    case 15:
+    case 19:
+    case 20:
+      return getStrDeg(value);
+
+    case 16:
+      if (!isMoon)
+      {
+        return QString::number(value, 'f', 6) + " AU";
+      }
+      return QString::number(value * EARTH_DIAM) + QCoreApplication::translate("CEphList", " Km");
+
+    case 17:
+      if (!isMoon)
+      {
+        return QString::number(value, 'f', 6) + " AU";
+      }
+      return QCoreApplication::translate("CEphList", "N/A");
+
+    case 18:
+      return ((value >= 0) ? "+" : "") + QString::number(R2D(value), 'f', 2) + "°";
+
+    case 21:
+    case 22:
+    case 23:
+      return QString::number(value, 'f', 6) + " AU";
+
+    case 24:
+      return QString::number(value * 24. * 60., 'f', 2) + QCoreApplication::translate("CEphList", " mins.");
+  }
+
+  return QString();
+}
+
+///////////////////////////////////////////////////////////////////////////
+// reentrant (own CAstro per thread)
+void CEphEngine::calcRow(CAstro *astro, mapView_t *view, double *out) const
+///////////////////////////////////////////////////////////////////////////
+{
+  orbit_t o;
+  orbit_t sun;
+
+  astro->setParam(view);
+
+  switch (m_params.type)
+  {
+    case MO_PLANET:
+      astro->calcPlanet(m_params.obj, &o);
+      break;
+
+    case MO_COMET:
+      astro->calcPlanet(PT_EARTH, &sun, true, true, false);
+      comSolve(&m_comet, view->jd, astro, &sun, &o);
+      break;
+
+    case MO_ASTER:
+      astro->calcPlanet(PT_EARTH, &sun, true, true, false);
+      astSolve(&m_aster, view->jd, astro, &sun, &o);
+      break;
+  }
+
+  double ra2000 = o.lRD.Ra;
+  double dec2000 = o.lRD.Dec;
+
+  if (m_columns.contains(10) || m_columns.contains(11))
+  {
+    precess(&ra2000, &dec2000, view->jd, JD2000);
+  }
+
+  for (int j = 0; j < m_columns.count(); j++)
+  {
+    double v = 0;
+
+    switch (m_columns[j])
+    {
+      case 0:
+      case 1:
+      case 2:
+        v = view->jd;
+        break;
+
+      case 3:
+        v = o.mag;
+        break;
+
+      case 4:
+        v = o.phase;
+        break;
+
+      case 5:
+        v = o.PA;
+        break;
+
+      case 6:
+        v = o.sx;
+        break;
+
+      case 7:
+        v = o.sy;
+        break;
+
+      case 8:
+        v = o.lRD.Ra;
+        break;
+
+      case 9:
+        v = o.lRD.Dec;
+        break;
+
+      case 10:
+        v = ra2000;
+        break;
+
+      case 11:
+        v = dec2000;
+        break;
+
+      case 12:
+        v = o.gRD.Ra;
+        break;
+
+      case 13:
+        v = o.gRD.Dec;
+        break;
+
+      case 14:
+        v = o.lAzm;
+        break;
+
+      case 15:
+        v = o.lAlt;
+        break;
+
+      case 16:
+        v = o.R;
+        break;
+
+      case 17:
+        v = o.r;
+        break;
+
+      case 18:
+        v = o.elongation;
+        break;
+
+      case 19:
+        v = o.hLon;
+        break;
+
+      case 20:
+        v = o.hLat;
+        break;
+
+      case 21:
+        v = o.hRect[0];
+        break;
+
+      case 22:
+        v = o.hRect[1];
+        break;
+
+      case 23:
+        v = o.hRect[2];
+        break;
+
+      case 24:
+        v = o.light;
+        break;
+    }
+
+    out[j] = v;
+  }
+}
+
+/////////////////////
+void CEphEngine::run()
+/////////////////////
+{
+  SkFile          f(m_params.fileName);
+  QTextStream     ts;
+  ephFileHeader_t head;
+  int             cols = m_columns.count();
+  bool            moon = isMoon();
+
+  m_values.clear();
+
+  if (m_params.format != EE_FMT_MEMORY)
+  {
+    QIODevice::OpenMode mode = SkFile::WriteOnly;
+
+    if (m_params.format == EE_FMT_CSV)
+    {
+      mode |= SkFile::Text;
+    }
+
+    if (!f.open(mode))
+    {
+      m_error = true;
+      emit sigDone();
+      return;
+    }
+  }
+
+  if (m_params.format == EE_FMT_BINARY)
+  {
+    memset(&head, 0, sizeof(head));
+    memcpy(head.magic, EE_MAGIC, sizeof(head.magic));
+    head.columns = cols;
+    head.isMoon = moon;
+    head.tz = m_params.tz;
+
+    for (int j = 0; j < cols; j++)
+    {
+      head.column[j] = m_columns[j];
+    }
+
+    m_error = f.write((const char *)&head, sizeof(head)) != sizeof(head);
+  }
+  else
+  if (m_params.format == EE_FMT_CSV)
+  {
+    ts.setDevice(&f);
+
+    foreach (const QString &str, m_params.header)
+    {
+      ts << str << ";";
+    }
+    ts << "\n";
+  }
+
+  QVector <double> block(EE_BLOCK * cols);
+  double          *out = block.data();
+  qint64           done = 0;
+  int              lastPercent = -1;
+
+  while (done < m_params.count && !m_end && !m_error)
+  {
+    int n = (int)qMin((qint64)EE_BLOCK, m_params.count - done);
+
+    #pragma omp parallel
+    {
+      CAstro    astro;
+      mapView_t view = m_view;
+
+      #pragma omp for schedule(static)
+      for (int i = 0; i < n; i++)
+      {
+        view.jd = m_params.jdFrom + (done + i) * m_params.step - m_params.tz;
+        calcRow(&astro, &view, out + i * cols);
+      }
+    }
+
+    // rows are written in time order
+    switch (m_params.format)
+    {
+      case EE_FMT_BINARY:
+      {
+        qint64 size = (qint64)n * cols * sizeof(double);
+
+        m_error = f.write((const char *)out, size) != size;
+        break;
+      }
+
+      case EE_FMT_CSV:
+        for (int i = 0; i < n; i++)
+        {
+          for (int j = 0; j < cols; j++)
+          {
+            ts << formatValue(m_columns[j], out[i * cols + j], m_params.tz, moon) << ";";
+          }
+          ts << "\n";
+        }
+        m_error = ts.status() != QTextStream::Ok;
+        break;
+
+      case EE_FMT_MEMORY:
+        m_values.resize(m_values.count() + n * cols);
+        memcpy(m_values.data() + m_values.count() - n * cols, out, n * cols * sizeof(double));
+        break;
+    }
+
+    done += n;
+
+    int percent = (int)(100 * done / m_params.count);
+
+    if (percent != lastPercent)
+    {
+      lastPercent = percent;
+      emit sigProgress(percent);
+    }
+  }
+
+  if (m_params.format == EE_FMT_CSV)
+  {
+    ts.flush();
+  }
+  else
+  if (m_params.format == EE_FMT_BINARY && !m_end && !m_error)
+  { // mark as complete
+    head.rows = done;
+    m_error = !f.seek(0) || f.write((const char *)&head, sizeof(head)) != sizeof(head);
+  }
+
+  if (m_params.format != EE_FMT_MEMORY)
+  {
+    f.close();
+
+    if (m_end || m_error)
+    {
+      f.remove();
+    }
+  }
+
+  emit sigDone();
+}
@@ -0,0 +1,77 @@
+#ifndef CEPHENGINE_H
+#define CEPHENGINE_H
+
+#include <QtCore>
+
+#include "castro.h"
+#include "cmapview.h"
+#include "ccomdlg.h"
+#include "casterdlg.h"
+
+#define EE_COLUMN_COUNT     25
+#define EE_BLOCK            4096    // rows computed in parallel between writes
+
+// output
+#define EE_FMT_BINARY       0       // ephFileHeader_t + raw values (see CEphEngine::formatValue)
+#define EE_FMT_CSV          1
+#define EE_FMT_MEMORY       2       // CEphEngine::takeValues()
+
+#define EE_MAGIC            "SKEPH01"
+
+typedef struct
+{
+  char    magic[8];
+  qint32  columns;
+  qint32  isMoon;
+  double  tz;
+  qint64  rows;                     // 0 = unfinished file
+  qint32  column[EE_COLUMN_COUNT];  // column ids (see CEphList)
+} ephFileHeader_t;
+
+typedef struct
+{
+  int          type;                // MO_PLANET, MO_COMET, MO_ASTER
+  int          obj;                 // planet or index to tComets/tAsteroids
+  double       jdFrom;              // local time
+  double       step;
+  qint64       count;               // rows
+  double       tz;
+  QList <int>  columns;
+  int          format;              // EE_FMT_xxx
+  QString      fileName;
+  QStringList  header;              // CSV header
+} ephParams_t;
+
+class CEphEngine : public QThread
+{
+  Q_OBJECT
+
+public:
+  CEphEngine(const mapView_t *view, const ephParams_t &params);
+
+  void              stop();
+  bool              isError() const;
+  bool              isMoon() const;
+  QVector <double>  takeValues();
+
+  static QString formatValue(int column, double value, double tz, bool isMoon);
+
+signals:
+  void sigProgress(int percent);
+  void sigDone(void);
+
+protected:
+  void run();
+  void calcRow(CAstro *astro, mapView_t *view, double *out) const;
+
+  mapView_t         m_view;
+  ephParams_t       m_params;
+  QVector <int>     m_columns;
+  asteroid_t        m_aster;    // private copies of the solved object
+  comet_t           m_comet;
+  volatile bool     m_end;
+  bool              m_error;
+  QVector <double>  m_values;   // EE_FMT_MEMORY
+};
+
+#endif // CEPHENGINE_H
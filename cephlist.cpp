@@ -8,10 +8,12 @@
 #include "ccomdlg.h"
 #include "casterdlg.h"
 #include "cchartdialog.h"
+#include "cephengine.h"
 
 #include <QPair>
+#include "clazyload.h"
 
-#define EL_COLUMN_COUNT     25
+#define EL_COLUMN_COUNT     EE_COLUMN_COUNT
 
 static int columnOrder[EL_COLUMN_COUNT];
 static QString cELColumn[EL_COLUMN_COUNT];
@@ -25,10 +27,38 @@ static Qt::CheckState bChecked[EL_COLUMN_COUNT];
 static int cb_g1_index = 1;
 static int cb_g2_index = 2;
 
+//////////////////////////////////////////////////////////////
+// raw CEphEngine value to chart units
+static double graphValue(int column, double value, bool isMoon)
+//////////////////////////////////////////////////////////////
+{
+  switch (column)
+  {
+    case 3:
+    case 6:
+    case 7:
+      return value;
+
+    case 4:
+      return value * 100;
+
+    case 16:
+      return isMoon ? value * EARTH_DIAM : value;
+
+    case 17:
+      return isMoon ? 0 : value;
+  }
+
+  return R2D(value);
+}
+
 CEphList::CEphList(QWidget *parent, mapView_t *view) :
   QDialog(parent),
   ui(new Ui::CEphList)
 {
+  g_lazyAsteroids.ensure();
+  g_lazyComets.ensure();
+
   ui->setupUi(this);
 
   cELColumn[0] = tr("JD");
@@ -207,8 +237,6 @@ void CEphList::generateList()
   QString     name;
   QListWidgetItem *com;
 
-  QList  <tableRow_t> rows;
-
   for (int i = 0; i < EL_COLUMN_COUNT; i++)
   {
     QListWidgetItem *item = ui->listWidget_2->item(i);
@@ -300,183 +328,131 @@ void CEphList::generateList()
 
   step = ui->spinBox->value() * mul;
 
-  int count = (jdTo - jdFrom) / step;
+  ephParams_t params;
+
+  params.type = type;
+  params.obj = obj;
+  params.jdFrom = jdFrom;
+  params.step = step;
+  params.count = (qint64)((jdTo - jdFrom) / step + 1e-9) + 1;
+  params.tz = tz;
+  params.columns = columns;
+  params.header = strCol;
+  params.format = EE_FMT_BINARY;
 
-  if (count > 1000)
+  switch (type)
   {
-    if (QMessageBox::No == msgBoxQuest(this, tr("Calculation 1000+ positions. Do you want to continue?")))
-      return;
+    case MO_PLANET:
+      name = cAstro.getName(obj);
+      break;
+
+    case MO_COMET:
+      name = tComets[obj].name;
+      break;
+
+    case MO_ASTER:
+      name = tAsteroids[obj].name;
+      break;
   }
 
-  for (double jd = jdFrom; jd <= jdTo; jd += step)
-  {
-    bool isMoon = false;
-    tableRow_t row;
-    orbit_t o;
+  if (params.count > 1000)
+  { // large tables can be streamed directly to the file
+    QMessageBox msg(QObject::tr("Question"), tr("Calculation 1000+ positions. Do you want to continue?"), QMessageBox::Question, QMessageBox::Yes, QMessageBox::No, QMessageBox::NoButton, this);
+    msg.setButtonText(QMessageBox::Yes, QObject::tr("Yes"));
+    msg.setButtonText(QMessageBox::No, QObject::tr("No"));
+    QPushButton *csv = msg.addButton(tr("Save to CSV..."), QMessageBox::ActionRole);
 
-    m_view.jd = jd - tz;
-    cAstro.setParam(&m_view);
+    msg.exec();
 
-    switch (type)
+    if (msg.clickedButton() == csv)
     {
-      case MO_PLANET:
-        cAstro.calcPlanet(obj, &o);
-        name = cAstro.getName(obj);
-        isMoon = (obj == PT_MOON);
-        break;
-
-      case MO_COMET:
-        comSolve(&tComets[obj], m_view.jd);
-        name = tComets[obj].name;
-        o = tComets[obj].orbit;
-        break;
-
-      case MO_ASTER:
-        astSolve(&tAsteroids[obj], m_view.jd);
-        name = tAsteroids[obj].name;
-        o = tAsteroids[obj].orbit;
-        break;
-    }
+      params.fileName = QFileDialog::getSaveFileName(this, tr("Save File"), "untitled.csv", tr("CSV Files (*.csv)"));
+      if (params.fileName.isEmpty())
+        return;
 
-    for (int j = 0; j < columns.count(); j++)
+      params.format = EE_FMT_CSV;
+    }
+    else
+    if (msg.clickedButton() != msg.button(QMessageBox::Yes))
     {
-      QString str;
+      return;
+    }
+  }
 
-      double ra2000 = o.lRD.Ra;
-      double dec2000 = o.lRD.Dec;
+  QTemporaryFile tmp(QDir::tempPath() + "/skytech_eph_XXXXXX.bin");
 
-      precess(&ra2000, &dec2000, m_view.jd, JD2000);
+  if (params.format == EE_FMT_BINARY)
+  {
+    if (!tmp.open())
+    {
+      msgBoxError(this, tr("Cannot create temporary file!!!"));
+      return;
+    }
+    params.fileName = tmp.fileName();
+    tmp.close();
+  }
 
-      switch (columns[j])
-      {
-        case 0:
-          str = QString::number(m_view.jd, 'f', 6);
-          break;
-
-        case 1:
-          str = getStrDate(m_view.jd, tz);
-          break;
-
-        case 2:
-          str = getStrTime(m_view.jd, tz);
-          break;
-
-        case 3:
-          str = getStrMag(o.mag);
-          break;
-
-        case 4:
-          str = QString::number(o.phase, 'f', 3);
-          break;
-
-        case 5:
-          str = QString::number(R2D(o.PA), 'f', 1) + "°";
-          break;
-
-        case 6:
-          str = QString::number(o.sx, 'f', 2) + "\"";
-          //chart1.append(qMakePair(m_view.jd, o.sx));
-          break;
-
-        case 7:
-          str = QString::number(o.sy, 'f', 2) + "\"";
-          break;
-
-        case 8:
-          str = getStrRA(o.lRD.Ra);
-          //chart.append(qMakePair(m_view.jd, R2D(o.lRD.Ra)));
-          break;
-
-        case 9:
-          str = getStrDeg(o.lRD.Dec);
-          break;
-
-        case 10:
-          str = getStrRA(ra2000);
-          break;
-
-        case 11:
-          str = getStrDeg(dec2000);
-          break;
-
-        case 12:
-          str = getStrRA(o.gRD.Ra);
-          break;
-
-        case 13:
-          str = getStrDeg(o.gRD.Dec);
-          break;
-
-        case 14:
-          str = getStrDeg(o.lAzm);
-          break;
-
-        case 15:
-          str = getStrDeg(o.lAlt);
-          break;
-
-        case 16:
-          if (!isMoon)
-          {
-            str = QString::number(o.R, 'f', 6) + " AU";
-          }
-          else
-          {
-            str = QString::number(o.R * EARTH_DIAM) + tr(" Km");
-          }
-          break;
-
-        case 17:
-          if (!isMoon)
-          {
-            str = QString::number(o.r, 'f', 6) + " AU";
-          }
-          else
-          {
-            str = tr("N/A");
-          }
-          break;
-
-        case 18:
-          str = ((o.elongation >= 0) ? "+" : "") + QString::number(R2D(o.elongation), 'f', 2) + "°";
-          //chart2.append(qMakePair(m_view.jd, R2D(o.elongation)));
-          break;
-
-        case 19:
-          str = getStrDeg(o.hLon);
-          break;
-
-        case 20:
-          str = getStrDeg(o.hLat);
-          break;
-
-        case 21:
-          str = QString::number(o.hRect[0], 'f', 6) + " AU";
-          break;
-
-        case 22:
-          str = QString::number(o.hRect[1], 'f', 6) + " AU";
-          break;
-
-        case 23:
-          str = QString::number(o.hRect[2], 'f', 6) + " AU";
-          break;
-
-        case 24:
-          str = QString::number(o.light * 24. * 60., 'f', 2) + tr(" mins.");
-          break;
-      }
+  CEphEngine engine(&m_view, params);
 
-      row.row.append(str);
-    }
+  if (!runEngine(&engine) || params.format == EE_FMT_CSV)
+  {
+    return;
+  }
+
+  CEphFileModel *model = new CEphFileModel(params.fileName, strCol);
 
-    rows.append(row);
+  if (!model->isValid())
+  {
+    delete model;
+    msgBoxError(this, tr("Cannot read file!!!"));
+    return;
   }
 
-  CEphTable dlg(this, name, strCol, rows);
+  CEphTable dlg(this, name, model);
   dlg.exec();
 }
 
+////////////////////////////////////////////////
+// false when cancelled or failed
+bool CEphList::runEngine(CEphEngine *engine)
+////////////////////////////////////////////////
+{
+  QProgressDialog dlg(tr("Please wait..."), tr("Cancel"), 0, 100, this);
+
+  dlg.setWindowModality(Qt::WindowModal);
+  dlg.setMinimumDuration(0);
+  dlg.setAutoClose(false);
+  dlg.setAutoReset(false);
+
+  connect(engine, SIGNAL(sigProgress(int)), &dlg, SLOT(setValue(int)), Qt::QueuedConnection);
+  connect(engine, SIGNAL(sigDone()), &dlg, SLOT(accept()), Qt::QueuedConnection);
+
+  engine->start();
+
+  // accepted by sigDone only
+  bool done = dlg.exec() == QDialog::Accepted;
+
+  if (!done)
+  {
+    engine->stop();
+  }
+
+  engine->wait();
+
+  if (!done)
+  {
+    return false;
+  }
+
+  if (engine->isError())
+  {
+    msgBoxError(this, tr("Cannot write file!!!"));
+    return false;
+  }
+
+  return true;
+}
+
 void CEphList::generateGraph()
 {
   int type;
@@ -559,9 +535,34 @@ void CEphList::generateGraph()
 
   step = ui->spinBox->value() * mul;
 
-  int count = (jdTo - jdFrom) / step;
+  int col[2] = { ui->cb_g1->currentData().toInt(), ui->cb_g2->currentData().toInt() };
 
-  if (count > 1000)
+  if (col[0] < 0)
+  {
+    msgBoxError(this, tr("Select first chart!!!"));
+    return;
+  }
+
+  ephParams_t params;
+
+  params.type = type;
+  params.obj = obj;
+  params.jdFrom = jdFrom;
+  params.step = step;
+  params.count = (qint64)((jdTo - jdFrom) / step + 1e-9) + 1;
+  params.tz = tz;
+  params.format = EE_FMT_MEMORY;
+  params.columns.append(0);
+
+  for (int i = 0; i < 2; i++)
+  {
+    if (col[i] >= 0)
+    {
+      params.columns.append(col[i]);
+    }
+  }
+
+  if (params.count > 1000)
   {
     if (QMessageBox::No == msgBoxQuest(this, tr("Calculation 1000+ positions. Do you want to continue?")))
       return;
@@ -569,159 +570,56 @@ void CEphList::generateGraph()
 
   QString name;
 
-  if (ui->cb_g1->currentIndex() > 0)
+  switch (type)
   {
-    graph1Name = ui->cb_g1->currentText();
+    case MO_PLANET:
+      name = cAstro.getName(obj);
+      break;
+
+    case MO_COMET:
+      name = tComets[obj].name;
+      break;
+
+    case MO_ASTER:
+      name = tAsteroids[obj].name;
+      break;
   }
 
-  if (ui->cb_g2->currentIndex() > 0)
+  if (col[0] >= 0)
   {
-    graph2Name = ui->cb_g2->currentText();
+    graph1Name = ui->cb_g1->currentText();
   }
 
-  for (double jd = jdFrom; jd <= jdTo; jd += step)
+  if (col[1] >= 0)
   {
-    bool isMoon = false;
-    orbit_t o;
+    graph2Name = ui->cb_g2->currentText();
+  }
 
-    m_view.jd = jd - tz;
-    cAstro.setParam(&m_view);
+  CEphEngine engine(&m_view, params);
 
-    switch (type)
-    {
-      case MO_PLANET:
-        cAstro.calcPlanet(obj, &o);
-        name = cAstro.getName(obj);
-        isMoon = (obj == PT_MOON);
-        break;
-
-      case MO_COMET:
-        comSolve(&tComets[obj], m_view.jd);
-        name = tComets[obj].name;
-        o = tComets[obj].orbit;
-        break;
-
-      case MO_ASTER:
-        astSolve(&tAsteroids[obj], m_view.jd);
-        name = tAsteroids[obj].name;
-        o = tAsteroids[obj].orbit;
-        break;
-    }
+  if (!runEngine(&engine))
+  {
+    return;
+  }
 
-    double ra2000 = o.lRD.Ra;
-    double dec2000 = o.lRD.Dec;
+  QVector <double> values = engine.takeValues();
+  int              cols = params.columns.count();
+  bool             isMoon = engine.isMoon();
 
-    precess(&ra2000, &dec2000, m_view.jd, JD2000);
+  for (int r = 0; r < values.count() / cols; r++)
+  {
+    const double *v = values.constData() + r * cols;
+    int           k = 1;
 
     for (int i = 0; i < 2; i++)
     {
-      QComboBox *cb;
-
-      if (i == 0)
-      {
-        cb = ui->cb_g1;
-      }
-      else
-      {
-        cb = ui->cb_g2;
-      }
-
-      switch (cb->currentData().toInt())
+      if (col[i] >= 0)
       {
-        case -1:
-          break;
-
-        case 3:
-          chart[i].append(qMakePair(m_view.jd, o.mag));
-          break;
-
-        case 4:
-          chart[i].append(qMakePair(m_view.jd, o.phase * 100));
-          break;
-
-        case 5:
-          chart[i].append(qMakePair(m_view.jd, R2D(o.PA)));
-          break;
-
-        case 6:
-          chart[i].append(qMakePair(m_view.jd, o.sx));
-          break;
-
-        case 7:
-          chart[i].append(qMakePair(m_view.jd, o.sy));
-          break;
-
-        case 8:
-          chart[i].append(qMakePair(m_view.jd, R2D(o.lRD.Ra)));
-          break;
-
-        case 9:
-          chart[i].append(qMakePair(m_view.jd, R2D(o.lRD.Dec)));
-          break;
-
-        case 10:
-          chart[i].append(qMakePair(m_view.jd, R2D(ra2000)));
-          break;
-
-        case 11:
-          chart[i].append(qMakePair(m_view.jd, R2D(dec2000)));
-          break;
-
-        case 12:
-          chart[i].append(qMakePair(m_view.jd, R2D(o.gRD.Ra)));
-          break;
-
-        case 13:
-          chart[i].append(qMakePair(m_view.jd, R2D(o.gRD.Dec)));
-          break;
-
-        case 14:
-          chart[i].append(qMakePair(m_view.jd, R2D(o.lAzm)));
-          break;
-
-        case 15:
-          chart[i].append(qMakePair(m_view.jd, R2D(o.lAlt)));
-          break;
-
-        case 16:
-          if (!isMoon)
-          {
-            chart[i].append(qMakePair(m_view.jd, o.R));
-          }
-          else
-          {
-            chart[i].append(qMakePair(m_view.jd, o.R * EARTH_DIAM));
-          }
-          break;
-
-        case 17:
-          if (!isMoon)
-          {
-            chart[i].append(qMakePair(m_view.jd, o.r));
-          }
-          else
-          {
-            chart[i].append(qMakePair(m_view.jd, 0));
-          }
-          break;
-
-        case 18:
-          chart[i].append(qMakePair(m_view.jd, R2D((o.elongation))));
-          break;
-
-        default:
-          qDebug() << "invalid param !";
+        chart[i].append(qMakePair(v[0], graphValue(col[i], v[k++], isMoon)));
       }
     }
   }
 
-  if ((chart[0].isEmpty() && chart[1].isEmpty()) || chart[0].isEmpty())
-  {
-    msgBoxError(this, tr("Select first chart!!!"));
-    return;
-  }
-
-
   CChartDialog dlg(this, name, chart[0], chart[1], graph1Name, graph2Name, ui->cb_axis1->isChecked(), ui->cb_axis2->isChecked());
   dlg.exec();
 }
@@ -23,6 +23,8 @@
 #include <QDialog>
 #include "cmapview.h"
 
+class CEphEngine;
+
 namespace Ui {
   class CEphList;
 }
@@ -40,6 +42,7 @@ protected:
   bool showNoObjectSelected(int obj);
   void generateList();
   void generateGraph();
+  bool runEngine(CEphEngine *engine);
 
 private slots:
   void on_pushButton_clicked();
@@ -44,6 +44,23 @@ CEphTable::CEphTable(QWidget *parent, QString name, QStringList header, QList<ta
   ui->tableView->setModel(m);
 }
 
+CEphTable::CEphTable(QWidget *parent, QString name, QAbstractItemModel *model) :
+  QDialog(parent),
+  ui(new Ui::CEphTable)
+{
+  ui->setupUi(this);
+
+  m_name = name;
+  setWindowTitle(tr("Ephemerides of ") + name + QString(tr(" (Records : %1)").arg(model->rowCount())));
+
+  // uniform rows, no per row size hints with large models
+  ui->tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+  ui->tableView->verticalHeader()->setDefaultSectionSize(ui->tableView->fontMetrics().height() + 6);
+
+  model->setParent(this);
+  ui->tableView->setModel(model);
+}
+
 CEphTable::~CEphTable()
 {
   delete ui;
@@ -150,3 +167,94 @@ void CEphTable::on_pushButton_clicked()
   delete document;
 
 }
+
+CEphFileModel::CEphFileModel(const QString &fileName, const QStringList &header, QObject *parent) :
+  QAbstractTableModel(parent),
+  m_file(fileName)
+{
+  m_header = header;
+  m_rows = 0;
+  m_pageFirst = -1;
+
+  if (!m_file.open(QFile::ReadOnly) ||
+      m_file.read((char *)&m_head, sizeof(m_head)) != sizeof(m_head) ||
+      memcmp(m_head.magic, EE_MAGIC, sizeof(m_head.magic)) ||
+      m_head.columns <= 0 || m_head.columns > EE_COLUMN_COUNT || m_head.rows <= 0)
+  { // invalid or unfinished
+    m_file.close();
+    m_head.columns = 0;
+    return;
+  }
+
+  m_rows = (int)qMin(m_head.rows, (qint64)INT_MAX);
+}
+
+/////////////////////////////////////
+bool CEphFileModel::isValid() const
+/////////////////////////////////////
+{
+  return m_file.isOpen();
+}
+
+//////////////////////////////////////////////////////////////
+int CEphFileModel::rowCount(const QModelIndex &parent) const
+//////////////////////////////////////////////////////////////
+{
+  return parent.isValid() ? 0 : m_rows;
+}
+
+/////////////////////////////////////////////////////////////////
+int CEphFileModel::columnCount(const QModelIndex &parent) const
+/////////////////////////////////////////////////////////////////
+{
+  return parent.isValid() ? 0 : m_head.columns;
+}
+
+////////////////////////////////////////////////////
+const double *CEphFileModel::row(int index) const
+////////////////////////////////////////////////////
+{
+  if (m_pageFirst < 0 || index < m_pageFirst || index >= m_pageFirst + ET_PAGE_ROWS)
+  {
+    qint64 rowSize = m_head.columns * sizeof(double);
+
+    m_pageFirst = index - (index % ET_PAGE_ROWS);
+
+    int count = qMin(ET_PAGE_ROWS, m_rows - m_pageFirst);
+    m_page.resize(count * m_head.columns);
+
+    if (!m_file.seek(sizeof(m_head) + m_pageFirst * rowSize) ||
+        m_file.read((char *)m_page.data(), count * rowSize) != count * rowSize)
+    {
+      m_page.fill(0);
+    }
+  }
+
+  return m_page.constData() + (index - m_pageFirst) * m_head.columns;
+}
+
+///////////////////////////////////////////////////////////////////////
+QVariant CEphFileModel::data(const QModelIndex &index, int role) const
+///////////////////////////////////////////////////////////////////////
+{
+  if (role != Qt::DisplayRole || !index.isValid() || index.row() >= m_rows)
+  {
+    return QVariant();
+  }
+
+  int column = index.column();
+
+  return CEphEngine::formatValue(m_head.column[column], row(index.row())[column], m_head.tz, m_head.isMoon);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+QVariant CEphFileModel::headerData(int section, Qt::Orientation orientation, int role) const
+///////////////////////////////////////////////////////////////////////////////////////////////
+{
+  if (role == Qt::DisplayRole && orientation == Qt::Horizontal && section < m_header.count())
+  {
+    return m_header[section];
+  }
+
+  return QAbstractTableModel::headerData(section, orientation, role);
+}
@@ -23,11 +23,38 @@
 #include <QtGui>
 #include <QtWidgets>
 
+#include "cephengine.h"
+
+#define ET_PAGE_ROWS      1024    // rows read at once by CEphFileModel
+
 typedef struct
 {
   QStringList row;
 } tableRow_t;
 
+// pages rows from a CEphEngine binary file on demand
+class CEphFileModel : public QAbstractTableModel
+{
+public:
+  CEphFileModel(const QString &fileName, const QStringList &header, QObject *parent = 0);
+
+  bool     isValid() const;
+  int      rowCount(const QModelIndex &parent = QModelIndex()) const;
+  int      columnCount(const QModelIndex &parent = QModelIndex()) const;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+protected:
+  const double *row(int index) const;
+
+  mutable QFile            m_file;
+  ephFileHeader_t          m_head;
+  QStringList              m_header;
+  int                      m_rows;
+  mutable int              m_pageFirst;
+  mutable QVector <double> m_page;
+};
+
 namespace Ui {
   class CEphTable;
 }
@@ -38,6 +65,7 @@ class CEphTable : public QDialog
 
 public:
   explicit CEphTable(QWidget *parent, QString name, QStringList header, QList <tableRow_t> row, const QStringList &headerToolTips = QStringList());
+  explicit CEphTable(QWidget *parent, QString name, QAbstractItemModel *model);
   ~CEphTable();
 
 protected:
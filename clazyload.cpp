@@ -0,0 +1,92 @@
+#include "clazyload.h"
+
+static QList <CLazyLoad *> &lazyList()
+{
+  static QList <CLazyLoad *> list;
+
+  return list;
+}
+
+class CLazyWarmUp : public QRunnable
+{
+public:
+  CLazyWarmUp(CLazyLoad *lazy) : m_lazy(lazy) {}
+
+  void run()
+  {
+    m_lazy->ensure();
+  }
+
+private:
+  CLazyLoad *m_lazy;
+};
+
+/////////////////////////////////////////////////////////////////////
+CLazyLoad::CLazyLoad(const char *name, lazyLoadFnc_t fnc, bool gui) :
+  m_mutex(QMutex::Recursive)
+/////////////////////////////////////////////////////////////////////
+{
+  m_name = name;
+  m_fnc = fnc;
+  m_gui = gui;
+  m_loading = false;
+
+  lazyList().append(this);
+}
+
+///////////////////////////
+void CLazyLoad::ensure()
+///////////////////////////
+{
+  if (m_loaded.loadAcquire())
+  {
+    return;
+  }
+
+  QMutexLocker locker(&m_mutex);
+
+  if (m_loaded.loadAcquire() || m_loading)
+  {
+    return;
+  }
+
+  QElapsedTimer timer;
+
+  timer.start();
+  m_loading = true;
+  m_fnc();
+  m_loading = false;
+  m_loaded.storeRelease(1);
+
+  qDebug() << "lazy load" << m_name << timer.elapsed() << "ms";
+}
+
+///////////////////////////////////
+bool CLazyLoad::isLoaded() const
+///////////////////////////////////
+{
+  return m_loaded.loadAcquire() != 0;
+}
+
+////////////////////////////////////////////////////////////////////
+// loads all remaining data sets (call from the GUI thread when idle)
+void CLazyLoad::warmUpAll()
+////////////////////////////////////////////////////////////////////
+{
+  foreach (CLazyLoad *lazy, lazyList())
+  {
+    if (lazy->isLoaded())
+    {
+      continue;
+    }
+
+    if (lazy->m_gui)
+    {
+      lazy->ensure();
+    }
+    else
+    {
+      QThreadPool::globalInstance()->start(new CLazyWarmUp(lazy));
+    }
+  }
+}
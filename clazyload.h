@@ -0,0 +1,37 @@
+#ifndef CLAZYLOAD_H
+#define CLAZYLOAD_H
+
+#include <QtCore>
+
+typedef void (*lazyLoadFnc_t)(void);
+
+// Data set loaded on the first use (ensure()) or by the background warm-up.
+// Calls of ensure() from inside the load function return immediately.
+class CLazyLoad
+{
+public:
+  CLazyLoad(const char *name, lazyLoadFnc_t fnc, bool gui = false);
+
+  void ensure();
+  bool isLoaded() const;
+
+  static void warmUpAll();
+
+private:
+  const char     *m_name;
+  lazyLoadFnc_t   m_fnc;
+  bool            m_gui;        // must be loaded in the GUI thread
+  bool            m_loading;
+  QAtomicInt      m_loaded;
+  QMutex          m_mutex;
+};
+
+extern CLazyLoad g_lazyLunarFeatures;
+extern CLazyLoad g_lazyGCVS;
+extern CLazyLoad g_lazyVOCatalogs;
+extern CLazyLoad g_lazyAsteroids;
+extern CLazyLoad g_lazyComets;
+extern CLazyLoad g_lazySatellites;
+extern CLazyLoad g_lazyDSOPlugins;
+
+#endif // CLAZYLOAD_H
@@ -8,14 +8,16 @@ CLineEditComp::CLineEditComp(QWidget *parent) :
   m_completer = new QCompleter();
   m_model = new QStringListModel();
 
+  // model is filled in slotTextEdited() with word prefix matches
   m_completer->setModel(m_model);
   m_completer->setMaxVisibleItems(16);
   m_completer->setCaseSensitivity(Qt::CaseInsensitive);
-  m_completer->setCompletionMode(QCompleter::PopupCompletion);
-  m_completer->setFilterMode(Qt::MatchContains );
+  m_completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
 
   setCompleter(m_completer);
 
+  connect(this, SIGNAL(textEdited(QString)), this, SLOT(slotTextEdited(QString)));
+
   m_max = 1000;
 }
 
@@ -30,26 +32,22 @@ void CLineEditComp::setMaxCompleterWords(int nMax)
 void CLineEditComp::addWord(QString word)
 /////////////////////////////////////////
 {
-  QStringList list = m_model->stringList();
+  QString key = CNameIndex::normalize(word);
 
-  if (!list.contains(word, Qt::CaseInsensitive))
-  {
-    list << word;
-  }
-  else
+  if (m_wordSet.contains(key))
   {
     return;
   }
 
-  while (1)
+  m_words << word;
+  m_wordSet.insert(key);
+
+  while (m_words.count() > m_max)
   {
-    if (list.count() > m_max)
-      list.removeFirst();
-    else
-      break;
+    m_wordSet.remove(CNameIndex::normalize(m_words.takeFirst()));
   }
 
-  m_model->setStringList(list);
+  m_index.clear();
 }
 
 void CLineEditComp::addWords(QStringList words)
@@ -62,12 +60,54 @@ void CLineEditComp::addWords(QStringList words)
 
 void CLineEditComp::addWordsAlways(QStringList words)
 {
-  QStringList list = m_model->stringList();
-  m_model->setStringList(list + words);
+  foreach (QString word, words)
+  {
+    m_words << word;
+    m_wordSet.insert(CNameIndex::normalize(word));
+  }
+
+  m_index.clear();
+}
+
+////////////////////////////////////////////////////////
+void CLineEditComp::addIndex(const CNameIndex *index)
+////////////////////////////////////////////////////////
+{
+  m_indexes.append(index);
 }
 
 void CLineEditComp::removeWords()
 {
+  m_words.clear();
+  m_wordSet.clear();
+  m_index.clear();
   m_model->setStringList(QStringList());
 }
 
+//////////////////////////////////////////////////////////
+void CLineEditComp::slotTextEdited(const QString &text)
+//////////////////////////////////////////////////////////
+{
+  if (!m_index.isBuilt())
+  {
+    for (int i = 0; i < m_words.count(); i++)
+    {
+      m_index.add(m_words[i], i);
+    }
+    m_index.build();
+  }
+
+  QStringList list = m_index.complete(text, LEC_MAX_SUGGESTIONS);
+
+  foreach (const CNameIndex *index, m_indexes)
+  {
+    if (list.count() >= LEC_MAX_SUGGESTIONS)
+    {
+      break;
+    }
+    list += index->complete(text, LEC_MAX_SUGGESTIONS - list.count());
+  }
+
+  list.removeDuplicates();
+  m_model->setStringList(list);
+}
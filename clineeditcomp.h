@@ -4,6 +4,10 @@
 #include <QLineEdit>
 #include <QStringListModel>
 
+#include "cnameindex.h"
+
+#define LEC_MAX_SUGGESTIONS     100
+
 class CLineEditComp : public QLineEdit
 {
   Q_OBJECT
@@ -13,12 +17,21 @@ public:
   void addWord(QString word);
   void addWords(QStringList words);
   void addWordsAlways(QStringList words);
+  void addIndex(const CNameIndex *index);
   void removeWords();
 
 protected:
   QCompleter       *m_completer;
   QStringListModel *m_model;
   int               m_max;
+
+  QStringList                  m_words;
+  QSet <QString>               m_wordSet;    // normalized m_words
+  CNameIndex                   m_index;      // m_words index (rebuilt on demand)
+  QList <const CNameIndex *>   m_indexes;    // external indices (catalogues)
+
+protected slots:
+  void slotTextEdited(const QString &text);
 };
 
 #endif // CLINEEDITCOMP_H
@@ -22,11 +22,186 @@
 #include "cmeteorshower.h"
 #include "gcvs.h"
 #include "vocatalogmanager.h"
+#include "clazyload.h"
 
 extern CPlanetRenderer  cPlanetRenderer;
 extern QImage *g_pSunTexture;
 extern QString g_horizonName;
 
+// load tasks
+enum
+{
+  LT_STAR_BITMAPS,
+  LT_PLANETS,
+  LT_CONST_NAMES,
+  LT_DSO,
+  LT_GSC_REGIONS,
+  LT_TYCHO,
+  LT_CONSTELLATIONS,
+  LT_MILKYWAY,
+  LT_SUN_TEXTURE,
+  LT_DB,
+  LT_HORIZON,
+  LT_TRACKING,
+  LT_DRAWINGS,
+  LT_JPL_EPHEMS,
+  LT_COUNT
+};
+
+#define LT_BIT(t)     (1 << (t))
+#define LT_ALL        (LT_BIT(LT_COUNT) - 1)
+
+typedef void (*loadFnc_t)(void);
+
+typedef struct
+{
+  const char *name;
+  loadFnc_t   fnc;
+  quint32     deps;     // tasks to wait for (LT_BIT)
+  bool        gui;      // must run in the GUI thread (QPixmap, SQL connection, plugins)
+} loadTask_t;
+
+static void loadStarBitmaps()
+{
+  cStarRenderer.open(g_skSet.map.starBitmapName);
+}
+
+static void loadPlanets()
+{
+  if (!cPlanetRenderer.load())
+  {
+    qDebug() << g_skSet.map.planet.moonImage;
+    qFatal("Cannot find moon image!!!");
+  }
+}
+
+static void loadConstNames()
+{
+  loadConstelNonLatinNames("../data/constellation/" + g_skSet.map.constellation.language);
+}
+
+static void loadDSO()
+{
+  cDSO.load();
+}
+
+static void loadVOCatalogs()
+{
+  g_voCatalogManager.loadAll();
+}
+
+static void loadGSCRegions()
+{
+  cGSCReg.loadRegions();
+}
+
+static void loadTycho()
+{
+  cTYC.load();
+}
+
+static void loadMilkyWay()
+{
+  cMilkyWay.load();
+}
+
+static void loadAsteroids()
+{
+  astLoad(curAsteroidCatName);
+}
+
+static void loadComets()
+{
+  comLoad(curCometCatName);
+}
+
+static void loadSunTexture()
+{
+  g_pSunTexture = new QImage(QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/data/sun/sun_tex.png");
+  if (g_pSunTexture->isNull())
+  {
+    delete g_pSunTexture;
+    g_pSunTexture = NULL;
+  }
+}
+
+static void loadDB()
+{
+  g_pDb = new CDB(QSqlDatabase::addDatabase("QSQLITE", "sql_skytech"));
+  g_pDb->setDatabaseName(QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/data/db/skytech.sql");
+  qDebug() << QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/data/db/skytech.sql";
+  if (g_pDb->open())
+  {
+    g_pDb->init();
+  }
+}
+
+static void loadHorizon()
+{
+  QSettings set;
+
+  g_horizonName = set.value("horizon_file", "none").toString();
+  background.loadBackground(g_horizonName);
+}
+
+static void loadLunarFeatures()
+{
+  cLunarFeatures.load("../data/moon/features.csv");
+}
+
+static void loadGCVS()
+{
+  g_GCVS.load();
+}
+
+static void loadSatellites()
+{
+  sgp4.loadTLEData(curSatelliteCatName);
+}
+
+static const loadTask_t g_loadTasks[LT_COUNT] =
+{
+  { "star bitmaps",     loadStarBitmaps,         0,                       true  },
+  { "planets",          loadPlanets,             0,                       false },
+  { "const. names",     loadConstNames,          0,                       false },
+  { "DSO",              loadDSO,                 0,                       false },
+  { "GSC regions",      loadGSCRegions,          0,                       false },
+  { "Tycho",            loadTycho,               LT_BIT(LT_GSC_REGIONS),  false },
+  { "constellations",   constLoad,               LT_BIT(LT_GSC_REGIONS),  false },
+  { "Milky Way",        loadMilkyWay,            0,                       false },
+  { "Sun texture",      loadSunTexture,          0,                       false },
+  { "database",         loadDB,                  0,                       true  },
+  { "horizon",          loadHorizon,             0,                       false },
+  { "tracking",         loadTracking,            0,                       false },
+  { "drawings",         drawingLoad,             0,                       false },
+  { "JPL ephemerides",  CAstro::initJPLEphems,   0,                       false },
+};
+
+// rarely used data sets (loaded on the first use or by CLazyLoad::warmUpAll())
+CLazyLoad g_lazyLunarFeatures("lunar features", loadLunarFeatures);
+CLazyLoad g_lazyGCVS("GCVS", loadGCVS);
+CLazyLoad g_lazyVOCatalogs("VO catalogues", loadVOCatalogs);
+CLazyLoad g_lazyAsteroids("asteroids", loadAsteroids);
+CLazyLoad g_lazyComets("comets", loadComets);
+CLazyLoad g_lazySatellites("satellites", loadSatellites);
+CLazyLoad g_lazyDSOPlugins("DSO plugins", loadDSOPlugins, true);
+
+class CLoadTask : public QRunnable
+{
+public:
+  CLoadTask(QObject *receiver, int task) : m_receiver(receiver), m_task(task) {}
+
+  void run()
+  {
+    g_loadTasks[m_task].fnc();
+    QMetaObject::invokeMethod(m_receiver, "slotTaskDone", Qt::QueuedConnection, Q_ARG(int, m_task));
+  }
+
+private:
+  QObject *m_receiver;
+  int      m_task;
+};
+
 CLoadingDlg::CLoadingDlg(QWidget *parent) :
   QDialog(parent),
   ui(new Ui::CLoadingDlg)
@@ -44,7 +219,7 @@ CLoadingDlg::CLoadingDlg(QWidget *parent) :
   setFixedSize(size());
   ui->label_3->setText(SK_VERSION);
 
-  ui->progressBar->setRange(0, 15);
+  ui->progressBar->setRange(0, LT_COUNT);
 
   ui->progressBar->setStyleSheet("QProgressBar { border: 1px; border-color: white; background-color: #81d4fa;  height: 1px; }  QProgressBar::chunk {  background-color: #0277bd }");
 
@@ -79,105 +254,96 @@ void CLoadingDlg::paintEvent(QPaintEvent *)
 void CLoadingDlg::sigProgress(int val)
 {
   ui->progressBar->setValue(val);
-  qApp->processEvents(QEventLoop::AllEvents);
 }
 
-void CLoadingDlg::slotLoad()
+// starts all tasks with finished dependencies on the thread pool,
+// then runs the ready GUI tasks in this thread
+void CLoadingDlg::startTasks()
 {
-  QSettings set;
+  while (true)
+  {
+    int gui = -1;
+
+    for (int i = 0; i < LT_COUNT; i++)
+    {
+      const loadTask_t &task = g_loadTasks[i];
+
+      if ((m_started & LT_BIT(i)) || (task.deps & m_done) != task.deps)
+      {
+        continue;
+      }
+
+      if (task.gui)
+      {
+        if (gui == -1)
+        {
+          gui = i;
+        }
+        continue;
+      }
+
+      m_started |= LT_BIT(i);
+      QThreadPool::globalInstance()->start(new CLoadTask(this, i));
+    }
+
+    if (gui == -1)
+    {
+      break;
+    }
+
+    m_started |= LT_BIT(gui);
+    g_loadTasks[gui].fnc();
+    slotTaskDone(gui);
+  }
+}
 
-  setSetDefaultVal();
+void CLoadingDlg::slotTaskDone(int task)
+{
+  int count = 0;
 
-  g_setName = set.value("set_profile", "default").toString();
-  qDebug("prof = %s", qPrintable(g_setName));
-  setLoad(g_setName);
+  m_done |= LT_BIT(task);
 
-  cStarRenderer.open(g_skSet.map.starBitmapName);
-  if (!cPlanetRenderer.load())
+  for (int i = 0; i < LT_COUNT; i++)
   {
-    qDebug() << g_skSet.map.planet.moonImage;
-    qFatal("Cannot find moon image!!!");
+    if (m_done & LT_BIT(i))
+    {
+      count++;
+    }
   }
 
-  loadConstelNonLatinNames("../data/constellation/" + g_skSet.map.constellation.language);
-
-  qDebug() << "L1";
-  //constLoad();
-  sigProgress(1);
-
-  qDebug() << "L2";
-  cDSO.load();
-  g_voCatalogManager.loadAll();
-  sigProgress(2);
+  qDebug() << "loaded" << g_loadTasks[task].name;
+  sigProgress(count);
+}
 
-  qDebug() << "L3";
-  cGSCReg.loadRegions();
-  sigProgress(3);
+void CLoadingDlg::slotLoad()
+{
+  QSettings set;
+  QElapsedTimer timer;
 
-  qDebug() << "L4";
-  cTYC.load();
-  constLoad();
-  sigProgress(4);
+  timer.start();
+  setSetDefaultVal();
 
-  qDebug() << "L5";
-  cMilkyWay.load();
-  sigProgress(5);
+  g_setName = set.value("set_profile", "default").toString();
+  qDebug("prof = %s", qPrintable(g_setName));
+  setLoad(g_setName);
 
-  qDebug() << "L7";
   curAsteroidCatName = set.value("asteroid_file", "").toString();
-  astLoad(curAsteroidCatName);
-  sigProgress(6);
-
-  qDebug() << "L8";
   curCometCatName = set.value("comet_file", "").toString();
-  comLoad(curCometCatName);
-  sigProgress(7);
+  curSatelliteCatName = set.value("satellite_file", "").toString();
 
-  qDebug() << "L9";
-  g_pSunTexture = new QImage(QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/data/sun/sun_tex.png");
-  if (g_pSunTexture->isNull())
-  {
-    delete g_pSunTexture;
-    g_pSunTexture = NULL;
-  }
-  sigProgress(8);
+  m_started = 0;
+  m_done = 0;
 
-  qDebug() << "L10";
-  g_pDb = new CDB(QSqlDatabase::addDatabase("QSQLITE", "sql_skytech"));
-  g_pDb->setDatabaseName(QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/data/db/skytech.sql");
-  qDebug() << QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/data/db/skytech.sql";
-  if (g_pDb->open())
+  while (m_done != LT_ALL)
   {
-    g_pDb->init();
+    startTasks();
+    if (m_done != LT_ALL)
+    {
+      qApp->processEvents(QEventLoop::AllEvents | QEventLoop::WaitForMoreEvents);
+    }
   }
 
-  sigProgress(9);
-
-  qDebug() << "L11";
-  g_horizonName = set.value("horizon_file", "none").toString();
-  background.loadBackground(g_horizonName);
-
-  sigProgress(10);
-  //cLunarFeatures.load("../data/moon/moon.dat");
-  cLunarFeatures.load("../data/moon/features.csv");
-
-  sigProgress(11);
-  loadTracking();
-
-  sigProgress(12);
-  drawingLoad();
-
-  sigProgress(13);
-  loadDSOPlugins();
-
-  sigProgress(14);
-  g_GCVS.load();
-
-  sigProgress(15);
-  curSatelliteCatName = set.value("satellite_file", "").toString();
-  sgp4.loadTLEData(curSatelliteCatName);
-
-  CAstro::initJPLEphems();  
+  qDebug() << "loading time" << timer.elapsed() << "ms";
 
   usnoB1.setUsnoDir(set.value("usno_b1_path", "").toString());
   usno.setUsnoDir(set.value("usno2_path", "").toString());
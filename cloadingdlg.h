@@ -35,11 +35,15 @@ protected:
 
 private:
   void sigProgress(int val);
+  void startTasks();
   Ui::CLoadingDlg *ui;
   QPixmap *m_logo;
+  quint32  m_started;   // bit mask of the load tasks
+  quint32  m_done;
 
 public slots:
   void slotLoad();
+  void slotTaskDone(int task);
 };
 
 #if 0
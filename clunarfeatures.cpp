@@ -5,11 +5,54 @@
 #include "setting.h"
 #include "mapobj.h"
 #include "colongitude.h"
+#include "clazyload.h"
+
+#include <algorithm>
 
 // http://www.fourmilab.ch/earthview/lunarform/lunarform.html
 
 static const double    mkm = 1738 * 2;
 
+extern int  g_ephType;
+extern int  g_ephMoonType;
+extern bool g_useJPLEphem;
+extern bool g_geocentric;
+
+typedef struct
+{
+  double  jd;
+  double  lon, lat, alt;
+  double  deltaT;
+  qint32  deltaTAlg;
+  qint32  ephType, ephMoonType, useJPL, geocentric;
+  qint32  flipX, flipY;
+} lfVisKey_t;
+
+/////////////////////////////////////////////////
+// view and the settings the moon orientation depends on
+static QByteArray lfVisKey(const mapView_t *view)
+/////////////////////////////////////////////////
+{
+  lfVisKey_t k;
+
+  memset(&k, 0, sizeof(k));
+
+  k.jd = view->jd;
+  k.lon = view->geo.lon;
+  k.lat = view->geo.lat;
+  k.alt = view->geo.alt;
+  k.deltaT = view->deltaT;
+  k.deltaTAlg = view->deltaTAlg;
+  k.ephType = g_ephType;
+  k.ephMoonType = g_ephMoonType;
+  k.useJPL = g_useJPLEphem;
+  k.geocentric = g_geocentric;
+  k.flipX = view->flipX;
+  k.flipY = view->flipY;
+
+  return QByteArray((const char *)&k, sizeof(k));
+}
+
 CLunarFeatures cLunarFeatures;
 
 QDataStream& operator<<(QDataStream& out, const lfParam_t& v)
@@ -37,6 +80,49 @@ CLunarFeatures::CLunarFeatures()
 {
 }
 
+// orders the features along one axis of their unit vectors
+class CLFAxisLess
+{
+public:
+  CLFAxisLess(const SKVECTOR *vec, int axis) : m_vec(vec), m_axis(axis) {}
+
+  bool operator()(int a, int b) const
+  {
+    return coord(a) < coord(b);
+  }
+
+private:
+  double coord(int i) const
+  {
+    return m_axis == 0 ? m_vec[i].x : (m_axis == 1 ? m_vec[i].y : m_vec[i].z);
+  }
+
+  const SKVECTOR *m_vec;
+  int             m_axis;
+};
+
+///////////////////////////////////////////////////////////
+static double lfAngle(const SKVECTOR &a, const SKVECTOR &b)
+///////////////////////////////////////////////////////////
+{
+  double d = a.x * b.x + a.y * b.y + a.z * b.z;
+
+  return acos(CLAMP(d, -1, 1));
+}
+
+///////////////////////////////////////////////
+// angular extent of the feature (same as the
+// hover range of getCoordinates)
+static double lfExtent(const lunarItem_t &item)
+///////////////////////////////////////////////
+{
+  double rad = item.rad * 0.5;
+
+  if (rad == 0) rad = 10;
+
+  return rad / 1737.0;
+}
+
 ////////////////////////////////////////////////////////////
 static bool sort(const lunarItem_t &a, const lunarItem_t &b)
 ////////////////////////////////////////////////////////////
@@ -105,6 +191,115 @@ void CLunarFeatures::load(QString name)
   }
 
   qSort(tLunarItems.begin(), tLunarItems.end(), sort);
+
+  buildIndex();
+}
+
+/////////////////////////////////
+void CLunarFeatures::buildIndex()
+/////////////////////////////////
+{
+  int count = tLunarItems.count();
+
+  m_vec.resize(count);
+  m_order.resize(count);
+  m_nodes.clear();
+
+  for (int i = 0; i < count; i++)
+  {
+    const lunarItem_t &item = tLunarItems.at(i);
+
+    cAstro.sphToXYZ(item.lon, item.lat, 1, m_vec[i].x, m_vec[i].y, m_vec[i].z);
+    m_order[i] = i;
+  }
+
+  if (count > 0)
+  {
+    m_nodes.reserve(2 * (count / LF_LEAF_SIZE + 1));
+    buildNode(0, count);
+  }
+}
+
+///////////////////////////////////////////////////
+int CLunarFeatures::buildNode(int first, int count)
+///////////////////////////////////////////////////
+{
+  lfNode_t  node;
+  SKVECTOR  mn(1, 1, 1);
+  SKVECTOR  mx(-1, -1, -1);
+  SKVECTOR  c(0, 0, 0);
+  int       index = m_nodes.count();
+
+  m_nodes.append(node);
+
+  node.first = first;
+  node.count = count;
+  node.maxRad = 0;
+  node.hasPoint = false;
+  node.types = 0;
+
+  for (int i = first; i < first + count; i++)
+  {
+    const SKVECTOR    &v = m_vec[m_order[i]];
+    const lunarItem_t &item = tLunarItems.at(m_order[i]);
+
+    c.x += v.x;
+    c.y += v.y;
+    c.z += v.z;
+
+    mn.x = qMin(mn.x, v.x); mx.x = qMax(mx.x, v.x);
+    mn.y = qMin(mn.y, v.y); mx.y = qMax(mx.y, v.y);
+    mn.z = qMin(mn.z, v.z); mx.z = qMax(mx.z, v.z);
+
+    node.maxRad = qMax(node.maxRad, item.rad);
+    node.hasPoint |= item.rad <= 0;
+    node.types |= 1 << item.type;
+  }
+
+  double len = SKVECLength(&c);
+
+  if (len > 1e-9)
+  {
+    node.center = SKVECTOR(c.x / len, c.y / len, c.z / len);
+  }
+  else
+  {
+    node.center = m_vec[m_order[first]];
+  }
+
+  node.radius = 0;
+  for (int i = first; i < first + count; i++)
+  {
+    double r = lfAngle(node.center, m_vec[m_order[i]]) + lfExtent(tLunarItems.at(m_order[i]));
+
+    node.radius = qMax(node.radius, r);
+  }
+  node.radius += 1e-6;
+
+  if (count <= LF_LEAF_SIZE)
+  {
+    node.left = -1;
+    node.right = -1;
+  }
+  else
+  {
+    // split at the median of the widest axis
+    int axis = 0;
+    int half = count / 2;
+
+    if (mx.y - mn.y > mx.x - mn.x) axis = 1;
+    if (mx.z - mn.z > qMax(mx.x - mn.x, mx.y - mn.y)) axis = 2;
+
+    std::nth_element(m_order.begin() + first, m_order.begin() + first + half,
+                     m_order.begin() + first + count, CLFAxisLess(m_vec.constData(), axis));
+
+    node.left = buildNode(first, half);
+    node.right = buildNode(first + half, count - half);
+  }
+
+  m_nodes[index] = node;
+
+  return index;
 }
 
 
@@ -122,8 +317,9 @@ void CLunarFeatures::draw(CSkPainter *p, SKPOINT *pt, int rad, orbit_t *moon, ma
   if (!par.bShowLF)
     return;
 
-  lunarItem_t item;
-  lunarItem_t *lf;  
+  g_lazyLunarFeatures.ensure();
+
+  const lunarItem_t *lf;
 
   double angle;
 
@@ -156,9 +352,55 @@ void CLunarFeatures::draw(CSkPainter *p, SKPOINT *pt, int rad, orbit_t *moon, ma
 
   pth.addEllipse(QPoint(pt->sx, pt->sy), rad, rad);
 
-  foreach (item, tLunarItems)
+  // collect the features on the visible hemisphere and on the screen
+  QVector <int> visible;
+  QVector <int> stack;
+
+  if (m_nodes.count() > 0)
   {
-    lf = &item;
+    stack.append(0);
+  }
+
+  while (!stack.isEmpty())
+  {
+    const lfNode_t &node = m_nodes.at(stack.takeLast());
+    SKVECTOR        c = node.center;
+    SKVECTOR        out;
+
+    if ((par.filter & node.types) == 0)
+      continue;
+
+    if (!node.hasPoint && (node.maxRad < par.maxKmDiam || (node.maxRad / mkm) * scale < par.minDetail))
+      continue;
+
+    SKVECTransform3(&out, &c, &mat);
+
+    if (node.radius < R90 && out.x < -sin(node.radius))
+      continue;
+
+    if (!trfPointOnScr((int)(pt->sx + scale * out.y), (int)(pt->sy - scale * out.z), node.radius * scale + 1))
+      continue;
+
+    if (node.left < 0)
+    {
+      for (int i = node.first; i < node.first + node.count; i++)
+      {
+        visible.append(m_order[i]);
+      }
+    }
+    else
+    {
+      stack.append(node.left);
+      stack.append(node.right);
+    }
+  }
+
+  // keep the drawing order by size
+  qSort(visible);
+
+  foreach (int index, visible)
+  {
+    lf = &tLunarItems.at(index);
 
     if ((par.filter & (1 << lf->type)) != (1 << lf->type))
       continue;
@@ -174,9 +416,9 @@ void CLunarFeatures::draw(CSkPainter *p, SKPOINT *pt, int rad, orbit_t *moon, ma
         continue;
     }
 
-    SKVECTOR in, out;
+    SKVECTOR in = m_vec[index];
+    SKVECTOR out;
 
-    cAstro.sphToXYZ(lf->lon, lf->lat, 1, in.x, in.y, in.z);
     SKVECTransform3(&out, &in, &mat);
 
     if (out.x < 0)
@@ -263,6 +505,8 @@ void CLunarFeatures::draw(CSkPainter *p, SKPOINT *pt, int rad, orbit_t *moon, ma
 
 QStringList CLunarFeatures::getNames()
 {
+  g_lazyLunarFeatures.ensure();
+
   QStringList list;
 
   foreach (const lunarItem_t &item, tLunarItems)
@@ -277,6 +521,8 @@ QStringList CLunarFeatures::getNames()
 bool CLunarFeatures::search(QString str, mapView_t *view, double &ra, double &dec, double &fov, int searchIndex)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
+  g_lazyLunarFeatures.ensure();
+
   lunarItem_t item;
   lunarItem_t *lf;
   orbit_t      o;
@@ -373,6 +619,8 @@ static double distance2(double lat1, double lon1, double lat2, double lon2)
 
 bool CLunarFeatures::getCoordinates(const mapView_t *view, const QPointF &center, const QPointF &pos, double &lon, double &lat, QString &desc)
 {
+  g_lazyLunarFeatures.ensure();
+
   orbit_t o;
 
   cAstro.setParam(view);
@@ -441,22 +689,60 @@ bool CLunarFeatures::getCoordinates(const mapView_t *view, const QPointF &center
 
   desc.clear();
 
-  lunarItem_t item;
-  foreach (item, tLunarItems)
+  // first (smallest) feature in range, only the nodes containing the point are visited
+  SKVECTOR      q;
+  QVector <int> stack;
+  int           found = -1;
+
+  cAstro.sphToXYZ(lon, lat, 1, q.x, q.y, q.z);
+
+  if (m_nodes.count() > 0)
   {
-    double d = distance(item.lat, item.lon, lat, lon);
-    double rad = item.rad * 0.5;
-    if (rad == 0) rad = 10;
-    if (d <= rad)
+    stack.append(0);
+  }
+
+  while (!stack.isEmpty())
+  {
+    const lfNode_t &node = m_nodes.at(stack.takeLast());
+
+    if (lfAngle(q, node.center) > node.radius)
+      continue;
+
+    if (node.left >= 0)
     {
-      desc += "<b>" + item.name + "</b><br/>";
-      desc += getTypeName(item.type) + "<br/>";
-      desc += item.desc;
-      if (item.rad > 0)
+      stack.append(node.left);
+      stack.append(node.right);
+      continue;
+    }
+
+    for (int i = node.first; i < node.first + node.count; i++)
+    {
+      int index = m_order[i];
+
+      if (found >= 0 && index > found)
+        continue;
+
+      const lunarItem_t &item = tLunarItems.at(index);
+      double d = distance(item.lat, item.lon, lat, lon);
+      double rad = item.rad * 0.5;
+      if (rad == 0) rad = 10;
+      if (d <= rad)
       {
-        desc += "<br/>" + QString(tr("Diameter : %1 km")).arg(item.rad);
+        found = index;
       }
-      return true;
+    }
+  }
+
+  if (found >= 0)
+  {
+    const lunarItem_t &item = tLunarItems.at(found);
+
+    desc += "<b>" + item.name + "</b><br/>";
+    desc += getTypeName(item.type) + "<br/>";
+    desc += item.desc;
+    if (item.rad > 0)
+    {
+      desc += "<br/>" + QString(tr("Diameter : %1 km")).arg(item.rad);
     }
   }
 
@@ -465,23 +751,31 @@ bool CLunarFeatures::getCoordinates(const mapView_t *view, const QPointF &center
 
 bool CLunarFeatures::isVisible(int index, mapView_t *view)
 {
-  lunarItem_t *lf = &tLunarItems[index];
-  orbit_t      o;
-  SKPOINT      pt;
-  SKMATRIX     mat;
-  SKMATRIX     mX, mY, mZ, mS;
+  g_lazyLunarFeatures.ensure();
 
-  cAstro.setParam(view);
-  cAstro.calcPlanet(PT_MOON, &o);
+  const lunarItem_t *lf = &tLunarItems.at(index);
 
-  double angle = o.PA;
+  QByteArray key = lfVisKey(view);
 
-  SKMATRIXRotateY(&mY, R90 + R180 + o.cMer);
-  SKMATRIXRotateX(&mX, R180 + o.cLat);
-  SKMATRIXRotateZ(&mZ, -angle);
-  SKMATRIXScale(&mS, view->flipX ? -1 : 1, view->flipY ? -1 : 1, 1);
+  // the moon orientation is computed once per view (called for every feature)
+  if (key != m_visKey)
+  {
+    orbit_t      o;
+    SKMATRIX     mX, mY, mZ, mS;
 
-  mat = mY * mX * mZ * mS;
+    cAstro.setParam(view);
+    cAstro.calcPlanet(PT_MOON, &o);
+
+    double angle = o.PA;
+
+    SKMATRIXRotateY(&mY, R90 + R180 + o.cMer);
+    SKMATRIXRotateX(&mX, R180 + o.cLat);
+    SKMATRIXRotateZ(&mZ, -angle);
+    SKMATRIXScale(&mS, view->flipX ? -1 : 1, view->flipY ? -1 : 1, 1);
+
+    m_visMat = mY * mX * mZ * mS;
+    m_visKey = key;
+  }
 
   SKVECTOR out;
   SKVECTOR in;
@@ -491,7 +785,7 @@ bool CLunarFeatures::isVisible(int index, mapView_t *view)
   in.y =        sin(lf->lat);
   in.z = clat * sin(-lf->lon);
 
-  SKVECTransform3(&out, &in, &mat);
+  SKVECTransform3(&out, &in, &m_visMat);
 
   return out.z < 0;
 }
@@ -20,6 +20,8 @@
 #define  LFT_SINUS          8
 #define  LFT_COUNT          9
 
+#define  LF_LEAF_SIZE       16
+
 typedef struct
 {
   double    lon;
@@ -30,6 +32,20 @@ typedef struct
   QString   desc;
 } lunarItem_t;
 
+// node of the ball tree over the features on the lunar sphere
+typedef struct
+{
+  SKVECTOR  center;    // unit vector
+  double    radius;    // angular radius incl. feature extents (rad)
+  double    maxRad;    // largest feature (km)
+  bool      hasPoint;  // contains features without diameter
+  int       types;     // 1 << LFT_xxx mask
+  int       first;     // range in m_order
+  int       count;
+  int       left;      // child nodes (-1 for a leaf)
+  int       right;
+} lfNode_t;
+
 typedef struct lfParam_t
 {
   lfParam_t ()
@@ -64,6 +80,17 @@ public:
   QStringList getNames();
 
   QList <lunarItem_t>  tLunarItems;
+
+private:
+  void buildIndex();
+  int  buildNode(int first, int count);
+
+  QVector <SKVECTOR>   m_vec;     // feature unit vectors (same order as tLunarItems)
+  QVector <int>        m_order;
+  QVector <lfNode_t>   m_nodes;   // m_nodes[0] is the root
+
+  QByteArray           m_visKey;  // isVisible() matrix cache (lfVisKey_t)
+  SKMATRIX             m_visMat;
 };
 
 extern CLunarFeatures cLunarFeatures;
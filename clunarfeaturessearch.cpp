@@ -4,11 +4,14 @@
 #include "skcore.h"
 
 #include <QDebug>
+#include "clazyload.h"
 
 CLunarFeaturesSearch::CLunarFeaturesSearch(QWidget *parent, mapView_t *view) :
   QDialog(parent),
   ui(new Ui::CLunarFeaturesSearch)
 {
+  g_lazyLunarFeatures.ensure();
+
   ui->setupUi(this);
 
   m_view = view;
@@ -31,12 +31,18 @@
 #include "cmeteorshower.h"
 
 bool g_forcedRecalculate = true;
+
+#define MC_RATE_SIDEREAL   (R360 * 1.00273791)    // rad/day
+#define MC_RATE_MOON       D2R(16)                // fastest regular object (rad/day)
 bool  g_onPrinterBW = false;
 bool *g_bMouseMoveMap;
 
 extern bool g_geocentric;
 extern bool g_developMode;
 extern bool g_showFps;
+extern bool g_showHorizon;
+extern bool g_showGrids;
+extern bool g_showSatellites;
 extern bool g_lockFOV;
 extern int g_numStars;
 extern int g_numRegions;
@@ -110,6 +116,8 @@ CMapView::CMapView(QWidget *parent) :
   configureGamepad();
   m_lastTeleRaDec.Ra = 0;
   m_lastTeleRaDec.Dec = 0;
+  m_cacheValid = false;
+  m_useCache = false;
 
   /*
   m_demo = new CDemonstration();
@@ -126,6 +134,9 @@ CMapView::CMapView(QWidget *parent) :
   slewingTimer->start(250);
   connect(slewingTimer, SIGNAL(timeout()), this, SLOT(slotSlewingTimer()));
 
+  m_teleTimer = new QTimer(this);
+  connect(m_teleTimer, SIGNAL(timeout()), this, SLOT(slotTeleTimer()));
+
   //setToolTip("");
 
   cur_rotate = QCursor(QPixmap(":/res/cur_rotate.png"));
@@ -1165,7 +1176,7 @@ void CMapView::keyEvent(int key, Qt::KeyboardModifiers)
   if (key == Qt::Key_Delete)
   {
     g_cDrawing.remove();
-    repaintMap(true);
+    refreshMap();
   }
 
   tryShowToolTip(m_lastMousePos, key == Qt::Key_Control);
@@ -1428,8 +1439,40 @@ void CMapView::slotTelePlugChange(double ra, double dec)
     precess(&m_lastTeleRaDec.Ra, &m_lastTeleRaDec.Dec, JD2000, m_mapView.jd);
   }
 
-  recenterHoldObject(this, false);
-  repaintMap();  
+  g_teleState.update(m_lastTeleRaDec);
+
+  if (isHoldObject(MO_TELESCOPE))
+  { // recenter (full repaint) only when the telescope leaves the center
+    radec_t rd;
+    SKPOINT pt;
+
+    precess(&m_lastTeleRaDec, &rd, m_mapView.jd, JD2000);
+    trfRaDecToPointNoCorrect(&rd, &pt);
+    if (!trfProjectPoint(&pt) ||
+        qAbs(pt.sx - width() / 2.0) > TS_RECENTER_PX || qAbs(pt.sy - height() / 2.0) > TS_RECENTER_PX)
+    {
+      recenterHoldObject(this, false);
+      return;
+    }
+  }
+
+  // the marker is an overlay (paintEvent), the map is not rendered again
+  if (g_teleState.isMoving() && !m_teleTimer->isActive())
+  {
+    m_teleTimer->start(TS_OVERLAY_MS);
+  }
+  update();
+}
+
+/////////////////////////////
+void CMapView::slotTeleTimer()
+/////////////////////////////
+{
+  if (!g_pTelePlugin || !g_teleState.isMoving())
+  {
+    m_teleTimer->stop();
+  }
+  update();
 }
 
 void CMapView::slotMapControl(QVector2D map, double rotate, double zoom)
@@ -1841,6 +1884,7 @@ void CMapView::printMapView(QPrinter *prn, const QString &profileName)
   m_mapView.mapEpoch = (m_mapView.epochJ2000 || !g_skSet.map.star.useProperMotion) ? JD2000 : m_mapView.jd;
   g_onPrinterBW = bw;
   smRenderSkyMap(&m_mapView, &p1, img);
+  smRenderOverlay(&m_mapView, &p1);
   g_onPrinterBW = false;
 
   p1.end();
@@ -1915,23 +1959,23 @@ void CMapView::repaintMap(bool bRepaint)
 
   pcMainWnd->timeDialogUpdate();
 
-  if (bRepaint)
+  if (bRepaint && pcMainWnd->isQuickInfoTimeUpdate())
   {
-    CSkPainter p(pBmp);
+    CObjFillInfo info;
+    ofiItem_t    *item = pcMainWnd->getQuickInfo();
+    ofiItem_t    newItem;
 
-    if (pcMainWnd->isQuickInfoTimeUpdate())
+    if ((g_quickInfoForced && item) || (item && !equals(m_mapView.jd, item->jd)))
     {
-      CObjFillInfo info;
-      ofiItem_t    *item = pcMainWnd->getQuickInfo();
-      ofiItem_t    newItem;
-
-      if ((g_quickInfoForced && item) || (item && !equals(m_mapView.jd, item->jd)))
-      {
-        info.fillInfo(&m_mapView, &item->mapObj, &newItem);
-        pcMainWnd->fillQuickInfo(&newItem, !g_quickInfoForced);
-        g_quickInfoForced = false;
-      }
+      info.fillInfo(&m_mapView, &item->mapObj, &newItem);
+      pcMainWnd->fillQuickInfo(&newItem, !g_quickInfoForced);
+      g_quickInfoForced = false;
     }
+  }
+
+  if (bRepaint && !(m_useCache && isMapCacheValid()))
+  {
+    CSkPainter p(pBmp);
 
     timer.start();
 
@@ -1942,6 +1986,11 @@ void CMapView::repaintMap(bool bRepaint)
     smRenderSkyMap(&m_mapView, &p, pBmp);
     g_nightRepaint = true;
 
+    m_cacheView = m_mapView;
+    m_cacheSize = pBmp->size();
+    m_cacheLayers = smCurrentLayers();
+    m_cacheValid = true;
+
     if (g_showFps)
     {
       p.setPen(QColor(255, 255, 255));
@@ -1958,6 +2007,52 @@ void CMapView::repaintMap(bool bRepaint)
   pcMainWnd->updateControlInfo();
   QWidget::update();
   g_forcedRecalculate = false;  
+
+  emit sigMapChanged();
+}
+
+/////////////////////////////
+// renders the map only when the cached one is out of date (view, time,
+// layers or size changed), otherwise only the overlays are repainted
+void CMapView::refreshMap()
+/////////////////////////////
+{
+  m_useCache = true;
+  repaintMap(true);
+  m_useCache = false;
+}
+
+//////////////////////////////////
+bool CMapView::isMapCacheValid()
+//////////////////////////////////
+{
+  const mapView_t &a = m_cacheView;
+  const mapView_t &b = m_mapView;
+
+  if (!m_cacheValid || g_forcedRecalculate || m_cacheSize != pBmp->size() || m_cacheLayers != smCurrentLayers())
+  {
+    return false;
+  }
+
+  if (a.x != b.x || a.y != b.y || a.roll != b.roll || a.fov != b.fov ||
+      a.coordType != b.coordType || a.flipX != b.flipX || a.flipY != b.flipY || a.epochJ2000 != b.epochJ2000 ||
+      a.deltaT != b.deltaT || a.deltaTAlg != b.deltaTAlg ||
+      a.starMagAdd != b.starMagAdd || a.dsoMagAdd != b.dsoMagAdd ||
+      a.geo.lon != b.geo.lon || a.geo.lat != b.geo.lat || a.geo.alt != b.geo.alt)
+  {
+    return false;
+  }
+
+  if (g_showSatellites)
+  {
+    return a.jd == b.jd;
+  }
+
+  // time bucket, the sky must not move more than half a pixel
+  double rate = (b.coordType == SMCT_ALT_AZM || g_showHorizon || g_showGrids) ? MC_RATE_SIDEREAL : MC_RATE_MOON;
+  double pixPerRad = qMax(width(), height()) / b.fov;
+
+  return qAbs(b.jd - a.jd) * rate * pixPerRad < 0.5;
 }
 
 //////////////////////////////////////
@@ -1998,10 +2093,21 @@ void CMapView::enableShapeEditor(bool enable)
 }
 
 ////////////////////////////////
+// map as shown (with the overlays)
 QImage *CMapView::getImage(void)
 ////////////////////////////////
 {
-  return(pBmp);
+  m_exportBmp = *pBmp;
+
+  CSkPainter p(&m_exportBmp);
+
+  p.setRenderHint(QPainter::Antialiasing, g_antialiasing);
+  p.setRenderHint(QPainter::SmoothPixmapTransform, g_antialiasing);
+
+  g_cDrawing.setView(&m_mapView);
+  smRenderOverlay(&m_mapView, &p, g_nightConfig);
+
+  return(&m_exportBmp);
 }
 
 
@@ -2020,18 +2126,23 @@ void CMapView::paintEvent(QPaintEvent *)
   if (g_nightConfig && g_nightRepaint)
   {
     for (int ii = 0; ii < pBmp->height(); ii++)
-    {           
+    {
       QRgb* rgbpixel = reinterpret_cast<QRgb*>(pBmp->scanLine(ii));
       for (int jj = 0; jj < pBmp->width(); jj++)
-      {        
+      {
         int gray = qGray(*rgbpixel);
         *rgbpixel = (255 << 24) | (gray << 16);
         rgbpixel++;
       }
     }
     g_nightRepaint = false;
-  }  
-  p.drawImage(0, 0, *pBmp);  
+  }
+  p.drawImage(0, 0, *pBmp);
+
+  // overlays are drawn in the night palette directly, the telescope
+  // timer repaints often and must not filter the whole window
+  g_cDrawing.setView(&m_mapView);
+  smRenderOverlay(&m_mapView, &p, g_nightConfig);
 
   if (m_zoomLens)
   {
@@ -2045,18 +2156,26 @@ void CMapView::paintEvent(QPaintEvent *)
     path.addEllipse(rect);
     p.setClipPath(path);
 
-    p.drawImage(rect,
-                *pBmp, QRect(pos.x() - radius / scale,
-                             pos.y() - radius / scale,
-                             2 * radius / scale, 2 * radius / scale));
+    QRect src = QRect(pos.x() - radius / scale,
+                      pos.y() - radius / scale,
+                      2 * radius / scale, 2 * radius / scale);
+
+    p.drawImage(rect, *pBmp, src);
+
+    // overlays magnified like the map
+    p.save();
+    p.translate(pos);
+    p.scale(scale, scale);
+    p.translate(-pos);
+    smRenderOverlay(&m_mapView, &p, g_nightConfig);
+    p.restore();
+
     p.setClipping(false);
     p.setBrush(Qt::NoBrush);
     p.setPen(QPen(QColor(g_skSet.map.drawing.color), 3));
     p.drawEllipse(rect);
   }
 
-  g_cDrawing.setView(&m_mapView);
-
   ofiItem_t *info = pcMainWnd->getQuickInfo();
   if (info != NULL)
   {
@@ -75,6 +75,7 @@ public:
           ~CMapView();
 
   void repaintMap(bool bRepaint = true);
+  void refreshMap();
   void keyEvent(int key, Qt::KeyboardModifiers modf);
   void keyReleaseEvent(int key, Qt::KeyboardModifiers modf);
   void saveSetting(void);
@@ -121,6 +122,7 @@ public:
 
   CDemonstration *m_demo;
   QTimer *slewingTimer;
+  QTimer *m_teleTimer;     // overlay refresh while the telescope moves
   bool slewBlink;
 
   CGamepad *m_gamePad;
@@ -148,8 +150,18 @@ protected:
   double getDsoMagnitudeLevel(void);
 
 private:
+  bool isMapCacheValid();
+
+  // key of the rendered (cached) map in pBmp
+  mapView_t m_cacheView;
+  QSize     m_cacheSize;
+  int       m_cacheLayers;
+  bool      m_cacheValid;
+  bool      m_useCache;
+
 
   QImage   *pBmp;
+  QImage    m_exportBmp;    // map with the overlays (getImage())
 
   double    m_lastStarMag;
   double    m_lastDsoMag;
@@ -175,6 +187,7 @@ private:
   double m_lastDec;
 
 signals:
+  void sigMapChanged();   // after repaintMap()
 
 public slots:
   void slotAnimChanged(curvePoint_t &p);
@@ -185,6 +198,7 @@ public slots:
   //void slotZoom(float zoom);
   void slotMapControl(QVector2D map, double rotate, double zoom);
   void slotSlewingTimer();
+  void slotTeleTimer();
   void slotGamepadChange(const gamepad_t &state, double speedMul);
 };
 
@@ -3,10 +3,7 @@
 #include "cplanetrenderer.h"
 #include "crts.h"
 #include "mapobj.h"
-
-extern int g_ephType;
-extern int g_ephMoonType;
-extern bool g_geocentric;
+#include "calmanac.h"
 
 ///////////////////////////////////////////////////////
 CMoonCal::CMoonCal(QWidget *parent, mapView_t *view) :
@@ -42,6 +39,8 @@ CMoonCal::CMoonCal(QWidget *parent, mapView_t *view) :
   ui->comboBox->addItem(tr("Sun2", "Sun (not Sunday)"));
   ui->comboBox->setCurrentIndex(0);
 
+  connect(&g_almanac, SIGNAL(sigReady()), this, SLOT(updateTime()));
+
   updateTime();
 }
 
@@ -145,14 +144,10 @@ void CMoonCal::updateTime()
 
   float size = 0.5 * qMin(w, h) * 0.8f;
 
-  int et = g_ephType;
-  int mt = g_ephMoonType;
-  bool gc = g_geocentric;
-
-  g_ephType = EPT_PLAN404;
-  g_ephMoonType = EPT_PLAN404;
-  g_geocentric = false;
+  // computed in background, redrawn on sigReady()
+  int parts = m_isMoon ? AL_NOON | AL_RTS : AL_RTS;
 
+  g_almanac.request(&m_view, jd, cnt, parts);
 
   for (int i = 0; i < cnt; i++)
   {
@@ -173,28 +168,14 @@ void CMoonCal::updateTime()
     p.setBrush(Qt::NoBrush);
     p.drawRect(r);
 
-    CAstro  a;
-    orbit_t o;
-    orbit_t s;
-    mapView_t view = m_view;
-    SKPOINT   pt;
+    almanacDay_t day;
+    mapView_t    view = m_view;
+    SKPOINT      pt;
+    bool         ready = g_almanac.get(&m_view, jd, parts, &day);
 
     view.flipX = false;
     view.flipY = false;
     view.jd = jd;
-    a.setParam(&view);
-    a.calcPlanet(PT_MOON, &o);
-    a.calcPlanet(PT_SUN, &s);
-
-    CRts   cRts;
-    rts_t  rts;
-
-    cRts.setLowPrec();
-
-    if (m_isMoon)
-      cRts.calcOrbitRTS(&rts, PT_MOON, MO_PLANET, &view);
-    else
-      cRts.calcOrbitRTS(&rts, PT_SUN, MO_PLANET, &view);
 
     pt.sx = r.center().x();
     pt.sy = r.center().y();
@@ -203,11 +184,18 @@ void CMoonCal::updateTime()
 
     r.setRect(pt.sx - size * 0.98f, pt.sy - size * 0.98f, size * 2 * 0.98f, size * 2 * 0.98f);
 
+    if (!ready)
+    {
+      p.setPen(QColor(128, 128, 128));
+      p.setFont(QFont("arial", 8));
+      p.drawText(rb, Qt::AlignCenter, tr("Computing..."));
+    }
+    else
     if (m_isMoon)
     {
       p.drawPixmap(r, *m_moon);
       p.save();
-      cPlanetRenderer.drawPhase(&o, &s, &p, &pt, &view, size, size, false);
+      cPlanetRenderer.drawPhase(&day.moon, &day.sun, &p, &pt, &view, size, size, false);
       p.restore();
     }
     else
@@ -229,26 +217,31 @@ void CMoonCal::updateTime()
     float tz = view.geo.tz;
     QString str;
 
-    switch (rts.flag)
+    if (ready)
     {
-      case RTS_ERR:
-        str = tr("Rise/Set solve ERROR!!!");
-        break;
-
-      case RTS_CIRC:
-        str = tr("Object is circumpolar.\n");
-        break;
-
-      case RTS_NONV:
-        str = tr("Object is never visible!\n");
-        break;
-
-      case RTS_DONE:
-        if ((rts.rts & RTS_T_RISE) == RTS_T_RISE)
-          str = tr("Rise : ") +  getStrTime(rts.rise, tz, true) + "\n";
-        if ((rts.rts & RTS_T_SET) == RTS_T_SET)
-          str += tr("Set : ") +  getStrTime(rts.set, tz, true);
-        break;
+      rts_t  &rts = day.rts[m_isMoon ? AL_MOON : AL_SUN];
+
+      switch (rts.flag)
+      {
+        case RTS_ERR:
+          str = tr("Rise/Set solve ERROR!!!");
+          break;
+
+        case RTS_CIRC:
+          str = tr("Object is circumpolar.\n");
+          break;
+
+        case RTS_NONV:
+          str = tr("Object is never visible!\n");
+          break;
+
+        case RTS_DONE:
+          if ((rts.rts & RTS_T_RISE) == RTS_T_RISE)
+            str = tr("Rise : ") +  getStrTime(rts.rise, tz, true) + "\n";
+          if ((rts.rts & RTS_T_SET) == RTS_T_SET)
+            str += tr("Set : ") +  getStrTime(rts.set, tz, true);
+          break;
+      }
     }
 
     p.setFont(QFont("arial", 8));
@@ -264,10 +257,6 @@ void CMoonCal::updateTime()
     }
   }
 
-  g_ephType = et;
-  g_ephMoonType = mt;
-  g_geocentric = gc;
-
   update();
 }
 
@@ -0,0 +1,202 @@
+#include "cnameindex.h"
+
+#include <algorithm>
+
+static bool keyLessThan(const nameIndexKey_t &a, const nameIndexKey_t &b)
+{
+  int c = a.key.compare(b.key);
+
+  if (c != 0)
+  {
+    return c < 0;
+  }
+  return a.id < b.id;
+}
+
+static bool keyLessThanStr(const nameIndexKey_t &a, const QString &b)
+{
+  return a.key.compare(b) < 0;
+}
+
+static inline bool isWordChar(const QChar &ch)
+{
+  return ch.isLetterOrNumber() || ch == '_';
+}
+
+////////////////////////
+CNameIndex::CNameIndex()
+////////////////////////
+{
+  m_built = false;
+}
+
+/////////////////////////
+void CNameIndex::clear()
+/////////////////////////
+{
+  m_names.clear();
+  m_data.clear();
+  m_exact.clear();
+  m_words.clear();
+  m_prefix.clear();
+  m_built = false;
+}
+
+/////////////////////////////////////////////////////////
+int CNameIndex::add(const QString &name, qint64 data)
+/////////////////////////////////////////////////////////
+{
+  int id = m_names.count();
+
+  m_names.append(name);
+  m_data.append(data);
+  m_exact[normalize(name)].append(id);
+  m_built = false;
+
+  return id;
+}
+
+/////////////////////////
+void CNameIndex::build()
+/////////////////////////
+{
+  m_words.clear();
+  m_prefix.clear();
+  m_prefix.reserve(m_names.count() * 2);
+
+  for (int id = 0; id < m_names.count(); id++)
+  {
+    const QString &name = m_names[id];
+
+    for (int i = 0; i < name.length(); i++)
+    {
+      if (!isWordChar(name[i]) || (i > 0 && isWordChar(name[i - 1])))
+      {
+        continue;
+      }
+
+      int end = i;
+      while (end < name.length() && isWordChar(name[end])) end++;
+
+      QList <int> &list = m_words[name.mid(i, end - i).toLower()];
+      if (list.isEmpty() || list.last() != id)
+      {
+        list.append(id);
+      }
+
+      nameIndexKey_t key;
+
+      key.key = normalize(name.mid(i));
+      key.id = id;
+      m_prefix.append(key);
+    }
+  }
+
+  std::sort(m_prefix.begin(), m_prefix.end(), keyLessThan);
+  m_built = true;
+}
+
+///////////////////////////////
+int CNameIndex::count() const
+///////////////////////////////
+{
+  return m_names.count();
+}
+
+////////////////////////////////////////////////
+const QString &CNameIndex::name(int id) const
+////////////////////////////////////////////////
+{
+  return m_names[id];
+}
+
+//////////////////////////////////////
+qint64 CNameIndex::data(int id) const
+//////////////////////////////////////
+{
+  return m_data[id];
+}
+
+//////////////////////////////////////////////////////////
+// returns ids with the same normalized name in the order they were added
+QList<int> CNameIndex::find(const QString &name) const
+//////////////////////////////////////////////////////////
+{
+  return m_exact.value(normalize(name));
+}
+
+//////////////////////////////////////////////////////////
+// returns ids of names containing the whole word (needs build())
+QList<int> CNameIndex::findWord(const QString &word) const
+//////////////////////////////////////////////////////////
+{
+  return m_words.value(word.toLower());
+}
+
+///////////////////////////////////////////////////////////////////////
+// returns up to max names with a word starting with prefix (needs build())
+QStringList CNameIndex::complete(const QString &prefix, int max) const
+///////////////////////////////////////////////////////////////////////
+{
+  QStringList  list;
+  QSet <int>   used;
+  QString      key = normalize(prefix);
+
+  if (key.isEmpty())
+  {
+    return list;
+  }
+
+  QVector <nameIndexKey_t>::const_iterator it = std::lower_bound(m_prefix.constBegin(), m_prefix.constEnd(), key, keyLessThanStr);
+
+  for (; it != m_prefix.constEnd() && list.count() < max; ++it)
+  {
+    if (!it->key.startsWith(key))
+    {
+      break;
+    }
+
+    if (!used.contains(it->id))
+    {
+      used.insert(it->id);
+      list.append(m_names[it->id]);
+    }
+  }
+
+  return list;
+}
+
+//////////////////////////////////////////////////////
+// same rules as compareName() (no spaces, no case)
+QString CNameIndex::normalize(const QString &name)
+//////////////////////////////////////////////////////
+{
+  QString str = name.toLower();
+
+  str.remove(' ');
+
+  return str;
+}
+
+////////////////////////////////////////////////////////
+QStringList CNameIndex::words(const QString &name)
+////////////////////////////////////////////////////////
+{
+  QStringList list;
+  QString     word;
+
+  for (int i = 0; i <= name.length(); i++)
+  {
+    if (i < name.length() && isWordChar(name[i]))
+    {
+      word += name[i];
+    }
+    else if (!word.isEmpty())
+    {
+      list.append(word.toLower());
+      word.clear();
+    }
+  }
+
+  return list;
+}
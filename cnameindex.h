@@ -0,0 +1,44 @@
+#ifndef CNAMEINDEX_H
+#define CNAMEINDEX_H
+
+#include <QtCore>
+
+typedef struct
+{
+  QString key;      // normalized name from a word start to its end
+  int     id;
+} nameIndexKey_t;
+
+// Normalized (case and space insensitive) name index.
+// Exact lookups go through a hash, word lookups through a word hash and
+// completion through a sorted table of word-start keys (flattened prefix trie).
+class CNameIndex
+{
+public:
+  CNameIndex();
+  void    clear();
+  int     add(const QString &name, qint64 data);
+  void    build();
+
+  int            count() const;
+  bool           isBuilt() const { return m_built; }
+  const QString &name(int id) const;
+  qint64         data(int id) const;
+
+  QList <int>  find(const QString &name) const;
+  QList <int>  findWord(const QString &word) const;
+  QStringList  complete(const QString &prefix, int max) const;
+
+  static QString     normalize(const QString &name);
+  static QStringList words(const QString &name);
+
+private:
+  QVector <QString>               m_names;
+  QVector <qint64>                m_data;
+  QHash <QString, QList <int> >   m_exact;
+  QHash <QString, QList <int> >   m_words;
+  QVector <nameIndexKey_t>        m_prefix;
+  bool                            m_built;
+};
+
+#endif // CNAMEINDEX_H
@@ -4,8 +4,11 @@
 #include "ccomdlg.h"
 #include "setting.h"
 #include "csgp4.h"
+#include "ctrackengine.h"
+#include "precess.h"
 
-#define TRACKING_VERSION        "TRK10"
+#define TRACKING_VERSION        "TRK11"
+#define TRACKING_VERSION_10     "TRK10"
 
 QList <tracking_t> tTracking;
 extern CMapView    *pcMapView;
@@ -24,7 +27,7 @@ void loadTracking(void)
 
     s >> version;
 
-    if (version != TRACKING_VERSION)
+    if (version != TRACKING_VERSION && version != TRACKING_VERSION_10)
       return;
 
     s >> count;
@@ -44,20 +47,31 @@ void loadTracking(void)
       s >> t.type;
       s >> t.markStep;
 
-      int c;
-
-      s >> c;
+      if (version == TRACKING_VERSION)
+      {
+        QByteArray data;
 
-      for (int j = 0; j < c; j++)
+        s >> data;
+        CTrackEngine::unpack(data, t.tPos);
+      }
+      else
       {
-        trackPos_t p;
+        int c;
+
+        s >> c;
+
+        for (int j = 0; j < c; j++)
+        {
+          trackPos_t p;
 
-        s >> p.jd;
-        s >> p.mag;
-        s >> p.rd.Ra;
-        s >> p.rd.Dec;
+          s >> p.jd;
+          s >> p.mag;
+          s >> p.rd.Ra;
+          s >> p.rd.Dec;
+          p.index = j;
 
-        t.tPos.append(p);
+          t.tPos.append(p);
+        }
       }
       tTracking.append(t);
     }
@@ -90,15 +104,7 @@ void saveTracking(void)
       s << tTracking.at(i).type;
       s << tTracking.at(i).markStep;
 
-      s << tTracking.at(i).tPos.count();
-
-      for (int j = 0; j < tTracking.at(i).tPos.count(); j++)
-      {
-        s << tTracking.at(i).tPos[j].jd;
-        s << tTracking.at(i).tPos[j].mag;
-        s << tTracking.at(i).tPos[j].rd.Ra;
-        s << tTracking.at(i).tPos[j].rd.Dec;        
-      }
+      s << CTrackEngine::pack(tTracking.at(i).tPos);
     }
 
     f.close();
@@ -154,96 +160,203 @@ static float drawLineTicks(SKPOINT *p1, SKPOINT *p2, CSkPainter *pPainter, int s
   return(0);
 }
 
+//////////////////////////////////////////////////////////////
+static void trackLod(const QVector <SKVECTOR> &v, const QVector <int> &in, double sep, QVector <int> &out)
+//////////////////////////////////////////////////////////////
+{
+  double minDot = cos(sep);
+
+  out.clear();
+
+  for (int i = 0; i < in.count(); i++)
+  {
+    if (out.isEmpty() || i == in.count() - 1)
+    {
+      out.append(in[i]);
+      continue;
+    }
+
+    const SKVECTOR &a = v[out.last()];
+    const SKVECTOR &b = v[in[i]];
+
+    if (a.x * b.x + a.y * b.y + a.z * b.z <= minDot)
+    {
+      out.append(in[i]);
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////
+static void trackUpdateCache(tracking_t *track, mapView_t *view)
+/////////////////////////////////////////////////////////////
+{
+  trackCache_t *cache = &track->cache;
+  int           count = track->tPos.count();
+
+  if (cache->v.count() != count)
+  {
+    QVector <int> all;
+    QVector <int> ticks;
+
+    cache->v.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+      const radec_t &rd = track->tPos[i].rd;
+      double cd = cos(-rd.Dec);
+
+      cache->v[i].x = cd * sin(-rd.Ra);
+      cache->v[i].y = sin(-rd.Dec);
+      cache->v[i].z = cd * cos(-rd.Ra);
+
+      int index = track->tPos[i].index;
+
+      all.append(i);
+      if (index >= 0 && ((index % track->labelStep) == 0 || (index % track->markStep) == 0))
+      {
+        ticks.append(i);
+      }
+    }
+
+    cache->lod[0] = all;
+    cache->ticks[0] = ticks;
+
+    for (int l = 1; l < TR_LOD_LEVELS; l++)
+    {
+      double sep = TR_LOD_SEP * pow(4.0, l - 1);
+
+      trackLod(cache->v, all, sep, cache->lod[l]);
+      trackLod(cache->v, ticks, sep * TR_TICK_PX / TR_LOD_PX, cache->ticks[l]);
+    }
+
+    cache->jd = CM_UNDEF;
+    cache->labels.clear();
+  }
+
+  if (cache->jd != view->jd)
+  {
+    SKMATRIX mat;
+
+    precessMatrix(view->jd, JD2000, &mat);
+
+    cache->jd = view->jd;
+    cache->w.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+      SKVECTransform3(&cache->w[i], &cache->v[i], &mat);
+    }
+  }
+
+  if (cache->labels.count() != count || cache->tz != view->geo.tz)
+  {
+    cache->tz = view->geo.tz;
+    cache->labels.fill(QString(), count);
+  }
+}
+
 ///////////////////////////////////////////////////////
 void trackRender(mapView_t *view, CSkPainter *pPainter)
 ///////////////////////////////////////////////////////
 {
   SKPOINT p1;
   SKPOINT p2;
+  int     scrWidth;
+  int     scrHeight;
 
   int markSize = 2;
 
+  trfGetScreenSize(scrWidth, scrHeight);
+
+  double pixel = view->fov / qMax(1, scrWidth);
+  int    level = 0;
+
+  for (int l = TR_LOD_LEVELS - 1; l > 0; l--)
+  {
+    if (TR_LOD_SEP * pow(4.0, l - 1) <= pixel * TR_LOD_PX)
+    {
+      level = l;
+      break;
+    }
+  }
+
   pPainter->setBrush(QColor(g_skSet.map.tracking.color));
 
   for (int i = 0; i < tTracking.count(); i++)
   {
-    if (!tTracking[i].show)
+    if (!tTracking[i].show || tTracking[i].tPos.count() < 2)
     {
       continue;
     }
 
-    const trackPos_t *pos1;
-    const trackPos_t *pos2;
-    int   ls = tTracking[i].labelStep;
-    bool  bDT = tTracking[i].bShowDateTime;
-    bool  bMag = tTracking[i].bShowMag;
-    float la = tTracking[i].labelAngle;
-    int   markStep = tTracking[i].markStep;
+    tracking_t   *track = &tTracking[i];
+    trackCache_t *cache = &track->cache;
+    int   ls = track->labelStep;
+    bool  bDT = track->bShowDateTime;
+    bool  bMag = track->bShowMag;
+    float la = track->labelAngle;
+    int   markStep = track->markStep;
 
-    for (int j = 0; j < tTracking[i].tPos.count() - 1; j++)
-    {
-      pos1 = &tTracking[i].tPos.at(j);
-      trfRaDecToPointCorrectFromTo(&pos1->rd, &p1, view->jd, JD2000);
+    trackUpdateCache(track, view);
+
+    const QVector <int> &pts = cache->lod[level];
+    QVector <QLine>      lines;
 
-      pos2 = &tTracking[i].tPos.at(j + 1);
-      trfRaDecToPointCorrectFromTo(&pos2->rd, &p2, view->jd, JD2000);
+    for (int j = 0; j < pts.count() - 1; j++)
+    {
+      p1.w = cache->w[pts[j]];
+      p2.w = cache->w[pts[j + 1]];
 
       if (trfProjectLine(&p1, &p2))
       {
-        pPainter->setPen(QColor(g_skSet.map.tracking.color));
-        pPainter->drawLine(p1.sx, p1.sy, p2.sx, p2.sy);
+        lines.append(QLine(p1.sx, p1.sy, p2.sx, p2.sy));
+      }
+    }
 
-        if ((j % ls) == 0)
-        {
-          QString str;
+    pPainter->setPen(QColor(g_skSet.map.tracking.color));
+    pPainter->drawLines(lines);
 
-          if (bDT)
-            str += getStrDate(pos1->jd, view->geo.tz) + " " + getStrTime(pos1->jd, view->geo.tz, true) + " ";
-          if (bMag && pos1->mag != CM_UNDEF)
-            str += getStrMag(pos1->mag);
+    const QVector <int> &ticks = cache->ticks[level];
+    QPoint               lastLabel;
+    bool                 isLabel = false;
 
-          pPainter->drawCross(p1.sx, p1.sy, 7);
+    for (int j = 0; j < ticks.count(); j++)
+    {
+      const trackPos_t *pos = &track->tPos[ticks[j]];
 
-          setSetFontColor(FONT_TRACKING, pPainter);
-          setSetFont(FONT_TRACKING, pPainter);
-          pPainter->drawRotatedText(la + R2D(view->roll), p1.sx, p1.sy, "  "  + str);
-          pPainter->setPen(QColor(g_skSet.map.tracking.color));
-        }
-        else
+      p1.w = cache->w[ticks[j]];
+      if (!trfProjectPoint(&p1))
+      {
+        continue;
+      }
+
+      if ((pos->index % ls) == 0 &&
+          (!isLabel || (QPoint(p1.sx, p1.sy) - lastLabel).manhattanLength() >= TR_LABEL_PX))
+      {
+        QString &str = cache->labels[ticks[j]];
+
+        if (str.isEmpty())
         {
-          if ((j % markStep) == 0)
-          {
-            pPainter->drawCircle(QPoint(p1.sx, p1.sy), markSize);
-          }
+          if (bDT)
+            str += getStrDate(pos->jd, view->geo.tz) + " " + getStrTime(pos->jd, view->geo.tz, true) + " ";
+          if (bMag && pos->mag != CM_UNDEF)
+            str += getStrMag(pos->mag);
+          str = "  " + str;
         }
 
-        if (j + 2 == tTracking[i].tPos.count())
-        { // last tick
-          if (((j + 1) % ls) == 0)
-          {
-            QString str;
-
-            if (bDT)
-              str += getStrDate(pos2->jd, view->geo.tz) + " " + getStrTime(pos2->jd, view->geo.tz, true) + " ";
-            if (bMag)
-              str += getStrMag(pos2->mag);
-
-            pPainter->drawCross(p2.sx, p2.sy, 7);
-
-            setSetFontColor(FONT_TRACKING, pPainter);
-            setSetFont(FONT_TRACKING, pPainter);
-            pPainter->drawRotatedText(la + R2D(view->roll), p2.sx, p2.sy, "  " + str);
-            pPainter->setPen(QColor(g_skSet.map.tracking.color));
-          }
-          else
-          {
-            if ((j % markStep) == 0)
-              pPainter->drawCircle(QPoint(p2.sx, p2.sy), markSize);
-          }
-        }
+        pPainter->drawCross(p1.sx, p1.sy, 7);
+
+        setSetFontColor(FONT_TRACKING, pPainter);
+        setSetFont(FONT_TRACKING, pPainter);
+        pPainter->drawRotatedText(la + R2D(view->roll), p1.sx, p1.sy, str);
+        pPainter->setPen(QColor(g_skSet.map.tracking.color));
+
+        lastLabel = QPoint(p1.sx, p1.sy);
+        isLabel = true;
+      }
+      else
+      if ((pos->index % markStep) == 0)
+      {
+        pPainter->drawCircle(QPoint(p1.sx, p1.sy), markSize);
       }
-      //pos1 = pos2;
-      //p1 = p2;
     }
   }
 }
@@ -314,14 +427,9 @@ void CObjTracking::on_pushButton_2_clicked()
   int        tt = ui->comboBox->currentIndex();
   int        ls = ui->spinBox_2->value();
   double     jdStep;
-  int        c = 0;
-  orbit_t    o;
-  orbit_t    o1;
   tracking_t track;
-  trackPos_t pos;
   asteroid_t *ast;
   comet_t    *com;
-  satellite_t sat;
 
   if (jdFrom >= jdTo)
   {
@@ -350,8 +458,6 @@ void CObjTracking::on_pushButton_2_clicked()
 
   jdStep /= 86400.0;
 
-  // FIXME: zkontrolovat vsechny pouziti cAstro
-
   track.show = true;
   track.labelStep = ls;
   track.bShowDateTime = ui->checkBox->isChecked();
@@ -387,57 +493,32 @@ void CObjTracking::on_pushButton_2_clicked()
       break;
   }
 
-  for (double j = jdFrom; j <= jdTo; j+= jdStep, c++)
+  CTrackEngine engine(&m_view, m_item, jdFrom, jdTo, jdStep, track.labelStep, track.markStep);
+
+  if (!engine.isCached())
   {
-    m_view.jd = j;
-    cAstro.setParam(&m_view);
+    QProgressDialog dlg(tr("Please wait..."), tr("Cancel"), 0, 100, this);
+
+    dlg.setWindowModality(Qt::WindowModal);
+    dlg.setMinimumDuration(0);
+    dlg.setAutoClose(false);
+    dlg.setAutoReset(false);
+
+    connect(&engine, SIGNAL(sigProgress(int)), &dlg, SLOT(setValue(int)), Qt::QueuedConnection);
+    connect(&engine, SIGNAL(sigDone()), &dlg, SLOT(accept()), Qt::QueuedConnection);
 
-    switch (m_item->type)
+    engine.start();
+    if (dlg.exec() != QDialog::Accepted)
     {
-      case MO_PLANET:
-        cAstro.calcPlanet(m_item->par1, &o);
-        pos.rd.Ra = o.lRD.Ra;
-        pos.rd.Dec = o.lRD.Dec;
-        pos.mag = o.mag;
-        pos.jd = j;
-        break;
-
-      case MO_EARTH_SHD:
-        cAstro.calcPlanet(PT_MOON, &o1);
-        cAstro.calcEarthShadow(&o, &o1);
-        pos.rd.Ra = o.lRD.Ra;
-        pos.rd.Dec = o.lRD.Dec;
-        pos.mag = CM_UNDEF;
-        pos.jd = j;
-        break;
-
-      case MO_COMET:
-        comSolve(com, j);
-        pos.rd.Ra = com->orbit.lRD.Ra;
-        pos.rd.Dec = com->orbit.lRD.Dec;
-        pos.mag = com->orbit.mag;
-        pos.jd = j;
-        break;
-
-      case MO_ASTER:
-        astSolve(ast, j);
-        pos.rd.Ra = ast->orbit.lRD.Ra;
-        pos.rd.Dec = ast->orbit.lRD.Dec;
-        pos.mag = ast->orbit.mag;
-        pos.jd = j;
-        break;
-
-      case MO_SATELLITE:
-        sgp4.solve(m_item->par1, &m_view, &sat);
-
-        cAstro.convAA2RDRef(sat.azimuth, sat.elevation, &pos.rd.Ra, &pos.rd.Dec);
-        pos.mag = CM_UNDEF;
-        pos.jd = j;
-        break;
+      engine.stop();
+      engine.wait();
+      return;
     }
-    track.tPos.append(pos);
+    engine.wait();
   }
 
+  track.tPos = engine.positions();
+
   if (track.tPos.count() < 2)
   {
     msgBoxError(this, tr("Tracking has too few points!"));
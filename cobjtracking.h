@@ -5,13 +5,32 @@
 #include "cobjfillinfo.h"
 #include "cmapview.h"
 
+#define TR_LOD_LEVELS     6
+#define TR_LOD_SEP        D2R(1 / 60.0)   // level 1 min. point distance (x4 per level)
+#define TR_LOD_PX         2               // max. point distance at the chosen level
+#define TR_TICK_PX        6               // min. distance of marks
+#define TR_LABEL_PX       40              // min. distance of labels
+
 typedef struct
 {
   radec_t  rd;
   float    mag;
   double   jd;
+  int      index;     // at user step, -1 = adaptive sample
 } trackPos_t;
 
+// screen space data (rebuilt when the map epoch changes)
+typedef struct
+{
+  double              jd;
+  QVector <SKVECTOR>  v;                      // of date
+  QVector <SKVECTOR>  w;                      // map epoch
+  QVector <int>       lod[TR_LOD_LEVELS];     // points per level (0 = all)
+  QVector <int>       ticks[TR_LOD_LEVELS];   // labels and marks per level
+  double              tz;
+  QVector <QString>   labels;
+} trackCache_t;
+
 typedef struct
 {
   bool       show;
@@ -24,7 +43,8 @@ typedef struct
   double     jdFrom;
   double     jdTo;
   int        type;
-  QList      <trackPos_t> tPos;
+  QVector    <trackPos_t> tPos;
+  trackCache_t cache;
 } tracking_t;
 
 
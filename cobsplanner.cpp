@@ -0,0 +1,495 @@
+#include "cobsplanner.h"
+#include "crts.h"
+#include "cdso.h"
+#include "gcvs.h"
+#include "tycho.h"
+#include "precess.h"
+#include "mapobj.h"
+#include "cdbstarsdlg.h"
+#include "vsop87.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define OP_SSE2
+#endif
+
+#define OP_SIDEREAL_RATE    (MPI2 * 1.00273790935)    // rad/day
+
+// 4 bit mask helpers
+static const int opBitCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+static const int opFirstBit[16] = { -1, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0 };
+static const int opLastBit[16]  = { -1, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3 };
+
+typedef struct
+{
+  const float *a;       // cos(lat) * cos(lst)
+  const float *b;       // cos(lat) * sin(lst)
+  const float *off;     // 0 or -4 for padding
+  const float *mx;      // Moon unit vector (zero when ignored)
+  const float *my;
+  const float *mz;
+  int          count;   // multiple of 4
+  float        sinLat;
+  float        thr;     // sin(min. alt)
+  float        cosMoon; // cos(min. Moon dist.)
+} planKernel_t;
+
+typedef struct
+{
+  int   count;          // visible samples
+  int   first;
+  int   last;
+  int   maxIdx;
+  float maxSinAlt;
+} planEval_t;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// sin(alt) = sin(lat) * z + cos(lat) * (x * cos(lst) + y * sin(lst))
+static void planEvalObject(const planKernel_t *k, float x, float y, float z, planEval_t *out)
+//////////////////////////////////////////////////////////////////////////////////////////
+{
+  float zs = z * k->sinLat;
+
+  out->count = 0;
+  out->first = -1;
+  out->last = -1;
+  out->maxIdx = -1;
+  out->maxSinAlt = -2;
+
+#ifdef OP_SSE2
+  const __m128 vx = _mm_set1_ps(x);
+  const __m128 vy = _mm_set1_ps(y);
+  const __m128 vz = _mm_set1_ps(z);
+  const __m128 vzs = _mm_set1_ps(zs);
+  const __m128 vthr = _mm_set1_ps(k->thr);
+  const __m128 vcm = _mm_set1_ps(k->cosMoon);
+  const __m128 vnone = _mm_set1_ps(-2);
+  const __m128 vfour = _mm_set1_ps(4);
+
+  __m128 vmax = vnone;
+  __m128 vmaxIdx = _mm_setzero_ps();
+  __m128 vidx = _mm_set_ps(3, 2, 1, 0);
+
+  for (int i = 0; i < k->count; i += 4)
+  {
+    __m128 s = _mm_add_ps(_mm_add_ps(vzs, _mm_load_ps(k->off + i)),
+                          _mm_add_ps(_mm_mul_ps(vx, _mm_load_ps(k->a + i)), _mm_mul_ps(vy, _mm_load_ps(k->b + i))));
+    __m128 d = _mm_add_ps(_mm_mul_ps(vx, _mm_load_ps(k->mx + i)),
+                          _mm_add_ps(_mm_mul_ps(vy, _mm_load_ps(k->my + i)), _mm_mul_ps(vz, _mm_load_ps(k->mz + i))));
+    __m128 m = _mm_and_ps(_mm_cmpgt_ps(s, vthr), _mm_cmple_ps(d, vcm));
+    int bits = _mm_movemask_ps(m);
+
+    if (bits)
+    {
+      if (out->first < 0)
+      {
+        out->first = i + opFirstBit[bits];
+      }
+      out->last = i + opLastBit[bits];
+      out->count += opBitCount[bits];
+
+      __m128 sm = _mm_or_ps(_mm_and_ps(m, s), _mm_andnot_ps(m, vnone));
+      __m128 gt = _mm_cmpgt_ps(sm, vmax);
+
+      vmax = _mm_or_ps(_mm_and_ps(gt, sm), _mm_andnot_ps(gt, vmax));
+      vmaxIdx = _mm_or_ps(_mm_and_ps(gt, vidx), _mm_andnot_ps(gt, vmaxIdx));
+    }
+    vidx = _mm_add_ps(vidx, vfour);
+  }
+
+  if (out->count > 0)
+  {
+    float maxv[4];
+    float maxi[4];
+
+    _mm_storeu_ps(maxv, vmax);
+    _mm_storeu_ps(maxi, vmaxIdx);
+
+    for (int i = 0; i < 4; i++)
+    {
+      if (maxv[i] > out->maxSinAlt || (maxv[i] == out->maxSinAlt && (int)maxi[i] < out->maxIdx))
+      {
+        out->maxSinAlt = maxv[i];
+        out->maxIdx = (int)maxi[i];
+      }
+    }
+  }
+#else
+  for (int i = 0; i < k->count; i++)
+  {
+    float s = zs + k->off[i] + x * k->a[i] + y * k->b[i];
+    float d = x * k->mx[i] + y * k->my[i] + z * k->mz[i];
+
+    if (s > k->thr && d <= k->cosMoon)
+    {
+      if (out->first < 0)
+      {
+        out->first = i;
+      }
+      out->last = i;
+      out->count++;
+
+      if (s > out->maxSinAlt)
+      {
+        out->maxSinAlt = s;
+        out->maxIdx = i;
+      }
+    }
+  }
+#endif
+}
+
+static bool planResultSort(const planResult_t &a, const planResult_t &b)
+{
+  return a.score > b.score;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+CObsPlanner::CObsPlanner(const mapView_t *view, const planParams_t &params, const QVector<planTarget_t> &targets)
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  m_view = *view;
+  m_params = params;
+  m_params.nights = qBound(1, m_params.nights, OP_MAX_NIGHTS);
+  m_params.minMoonDist = qBound(0.0, m_params.minMoonDist, R90);
+  m_targets = targets;
+  m_end = false;
+
+  // twilight times only
+  m_astro.setAccuracy(VSOP87_ACC_10SEC);
+}
+
+/////////////////////////
+void CObsPlanner::stop()
+/////////////////////////
+{
+  m_end = true;
+}
+
+//////////////////////////////////////////////////
+// results found since the last call (thread safe)
+QList<planResult_t> CObsPlanner::takeResults()
+//////////////////////////////////////////////////
+{
+  QMutexLocker locker(&m_mutex);
+  QList <planResult_t> list = m_results;
+
+  m_results.clear();
+
+  return list;
+}
+
+//////////////////////////////////////////////////////////////
+const planTarget_t &CObsPlanner::target(int index) const
+//////////////////////////////////////////////////////////////
+{
+  return m_targets[index];
+}
+
+/////////////////////////////////////////////////////////////////////
+void CObsPlanner::addDSO(QVector<planTarget_t> &list, float maxMag)
+/////////////////////////////////////////////////////////////////////
+{
+  for (int i = 0; i < cDSO.dsoHead.numDso; i++)
+  {
+    dso_t *dso = &cDSO.dso[i];
+
+    if (dso->type == DSOT_NGC_DUPP || dso->mag == NO_DSO_MAG || dso->DSO_MAG > maxMag)
+    {
+      continue;
+    }
+
+    planTarget_t t;
+
+    t.type = OPT_DSO;
+    t.name = cDSO.getName(dso);
+    t.rd = dso->rd;
+    t.mag = dso->DSO_MAG;
+    t.data = (qint64)dso;
+    t.tyc[0] = t.tyc[1] = t.tyc[2] = 0;
+
+    list.append(t);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CObsPlanner::addVariableStars(QVector<planTarget_t> &list, float maxMag)
+///////////////////////////////////////////////////////////////////////////////
+{
+  QList <gcvs_t> gcvs = g_GCVS.getList();
+
+  for (int i = 0; i < gcvs.count(); i++)
+  {
+    int tyc[3] = { gcvs[i].tyc1, gcvs[i].tyc2, gcvs[i].tyc3 };
+    tychoStar_t *star = cTYC.findTYCStar(tyc);
+
+    if (star == NULL || gcvs[i].magMax > maxMag)
+    {
+      continue;
+    }
+
+    planTarget_t t;
+
+    t.type = OPT_VARIABLE;
+    t.name = gcvs[i].name;
+    t.rd = star->rd;
+    t.mag = gcvs[i].magMax;
+    t.data = 0;
+    t.tyc[0] = tyc[0];
+    t.tyc[1] = tyc[1];
+    t.tyc[2] = tyc[2];
+
+    list.append(t);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+void CObsPlanner::addDoubleStars(QVector<planTarget_t> &list, float maxMag, double yr)
+//////////////////////////////////////////////////////////////////////////////////////
+{
+  QList <dblStar_t> dbl;
+
+  CDbStarsDlg::loadList(dbl, yr);
+
+  for (int i = 0; i < dbl.count(); i++)
+  {
+    if (dbl[i].mag1 > maxMag)
+    {
+      continue;
+    }
+
+    planTarget_t t;
+
+    t.type = OPT_DOUBLE;
+    t.name = dbl[i].name;
+    t.rd = dbl[i].rd;
+    t.mag = dbl[i].mag1;
+    t.data = 0;
+    t.tyc[0] = dbl[i].tyc[0];
+    t.tyc[1] = dbl[i].tyc[1];
+    t.tyc[2] = dbl[i].tyc[2];
+
+    list.append(t);
+  }
+}
+
+//////////////////////
+void CObsPlanner::run()
+//////////////////////
+{
+  double startDay = getStartOfDay(m_view.jd, m_view.geo.tz);
+  int    count = m_targets.count();
+
+  // all targets to the equator of the middle of the period
+  SKMATRIX mat;
+
+  precessMatrix(JD2000, startDay + m_params.nights * 0.5, &mat);
+
+  m_x.resize(count);
+  m_y.resize(count);
+  m_z.resize(count);
+
+  for (int i = 0; i < count; i++)
+  {
+    double ra = m_targets[i].rd.Ra;
+    double dec = m_targets[i].rd.Dec;
+
+    precessMat(&ra, &dec, &mat);
+
+    m_x[i] = cos(dec) * cos(ra);
+    m_y[i] = cos(dec) * sin(ra);
+    m_z[i] = sin(dec);
+  }
+
+  for (int n = 0; n < m_params.nights && !m_end; n++)
+  {
+    planNight_t         night;
+    QList <planResult_t> list;
+    double              day = startDay + n;
+
+    if (calcNight(day, day + 1, &night))
+    {
+      evalNight(day, &night, list);
+    }
+
+    m_mutex.lock();
+    m_results.append(list);
+    m_mutex.unlock();
+
+    emit sigProgress((n + 1) * 100 / m_params.nights);
+  }
+
+  emit sigDone();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// twilight and Moon for night between day and nextDay
+bool CObsPlanner::calcNight(double day, double nextDay, planNight_t *night)
+//////////////////////////////////////////////////////////////////////////
+{
+  mapView_t  v = m_view;
+  CRts       rts;
+  rts_t      sun;
+  daylight_t dl1;
+  daylight_t dl2;
+
+  rts.setAstro(&m_astro);
+
+  v.jd = day;
+  rts.calcOrbitRTS(&sun, PT_SUN, MO_PLANET, &v);
+  rts.calcTwilight(&dl1, &v, sun.transit);
+
+  v.jd = nextDay;
+  rts.calcOrbitRTS(&sun, PT_SUN, MO_PLANET, &v);
+  rts.calcTwilight(&dl2, &v, sun.transit);
+
+  if (dl1.endAstroTw == 0 || dl2.beginAstroTw == 0 || dl2.beginAstroTw <= dl1.endAstroTw)
+  { // no astronomical night
+    return false;
+  }
+
+  night->dusk = dl1.endAstroTw;
+  night->dawn = dl2.beginAstroTw;
+
+  for (int i = 0; i < 2; i++)
+  {
+    orbit_t moon;
+
+    v.jd = i == 0 ? night->dusk : night->dawn;
+    m_astro.setParam(&v);
+    m_astro.calcPlanet(PT_MOON, &moon);
+
+    if (i == 0)
+    {
+      night->lst = m_astro.m_lst;
+      night->moonPhase = moon.phase;
+    }
+
+    night->moon[i][0] = cos(moon.lRD.Dec) * cos(moon.lRD.Ra);
+    night->moon[i][1] = cos(moon.lRD.Dec) * sin(moon.lRD.Ra);
+    night->moon[i][2] = sin(moon.lRD.Dec);
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+void CObsPlanner::evalNight(double day, const planNight_t *night, QList<planResult_t> &out)
+/////////////////////////////////////////////////////////////////////////////////////////
+{
+  int samples = (int)((night->dawn - night->dusk) / OP_STEP) + 1;
+  int count = (samples + 3) & ~3;
+
+  // 16 byte aligned sample tables
+  QVector <float> buffer(count * 6 + 4);
+  float *a = (float *)(((quintptr)buffer.data() + 15) & ~(quintptr)15);
+  float *b = a + count;
+  float *off = b + count;
+  float *mx = off + count;
+  float *my = mx + count;
+  float *mz = my + count;
+
+  double sinLat = sin(m_view.geo.lat);
+  double cosLat = cos(m_view.geo.lat);
+  bool   useMoon = night->moonPhase >= m_params.maxMoonPhase;
+
+  for (int i = 0; i < count; i++)
+  {
+    if (i >= samples)
+    {
+      a[i] = b[i] = mx[i] = my[i] = mz[i] = 0;
+      off[i] = -4;
+      continue;
+    }
+
+    double lst = night->lst + i * OP_STEP * OP_SIDEREAL_RATE;
+    double t = samples > 1 ? i / (double)(samples - 1) : 0;
+    double m[3];
+
+    a[i] = cosLat * cos(lst);
+    b[i] = cosLat * sin(lst);
+    off[i] = 0;
+
+    for (int j = 0; j < 3; j++)
+    {
+      m[j] = LERP(t, night->moon[0][j], night->moon[1][j]);
+    }
+
+    double len = sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+    double moonSinAlt = (sinLat * m[2] + a[i] * m[0] + b[i] * m[1]) / len;
+
+    if (useMoon && moonSinAlt > 0)
+    {
+      mx[i] = m[0] / len;
+      my[i] = m[1] / len;
+      mz[i] = m[2] / len;
+    }
+    else
+    { // Moon below horizon or too faint
+      mx[i] = my[i] = mz[i] = 0;
+    }
+  }
+
+  planKernel_t kernel;
+
+  kernel.a = a;
+  kernel.b = b;
+  kernel.off = off;
+  kernel.mx = mx;
+  kernel.my = my;
+  kernel.mz = mz;
+  kernel.count = count;
+  kernel.sinLat = sinLat;
+  kernel.thr = sin(m_params.minAlt);
+  kernel.cosMoon = cos(m_params.minMoonDist);
+
+  int targets = m_targets.count();
+  QVector <planEval_t> eval(targets);
+
+  #pragma omp parallel for schedule(dynamic, 1024)
+  for (int i = 0; i < targets; i++)
+  {
+    // never above min. altitude
+    if (sinLat * m_z[i] + cosLat * sqrt(m_x[i] * m_x[i] + m_y[i] * m_y[i]) <= kernel.thr)
+    {
+      eval[i].count = 0;
+      continue;
+    }
+
+    planEvalObject(&kernel, m_x[i], m_y[i], m_z[i], &eval[i]);
+  }
+
+  QVector <planResult_t> list;
+
+  for (int i = 0; i < targets; i++)
+  {
+    if (eval[i].count == 0)
+    {
+      continue;
+    }
+
+    planResult_t r;
+
+    r.target = i;
+    r.night = day;
+    r.from = night->dusk + eval[i].first * OP_STEP;
+    r.to = night->dusk + eval[i].last * OP_STEP;
+    r.maxAltJD = night->dusk + eval[i].maxIdx * OP_STEP;
+    r.maxAlt = asin(qBound(-1.f, eval[i].maxSinAlt, 1.f));
+    // visible hours weighted by max. altitude
+    r.score = eval[i].count * OP_STEP * 24 * eval[i].maxSinAlt;
+
+    list.append(r);
+  }
+
+  int num = qMin(list.count(), m_params.maxPerNight);
+
+  std::partial_sort(list.begin(), list.begin() + num, list.end(), planResultSort);
+
+  for (int i = 0; i < num; i++)
+  {
+    out.append(list[i]);
+  }
+}
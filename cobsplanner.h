@@ -0,0 +1,95 @@
+#ifndef COBSPLANNER_H
+#define COBSPLANNER_H
+
+#include <QtCore>
+
+#include "castro.h"
+#include "cmapview.h"
+#include "jd.h"
+
+#define OPT_DSO             0
+#define OPT_VARIABLE        1
+#define OPT_DOUBLE          2
+
+#define OP_STEP             (JD1SEC * 60 * 10)   // altitude sampling step
+#define OP_MAX_NIGHTS       365
+
+typedef struct
+{
+  int      type;        // OPT_xxx
+  QString  name;
+  radec_t  rd;          // J2000
+  float    mag;
+  qint64   data;        // dso_t * (OPT_DSO)
+  int      tyc[3];      // tycho star (OPT_VARIABLE, OPT_DOUBLE)
+} planTarget_t;
+
+typedef struct
+{
+  int    target;        // index to CObsPlanner::target()
+  double night;         // start of the day (local)
+  double from;          // visibility window
+  double to;
+  double maxAltJD;
+  float  maxAlt;
+  float  score;
+} planResult_t;
+
+typedef struct
+{
+  int    nights;
+  double minAlt;        // rad
+  double minMoonDist;   // rad (max. 90 deg.)
+  double maxMoonPhase;  // Moon is ignored when less illuminated (0..1)
+  int    maxPerNight;   // best results per night
+} planParams_t;
+
+typedef struct
+{
+  double dusk;          // end of astronomical twilight
+  double dawn;          // begin of astronomical twilight
+  double lst;           // local sidereal time at dusk
+  double moonPhase;
+  double moon[2][3];    // Moon unit vector at dusk/dawn
+} planNight_t;
+
+class CObsPlanner : public QThread
+{
+  Q_OBJECT
+
+public:
+  CObsPlanner(const mapView_t *view, const planParams_t &params, const QVector <planTarget_t> &targets);
+
+  void                  stop();
+  QList <planResult_t>  takeResults();
+  const planTarget_t   &target(int index) const;
+
+  static void addDSO(QVector <planTarget_t> &list, float maxMag);
+  static void addVariableStars(QVector <planTarget_t> &list, float maxMag);
+  static void addDoubleStars(QVector <planTarget_t> &list, float maxMag, double yr);
+
+signals:
+  void sigProgress(int percent);
+  void sigDone(void);
+
+protected:
+  void run();
+  bool calcNight(double day, double nextDay, planNight_t *night);
+  void evalNight(double day, const planNight_t *night, QList <planResult_t> &out);
+
+  mapView_t               m_view;
+  planParams_t            m_params;
+  QVector <planTarget_t>  m_targets;
+  CAstro                  m_astro;
+  volatile bool           m_end;
+
+  // equatorial unit vectors at date (SoA)
+  QVector <float>         m_x;
+  QVector <float>         m_y;
+  QVector <float>         m_z;
+
+  QMutex                  m_mutex;
+  QList <planResult_t>    m_results;
+};
+
+#endif // COBSPLANNER_H
@@ -0,0 +1,267 @@
+#include "cobsplannerdlg.h"
+#include "ui_cobsplannerdlg.h"
+#include "skutils.h"
+#include "tycho.h"
+#include "cdso.h"
+
+CObsPlannerDlg::CObsPlannerDlg(QWidget *parent, mapView_t *view) :
+  QDialog(parent),
+  ui(new Ui::CObsPlannerDlg)
+{
+  ui->setupUi(this);
+
+  m_view = *view;
+  m_planner = NULL;
+
+  m_model = new QStandardItemModel(0, 8);
+
+  m_proxy = new MyProxyPlanModel();
+  m_proxy->setSourceModel(m_model);
+
+  m_model->setHeaderData(0, Qt::Horizontal, tr("Name"));
+  m_model->setHeaderData(1, Qt::Horizontal, tr("Type"));
+  m_model->setHeaderData(2, Qt::Horizontal, tr("Mag"));
+  m_model->setHeaderData(3, Qt::Horizontal, tr("Night"));
+  m_model->setHeaderData(4, Qt::Horizontal, tr("From"));
+  m_model->setHeaderData(5, Qt::Horizontal, tr("To"));
+  m_model->setHeaderData(6, Qt::Horizontal, tr("Max. alt."));
+  m_model->setHeaderData(7, Qt::Horizontal, tr("Score"));
+
+  ui->treeView->setModel(m_proxy);
+  ui->treeView->setRootIsDecorated(false);
+  ui->treeView->header()->resizeSection(0, 150);
+  ui->treeView->header()->resizeSection(1, 80);
+  ui->treeView->header()->resizeSection(2, 60);
+  ui->treeView->header()->resizeSection(3, 90);
+  ui->treeView->header()->resizeSection(4, 70);
+  ui->treeView->header()->resizeSection(5, 70);
+  ui->treeView->header()->resizeSection(6, 70);
+  ui->treeView->header()->resizeSection(7, 60);
+  ui->treeView->setSortingEnabled(true);
+}
+
+CObsPlannerDlg::~CObsPlannerDlg()
+{
+  stopPlanner();
+
+  delete m_model;
+  delete m_proxy;
+  delete ui;
+}
+
+///////////////////////////////////
+void CObsPlannerDlg::stopPlanner()
+///////////////////////////////////
+{
+  if (m_planner)
+  {
+    m_planner->disconnect(this);
+    m_planner->stop();
+    m_planner->wait();
+    delete m_planner;
+    m_planner = NULL;
+  }
+}
+
+/////////////////////////////////////////////
+void CObsPlannerDlg::slotProgress(int percent)
+/////////////////////////////////////////////
+{
+  if (!m_planner)
+  {
+    return;
+  }
+
+  QList <planResult_t> list = m_planner->takeResults();
+
+  ui->progressBar->setValue(percent);
+
+  ui->treeView->setSortingEnabled(false);
+  for (int i = 0; i < list.count(); i++)
+  {
+    const planResult_t &res = list[i];
+    const planTarget_t &t = m_planner->target(res.target);
+    QString             type;
+    QList <QStandardItem *> row;
+
+    switch (t.type)
+    {
+      case OPT_DSO:
+        type = tr("DSO");
+        break;
+
+      case OPT_VARIABLE:
+        type = tr("Variable star");
+        break;
+
+      case OPT_DOUBLE:
+        type = tr("Double star");
+        break;
+    }
+
+    QStandardItem *item = new QStandardItem;
+    item->setText(t.name);
+    item->setData(res.target);
+    item->setData(res.maxAltJD, Qt::UserRole + 2);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(type);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(getStrMag(t.mag));
+    item->setData(t.mag);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(getStrDate(res.night, m_view.geo.tz));
+    item->setData(res.night);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(getStrTime(res.from, m_view.geo.tz, true));
+    item->setData(res.from);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(getStrTime(res.to, m_view.geo.tz, true));
+    item->setData(res.to);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(QString("%1°").arg(R2D(res.maxAlt), 0, 'f', 1));
+    item->setData(res.maxAlt);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(QString::number(res.score, 'f', 2));
+    item->setData(res.score);
+    row.append(item);
+
+    m_model->appendRow(row);
+  }
+  ui->treeView->setSortingEnabled(true);
+}
+
+/////////////////////////////////
+void CObsPlannerDlg::slotDone()
+/////////////////////////////////
+{
+  slotProgress(100);
+  ui->pushButton_3->setText(tr("Find"));
+}
+
+// find / stop
+/////////////////////////////////////////////
+void CObsPlannerDlg::on_pushButton_3_clicked()
+/////////////////////////////////////////////
+{
+  if (m_planner && m_planner->isRunning())
+  {
+    m_planner->stop();
+    return;
+  }
+
+  stopPlanner();
+
+  m_model->removeRows(0, m_model->rowCount());
+  ui->progressBar->setValue(0);
+
+  QVector <planTarget_t> targets;
+  float                  maxMag = ui->doubleSpinBox_mag->value();
+
+  if (ui->checkBox_dso->isChecked())
+  {
+    CObsPlanner::addDSO(targets, maxMag);
+  }
+
+  if (ui->checkBox_var->isChecked())
+  {
+    CObsPlanner::addVariableStars(targets, maxMag);
+  }
+
+  if (ui->checkBox_dbl->isChecked())
+  {
+    CObsPlanner::addDoubleStars(targets, maxMag, jdGetYearFromJD(m_view.jd) - 2000);
+  }
+
+  if (targets.count() == 0)
+  {
+    return;
+  }
+
+  planParams_t params;
+
+  params.nights = ui->spinBox_nights->value();
+  params.minAlt = D2R(ui->spinBox_alt->value());
+  params.minMoonDist = D2R(ui->spinBox_moonDist->value());
+  params.maxMoonPhase = ui->spinBox_moonPhase->value() / 100.0;
+  params.maxPerNight = ui->spinBox_count->value();
+
+  m_planner = new CObsPlanner(&m_view, params, targets);
+
+  connect(m_planner, SIGNAL(sigProgress(int)), this, SLOT(slotProgress(int)), Qt::QueuedConnection);
+  connect(m_planner, SIGNAL(sigDone()), this, SLOT(slotDone()), Qt::QueuedConnection);
+
+  ui->pushButton_3->setText(tr("Stop"));
+  m_planner->start();
+}
+
+// ok
+/////////////////////////////////////////////
+void CObsPlannerDlg::on_pushButton_2_clicked()
+/////////////////////////////////////////////
+{
+  QModelIndexList il = ui->treeView->selectionModel()->selectedIndexes();
+  if (il.count() == 0 || !m_planner)
+    return;
+
+  QModelIndex index = m_proxy->mapToSource(il.at(0));
+  QStandardItem *item = m_model->item(index.row(), 0);
+  const planTarget_t &t = m_planner->target(item->data().toInt());
+
+  m_rd = t.rd;
+  m_jd = item->data(Qt::UserRole + 2).toDouble();
+  m_fov = getOptObjFov(0, 0, D2R(2.5));
+  m_mapObj.type = MO_EMPTY;
+
+  if (t.type == OPT_DSO)
+  {
+    dso_t *dso = (dso_t *)t.data;
+
+    m_fov = getOptObjFov(dso->sx / 3600., dso->sy / 3600.);
+    m_mapObj.type = MO_DSO;
+    m_mapObj.par1 = (qint64)dso;
+    m_mapObj.par2 = 0;
+  }
+  else
+  {
+    int reg, tycIndex;
+    if (cTYC.findStar(NULL, TS_TYC, 0, 0, 0, 0, t.tyc[0], t.tyc[1], t.tyc[2], 0, reg, tycIndex))
+    {
+      m_mapObj.type = MO_TYCSTAR;
+      m_mapObj.par1 = reg;
+      m_mapObj.par2 = tycIndex;
+    }
+  }
+
+  stopPlanner();
+  done(DL_OK);
+}
+
+///////////////////////////////////////////////////////////////////
+void CObsPlannerDlg::on_treeView_doubleClicked(const QModelIndex &)
+///////////////////////////////////////////////////////////////////
+{
+  on_pushButton_2_clicked();
+}
+
+// cancel
+///////////////////////////////////////////
+void CObsPlannerDlg::on_pushButton_clicked()
+///////////////////////////////////////////
+{
+  stopPlanner();
+  done(DL_CANCEL);
+}
@@ -0,0 +1,68 @@
+#ifndef COBSPLANNERDLG_H
+#define COBSPLANNERDLG_H
+
+#include "skcore.h"
+#include "mapobj.h"
+#include "cobsplanner.h"
+
+#include <QDialog>
+
+namespace Ui {
+  class CObsPlannerDlg;
+}
+
+class MyProxyPlanModel: public QSortFilterProxyModel
+{
+protected:
+   bool lessThan(const QModelIndex& left, const QModelIndex& right) const
+   {
+     if (sortColumn() >= 2)
+     {
+       return (left.data(Qt::UserRole + 1).toDouble() < right.data(Qt::UserRole + 1).toDouble());
+     }
+
+     QVariant leftData = sourceModel()->data(left);
+     QVariant rightData = sourceModel()->data(right);
+
+     return QString::localeAwareCompare(leftData.toString(), rightData.toString()) < 0;
+   }
+};
+
+class CObsPlannerDlg : public QDialog
+{
+  Q_OBJECT
+
+public:
+  explicit CObsPlannerDlg(QWidget *parent, mapView_t *view);
+  ~CObsPlannerDlg();
+
+  radec_t  m_rd;
+  double   m_fov;
+  double   m_jd;
+  mapObj_t m_mapObj;
+
+protected:
+  void stopPlanner();
+
+  mapView_t           m_view;
+  CObsPlanner        *m_planner;
+  MyProxyPlanModel   *m_proxy;
+  QStandardItemModel *m_model;
+
+private slots:
+  void slotProgress(int percent);
+  void slotDone();
+
+  void on_pushButton_3_clicked();
+
+  void on_pushButton_2_clicked();
+
+  void on_treeView_doubleClicked(const QModelIndex &index);
+
+  void on_pushButton_clicked();
+
+private:
+  Ui::CObsPlannerDlg *ui;
+};
+
+#endif // COBSPLANNERDLG_H
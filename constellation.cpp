@@ -8,6 +8,13 @@
 
 #define NBNDRIES 357
 
+#define B1875             2405889.25855
+
+// B1875 lookup grid (1 x 1 deg. cells)
+#define CONST_GRID_RA     360
+#define CONST_GRID_DEC    180
+#define CONST_GRID_EPS    1e-9
+
 typedef struct
 {
   radec_t rd;
@@ -25,6 +32,13 @@ typedef struct
 
 #pragma pack()
 
+typedef struct
+{
+  qint16 con;      // constellation of the whole cell or -1
+  qint16 count;    // number of candidate boundaries
+  qint32 first;    // first candidate in constGridList
+} constGridCell_t;
+
 QList <constelLine_t> tConstLines;
 
 static qint32 numConstelNBnd = 0;
@@ -39,6 +53,9 @@ static radec_t constelRD[88];
 
 static constBnd_t constBnd[360];
 
+static QVector <constGridCell_t> constGrid;
+static QVector <qint16>          constGridList;
+
 extern bool g_showLabels;
 extern int  dev_const_type;
 extern int  dev_const_sel;
@@ -124,34 +141,137 @@ QString constGetName(int index, int type, bool addNonLatin)
   return(0);
 }
 
-/////////////////////////////////////////////////////////
-int constWhatConstel(double Ra, double Dec, double epoch)
-/////////////////////////////////////////////////////////
+////////////////////////////////////////////////////
+// B1875 ra/dec
+static int constWhatConstelScan(double Ra, double Dec)
+////////////////////////////////////////////////////
 {
-  // Besselian epoch 1875.0
-  precess(&Ra, &Dec, epoch, 2405889.25855);
-
   for (int a = 0; a < NBNDRIES ;a++)
   {
     if (constBnd[a].Dec > Dec) continue;
     if (constBnd[a].Ra2 <= Ra) continue;
     if (constBnd[a].Ra1 > Ra) continue;
 
-    if (Ra >= constBnd[a].Ra1 &&  Ra < constBnd[a].Ra2 && constBnd[a].Dec <= Dec)
+    return(constBnd[a].index);
+  }
+  return(0);
+}
+
+//////////////////////////////////////////////////////
+// B1875 ra/dec
+static int constWhatConstelGrid(double Ra, double Dec)
+//////////////////////////////////////////////////////
+{
+  int x = (int)(Ra / MPI2 * CONST_GRID_RA);
+  int y = (int)((Dec + R90) / MPI * CONST_GRID_DEC);
+
+  if (constGrid.isEmpty() || x < 0 || x >= CONST_GRID_RA || y < 0 || y >= CONST_GRID_DEC)
+  {
+    return(constWhatConstelScan(Ra, Dec));
+  }
+
+  const constGridCell_t &cell = constGrid[y * CONST_GRID_RA + x];
+
+  if (cell.con >= 0)
+  {
+    return(cell.con);
+  }
+
+  for (int i = cell.first; i < cell.first + cell.count; i++)
+  {
+    const constBnd_t &bnd = constBnd[constGridList[i]];
+
+    if (bnd.Dec <= Dec && bnd.Ra1 <= Ra && Ra < bnd.Ra2)
     {
-      return(constBnd[a].index);
+      return(bnd.index);
     }
-     else if (constBnd[a].Ra2 <  Ra)
-     {
-       continue;
-      }
-     else
+  }
+  return(0);
+}
+
+/////////////////////////////////////
+// candidate boundaries for each cell in the scan order, cut after the
+// first boundary that covers the whole cell
+static void constCreateGrid(void)
+/////////////////////////////////////
+{
+  constGrid.resize(CONST_GRID_RA * CONST_GRID_DEC);
+  constGridList.clear();
+
+  for (int y = 0; y < CONST_GRID_DEC; y++)
+  {
+    double dec0 = (y / (double)CONST_GRID_DEC) * MPI - R90;
+    double dec1 = ((y + 1) / (double)CONST_GRID_DEC) * MPI - R90;
+
+    for (int x = 0; x < CONST_GRID_RA; x++)
     {
-      return(0);
+      double ra0 = (x / (double)CONST_GRID_RA) * MPI2;
+      double ra1 = ((x + 1) / (double)CONST_GRID_RA) * MPI2;
+      constGridCell_t &cell = constGrid[y * CONST_GRID_RA + x];
+
+      cell.con = -1;
+      cell.count = 0;
+      cell.first = constGridList.count();
+
+      for (int a = 0; a < NBNDRIES; a++)
+      {
+        const constBnd_t &bnd = constBnd[a];
+
+        if (bnd.Dec > dec1 + CONST_GRID_EPS) continue;
+        if (bnd.Ra1 > ra1 + CONST_GRID_EPS) continue;
+        if (bnd.Ra2 <= ra0 - CONST_GRID_EPS) continue;
+
+        bool covers = bnd.Dec <= dec0 - CONST_GRID_EPS &&
+                      bnd.Ra1 <= ra0 - CONST_GRID_EPS &&
+                      bnd.Ra2 > ra1 + CONST_GRID_EPS;
+
+        if (covers && cell.count == 0)
+        {
+          cell.con = bnd.index;
+          break;
+        }
+
+        constGridList.append(a);
+        cell.count++;
+
+        if (covers)
+        {
+          break;
+        }
+      }
     }
-     break;
   }
-  return(0);
+}
+
+/////////////////////////////////////////////////////////
+int constWhatConstel(double Ra, double Dec, double epoch)
+/////////////////////////////////////////////////////////
+{
+  // Besselian epoch 1875.0
+  precess(&Ra, &Dec, epoch, B1875);
+
+  return(constWhatConstelGrid(Ra, Dec));
+}
+
+///////////////////////////////////////////////////////////////////////////
+// batch version, precession matrix is computed only once
+void constWhatConstel(const radec_t *rd, int *con, int count, double epoch)
+///////////////////////////////////////////////////////////////////////////
+{
+  SKMATRIX mat;
+
+  precessMatrix(epoch, B1875, &mat);
+
+  #pragma omp parallel for if (count > 4096)
+  for (int i = 0; i < count; i++)
+  {
+    double ra = rd[i].Ra;
+    double dec = rd[i].Dec;
+
+    precessMat(&ra, &dec, &mat);
+
+    con[i] = constWhatConstelGrid(ra, dec);
+  }
 }
 
 
@@ -170,6 +290,8 @@ static void constLoadBoundaries(void)
       f.read((char *)&constBnd[i], sizeof(constBnd_t));
     }
     f.close();
+
+    constCreateGrid();
   }
 
 }
@@ -26,6 +26,7 @@ void constRenderConstellationBnd(QPainter *p, mapView_t *view);
 void constRenderConstellationNames(CSkPainter *p, mapView_t *view);
 void constRenderConstelationLines2Edit(QPainter *p, mapView_t *view);
 int constWhatConstel(double Ra, double Dec, double epoch);
+void constWhatConstel(const radec_t *rd, int *con, int count, double epoch);
 bool constFind(QString name, double &ra, double &dec, double &fov, double jd);
 QList <constelLine_t> *constGetLinesList(void);
 
@@ -859,73 +859,75 @@ int CPlanetRenderer::renderPlanet(SKPOINT *pt, orbit_t *o, orbit_t *sun, mapView
       mesh->vertices[i].sp[2] = z;
     }
 
-    int i;
     bool bi = scanRender.isBillinearInt();
 
-    #pragma omp parallel for
-    for (i = 0; i < mesh->numFaces; i++)
+    #pragma omp parallel
     {
-      CScanRender scanRender;
+      CScanRender scanRender; // one scan buffer per thread
 
       scanRender.enableBillinearInt(bi);
 
-      int f0 = mesh->faces[i].vertices[0];
-      int f1 = mesh->faces[i].vertices[1];
-      int f2 = mesh->faces[i].vertices[2];
-      int f3 = mesh->faces[i].vertices[3];
-
-      if (mesh->vertices[f0].sp[2] > 0 && mesh->vertices[f1].sp[2] > 0 &&
-          mesh->vertices[f2].sp[2] > 0 && mesh->vertices[f3].sp[2] > 0)
-        continue;
-
-      scanRender.resetScanPoly(pImg->width(), pImg->height());
-
-      scanRender.scanLine(mesh->vertices[f0].sp[0],
-                          mesh->vertices[f0].sp[1],
-                          mesh->vertices[f1].sp[0],
-                          mesh->vertices[f1].sp[1],
-                          mesh->vertices[f0].uv[0],
-                          mesh->vertices[f0].uv[1],
-                          mesh->vertices[f1].uv[0],
-                          mesh->vertices[f1].uv[1]);
-
-      scanRender.scanLine(mesh->vertices[f1].sp[0],
-                          mesh->vertices[f1].sp[1],
-                          mesh->vertices[f2].sp[0],
-                          mesh->vertices[f2].sp[1],
-                          mesh->vertices[f1].uv[0],
-                          mesh->vertices[f1].uv[1],
-                          mesh->vertices[f2].uv[0],
-                          mesh->vertices[f2].uv[1]);
-
-      scanRender.scanLine(mesh->vertices[f2].sp[0],
-                          mesh->vertices[f2].sp[1],
-                          mesh->vertices[f3].sp[0],
-                          mesh->vertices[f3].sp[1],
-                          mesh->vertices[f2].uv[0],
-                          mesh->vertices[f2].uv[1],
-                          mesh->vertices[f3].uv[0],
-                          mesh->vertices[f3].uv[1]);
-
-      scanRender.scanLine(mesh->vertices[f3].sp[0],
-                          mesh->vertices[f3].sp[1],
-                          mesh->vertices[f0].sp[0],
-                          mesh->vertices[f0].sp[1],
-                          mesh->vertices[f3].uv[0],
-                          mesh->vertices[f3].uv[1],
-                          mesh->vertices[f0].uv[0],
-                          mesh->vertices[f0].uv[1]);
-
-      scanRender.renderPolygon(pImg, m_bmp[o->type]);
-
-      /*
-      pPainter->drawLine(mesh->vertices[f0].sp[0], mesh->vertices[f0].sp[1],
-                         mesh->vertices[f1].sp[0], mesh->vertices[f1].sp[1]);
-
-      pPainter->drawLine(mesh->vertices[f1].sp[0], mesh->vertices[f1].sp[1],
-                         mesh->vertices[f2].sp[0], mesh->vertices[f2].sp[1]);
-      */
+      #pragma omp for
+      for (int i = 0; i < mesh->numFaces; i++)
+      {
+        int f0 = mesh->faces[i].vertices[0];
+        int f1 = mesh->faces[i].vertices[1];
+        int f2 = mesh->faces[i].vertices[2];
+        int f3 = mesh->faces[i].vertices[3];
+
+        if (mesh->vertices[f0].sp[2] > 0 && mesh->vertices[f1].sp[2] > 0 &&
+            mesh->vertices[f2].sp[2] > 0 && mesh->vertices[f3].sp[2] > 0)
+          continue;
+
+        scanRender.resetScanPoly(pImg->width(), pImg->height());
+
+        scanRender.scanLine(mesh->vertices[f0].sp[0],
+                            mesh->vertices[f0].sp[1],
+                            mesh->vertices[f1].sp[0],
+                            mesh->vertices[f1].sp[1],
+                            mesh->vertices[f0].uv[0],
+                            mesh->vertices[f0].uv[1],
+                            mesh->vertices[f1].uv[0],
+                            mesh->vertices[f1].uv[1]);
+
+        scanRender.scanLine(mesh->vertices[f1].sp[0],
+                            mesh->vertices[f1].sp[1],
+                            mesh->vertices[f2].sp[0],
+                            mesh->vertices[f2].sp[1],
+                            mesh->vertices[f1].uv[0],
+                            mesh->vertices[f1].uv[1],
+                            mesh->vertices[f2].uv[0],
+                            mesh->vertices[f2].uv[1]);
+
+        scanRender.scanLine(mesh->vertices[f2].sp[0],
+                            mesh->vertices[f2].sp[1],
+                            mesh->vertices[f3].sp[0],
+                            mesh->vertices[f3].sp[1],
+                            mesh->vertices[f2].uv[0],
+                            mesh->vertices[f2].uv[1],
+                            mesh->vertices[f3].uv[0],
+                            mesh->vertices[f3].uv[1]);
+
+        scanRender.scanLine(mesh->vertices[f3].sp[0],
+                            mesh->vertices[f3].sp[1],
+                            mesh->vertices[f0].sp[0],
+                            mesh->vertices[f0].sp[1],
+                            mesh->vertices[f3].uv[0],
+                            mesh->vertices[f3].uv[1],
+                            mesh->vertices[f0].uv[0],
+                            mesh->vertices[f0].uv[1]);
+
+        scanRender.renderPolygon(pImg, m_bmp[o->type]);
+
+        /*
+        pPainter->drawLine(mesh->vertices[f0].sp[0], mesh->vertices[f0].sp[1],
+                           mesh->vertices[f1].sp[0], mesh->vertices[f1].sp[1]);
+
+        pPainter->drawLine(mesh->vertices[f1].sp[0], mesh->vertices[f1].sp[1],
+                           mesh->vertices[f2].sp[0], mesh->vertices[f2].sp[1]);
+        */
 
+      }
     }
 
     drawAxises(angle, pPainter, sx, sy, isPreview, pt, o, mapView);
@@ -1028,74 +1030,76 @@ void CPlanetRenderer::renderSphere(QPainter *pPainter, SKPOINT *pt, double r, do
     mesh->vertices[i].sp[2] = z;
   }
 
-  int i;
   bool bi = scanRender.isBillinearInt();
 
-  #pragma omp parallel for
-  for (i = 0; i < mesh->numFaces; i++)
+  #pragma omp parallel
   {
-    CScanRender scanRender;
+    CScanRender scanRender; // one scan buffer per thread
 
     scanRender.enableBillinearInt(bi);
 
-    int f0 = mesh->faces[i].vertices[0];
-    int f1 = mesh->faces[i].vertices[1];
-    int f2 = mesh->faces[i].vertices[2];
-    int f3 = mesh->faces[i].vertices[3];
+    #pragma omp for
+    for (int i = 0; i < mesh->numFaces; i++)
+    {
+      int f0 = mesh->faces[i].vertices[0];
+      int f1 = mesh->faces[i].vertices[1];
+      int f2 = mesh->faces[i].vertices[2];
+      int f3 = mesh->faces[i].vertices[3];
 
-    if (mesh->vertices[f0].sp[2] > 0 && mesh->vertices[f1].sp[2] > 0 &&
-        mesh->vertices[f2].sp[2] > 0 && mesh->vertices[f3].sp[2] > 0)
-      continue;
+      if (mesh->vertices[f0].sp[2] > 0 && mesh->vertices[f1].sp[2] > 0 &&
+          mesh->vertices[f2].sp[2] > 0 && mesh->vertices[f3].sp[2] > 0)
+        continue;
 
-    scanRender.resetScanPoly(pImg->width(), pImg->height());
+      scanRender.resetScanPoly(pImg->width(), pImg->height());
 
-    scanRender.scanLine(mesh->vertices[f0].sp[0],
-                        mesh->vertices[f0].sp[1],
-                        mesh->vertices[f1].sp[0],
-                        mesh->vertices[f1].sp[1],
-                        mesh->vertices[f0].uv[0],
-                        mesh->vertices[f0].uv[1],
-                        mesh->vertices[f1].uv[0],
-                        mesh->vertices[f1].uv[1]);
+      scanRender.scanLine(mesh->vertices[f0].sp[0],
+                          mesh->vertices[f0].sp[1],
+                          mesh->vertices[f1].sp[0],
+                          mesh->vertices[f1].sp[1],
+                          mesh->vertices[f0].uv[0],
+                          mesh->vertices[f0].uv[1],
+                          mesh->vertices[f1].uv[0],
+                          mesh->vertices[f1].uv[1]);
 
-    scanRender.scanLine(mesh->vertices[f1].sp[0],
-                        mesh->vertices[f1].sp[1],
-                        mesh->vertices[f2].sp[0],
-                        mesh->vertices[f2].sp[1],
-                        mesh->vertices[f1].uv[0],
-                        mesh->vertices[f1].uv[1],
-                        mesh->vertices[f2].uv[0],
-                        mesh->vertices[f2].uv[1]);
+      scanRender.scanLine(mesh->vertices[f1].sp[0],
+                          mesh->vertices[f1].sp[1],
+                          mesh->vertices[f2].sp[0],
+                          mesh->vertices[f2].sp[1],
+                          mesh->vertices[f1].uv[0],
+                          mesh->vertices[f1].uv[1],
+                          mesh->vertices[f2].uv[0],
+                          mesh->vertices[f2].uv[1]);
 
-    scanRender.scanLine(mesh->vertices[f2].sp[0],
-                        mesh->vertices[f2].sp[1],
-                        mesh->vertices[f3].sp[0],
-                        mesh->vertices[f3].sp[1],
-                        mesh->vertices[f2].uv[0],
-                        mesh->vertices[f2].uv[1],
-                        mesh->vertices[f3].uv[0],
-                        mesh->vertices[f3].uv[1]);
+      scanRender.scanLine(mesh->vertices[f2].sp[0],
+                          mesh->vertices[f2].sp[1],
+                          mesh->vertices[f3].sp[0],
+                          mesh->vertices[f3].sp[1],
+                          mesh->vertices[f2].uv[0],
+                          mesh->vertices[f2].uv[1],
+                          mesh->vertices[f3].uv[0],
+                          mesh->vertices[f3].uv[1]);
 
-    scanRender.scanLine(mesh->vertices[f3].sp[0],
-                        mesh->vertices[f3].sp[1],
-                        mesh->vertices[f0].sp[0],
-                        mesh->vertices[f0].sp[1],
-                        mesh->vertices[f3].uv[0],
-                        mesh->vertices[f3].uv[1],
-                        mesh->vertices[f0].uv[0],
-                        mesh->vertices[f0].uv[1]);
+      scanRender.scanLine(mesh->vertices[f3].sp[0],
+                          mesh->vertices[f3].sp[1],
+                          mesh->vertices[f0].sp[0],
+                          mesh->vertices[f0].sp[1],
+                          mesh->vertices[f3].uv[0],
+                          mesh->vertices[f3].uv[1],
+                          mesh->vertices[f0].uv[0],
+                          mesh->vertices[f0].uv[1]);
 
-    scanRender.renderPolygon(pImg, texture);
+      scanRender.renderPolygon(pImg, texture);
 
 
-    /*
-    pPainter->setPen(Qt::black);
-    pPainter->drawLine(mesh->vertices[f0].sp[0], mesh->vertices[f0].sp[1],
-                       mesh->vertices[f1].sp[0], mesh->vertices[f1].sp[1]);
+      /*
+      pPainter->setPen(Qt::black);
+      pPainter->drawLine(mesh->vertices[f0].sp[0], mesh->vertices[f0].sp[1],
+                         mesh->vertices[f1].sp[0], mesh->vertices[f1].sp[1]);
 
-    pPainter->drawLine(mesh->vertices[f1].sp[0], mesh->vertices[f1].sp[1],
-                       mesh->vertices[f2].sp[0], mesh->vertices[f2].sp[1]);
-    */
+      pPainter->drawLine(mesh->vertices[f1].sp[0], mesh->vertices[f1].sp[1],
+                         mesh->vertices[f2].sp[0], mesh->vertices[f2].sp[1]);
+      */
+    }
   }
 }
 
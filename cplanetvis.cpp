@@ -1,5 +1,6 @@
 #include "cplanetvis.h"
 #include "ui_cplanetvis.h"
+#include "calmanac.h"
 
 CPlanetVis::CPlanetVis(QWidget *parent, mapView_t *view) :
   QDialog(parent),
@@ -10,6 +11,8 @@ CPlanetVis::CPlanetVis(QWidget *parent, mapView_t *view) :
   m_view = *view;
   updateTitle();
 
+  connect(&g_almanac, SIGNAL(sigReady()), this, SLOT(update()));
+
   QColor col = QColor(32, 32, 32);
   ui->frame_12->setStyleSheet("background:" + col.name());
   col = QColor(200, 32, 32);
@@ -86,17 +89,20 @@ void CPlanetVis::paintEvent(QPaintEvent *)
     x += delta;
   }
 
+  almanacDay_t day;
+
+  if (!g_almanac.get(&m_view, m_view.jd, AL_HOURLY, &day))
+  { // repainted on sigReady()
+    g_almanac.request(&m_view, m_view.jd, 1, AL_HOURLY);
+    return;
+  }
+
   for (int i = 0; i < 9; i++)
   {
     QRect     fRect;
     QRect     rc;
     float     x = 0;
     float     delta;
-    orbit_t   orbit;
-    orbit_t   sun;
-    CAstro    astro;
-    mapView_t view = m_view;
-    double    jd = getStartOfDay(m_view.jd, m_view.geo.tz);
 
     fRect = frm[i]->geometry();
 
@@ -105,11 +111,8 @@ void CPlanetVis::paintEvent(QPaintEvent *)
     p.setPen(QPen(Qt::gray, 1, Qt::DotLine));
     for (int h = 0; h < 24; h++)
     {
-      view.jd = jd;
-      astro.setParam(&view);
-
-      astro.calcPlanet(PT_SUN, &sun);
-      astro.calcPlanet(id[i], &orbit);
+      float alt = day.alt[id[i]][h];
+      float sunAlt = day.alt[PT_SUN][h];
 
       rc = fRect;
       rc.setX(x + fRect.x());
@@ -117,17 +120,17 @@ void CPlanetVis::paintEvent(QPaintEvent *)
 
       QColor col;
 
-      if (orbit.lAlt <= 0)
+      if (alt <= 0)
         col = QColor(32, 32, 32);
       else
       {
-        if (sun.lAlt >= 0)
+        if (sunAlt >= 0)
           col = QColor(200, 32, 32);
         else
           col = QColor(32, 200, 32);
       }
 
-      if (orbit.lAlt > 0)
+      if (alt > 0)
       {
         p.fillRect(rc, QColor(32, 32, 32));
         p.fillRect(rc.adjusted(0, 10, 0, -10), col);
@@ -138,8 +141,6 @@ void CPlanetVis::paintEvent(QPaintEvent *)
       }
       p.drawLine(rc.right(), rc.top() + 1, rc.right(), rc.bottom() - 1);
 
-      jd += 1 / 24.0;
-
       x += delta;
     }
   }
@@ -147,6 +148,7 @@ void CPlanetVis::paintEvent(QPaintEvent *)
 
 void CPlanetVis::updateTitle()
 {
+  g_almanac.request(&m_view, m_view.jd, 1, AL_HOURLY);
   setWindowTitle(tr("Planet visibility at ") + getStrDate(m_view.jd, m_view.geo.tz));
 }
 
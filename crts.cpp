@@ -6,11 +6,58 @@
 #include "ccomdlg.h"
 
 // TODO: kontrola jizni polokoule
-// TODO: u fixed objektu pouzit alg. meeus str. 97
 
 #define RTS_IADD        JD1SEC * 60 * 60 * 3
 #define MAX_RTS_ITIN    3000
 
+#define RTS_SIDEREAL_RATE   (MPI2 * 1.00273790935)    // rad/day
+
+//////////////////////////////////////////////////////
+// local sidereal time (same as in CAstro::setParam())
+static double rtsLst(double jd, double lon)
+//////////////////////////////////////////////////////
+{
+  double T = (jd - 2451545.0) / 36525.0;
+  double theta = 280.46061837 + 360.98564736629 * (jd - 2451545.0) + 0.000387933 * T * T - T * T * T / 38710000.0;
+  double lst = DEG2RAD(theta) + lon;
+
+  rangeDbl(&lst, MPI2);
+
+  return(lst);
+}
+
+///////////////////////////////////////////////////////////////////////
+// first time after jd0 when object is at hour angle ha
+static double rtsTimeAtHA(double jd0, double lst0, double lon, double ra, double ha)
+///////////////////////////////////////////////////////////////////////
+{
+  double dHA = ha - (lst0 - ra);
+
+  rangeDbl(&dHA, MPI2);
+
+  double jd = jd0 + dHA / RTS_SIDEREAL_RATE;
+
+  // correction step with exact sidereal time
+  double err = ha - (rtsLst(jd, lon) - ra);
+
+  err = atan2(sin(err), cos(err));
+  jd += err / RTS_SIDEREAL_RATE;
+
+  return(jd);
+}
+
+///////////////////////////////////////////////////////////
+// same as CAstro::convRD2AARef()
+static double rtsAzm(double ha, double dec, double lat)
+///////////////////////////////////////////////////////////
+{
+  double azm = R90 - atan2(sin(dec) * cos(lat) - cos(dec) * cos(ha) * sin(lat), -cos(dec) * sin(ha));
+
+  rangeDbl(&azm, MPI2);
+
+  return(azm);
+}
+
 CRts::CRts()
 {
   m_bLow = false;
@@ -231,139 +278,96 @@ void CRts::calcOrbitRTS(rts_t *rts, qint64 ptr, int type, const mapView_t *view)
 void CRts::calcFixed(rts_t *rts, double ra, double dec, const mapView_t *view)
 //////////////////////////////////////////////////////////////////////////////
 {
-  mapView_t v;
-  double jd;
-  double add = RTS_IADD;
-  double curDay = getStartOfDay(view->jd, view->geo.tz);
-  double startDay = curDay;
-  double lAzm;
-  double lAlt;
-  double azm;
-  double alt;
+  radec_t rd;
 
-  jd = curDay;
+  rd.Ra = ra;
+  rd.Dec = dec;
 
-  v = *view;
+  calcFixed(rts, &rd, 1, view);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+// star/dso list (ra/dec at date)
+void CRts::calcFixed(rts_t *rts, const radec_t *rd, int count, const mapView_t *view)
+///////////////////////////////////////////////////////////////////////////////////////
+{
+  double startDay = getStartOfDay(view->jd, view->geo.tz);
+  double lst0 = rtsLst(startDay, view->geo.lon);
+
+  // geo. position and refraction params.
+  ast->setParam(view);
+
+  // geometric altitude of the apparent horizon
+  double h0 = -ast->getInvAtmRef(0);
+
+  #pragma omp parallel for if (count > 256)
+  for (int i = 0; i < count; i++)
+  {
+    calcFixedRTS(&rts[i], rd[i].Ra, rd[i].Dec, view, startDay, lst0, h0);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// analytic solution from hour angle (meeus chap. 15)
+void CRts::calcFixedRTS(rts_t *rts, double ra, double dec, const mapView_t *view, double startDay, double lst0, double h0)
+//////////////////////////////////////////////////////////////////////////////////////////
+{
+  double lat = view->geo.lat;
+  double lon = view->geo.lon;
 
   memset(rts, 0, sizeof(rts_t));
   rts->flag = RTS_DONE;
   rts->rts = 0;
 
   // transit
-  v.jd = jd;
-  ast->setParam(&v);
-  ast->convRD2AARef(ra, dec, &lAzm, &lAlt);
+  double alt = asin(qBound(-1.0, sin(lat) * sin(dec) + cos(lat) * cos(dec), 1.0));
 
-  int cnt = 0;
-  while (1)
-  {
-    v.jd = jd;
-    ast->setParam(&v);
-    ast->convRD2AARef(ra, dec, &azm, &alt);
-
-    if (azm >= R180 && lAzm <= R180)
-    {
-      jd -= add;
-      add *= 0.5;
-      if (add < m_limit) break;
-    }
-    else
-    {
-      jd += add;
-    }
-    if (++cnt > MAX_RTS_ITIN)
-    {
-      rts->flag = RTS_ERR;
-      return;
-    }
-    lAzm = azm;
-  }
-
-  rts->tAlt = alt;
-  rts->transit = jd; 
+  rts->tAlt = alt + ast->getAtmRef(alt);
+  rts->transit = rtsTimeAtHA(startDay, lst0, lon, ra, 0);
 
   if (isNotRTS(dec, rts, view))
   { // no rise / set
     return;
   }
 
-  rts->rts |= RTS_T_TRANSIT;
-
-  // rise
-  jd = curDay;
-  add = RTS_IADD;
-  v.jd = jd;
-  ast->setParam(&v);
-  ast->convRD2AARef(ra, dec, &lAzm, &lAlt);
+  double den = cos(lat) * cos(dec);
 
-  cnt = 0;
-  while (1)
+  if (qAbs(den) < 1e-12)
   {
-    v.jd = jd;
-    ast->setParam(&v);
-    ast->convRD2AARef(ra, dec, &azm, &alt);
-
-    if (alt > 0 && lAlt < 0)
-   {
-     jd -= add;
-     add /= 2.0;
-     if (add < m_limit) break;
-   }
-   else
-   {
-     jd += add;
-   }
-   if (++cnt > MAX_RTS_ITIN)
-   {
-     rts->flag = RTS_ERR;
-     return;
-   }
-    lAlt = alt;
+    rts->flag = RTS_ERR;
+    return;
   }
 
-  rts->rAzm = azm;
-  rts->rise = jd;
+  double cosH0 = (sin(h0) - sin(lat) * sin(dec)) / den;
 
-  if (jd <= startDay + 1)
-    rts->rts |= RTS_T_RISE;
+  if (cosH0 >= 1)
+  { // never reach apparent horizon
+    rts->flag = RTS_NONV;
+    return;
+  }
 
+  if (cosH0 <= -1)
+  {
+    rts->flag = RTS_CIRC;
+    return;
+  }
 
-  // set
-  jd = curDay;
-  add = RTS_IADD;
-  v.jd = jd;
-  ast->setParam(&v);
-  ast->convRD2AARef(ra, dec, &lAzm, &lAlt);
+  rts->rts |= RTS_T_TRANSIT;
 
-  cnt = 0;
-  while (1)
-  {
-    v.jd = jd;
-    ast->setParam(&v);
-    ast->convRD2AARef(ra, dec, &azm, &alt);
+  double H0 = acos(cosH0);
 
-    if (alt < 0 && lAlt > 0)
-   {
-     jd -= add;
-     add /= 2.0;
-     if (add < m_limit) break;
-   }
-   else
-   {
-     jd += add;
-   }
-   if (++cnt > MAX_RTS_ITIN)
-   {
-     rts->flag = RTS_ERR;
-     return;
-   }
-    lAlt = alt;
-  }
+  // rise
+  rts->rise = rtsTimeAtHA(startDay, lst0, lon, ra, -H0);
+  rts->rAzm = rtsAzm(-H0, dec, lat);
 
-  rts->sAzm = azm;
-  rts->set = jd;
+  if (rts->rise <= startDay + 1)
+    rts->rts |= RTS_T_RISE;
 
-  if (jd <= startDay + 1)
+  // set
+  rts->set = rtsTimeAtHA(startDay, lst0, lon, ra, H0);
+  rts->sAzm = rtsAzm(H0, dec, lat);
+
+  if (rts->set <= startDay + 1)
     rts->rts |= RTS_T_SET;
 }
 
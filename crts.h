@@ -45,7 +45,9 @@ public:
     CRts();
 
     void setLowPrec(void);
+    void setAstro(CAstro *astro) { ast = astro; }
     void calcFixed(rts_t *rts, double ra, double dec, const mapView_t *view);
+    void calcFixed(rts_t *rts, const radec_t *rd, int count, const mapView_t *view);
     void calcOrbitRTS(rts_t *rts, qint64 ptr, int type, const mapView_t *view);
     void calcTwilight(daylight_t *rts, mapView_t *view, double sunTransit);
 
@@ -55,6 +57,7 @@ protected:
     bool calcSunPosAtAlt(double start, double atAlt, double *jdTo, mapView_t *view, bool center, bool ascent);
 
   double getRTSRaDecFromPtr(radec_t *rd, qint64 ptr, int type, double jd);
+  void   calcFixedRTS(rts_t *rts, double ra, double dec, const mapView_t *view, double startDay, double lst0, double h0);
 
   CAstro *ast;
   bool   m_bLow;
@@ -1,11 +1,15 @@
 #include "csatevents.h"
 #include "ui_csatevents.h"
 #include "cconsole.h"
+#include "csateventsolver.h"
 
 #include <QPrinter>
 #include <QPrintDialog>
+#include <QProgressDialog>
+#include <QFileDialog>
 
 static int lastSel = 0;
+static int lastDays = 1;
 
 CSatEvents::CSatEvents(QWidget *parent, mapView_t *view) :
   QDialog(parent),
@@ -24,6 +28,7 @@ CSatEvents::CSatEvents(QWidget *parent, mapView_t *view) :
   ui->comboBox->addItem(cAstro.getName(PT_URANUS));
   ui->comboBox->addItem(cAstro.getName(PT_NEPTUNE));
 
+  ui->spinBox->setValue(lastDays);
   ui->comboBox->setCurrentIndex(lastSel);
 
   solve(m_jd, lastSel + PT_MARS);
@@ -31,166 +36,85 @@ CSatEvents::CSatEvents(QWidget *parent, mapView_t *view) :
 
 CSatEvents::~CSatEvents()
 {
+  lastDays = ui->spinBox->value();
 
   delete ui;
 }
 
 void CSatEvents::solve(double jd, int pln)
 {
-  double step = SECTODAY(60);
-  bool   first = true;
-  bool   transit[MAX_XYZ_SATS];
-  bool   throwShd[MAX_XYZ_SATS];
-  bool   hidden[MAX_XYZ_SATS];
-  bool   inSun[MAX_XYZ_SATS];
-  double lastSep1[MAX_XYZ_SATS];
-  double lastSep2[MAX_XYZ_SATS];
-  double tz = m_view.geo.tz;  
-
-  setWindowTitle(QString(tr("Events for %1")).arg(getStrDate(jd, tz)));
+  int    days = ui->spinBox->value();
+  double tz = m_view.geo.tz;
 
-  QStandardItemModel *m = (QStandardItemModel *)ui->treeView->model();
-
-  if (m != NULL)
-    delete m;
-
-  m = new QStandardItemModel(0, 2);
-  int row = 0;
+  if (days == 1)
+  {
+    setWindowTitle(QString(tr("Events for %1")).arg(getStrDate(jd, tz)));
+  }
+  else
+  {
+    setWindowTitle(QString(tr("Events for %1")).arg(getStrDate(jd, tz) + " - " + getStrDate(jd + days - 1, tz)));
+  }
 
-  m->setHeaderData(0, Qt::Horizontal, tr("Time"));
-  m->setHeaderData(1, Qt::Horizontal, tr("Desc."));
+  CSatEventSolver solver(&m_view, pln, jd, jd + days);
 
-  for (double j = jd; j < jd + 1; j += step)
+  if (!solver.isCached())
   {
-    orbit_t  o, s;
-    CPlanetSatellite planSat;
-    planetSatellites_t sats;
-
-    m_view.jd = j;
-    cAstro.setParam(&m_view);
-    cAstro.calcPlanet(PT_EARTH, &s, true, true, false);
-    cAstro.calcPlanet(pln, &o);
+    QProgressDialog dlg(tr("Please wait..."), tr("Cancel"), 0, 100, this);
 
-    planSat.solve(j - o.light, pln, &sats, &o, &s);
-    if (first)
-    {
-      for (int i = 0; i < sats.sats.count(); i++)
-      {
-        double s = qAbs(sats.sats[i].ex);
+    dlg.setWindowModality(Qt::WindowModal);
+    dlg.setMinimumDuration(0);
+    dlg.setAutoClose(false);
+    dlg.setAutoReset(false);
 
-        transit[i] = sats.sats[i].isTransit;
-        hidden[i] = sats.sats[i].isHidden;
-        throwShd[i] = sats.sats[i].isThrowShadow;
-        inSun[i] = sats.sats[i].isInLight;
-        lastSep1[i] = lastSep2[i] = s;
-      }
-      first = false;
-    }
+    connect(&solver, SIGNAL(sigProgress(int)), &dlg, SLOT(setValue(int)), Qt::QueuedConnection);
+    connect(&solver, SIGNAL(sigDone()), &dlg, SLOT(accept()), Qt::QueuedConnection);
 
-    QStandardItem *item;
-    for (int i = 0; i < sats.sats.count(); i++)
+    solver.start();
+    if (dlg.exec() != QDialog::Accepted)
     {
-      double s = qAbs(sats.sats[i].ex);//sats.sats[i].distance;
-
-      if (lastSep1[i] > lastSep2[i] && s < lastSep1[i])
-      {
-        item = new QStandardItem;
-        item->setText(getStrTime(j, tz, true));
-        item->setData(j);
-        m->setItem(row, 0, item);
-
-        item = new QStandardItem;
-        item->setText(QString(tr("Max elongation of %1")).arg(sats.sats[i].name));
-        m->setItem(row, 1, item);
-
-        row++;
-      }
-      lastSep2[i] = lastSep1[i];
-      lastSep1[i] = s;
+      solver.stop();
     }
+    solver.wait();
 
-    for (int i = 0; i < sats.sats.count(); i++)
-    {
-      if (transit[i] != sats.sats[i].isTransit)
-      {
-        transit[i] = sats.sats[i].isTransit;
-
-        item = new QStandardItem;
-        item->setText(getStrTime(j, tz, true));
-        item->setData(j);
-        m->setItem(row, 0, item);
-
-        item = new QStandardItem;
-        if (transit[i])
-          item->setText(QString(tr("Begin transit of %1")).arg(sats.sats[i].name));
-        else
-          item->setText(QString(tr("End of transit %1")).arg(sats.sats[i].name));
-        m->setItem(row, 1, item);
-
-        row++;
-      }
-
-      if (inSun[i] != sats.sats[i].isInLight && !sats.sats[i].isHidden)
-      {
-        inSun[i] = sats.sats[i].isInLight;
-
-        item = new QStandardItem;
-        item->setText(getStrTime(j, tz, true));
-        item->setData(j);
-        m->setItem(row, 0, item);
-
-        item = new QStandardItem;
-        if (inSun[i])
-          item->setText(QString(tr("End of eclipse %1")).arg(sats.sats[i].name));
-        else
-          item->setText(QString(tr("Begin eclipse of %1")).arg(sats.sats[i].name));
-        m->setItem(row, 1, item);
+    if (!solver.isCached())
+    { // cancelled, only some days are solved
+      setWindowTitle(windowTitle() + " " + tr("(incomplete)"));
+    }
+  }
 
-        row++;
-      }
+  QStandardItemModel *m = (QStandardItemModel *)ui->treeView->model();
 
-      if (hidden[i] != sats.sats[i].isHidden)
-      {
-        hidden[i] = sats.sats[i].isHidden;
+  if (m != NULL)
+    delete m;
 
-        item = new QStandardItem;
-        item->setText(getStrTime(j, tz, true));
-        item->setData(j);
-        m->setItem(row, 0, item);
+  m = new QStandardItemModel(0, 3);
+  int row = 0;
 
-        item = new QStandardItem;
-        if (hidden[i])
-          item->setText(QString(tr("Begin occultation of %1")).arg(sats.sats[i].name));
-        else
-          item->setText(QString(tr("End of occultation %1")).arg(sats.sats[i].name));
-        m->setItem(row, 1, item);
+  m->setHeaderData(0, Qt::Horizontal, tr("Date"));
+  m->setHeaderData(1, Qt::Horizontal, tr("Time"));
+  m->setHeaderData(2, Qt::Horizontal, tr("Desc."));
 
-        row++;
-      }
+  foreach (const satEvent_t &e, solver.events())
+  {
+    QStandardItem *item;
 
-      if (throwShd[i] != sats.sats[i].isThrowShadow)
-      {
-        throwShd[i] = sats.sats[i].isThrowShadow;
+    item = new QStandardItem;
+    item->setText(getStrDate(e.jd, tz));
+    item->setData(e.jd);
+    m->setItem(row, 0, item);
 
-        item = new QStandardItem;
-        item->setText(getStrTime(j, tz, true));
-        item->setData(j);
-        m->setItem(row, 0, item);
+    item = new QStandardItem;
+    item->setText(getStrTime(e.jd, tz, true));
+    m->setItem(row, 1, item);
 
-        item = new QStandardItem;
-        if (throwShd[i])
-          item->setText(QString(tr("Begin shadow of %1")).arg(sats.sats[i].name));
-        else
-          item->setText(QString(tr("End of shadow %1")).arg(sats.sats[i].name));
-        m->setItem(row, 1, item);
+    item = new QStandardItem;
+    item->setText(CSatEventSolver::eventName(e));
+    m->setItem(row, 2, item);
 
-        row++;
-      }
-    }
+    row++;
   }
 
   ui->treeView->setModel(m);
-
 }
 
 void CSatEvents::on_pushButton_3_clicked()
@@ -207,14 +131,14 @@ void CSatEvents::on_comboBox_currentIndexChanged(int index)
 // prev day
 void CSatEvents::on_pushButton_clicked()
 {
-  m_jd--;
+  m_jd -= ui->spinBox->value();
   solve(m_jd, ui->comboBox->currentIndex() + PT_MARS);
 }
 
 // next day
 void CSatEvents::on_pushButton_2_clicked()
 {
-  m_jd++;
+  m_jd += ui->spinBox->value();
   solve(m_jd, ui->comboBox->currentIndex() + PT_MARS);
 }
 
@@ -229,11 +153,11 @@ void CSatEvents::on_pushButton_4_clicked()
   out <<  "<html>\n"
           "<head>\n"
           "<meta Content=\"Text/html; charset=Windows-1251\">\n"
-       <<  QString("<title>%1</title>\n").arg(tr("Events for ") + getStrDate(m_view.jd, m_view.geo.tz))
+       <<  QString("<title>%1</title>\n").arg(windowTitle())
           <<  "</head>\n"
           "<body bgcolor=#ffffff link=#5000A0>\n"
           "<b>"
-       << tr("Events for ") + getStrDate(m_view.jd, m_view.geo.tz) + "<br>" <<
+       << windowTitle() + "<br>" <<
           "</b>"
           "<table border=1 cellspacing=0 cellpadding=2>\n";
 
@@ -290,6 +214,7 @@ void CSatEvents::on_pushButton_5_clicked()
     case 1: m_planet = PT_JUPITER;break;
     case 2: m_planet = PT_SATURN; break;
     case 3: m_planet = PT_URANUS; break;
+    case 4: m_planet = PT_NEPTUNE; break;
   }
 
   m_time = il.at(0).data(Qt::UserRole + 1).toDouble();
@@ -310,3 +235,44 @@ void CSatEvents::on_treeView_doubleClicked(const QModelIndex &)
 {
   on_pushButton_5_clicked();
 }
+
+void CSatEvents::on_spinBox_editingFinished()
+{
+  solve(m_jd, ui->comboBox->currentIndex() + PT_MARS);
+}
+
+// export
+void CSatEvents::on_pushButton_6_clicked()
+{
+  QString name = QFileDialog::getSaveFileName(this, tr("Save File"),
+                                             "untitled.csv",
+                                             tr("CSV Files (*.csv)"));
+  if (name.isEmpty())
+    return;
+
+  QAbstractItemModel *model = ui->treeView->model();
+
+  SkFile fOut(name);
+  if (fOut.open(SkFile::WriteOnly | SkFile::Text))
+  {
+    QTextStream s(&fOut);
+
+    s << tr("Planet") << ";";
+    for (int column = 0; column < model->columnCount(); column++)
+    {
+      s << model->headerData(column, Qt::Horizontal).toString() << ";";
+    }
+    s << "\n";
+
+    for (int row = 0; row < model->rowCount(); row++)
+    {
+      s << ui->comboBox->currentText() << ";";
+      for (int column = 0; column < model->columnCount(); column++)
+      {
+        s << model->data(model->index(row, column)).toString().simplified() << ";";
+      }
+      s << "\n";
+    }
+  }
+  fOut.close();
+}
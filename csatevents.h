@@ -47,6 +47,10 @@ private slots:
 
   void on_treeView_doubleClicked(const QModelIndex &index);
 
+  void on_pushButton_6_clicked();
+
+  void on_spinBox_editingFinished();
+
 private:
   Ui::CSatEvents *ui;
 };
@@ -0,0 +1,484 @@
+#include "csateventsolver.h"
+
+#include <algorithm>
+
+extern bool g_useJPLEphem;
+extern int  g_ephType;
+extern int  g_ephMoonType;
+extern bool g_geocentric;
+
+#define SE_FUNC_DISK      0
+#define SE_FUNC_SHADOW    1
+
+typedef struct
+{
+  int     count;
+  double  disk[MAX_XYZ_SATS];     // distance from the limb (planet radii, < 0 inside)
+  double  shadow[MAX_XYZ_SATS];   // Sun-satellite line from the limb (< 0 eclipse or shadow)
+  double  elong[MAX_XYZ_SATS];
+  double  pos[MAX_XYZ_SATS][3];   // earth facing xyz (planet radii)
+  bool    front[MAX_XYZ_SATS];
+  bool    eclipse[MAX_XYZ_SATS];
+} satSample_t;
+
+typedef struct
+{
+  CAstro            astro;
+  CPlanetSatellite  sat;
+  mapView_t         view;
+  int               planet;
+  QStringList       names;
+} satContext_t;
+
+typedef struct
+{
+  qint64  day;                              // UT day
+  qint32  planet;
+  qint32  ephType, ephMoonType, useJPL, geocentric;
+  qint32  deltaTAlg;
+  double  deltaT;
+  double  lon, lat, alt;
+} seKey_t;
+
+static QMutex                                   seMutex;
+static QHash <QByteArray, QList <satEvent_t> >  seCache;    // seKey_t
+
+/////////////////////////////////////////////////////////////////////
+// planet, UT day and the settings the events depend on
+static QByteArray seKey(const mapView_t *view, int planet, qint64 day)
+/////////////////////////////////////////////////////////////////////
+{
+  seKey_t k;
+
+  memset(&k, 0, sizeof(k));
+
+  k.day = day;
+  k.planet = planet;
+  k.ephType = g_ephType;
+  k.ephMoonType = g_ephMoonType;
+  k.useJPL = g_useJPLEphem;
+  k.geocentric = g_geocentric;
+  k.deltaTAlg = view->deltaTAlg;
+  k.deltaT = view->deltaT;
+  k.lon = view->geo.lon;
+  k.lat = view->geo.lat;
+  k.alt = view->geo.alt;
+
+  return QByteArray((const char *)&k, sizeof(k));
+}
+
+///////////////////////////////////
+// less than the shortest half orbit
+static double seMaxStep(int planet)
+///////////////////////////////////
+{
+  switch (planet)
+  {
+    case PT_MARS:
+      return JD1SEC * 60 * 20;
+
+    case PT_JUPITER:
+      return JD1SEC * 3600 * 2;
+
+    case PT_SATURN:
+      return JD1SEC * 3600;
+
+    case PT_URANUS:
+      return JD1SEC * 60 * 90;
+  }
+
+  return JD1SEC * 3600 * 6;
+}
+
+////////////////////////////////////////////////////////////////////
+static void seSample(satContext_t *ctx, double jd, satSample_t *out)
+////////////////////////////////////////////////////////////////////
+{
+  orbit_t            o, s;
+  planetSatellites_t sats;
+
+  ctx->view.jd = jd;
+  ctx->astro.setParam(&ctx->view);
+  ctx->astro.calcPlanet(PT_EARTH, &s, true, true, false);
+  ctx->astro.calcPlanet(ctx->planet, &o);
+  ctx->sat.solve(jd - o.light, ctx->planet, &sats, &o, &s);
+
+  double flat = o.sx / o.sy;
+
+  out->count = qMin(sats.sats.count(), MAX_XYZ_SATS);
+
+  if (ctx->names.isEmpty())
+  {
+    for (int i = 0; i < out->count; i++)
+    {
+      ctx->names.append(sats.sats[i].name);
+    }
+  }
+
+  for (int i = 0; i < out->count; i++)
+  {
+    const planetSatellite_t &sat = sats.sats[i];
+
+    out->disk[i] = sqrt(POW2(sat.ex) + POW2(sat.ey * flat)) - 1;
+    out->shadow[i] = sat.shadowDist - 1;
+    out->elong[i] = qAbs(sat.ex);
+    out->pos[i][0] = sat.ex;
+    out->pos[i][1] = sat.ey;
+    out->pos[i][2] = sat.ez;
+    out->front[i] = sat.ez > 0;
+    out->eclipse[i] = !sat.isInLight;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Illinois method
+static double seRefine(satContext_t *ctx, int sat, int func, double t0, double f0, double t1, double f1)
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  satSample_t smp;
+  int         side = 0;
+
+  for (int i = 0; i < 50 && t1 - t0 > SE_PRECISION; i++)
+  {
+    double t = (f0 * t1 - f1 * t0) / (f0 - f1);
+
+    t = qBound(t0 + SE_PRECISION * 0.25, t, t1 - SE_PRECISION * 0.25);
+    seSample(ctx, t, &smp);
+
+    double f = (func == SE_FUNC_DISK) ? smp.disk[sat] : smp.shadow[sat];
+
+    if ((f < 0) == (f0 < 0))
+    {
+      t0 = t;
+      f0 = f;
+      if (side == -1)
+      {
+        f1 *= 0.5;
+      }
+      side = -1;
+    }
+    else
+    {
+      t1 = t;
+      f1 = f;
+      if (side == 1)
+      {
+        f0 *= 0.5;
+      }
+      side = 1;
+    }
+  }
+
+  return (t0 + t1) * 0.5;
+}
+
+////////////////////////////////////////////////////////////////////////
+// golden section search
+static double seMaxElong(satContext_t *ctx, int sat, double a, double b)
+////////////////////////////////////////////////////////////////////////
+{
+  const double r = 0.618033988749895;
+  satSample_t  smp;
+  double       c = b - r * (b - a);
+  double       d = a + r * (b - a);
+  double       fc, fd;
+
+  seSample(ctx, c, &smp);
+  fc = smp.elong[sat];
+  seSample(ctx, d, &smp);
+  fd = smp.elong[sat];
+
+  while (b - a > SE_ELONG_PRECISION)
+  {
+    if (fc > fd)
+    {
+      b = d;
+      d = c;
+      fd = fc;
+      c = b - r * (b - a);
+      seSample(ctx, c, &smp);
+      fc = smp.elong[sat];
+    }
+    else
+    {
+      a = c;
+      c = d;
+      fc = fd;
+      d = a + r * (b - a);
+      seSample(ctx, d, &smp);
+      fd = smp.elong[sat];
+    }
+  }
+
+  return (a + b) * 0.5;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+static void seAddEvent(satContext_t *ctx, QList <satEvent_t> &out, double jd, int type, int sat)
+////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  satEvent_t e;
+
+  e.jd = jd;
+  e.type = type;
+  e.sat = sat;
+  e.name = ctx->names[sat];
+
+  out.append(e);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// scans a bit past 'to', events found in <from, to) only
+static void seScan(satContext_t *ctx, double from, double to, QList <satEvent_t> &out)
+//////////////////////////////////////////////////////////////////////////////////////
+{
+  double      maxStep = seMaxStep(ctx->planet);
+  satSample_t prev2, prev, cur;
+  double      t2 = from - SE_MIN_STEP;
+  double      t1 = from;
+
+  seSample(ctx, t2, &prev2);
+  seSample(ctx, t1, &prev);
+
+  while (t1 < to + maxStep)
+  {
+    // no limb or shadow crossing within the half of the time to reach it
+    double step = maxStep;
+
+    for (int i = 0; i < prev.count; i++)
+    {
+      double v = sqrt(POW2(prev.pos[i][0] - prev2.pos[i][0]) +
+                      POW2(prev.pos[i][1] - prev2.pos[i][1]) +
+                      POW2(prev.pos[i][2] - prev2.pos[i][2])) / (t1 - t2);
+
+      if (v > 0)
+      {
+        step = qMin(step, 0.5 * qMin(qAbs(prev.disk[i]), qAbs(prev.shadow[i])) / v);
+      }
+    }
+
+    double t = t1 + qBound(SE_MIN_STEP, step, maxStep);
+
+    seSample(ctx, t, &cur);
+
+    for (int i = 0; i < cur.count; i++)
+    {
+      if ((prev.disk[i] < 0) != (cur.disk[i] < 0))
+      {
+        double jd = seRefine(ctx, i, SE_FUNC_DISK, t1, prev.disk[i], t, cur.disk[i]);
+        bool   begin = cur.disk[i] < 0;
+        bool   front = begin ? cur.front[i] : prev.front[i];
+
+        if (jd >= from && jd < to)
+        {
+          if (front)
+            seAddEvent(ctx, out, jd, begin ? SE_TRANSIT_BEGIN : SE_TRANSIT_END, i);
+          else
+            seAddEvent(ctx, out, jd, begin ? SE_OCCULT_BEGIN : SE_OCCULT_END, i);
+        }
+      }
+
+      if ((prev.shadow[i] < 0) != (cur.shadow[i] < 0))
+      {
+        double             jd = seRefine(ctx, i, SE_FUNC_SHADOW, t1, prev.shadow[i], t, cur.shadow[i]);
+        bool               begin = cur.shadow[i] < 0;
+        const satSample_t &in = begin ? cur : prev;
+
+        if (jd >= from && jd < to)
+        {
+          if (!in.eclipse[i])
+          {
+            seAddEvent(ctx, out, jd, begin ? SE_SHADOW_BEGIN : SE_SHADOW_END, i);
+          }
+          else
+          if (!(in.disk[i] < 0 && !in.front[i]))
+          { // eclipse behind the planet is not visible
+            seAddEvent(ctx, out, jd, begin ? SE_ECLIPSE_BEGIN : SE_ECLIPSE_END, i);
+          }
+        }
+      }
+
+      if (prev.elong[i] > prev2.elong[i] && prev.elong[i] >= cur.elong[i])
+      {
+        double jd = seMaxElong(ctx, i, t2, t);
+
+        if (jd >= from && jd < to)
+        {
+          seAddEvent(ctx, out, jd, SE_MAX_ELONGATION, i);
+        }
+      }
+    }
+
+    prev2 = prev;
+    t2 = t1;
+    prev = cur;
+    t1 = t;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+CSatEventSolver::CSatEventSolver(const mapView_t *view, int planet, double jdFrom, double jdTo)
+///////////////////////////////////////////////////////////////////////////////////////////////
+{
+  m_view = *view;
+  m_planet = planet;
+  m_jdFrom = jdFrom;
+  m_jdTo = jdTo;
+  m_end = false;
+
+  // UT days <day - 0.5, day + 0.5)
+  for (qint64 day = (qint64)floor(jdFrom + 0.5); day - 0.5 < jdTo; day++)
+  {
+    m_days.append(day);
+    m_keys.append(seKey(view, planet, day));
+  }
+}
+
+////////////////////////////
+void CSatEventSolver::stop()
+////////////////////////////
+{
+  m_end = true;
+}
+
+////////////////////////////////
+bool CSatEventSolver::isCached()
+////////////////////////////////
+{
+  QMutexLocker locker(&seMutex);
+
+  foreach (const QByteArray &key, m_keys)
+  {
+    if (!seCache.contains(key))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////
+static bool seLessThan(const satEvent_t &a, const satEvent_t &b)
+////////////////////////////////////////////////////////////////
+{
+  return a.jd < b.jd;
+}
+
+///////////////////////////////////////////
+QList<satEvent_t> CSatEventSolver::events()
+///////////////////////////////////////////
+{
+  QList <satEvent_t> list;
+  QMutexLocker       locker(&seMutex);
+
+  foreach (const QByteArray &key, m_keys)
+  {
+    foreach (const satEvent_t &e, seCache.value(key))
+    {
+      if (e.jd >= m_jdFrom && e.jd < m_jdTo)
+      {
+        list.append(e);
+      }
+    }
+  }
+
+  std::sort(list.begin(), list.end(), seLessThan);
+
+  return list;
+}
+
+///////////////////////////////////////////////////////////
+QString CSatEventSolver::eventName(const satEvent_t &event)
+///////////////////////////////////////////////////////////
+{
+  switch (event.type)
+  {
+    case SE_TRANSIT_BEGIN:
+      return QCoreApplication::translate("CSatEvents", "Begin transit of %1").arg(event.name);
+
+    case SE_TRANSIT_END:
+      return QCoreApplication::translate("CSatEvents", "End of transit %1").arg(event.name);
+
+    case SE_OCCULT_BEGIN:
+      return QCoreApplication::translate("CSatEvents", "Begin occultation of %1").arg(event.name);
+
+    case SE_OCCULT_END:
+      return QCoreApplication::translate("CSatEvents", "End of occultation %1").arg(event.name);
+
+    case SE_ECLIPSE_BEGIN:
+      return QCoreApplication::translate("CSatEvents", "Begin eclipse of %1").arg(event.name);
+
+    case SE_ECLIPSE_END:
+      return QCoreApplication::translate("CSatEvents", "End of eclipse %1").arg(event.name);
+
+    case SE_SHADOW_BEGIN:
+      return QCoreApplication::translate("CSatEvents", "Begin shadow of %1").arg(event.name);
+
+    case SE_SHADOW_END:
+      return QCoreApplication::translate("CSatEvents", "End of shadow %1").arg(event.name);
+
+    case SE_MAX_ELONGATION:
+      return QCoreApplication::translate("CSatEvents", "Max elongation of %1").arg(event.name);
+  }
+
+  return QString();
+}
+
+///////////////////////////
+void CSatEventSolver::run()
+///////////////////////////
+{
+  QList <int> missing;
+
+  seMutex.lock();
+  if (seCache.count() + m_days.count() > SE_CACHE_DAYS)
+  {
+    seCache.clear();
+  }
+
+  for (int i = 0; i < m_days.count(); i++)
+  {
+    if (!seCache.contains(m_keys.at(i)))
+    {
+      missing.append(i);
+    }
+  }
+  seMutex.unlock();
+
+  int count = missing.count();
+  int done = 0;
+
+  #pragma omp parallel
+  {
+    satContext_t ctx;
+
+    ctx.view = m_view;
+    ctx.planet = m_planet;
+    ctx.sat.setAstro(&ctx.astro);
+    ctx.sat.setCache(false); // own day cache, threads would thrash the shared one
+
+    #pragma omp for schedule(dynamic)
+    for (int i = 0; i < count; i++)
+    {
+      if (m_end)
+      {
+        continue;
+      }
+
+      QList <satEvent_t> list;
+      double             from = m_days.at(missing.at(i)) - 0.5;
+
+      seScan(&ctx, from, from + 1, list);
+
+      QMutexLocker locker(&seMutex);
+
+      seCache[m_keys.at(missing.at(i))] = list;
+
+      done++;
+      emit sigProgress(100 * done / count);
+    }
+  }
+
+  emit sigDone();
+}
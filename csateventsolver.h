@@ -0,0 +1,64 @@
+#ifndef CSATEVENTSOLVER_H
+#define CSATEVENTSOLVER_H
+
+#include <QtCore>
+
+#include "castro.h"
+#include "cmapview.h"
+#include "csatxyz.h"
+
+#define SE_TRANSIT_BEGIN      0
+#define SE_TRANSIT_END        1
+#define SE_OCCULT_BEGIN       2
+#define SE_OCCULT_END         3
+#define SE_ECLIPSE_BEGIN      4
+#define SE_ECLIPSE_END        5
+#define SE_SHADOW_BEGIN       6
+#define SE_SHADOW_END         7
+#define SE_MAX_ELONGATION     8
+
+#define SE_MIN_STEP           (JD1SEC * 60)
+#define SE_PRECISION          JD1SEC          // contact times
+#define SE_ELONG_PRECISION    (JD1SEC * 10)
+#define SE_CACHE_DAYS         20000           // all planets
+
+typedef struct
+{
+  double  jd;
+  int     type;     // SE_xxx
+  int     sat;      // index to planetSatellites_t::sats
+  QString name;
+} satEvent_t;
+
+// transits, occultations, eclipses and shadows of planetary satellites
+// solved per UT day in parallel, days are cached
+class CSatEventSolver : public QThread
+{
+  Q_OBJECT
+
+public:
+  CSatEventSolver(const mapView_t *view, int planet, double jdFrom, double jdTo);
+
+  void                stop();
+  bool                isCached();
+  QList <satEvent_t>  events();
+
+  static QString      eventName(const satEvent_t &event);
+
+signals:
+  void sigProgress(int percent);
+  void sigDone(void);
+
+protected:
+  void run();
+
+  mapView_t        m_view;
+  int              m_planet;
+  double           m_jdFrom;
+  double           m_jdTo;
+  QList <qint64>   m_days;
+  QList <QByteArray> m_keys;    // cache keys of m_days
+  volatile bool    m_end;
+};
+
+#endif // CSATEVENTSOLVER_H
@@ -0,0 +1,526 @@
+#include "csatpasses.h"
+#include "SolarPosition.h"
+#include "Globals.h"
+
+#define SP_MARGIN           D2R(1)
+#define SP_EARTH_RATE       (MPI2 * 1.00273790935)    // rad/day
+#define SP_BLOCK            512
+
+////////////////////////////////////////////////////////////////////////////
+CSatPasses::CSatPasses(const mapView_t *view, const satPassParams_t &params)
+////////////////////////////////////////////////////////////////////////////
+{
+  m_params = params;
+  m_params.days = qBound(1, m_params.days, SP_MAX_DAYS);
+  m_jdFrom = view->jd;
+  m_jdTo = view->jd + m_params.days;
+  m_end = false;
+
+  // observer (same as Eci::ToEci())
+  double lat = view->geo.lat;
+  double alt = view->geo.alt / 1000.0;
+  double c = 1.0 / sqrt(1.0 + kF * (kF - 2.0) * pow(sin(lat), 2.0));
+  double s = pow(1.0 - kF, 2.0) * c;
+
+  m_lon = view->geo.lon;
+  m_sinLat = sin(lat);
+  m_cosLat = cos(lat);
+  m_achcp = (kXKMPER * c + alt) * m_cosLat;
+  m_obsZ = (kXKMPER * s + alt) * m_sinLat;
+  m_obsR = sqrt(m_achcp * m_achcp + m_obsZ * m_obsZ);
+
+  m_batch = sgp4.batch();
+
+  for (int i = 0; i < sgp4.count(); i++)
+  {
+    m_names.append(sgp4.getName(i));
+  }
+
+  for (int i = 0; i < m_batch.index.count() + sgp4.deepSpace().count(); i++)
+  {
+    satPassSrc_t src;
+    bool         isBatch = i < m_batch.index.count();
+
+    src.sat = isBatch ? m_batch.index[i] : sgp4.deepSpace()[i - m_batch.index.count()];
+    src.batch = isBatch ? i : -1;
+    src.deep = -1;
+
+    tleItem_t *item = sgp4.tleItem(src.sat);
+
+    if (!isBatch)
+    {
+      src.deep = m_deep.count();
+      m_deep.append(*item->sgp4);
+    }
+
+    double e = item->elem.ecco;
+    double n = MPI2 / item->period * 1440.0;
+
+    src.period = item->period / 1440.0;
+    src.rate = n * pow(1 + e, 2) / pow(1 - e * e, 1.5) + SP_EARTH_RATE;
+    src.apogee = item->elem.aodp * (1 + e) * kXKMPER;
+    src.incl = item->inclination;
+
+    m_src.append(src);
+  }
+}
+
+/////////////////////////
+void CSatPasses::stop()
+/////////////////////////
+{
+  m_end = true;
+}
+
+//////////////////////////////////////////////////
+// passes found since the last call (thread safe)
+QList<satPass_t> CSatPasses::takeResults()
+//////////////////////////////////////////////////
+{
+  QMutexLocker locker(&m_mutex);
+  QList <satPass_t> list = m_results;
+
+  m_results.clear();
+
+  return list;
+}
+
+////////////////////////////////////////////////
+const QString &CSatPasses::name(int sat) const
+////////////////////////////////////////////////
+{
+  return m_names[sat];
+}
+
+/////////////////////
+void CSatPasses::run()
+/////////////////////
+{
+  int count = m_src.count();
+
+  for (int block = 0; block < count && !m_end; block += SP_BLOCK)
+  {
+    int                         n = qMin(SP_BLOCK, count - block);
+    QVector <QList <satPass_t> > out(n);
+
+    #pragma omp parallel for schedule(dynamic, 8)
+    for (int i = 0; i < n; i++)
+    {
+      if (!m_end)
+      {
+        findPasses(m_src[block + i], out[i]);
+      }
+    }
+
+    m_mutex.lock();
+    for (int i = 0; i < n; i++)
+    {
+      m_results.append(out[i]);
+    }
+    m_mutex.unlock();
+
+    emit sigProgress((block + n) * 100 / count);
+  }
+
+  emit sigDone();
+}
+
+////////////////////////////////////////////////////////////////////////
+bool CSatPasses::satPos(const satPassSrc_t &src, double jd, double *xyz) const
+////////////////////////////////////////////////////////////////////////
+{
+  if (src.batch >= 0)
+  {
+    return CSGP4::propagate(m_batch, src.batch, jd, xyz) == SGP4_OK;
+  }
+
+  try
+  {
+    Eci eci = m_deep.at(src.deep).FindPosition(CSGP4::jdToDateTime(jd));
+
+    xyz[0] = eci.Position().x;
+    xyz[1] = eci.Position().y;
+    xyz[2] = eci.Position().z;
+  }
+
+  catch (...)
+  {
+    return false;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+void CSatPasses::observerPos(double jd, double *xyz, double *sinTheta, double *cosTheta) const
+/////////////////////////////////////////////////////////////////////////////////////////////
+{
+  double theta = CSGP4::jdToDateTime(jd).ToLocalMeanSiderealTime(m_lon);
+
+  *sinTheta = sin(theta);
+  *cosTheta = cos(theta);
+
+  xyz[0] = m_achcp * *cosTheta;
+  xyz[1] = m_achcp * *sinTheta;
+  xyz[2] = m_obsZ;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+// cosAngle is the cosine of the geocentric angle between satellite and observer
+bool CSatPasses::elevation(const satPassSrc_t &src, double jd, satPos_t *pos, double *cosAngle) const
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  double xyz[3];
+  double obs[3];
+  double sinTheta, cosTheta;
+
+  if (!satPos(src, jd, xyz))
+  {
+    return false;
+  }
+
+  observerPos(jd, obs, &sinTheta, &cosTheta);
+  CSGP4::lookAngle(xyz, obs, m_sinLat, m_cosLat, sinTheta, cosTheta, pos);
+
+  if (cosAngle)
+  {
+    double r = sqrt(xyz[0] * xyz[0] + xyz[1] * xyz[1] + xyz[2] * xyz[2]);
+
+    *cosAngle = (xyz[0] * obs[0] + xyz[1] * obs[1] + xyz[2] * obs[2]) / (r * m_obsR);
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// golden section search of the culmination
+bool CSatPasses::findMax(const satPassSrc_t &src, double t1, double t2, double *tca, double *maxElev) const
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  const double g = 0.618033988749895;
+  satPos_t     p1, p2;
+  double       a = t1;
+  double       b = t2;
+  double       c = b - g * (b - a);
+  double       d = a + g * (b - a);
+
+  if (!elevation(src, c, &p1) || !elevation(src, d, &p2))
+  {
+    return false;
+  }
+
+  while (b - a > JD1SEC)
+  {
+    if (p1.elevation > p2.elevation)
+    {
+      b = d;
+      d = c;
+      p2 = p1;
+      c = b - g * (b - a);
+      if (!elevation(src, c, &p1)) return false;
+    }
+    else
+    {
+      a = c;
+      c = d;
+      p1 = p2;
+      d = a + g * (b - a);
+      if (!elevation(src, d, &p2)) return false;
+    }
+  }
+
+  *tca = (a + b) * 0.5;
+  *maxElev = qMax(p1.elevation, p2.elevation);
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// bisection of the min. elevation crossing between t1 and t2
+bool CSatPasses::findCross(const satPassSrc_t &src, double t1, double t2, double *t, double *azm) const
+///////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  satPos_t p1, pm;
+
+  if (!elevation(src, t1, &p1))
+  {
+    return false;
+  }
+
+  bool above1 = p1.elevation >= m_params.minElev;
+
+  while (fabs(t2 - t1) > JD1SEC)
+  {
+    double tm = (t1 + t2) * 0.5;
+
+    if (!elevation(src, tm, &pm))
+    {
+      return false;
+    }
+
+    if ((pm.elevation >= m_params.minElev) == above1)
+    {
+      t1 = tm;
+    }
+    else
+    {
+      t2 = tm;
+    }
+  }
+
+  *t = (t1 + t2) * 0.5;
+  if (!elevation(src, *t, &pm))
+  {
+    return false;
+  }
+  *azm = pm.azimuth;
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// cylindrical Earth shadow, the Sun is taken at culmination
+int CSatPasses::illumination(const satPassSrc_t &src, const satPass_t &pass) const
+///////////////////////////////////////////////////////////////////////////////
+{
+  SolarPosition solar;
+  Eci           eci = solar.FindPosition(CSGP4::jdToDateTime(pass.tca));
+  Vector        sun = eci.Position();
+  double        sunR = sun.Magnitude();
+  double        s[3] = { sun.x / sunR, sun.y / sunR, sun.z / sunR };
+  int           flags = 0;
+  int           steps = qBound(1, (int)((pass.los - pass.aos) / (JD1SEC * 30)), 20);
+
+  for (int i = 0; i <= steps; i++)
+  {
+    double jd = (i == steps / 2) ? pass.tca : pass.aos + (pass.los - pass.aos) * i / steps;
+    double xyz[3];
+    double obs[3];
+    double sinTheta, cosTheta;
+
+    if (!satPos(src, jd, xyz))
+    {
+      break;
+    }
+
+    double d = xyz[0] * s[0] + xyz[1] * s[1] + xyz[2] * s[2];
+    double px = xyz[0] - d * s[0];
+    double py = xyz[1] - d * s[1];
+    double pz = xyz[2] - d * s[2];
+    bool   sunlit = d > 0 || px * px + py * py + pz * pz > kXKMPER * kXKMPER;
+
+    if (!sunlit)
+    {
+      continue;
+    }
+
+    if (jd == pass.tca)
+    {
+      flags |= SPF_SUNLIT;
+    }
+
+    satPos_t sunPos;
+    double   sunXyz[3] = { sun.x, sun.y, sun.z };
+
+    observerPos(jd, obs, &sinTheta, &cosTheta);
+    CSGP4::lookAngle(sunXyz, obs, m_sinLat, m_cosLat, sinTheta, cosTheta, &sunPos);
+
+    if (sunPos.elevation < SP_TWILIGHT)
+    {
+      flags |= SPF_VISIBLE;
+    }
+  }
+
+  return flags;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+// coarse steps while the satellite cannot reach the observer's sky (bounded by its max.
+// angular rate), fine steps (1/120 of the period) near passes and root refinement
+void CSatPasses::findPasses(const satPassSrc_t &src, QList<satPass_t> &out) const
+///////////////////////////////////////////////////////////////////////////////////////
+{
+  double minElev = m_params.minElev;
+  double cosLambda = m_obsR * cos(minElev) / src.apogee;
+
+  if (cosLambda >= 1)
+  {
+    return;
+  }
+
+  // visibility radius (geocentric angle)
+  double lambda = acos(cosLambda) - minElev + SP_MARGIN;
+  double maxSubLat = src.incl <= R90 ? src.incl : R180 - src.incl;
+  double geoLat = atan2(m_obsZ, m_achcp);
+
+  if (fabs(geoLat) - maxSubLat > lambda)
+  {
+    return;
+  }
+
+  double   fine = CLAMP(src.period / 120.0, JD1SEC * 15, JD1SEC * 300);
+  double   t = m_jdFrom;
+  double   lastLos = m_jdFrom;
+  double   prevT[2];
+  double   prevE[2];
+  int      samples = 0;
+  satPos_t pos;
+
+  while (!m_end)
+  {
+    double cosAngle;
+    bool   last = t >= m_jdTo;
+
+    if (last)
+    {
+      t = m_jdTo;
+    }
+
+    if (!elevation(src, t, &pos, &cosAngle))
+    {
+      return; // decayed
+    }
+
+    double angle = acos(CLAMP(cosAngle, -1.0, 1.0));
+
+    if (angle > lambda)
+    {
+      if (last)
+      {
+        break;
+      }
+      samples = 0;
+      t += qMax(fine, (angle - lambda) / src.rate);
+      continue;
+    }
+
+    bool isMax = false;
+
+    if (samples == 0 && t == m_jdFrom)
+    {
+      // pass in progress at the start
+      prevT[1] = t;
+      prevE[1] = pos.elevation;
+      samples = 1;
+      t += fine;
+      continue;
+    }
+
+    // the first in-cone sample can already be past culmination (grazing pass)
+    if (samples >= 1 && pos.elevation <= prevE[1] && (samples == 1 || prevE[1] > prevE[0]))
+    {
+      isMax = true;
+    }
+    else if (samples >= 1 && last)
+    {
+      // pass in progress at the end
+      isMax = true;
+    }
+
+    if (isMax)
+    {
+      satPass_t pass;
+      double    from = samples >= 2 ? prevT[0] : prevT[1];
+
+      if (samples < 2)
+      {
+        // falling from the first sample, step back until the elevation
+        // stops rising (not before the start or the previous pass)
+        double   e = prevE[1];
+        satPos_t pb;
+
+        while (from > lastLos)
+        {
+          double f0 = qMax(lastLos, from - fine);
+
+          if (!elevation(src, f0, &pb)) return;
+          from = f0;
+          if (pb.elevation < e)
+          {
+            break;
+          }
+          e = pb.elevation;
+        }
+      }
+
+      if (findMax(src, from, t, &pass.tca, &pass.maxElev) && pass.maxElev >= minElev)
+      {
+        // AOS
+        double a = pass.tca;
+        satPos_t p;
+
+        pass.aos = m_jdFrom;
+        pass.aosAzm = pos.azimuth;
+        while (a > m_jdFrom)
+        {
+          double a0 = qMax(m_jdFrom, a - fine);
+
+          if (!elevation(src, a0, &p)) return;
+          if (p.elevation < minElev)
+          {
+            if (!findCross(src, a0, a, &pass.aos, &pass.aosAzm)) return;
+            break;
+          }
+          if (a0 == m_jdFrom)
+          {
+            pass.aos = m_jdFrom;
+            pass.aosAzm = p.azimuth;
+          }
+          a = a0;
+        }
+
+        // LOS
+        double b = pass.tca;
+
+        pass.los = m_jdTo;
+        pass.losAzm = pos.azimuth;
+        while (b < m_jdTo)
+        {
+          double b1 = qMin(m_jdTo, b + fine);
+
+          if (!elevation(src, b1, &p)) return;
+          if (p.elevation < minElev)
+          {
+            if (!findCross(src, b, b1, &pass.los, &pass.losAzm)) return;
+            break;
+          }
+          if (b1 == m_jdTo)
+          {
+            pass.los = m_jdTo;
+            pass.losAzm = p.azimuth;
+          }
+          b = b1;
+        }
+
+        pass.sat = src.sat;
+        pass.flags = illumination(src, pass);
+
+        if (!m_params.visibleOnly || (pass.flags & SPF_VISIBLE))
+        {
+          out.append(pass);
+        }
+
+        samples = 0;
+        lastLos = qMax(lastLos, pass.los);
+        t = qMax(t, pass.los) + fine;
+        if (last || pass.los >= m_jdTo)
+        {
+          break;
+        }
+        continue;
+      }
+    }
+
+    if (last)
+    {
+      break;
+    }
+
+    prevT[0] = prevT[1];
+    prevE[0] = prevE[1];
+    prevT[1] = t;
+    prevE[1] = pos.elevation;
+    samples = qMin(samples + 1, 2);
+    t += fine;
+  }
+}
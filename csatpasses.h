@@ -0,0 +1,91 @@
+#ifndef CSATPASSES_H
+#define CSATPASSES_H
+
+#include <QtCore>
+
+#include "csgp4.h"
+#include "cmapview.h"
+
+#define SPF_SUNLIT          1     // satellite is sunlit at culmination
+#define SPF_VISIBLE         2     // sunlit while the observer is in twilight or dark
+
+#define SP_TWILIGHT         D2R(-6)
+#define SP_MAX_DAYS         30
+
+typedef struct
+{
+  int    sat;           // index to sgp4
+  double aos;           // jd (UT)
+  double tca;
+  double los;
+  double aosAzm;
+  double losAzm;
+  double maxElev;
+  int    flags;         // SPF_xxx
+} satPass_t;
+
+typedef struct
+{
+  int    days;
+  double minElev;       // rad
+  bool   visibleOnly;
+} satPassParams_t;
+
+typedef struct
+{
+  int    sat;           // index to sgp4
+  int    batch;         // index to batch or -1
+  int    deep;          // index to m_deep or -1
+  double period;        // days
+  double rate;          // max. angular rate around the Earth centre (rad/day)
+  double apogee;        // km
+  double incl;          // rad
+} satPassSrc_t;
+
+class CSatPasses : public QThread
+{
+  Q_OBJECT
+
+public:
+  CSatPasses(const mapView_t *view, const satPassParams_t &params);
+
+  void                stop();
+  QList <satPass_t>   takeResults();
+  const QString      &name(int sat) const;
+
+signals:
+  void sigProgress(int percent);
+  void sigDone(void);
+
+protected:
+  void run();
+  void findPasses(const satPassSrc_t &src, QList <satPass_t> &out) const;
+  bool satPos(const satPassSrc_t &src, double jd, double *xyz) const;
+  void observerPos(double jd, double *xyz, double *sinTheta, double *cosTheta) const;
+  bool elevation(const satPassSrc_t &src, double jd, satPos_t *pos, double *cosAngle = NULL) const;
+  bool findMax(const satPassSrc_t &src, double t1, double t2, double *tca, double *maxElev) const;
+  bool findCross(const satPassSrc_t &src, double t1, double t2, double *t, double *azm) const;
+  int  illumination(const satPassSrc_t &src, const satPass_t &pass) const;
+
+  satPassParams_t         m_params;
+  double                  m_jdFrom;
+  double                  m_jdTo;
+  double                  m_lon;
+  double                  m_sinLat;
+  double                  m_cosLat;
+  double                  m_achcp;    // observer distance from the Earth axis (km)
+  double                  m_obsZ;
+  double                  m_obsR;
+  volatile bool           m_end;
+
+  // snapshot of the TLE set
+  sgp4Batch_t             m_batch;
+  QList <SGP4>            m_deep;
+  QVector <satPassSrc_t>  m_src;
+  QStringList             m_names;
+
+  QMutex                  m_mutex;
+  QList <satPass_t>       m_results;
+};
+
+#endif // CSATPASSES_H
@@ -0,0 +1,243 @@
+#include "csatpassesdlg.h"
+#include "ui_csatpassesdlg.h"
+#include "skutils.h"
+#include "castro.h"
+
+CSatPassesDlg::CSatPassesDlg(QWidget *parent, mapView_t *view) :
+  QDialog(parent),
+  ui(new Ui::CSatPassesDlg)
+{
+  ui->setupUi(this);
+
+  m_view = *view;
+  m_passes = NULL;
+
+  m_model = new QStandardItemModel(0, 9);
+
+  m_proxy = new MyProxyPassModel();
+  m_proxy->setSourceModel(m_model);
+
+  m_model->setHeaderData(0, Qt::Horizontal, tr("Name"));
+  m_model->setHeaderData(1, Qt::Horizontal, tr("Date"));
+  m_model->setHeaderData(2, Qt::Horizontal, tr("Rise"));
+  m_model->setHeaderData(3, Qt::Horizontal, tr("Azm."));
+  m_model->setHeaderData(4, Qt::Horizontal, tr("Culmination"));
+  m_model->setHeaderData(5, Qt::Horizontal, tr("Max. alt."));
+  m_model->setHeaderData(6, Qt::Horizontal, tr("Set"));
+  m_model->setHeaderData(7, Qt::Horizontal, tr("Azm."));
+  m_model->setHeaderData(8, Qt::Horizontal, tr("Illumination"));
+
+  ui->treeView->setModel(m_proxy);
+  ui->treeView->setRootIsDecorated(false);
+  ui->treeView->header()->resizeSection(0, 150);
+  ui->treeView->header()->resizeSection(1, 90);
+  for (int i = 2; i < 8; i++)
+  {
+    ui->treeView->header()->resizeSection(i, 70);
+  }
+  ui->treeView->setSortingEnabled(true);
+}
+
+CSatPassesDlg::~CSatPassesDlg()
+{
+  stopSearch();
+
+  delete m_model;
+  delete m_proxy;
+  delete ui;
+}
+
+/////////////////////////////////
+void CSatPassesDlg::stopSearch()
+/////////////////////////////////
+{
+  if (m_passes)
+  {
+    m_passes->disconnect(this);
+    m_passes->stop();
+    m_passes->wait();
+    delete m_passes;
+    m_passes = NULL;
+  }
+}
+
+////////////////////////////////////////////
+void CSatPassesDlg::slotProgress(int percent)
+////////////////////////////////////////////
+{
+  if (!m_passes)
+  {
+    return;
+  }
+
+  QList <satPass_t> list = m_passes->takeResults();
+  double            tz = m_view.geo.tz;
+
+  ui->progressBar->setValue(percent);
+
+  ui->treeView->setSortingEnabled(false);
+  for (int i = 0; i < list.count(); i++)
+  {
+    const satPass_t &pass = list[i];
+    QList <QStandardItem *> row;
+    QString          illum;
+
+    if (pass.flags & SPF_VISIBLE)
+    {
+      illum = tr("Visible");
+    }
+    else if (pass.flags & SPF_SUNLIT)
+    {
+      illum = tr("Sunlit");
+    }
+    else
+    {
+      illum = tr("Shadow");
+    }
+
+    QStandardItem *item = new QStandardItem;
+    item->setText(m_passes->name(pass.sat));
+    item->setData(pass.sat);
+    item->setData(pass.tca, Qt::UserRole + 2);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(getStrDate(pass.aos, tz));
+    item->setData(pass.aos);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(getStrTime(pass.aos, tz, false, true));
+    item->setData(pass.aos);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(QString("%1°").arg(R2D(pass.aosAzm), 0, 'f', 0));
+    item->setData(pass.aosAzm);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(getStrTime(pass.tca, tz, false, true));
+    item->setData(pass.tca);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(QString("%1°").arg(R2D(pass.maxElev), 0, 'f', 1));
+    item->setData(pass.maxElev);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(getStrTime(pass.los, tz, false, true));
+    item->setData(pass.los);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(QString("%1°").arg(R2D(pass.losAzm), 0, 'f', 0));
+    item->setData(pass.losAzm);
+    row.append(item);
+
+    item = new QStandardItem;
+    item->setText(illum);
+    row.append(item);
+
+    m_model->appendRow(row);
+  }
+  ui->treeView->setSortingEnabled(true);
+}
+
+////////////////////////////////
+void CSatPassesDlg::slotDone()
+////////////////////////////////
+{
+  slotProgress(100);
+  ui->pushButton_3->setText(tr("Find"));
+}
+
+// find / stop
+////////////////////////////////////////////
+void CSatPassesDlg::on_pushButton_3_clicked()
+////////////////////////////////////////////
+{
+  if (m_passes && m_passes->isRunning())
+  {
+    m_passes->stop();
+    return;
+  }
+
+  stopSearch();
+
+  m_model->removeRows(0, m_model->rowCount());
+  ui->progressBar->setValue(0);
+
+  if (sgp4.count() == 0)
+  {
+    return;
+  }
+
+  satPassParams_t params;
+
+  params.days = ui->spinBox_days->value();
+  params.minElev = D2R(ui->spinBox_elev->value());
+  params.visibleOnly = ui->checkBox_visible->isChecked();
+
+  m_passes = new CSatPasses(&m_view, params);
+
+  connect(m_passes, SIGNAL(sigProgress(int)), this, SLOT(slotProgress(int)), Qt::QueuedConnection);
+  connect(m_passes, SIGNAL(sigDone()), this, SLOT(slotDone()), Qt::QueuedConnection);
+
+  ui->pushButton_3->setText(tr("Stop"));
+  m_passes->start();
+}
+
+// ok
+////////////////////////////////////////////
+void CSatPassesDlg::on_pushButton_2_clicked()
+////////////////////////////////////////////
+{
+  QModelIndexList il = ui->treeView->selectionModel()->selectedIndexes();
+  if (il.count() == 0)
+    return;
+
+  QModelIndex index = m_proxy->mapToSource(il.at(0));
+  QStandardItem *item = m_model->item(index.row(), 0);
+  int sat = item->data().toInt();
+  satellite_t s;
+
+  m_jd = item->data(Qt::UserRole + 2).toDouble();
+  m_view.jd = m_jd;
+
+  sgp4.setObserver(&m_view);
+  if (!sgp4.solve(sat, &m_view, &s))
+  {
+    msgBoxError(this, tr("Cannot compute!"));
+    return;
+  }
+
+  cAstro.setParam(&m_view);
+  cAstro.convAA2RDRef(s.azimuth, s.elevation, &m_ra, &m_dec);
+
+  m_fov = getOptObjFov(0, 0, D2R(2.5));
+
+  m_mapObj.type = MO_SATELLITE;
+  m_mapObj.par1 = sat;
+  m_mapObj.par2 = 0;
+
+  stopSearch();
+  done(DL_OK);
+}
+
+//////////////////////////////////////////////////////////////////
+void CSatPassesDlg::on_treeView_doubleClicked(const QModelIndex &)
+//////////////////////////////////////////////////////////////////
+{
+  on_pushButton_2_clicked();
+}
+
+// cancel
+//////////////////////////////////////////
+void CSatPassesDlg::on_pushButton_clicked()
+//////////////////////////////////////////
+{
+  stopSearch();
+  done(DL_CANCEL);
+}
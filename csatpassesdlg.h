@@ -0,0 +1,69 @@
+#ifndef CSATPASSESDLG_H
+#define CSATPASSESDLG_H
+
+#include "skcore.h"
+#include "mapobj.h"
+#include "csatpasses.h"
+
+#include <QDialog>
+
+namespace Ui {
+  class CSatPassesDlg;
+}
+
+class MyProxyPassModel: public QSortFilterProxyModel
+{
+protected:
+   bool lessThan(const QModelIndex& left, const QModelIndex& right) const
+   {
+     if (sortColumn() >= 1 && sortColumn() <= 7)
+     {
+       return (left.data(Qt::UserRole + 1).toDouble() < right.data(Qt::UserRole + 1).toDouble());
+     }
+
+     QVariant leftData = sourceModel()->data(left);
+     QVariant rightData = sourceModel()->data(right);
+
+     return QString::localeAwareCompare(leftData.toString(), rightData.toString()) < 0;
+   }
+};
+
+class CSatPassesDlg : public QDialog
+{
+  Q_OBJECT
+
+public:
+  explicit CSatPassesDlg(QWidget *parent, mapView_t *view);
+  ~CSatPassesDlg();
+
+  double   m_ra;
+  double   m_dec;
+  double   m_fov;
+  double   m_jd;
+  mapObj_t m_mapObj;
+
+protected:
+  void stopSearch();
+
+  mapView_t           m_view;
+  CSatPasses         *m_passes;
+  MyProxyPassModel   *m_proxy;
+  QStandardItemModel *m_model;
+
+private slots:
+  void slotProgress(int percent);
+  void slotDone();
+
+  void on_pushButton_3_clicked();
+
+  void on_pushButton_2_clicked();
+
+  void on_treeView_doubleClicked(const QModelIndex &index);
+
+  void on_pushButton_clicked();
+
+private:
+  Ui::CSatPassesDlg *ui;
+};
+
+#endif // CSATPASSESDLG_H
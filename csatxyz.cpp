@@ -59,10 +59,11 @@ QString DS(double val)
   return QString::number(val, 'f', 10);
 }
 
-inline bool sphereIntersection(double *d, double *sphere_pos, double sphere_rad, double hit[3])
+// dist = sphere center to the line distance
+inline bool sphereIntersection(double *d, double *sphere_pos, double sphere_rad, double hit[3], double &dist)
 {
   double dn[3],w[3],closest_point[3];
-  double mag_d,dist,w_dist,int_dist;
+  double mag_d,w_dist,int_dist;
 
   w[0] = sphere_pos[0];
   w[1] = sphere_pos[1];
@@ -77,6 +78,7 @@ inline bool sphereIntersection(double *d, double *sphere_pos, double sphere_rad,
     int_dist = sqrt(w[0] * w[0] +
                     w[1] * w[1] +
                     w[2] * w[2]);
+    dist = int_dist;
     return (int_dist < sphere_rad);
   }
 
@@ -89,6 +91,14 @@ inline bool sphereIntersection(double *d, double *sphere_pos, double sphere_rad,
            dn[1] * w[1] +
            dn[2] * w[2];
 
+  closest_point[0] = dn[0] * w_dist;
+  closest_point[1] = dn[1] * w_dist;
+  closest_point[2] = dn[2] * w_dist;
+
+  dist = sqrt(POW2(closest_point[0] - sphere_pos[0]) +
+              POW2(closest_point[1] - sphere_pos[1]) +
+              POW2(closest_point[2] - sphere_pos[2]));
+
   if (w_dist <= -sphere_rad)
   { // moving away from object
     return false;
@@ -99,14 +109,6 @@ inline bool sphereIntersection(double *d, double *sphere_pos, double sphere_rad,
     return false;
   }
 
-  closest_point[0] = dn[0] * w_dist;
-  closest_point[1] = dn[1] * w_dist;
-  closest_point[2] = dn[2] * w_dist;
-
-  dist = sqrt(POW2(closest_point[0] - sphere_pos[0]) +
-              POW2(closest_point[1] - sphere_pos[1]) +
-              POW2(closest_point[2] - sphere_pos[2]));
-
   if (dist < sphere_rad)
   {
     hit[0] = w_dist * dn[0];
@@ -118,8 +120,114 @@ inline bool sphereIntersection(double *d, double *sphere_pos, double sphere_rad,
 }
 
 
-void CPlanetSatellite::solve(double jd, int id, planetSatellites_t *sats, orbit_t *pln, orbit_t *sun, bool all)
+// theory results shared by all instances (mag. without the planet part)
+typedef struct
+{
+  double                     jd;
+  QList <planetSatellite_t>  sats;
+  quint64                    use;
+} psEpoch_t;
+
+typedef struct
+{
+  double                     jdFrom;
+  double                     jdTo;
+  QList <planetSatellite_t>  sats;
+  QVector <double>           coef;     // x, y, z Chebyshev coef. per satellite
+  quint64                    use;
+} psWindow_t;
+
+static QMutex             psMutex;
+static QList <psEpoch_t>  psEpochs[PT_PLANET_COUNT];
+static QList <psWindow_t> psWindows[PT_PLANET_COUNT];
+static double             psLastJD[PT_PLANET_COUNT];
+static quint64            psUse;
+
+// window length, short to the fastest moon period
+static double psSpan(int id)
 {
+  switch (id)
+  {
+    case PT_MARS:
+      return 1 / 24.0;
+
+    case PT_SATURN:
+    case PT_URANUS:
+      return 3 / 24.0;
+  }
+
+  return 6 / 24.0;
+}
+
+static double psChebyshev(const double *c, double u)
+{
+  double b0 = 0;
+  double b1 = 0;
+  double b2 = 0;
+
+  for (int k = PS_DEGREE; k >= 1; k--)
+  {
+    b2 = b1;
+    b1 = b0;
+    b0 = 2 * u * b1 - b2 + c[k];
+  }
+
+  return u * b0 - b1 + c[0];
+}
+
+static void psAddMag(QList <planetSatellite_t> &list, double dmag)
+{
+  for (int i = 0; i < list.count(); i++)
+  {
+    list[i].mag += dmag;
+  }
+}
+
+static void psEvalWindow(const psWindow_t &w, double jd, planetSatellites_t *sats)
+{
+  double mid = 0.5 * (w.jdFrom + w.jdTo);
+  double u = (jd - mid) / (0.5 * (w.jdTo - w.jdFrom));
+
+  sats->sats = w.sats;
+  for (int i = 0; i < sats->sats.count(); i++)
+  {
+    const double *c = w.coef.constData() + i * 3 * (PS_DEGREE + 1);
+
+    sats->sats[i].x = psChebyshev(c, u);
+    sats->sats[i].y = psChebyshev(c + (PS_DEGREE + 1), u);
+    sats->sats[i].z = psChebyshev(c + 2 * (PS_DEGREE + 1), u);
+  }
+}
+
+CPlanetSatellite::CPlanetSatellite()
+{
+  m_astro = &cAstro;
+  m_useCache = true;
+}
+
+double CPlanetSatellite::magOffset(int id, const orbit_t *pln)
+{
+  double fv = qAbs(R2D(pln->FV));
+
+  switch (id)
+  {
+    case PT_MARS:
+      return 5 * log10(pln->R * pln->r) + fv * (0.0380 + fv * (-0.000273 + fv * 2e-6));
+
+    case PT_JUPITER:
+      return 5 * log10(pln->R * pln->r) + 0.005 * fv;
+
+    case PT_SATURN:
+      return 5 * log10(pln->r * pln->R) + 0.044 * fv;
+  }
+
+  return 5 * log10(pln->R * pln->r);
+}
+
+void CPlanetSatellite::solveTheory(double jd, int id, planetSatellites_t *sats, orbit_t *pln)
+{
+  sats->sats.clear();
+
   switch (id)
   {
     case PT_MARS:
@@ -142,6 +250,229 @@ void CPlanetSatellite::solve(double jd, int id, planetSatellites_t *sats, orbit_
       solveNeptuneSat(jd, sats, pln);
       break;
   }
+}
+
+// Chebyshev fit of the theory over <jdFrom, jdTo>
+bool CPlanetSatellite::fitWindow(double jdFrom, double jdTo, int id, orbit_t *pln,
+                                 QList <planetSatellite_t> &sats, QVector <double> &coef)
+{
+  const int           n = PS_DEGREE + 1;
+  double              mid = 0.5 * (jdFrom + jdTo);
+  double              half = 0.5 * (jdTo - jdFrom);
+  planetSatellites_t  node[PS_DEGREE + 1];
+
+  for (int j = 0; j < n; j++)
+  {
+    solveTheory(mid + half * cos(MPI * (j + 0.5) / n), id, &node[j], pln);
+
+    if (node[j].sats.count() != node[0].sats.count())
+    {
+      return false;
+    }
+  }
+
+  sats = node[0].sats;
+  coef.fill(0, sats.count() * 3 * n);
+
+  for (int i = 0; i < sats.count(); i++)
+  {
+    for (int k = 0; k < n; k++)
+    {
+      double sum[3] = {0, 0, 0};
+
+      for (int j = 0; j < n; j++)
+      {
+        double t = cos(MPI * k * (j + 0.5) / n);
+
+        sum[0] += node[j].sats[i].x * t;
+        sum[1] += node[j].sats[i].y * t;
+        sum[2] += node[j].sats[i].z * t;
+      }
+
+      for (int c = 0; c < 3; c++)
+      {
+        coef[(i * 3 + c) * n + k] = sum[c] * ((k == 0) ? 1.0 : 2.0) / n;
+      }
+    }
+  }
+
+  return true;
+}
+
+// exact epochs are reused (one frame is solved by the map, info panel, ...),
+// epochs close to the previous one are interpolated (realtime, time-lapse)
+void CPlanetSatellite::solveCached(double jd, int id, planetSatellites_t *sats, orbit_t *pln)
+{
+  double dmag = magOffset(id, pln);
+  double span = psSpan(id);
+  bool   sequence;
+  bool   forward;
+
+  psMutex.lock();
+
+  for (int i = 0; i < psEpochs[id].count(); i++)
+  {
+    if (psEpochs[id][i].jd == jd)
+    {
+      psEpochs[id][i].use = ++psUse;
+      sats->sats = psEpochs[id][i].sats;
+      psMutex.unlock();
+      psAddMag(sats->sats, dmag);
+      return;
+    }
+  }
+
+  for (int i = 0; i < psWindows[id].count(); i++)
+  {
+    if (jd >= psWindows[id][i].jdFrom && jd <= psWindows[id][i].jdTo)
+    {
+      psWindows[id][i].use = ++psUse;
+      psEvalWindow(psWindows[id][i], jd, sats);
+      psMutex.unlock();
+      psAddMag(sats->sats, dmag);
+      return;
+    }
+  }
+
+  sequence = qAbs(jd - psLastJD[id]) < span;
+  forward = jd >= psLastJD[id];
+  psLastJD[id] = jd;
+
+  psMutex.unlock();
+
+  if (sequence)
+  {
+    psWindow_t w;
+
+    w.jdFrom = forward ? jd : jd - span;
+    w.jdTo = forward ? jd + span : jd;
+
+    if (fitWindow(w.jdFrom, w.jdTo, id, pln, w.sats, w.coef))
+    {
+      psAddMag(w.sats, -dmag);
+      psEvalWindow(w, jd, sats);
+      psAddMag(sats->sats, dmag);
+
+      QMutexLocker locker(&psMutex);
+
+      w.use = ++psUse;
+      if (psWindows[id].count() >= PS_CACHE_WINDOWS)
+      {
+        int old = 0;
+
+        for (int i = 1; i < psWindows[id].count(); i++)
+        {
+          if (psWindows[id][i].use < psWindows[id][old].use)
+            old = i;
+        }
+        psWindows[id].removeAt(old);
+      }
+      psWindows[id].append(w);
+      return;
+    }
+  }
+
+  psEpoch_t e;
+
+  solveTheory(jd, id, sats, pln);
+
+  e.jd = jd;
+  e.sats = sats->sats;
+  psAddMag(e.sats, -dmag);
+
+  QMutexLocker locker(&psMutex);
+
+  e.use = ++psUse;
+  if (psEpochs[id].count() >= PS_CACHE_EPOCHS)
+  {
+    int old = 0;
+
+    for (int i = 1; i < psEpochs[id].count(); i++)
+    {
+      if (psEpochs[id][i].use < psEpochs[id][old].use)
+        old = i;
+    }
+    psEpochs[id].removeAt(old);
+  }
+  psEpochs[id].append(e);
+}
+
+// compares the interpolation windows with the theory between the nodes (regression check)
+bool CPlanetSatellite::check()
+{
+  static const int planet[5] = {PT_MARS, PT_JUPITER, PT_SATURN, PT_URANUS, PT_NEPTUNE};
+
+  CPlanetSatellite ps;
+  orbit_t          pln;
+  bool             ok = true;
+
+  memset(&pln, 0, sizeof(pln)); // the theories don't use it
+
+  for (int p = 0; p < 5; p++)
+  {
+    int    id = planet[p];
+    double span = psSpan(id);
+    double maxErr = 0;
+
+    // 1900 AD .. 2100 AD
+    for (int i = 0; i < PS_CHECK_WINDOWS; i++)
+    {
+      psWindow_t w;
+
+      w.jdFrom = 2415020.5 + i * (73049.0 / PS_CHECK_WINDOWS);
+      w.jdTo = w.jdFrom + span;
+
+      if (!ps.fitWindow(w.jdFrom, w.jdTo, id, &pln, w.sats, w.coef))
+      {
+        continue;
+      }
+
+      // window ends and midpoints between the nodes
+      for (int j = 0; j <= PS_CHECK_STEPS; j++)
+      {
+        double             jd = w.jdFrom + span * j / PS_CHECK_STEPS;
+        planetSatellites_t fit;
+        planetSatellites_t ref;
+
+        psEvalWindow(w, jd, &fit);
+        ps.solveTheory(jd, id, &ref, &pln);
+
+        if (fit.sats.count() != ref.sats.count())
+        {
+          ok = false;
+          continue;
+        }
+
+        for (int s = 0; s < ref.sats.count(); s++)
+        {
+          maxErr = qMax(maxErr, qAbs(fit.sats[s].x - ref.sats[s].x));
+          maxErr = qMax(maxErr, qAbs(fit.sats[s].y - ref.sats[s].y));
+          maxErr = qMax(maxErr, qAbs(fit.sats[s].z - ref.sats[s].z));
+        }
+      }
+    }
+
+    if (maxErr > PS_CHECK_TOL)
+    {
+      ok = false;
+    }
+
+    qDebug() << "planet moons" << id << "span" << span * 24 << "h err" << maxErr << "tol" << PS_CHECK_TOL;
+  }
+
+  return ok;
+}
+
+void CPlanetSatellite::solve(double jd, int id, planetSatellites_t *sats, orbit_t *pln, orbit_t *sun, bool all)
+{
+  if (m_useCache)
+  {
+    solveCached(jd, id, sats, pln);
+  }
+  else
+  {
+    solveTheory(jd, id, sats, pln);
+  }
 
   for (int i = 0; i < sats->sats.count(); i++)
   {
@@ -209,11 +540,14 @@ void CPlanetSatellite::solve(double jd, int id, planetSatellites_t *sats, orbit_
     double sar = POW2(s->x + pr[0]) + POW2(s->y + pr[1]) + POW2(s->z + pr[2]);
 
     double hitPoint[3];
+    double shadowDist;
     bool   shadow = false;
 
     s->isInLight = true;
 
-    bool hit = sphereIntersection(mn, pr, mul, hitPoint);
+    bool hit = sphereIntersection(mn, pr, mul, hitPoint, shadowDist);
+
+    s->shadowDist = shadowDist / mul;
 
     if (hit && sar > plr)
     {
@@ -263,7 +597,7 @@ void CPlanetSatellite::solve(double jd, int id, planetSatellites_t *sats, orbit_
       s->sRD.Ra = atan2(y, x);
       s->sRD.Dec = atan2(z, sqrt(x * x + y * y));
 
-      cAstro.calcParallax(&s->sRD, s->R);
+      m_astro->calcParallax(&s->sRD, s->R);
     }
     else
     {
@@ -284,9 +618,9 @@ void CPlanetSatellite::solve(double jd, int id, planetSatellites_t *sats, orbit_
     s->lRD.Ra = s->gRD.Ra;
     s->lRD.Dec = s->gRD.Dec;
 
-    s->size = cAstro.calcAparentSize(s->R, s->diameter);
+    s->size = CAstro::calcAparentSize(s->R, s->diameter);
 
-    cAstro.calcParallax(&s->lRD, s->R);
+    m_astro->calcParallax(&s->lRD, s->R);
 
     double r2 = pln->lRD.Ra;
     double d2 = pln->lRD.Dec;
@@ -345,8 +679,7 @@ void CPlanetSatellite::solveMarsSat(double jd, planetSatellites_t *sats, orbit_t
   double td = jd - 2441266.5;
   double ty = td / 365.25;
 
-  double fv = qAbs(R2D(pln->FV));
-  double dmag = 5 * log10(pln->R * pln->r) + fv * (0.0380 + fv * (-0.000273 + fv * 2e-6));
+  double dmag = magOffset(PT_MARS, pln);
 
   for (int b = 0; b < 2; b++)
   {
@@ -492,8 +825,7 @@ void CPlanetSatellite::solveJupiterSat(double jd, planetSatellites_t *sats, orbi
   QString name;
   double  diameter;
   double  mag;
-  double fv = qAbs(R2D(pln->FV));
-  double  dmag = 5 * log10(pln->R * pln->r) + 0.005 * fv;
+  double  dmag = magOffset(PT_JUPITER, pln);
 
   for (int b = 0; b < 4; b++)
   {
@@ -1180,7 +1512,7 @@ void CPlanetSatellite::solveUranusSat(double jd, planetSatellites_t *sats, orbit
   double diameter;
   QString name;
   double mag;
-  double dmag = 5 * log10(pln->R * pln->r);
+  double dmag = magOffset(PT_URANUS, pln);
 
   for (int b = 0; b < 5; b++)
   {
@@ -1611,7 +1943,7 @@ void CPlanetSatellite::solveNeptuneSat(double jd, planetSatellites_t *sats, orbi
     double diameter;
     QString name;
     double  mag;
-    double dmag = 5 * log10(pln->R * pln->r);
+    double dmag = magOffset(PT_NEPTUNE, pln);
 
     for (int b = 0; b < 2; b++)
     {
@@ -1843,8 +2175,7 @@ void CPlanetSatellite::solveSaturnSat(double jd, planetSatellites_t *sats, orbit
   QString name;
   double  diameter;
   double  mag;
-  double fv = qAbs(R2D(pln->FV));
-  double dmag = 5 * log10(pln->r * pln->R) + 0.044 * fv;
+  double dmag = magOffset(PT_SATURN, pln);
 
   for (int b = 0; b < 9; b++)
   {
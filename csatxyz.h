@@ -3,7 +3,14 @@
 
 #include "castro.h"
 
-#define MAX_XYZ_SATS  10
+#define MAX_XYZ_SATS      10
+
+#define PS_CACHE_EPOCHS   16    // exact solutions per planet
+#define PS_CACHE_WINDOWS  4     // interpolation windows per planet
+#define PS_DEGREE         8     // Chebyshev polynomial degree
+#define PS_CHECK_WINDOWS  32    // windows per planet checked by check()
+#define PS_CHECK_STEPS    24    // samples per checked window
+#define PS_CHECK_TOL      1e-9  // max. interpolation error (planet radii)
 
 typedef struct
 {
@@ -16,6 +23,7 @@ typedef struct
   double   R;            // geocentric distance
 
   double   distance;     // ang. distance from planet center
+  double   shadowDist;   // planet center to the Sun-satellite line (in planet radii)
   double   mag;
   double   diameter; // in km
   double   size;     // in arcsec
@@ -37,9 +45,20 @@ typedef struct
 class CPlanetSatellite
 {
 public:
+  CPlanetSatellite();
+  void setAstro(CAstro *astro) { m_astro = astro; }
+  void setCache(bool enable) { m_useCache = enable; }
   void solve(double jd, int id, planetSatellites_t *sats, orbit_t *pln, orbit_t *sun, bool all = true);
 
+  static double magOffset(int id, const orbit_t *pln);
+  static bool check();
+
 private:
+  void solveTheory(double jd, int id, planetSatellites_t *sats, orbit_t *pln);
+  void solveCached(double jd, int id, planetSatellites_t *sats, orbit_t *pln);
+  bool fitWindow(double jdFrom, double jdTo, int id, orbit_t *pln,
+                 QList <planetSatellite_t> &sats, QVector <double> &coef);
+
   void computeArguments(double t, double &l1, double &l2, double &l3, double &l4, double &om1, double &om2, double &om3, double &om4, double &psi, double &Gp, double &G);
 
   void solveJupiterSat(double jd, planetSatellites_t *sats, orbit_t *pln);
@@ -47,6 +66,9 @@ private:
   void solveUranusSat(double jd, planetSatellites_t *sats, orbit_t *pln);
   void solveNeptuneSat(double jd, planetSatellites_t *sats, orbit_t *pln);
   void solveSaturnSat(double jd, planetSatellites_t *sats, orbit_t *pln);
+
+  CAstro *m_astro;
+  bool    m_useCache;
 };
 
 
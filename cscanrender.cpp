@@ -2,10 +2,415 @@
 #include "omp.h"
 #include "skcore.h"
 
-//#define PARALLEL_OMP
+#if defined(__AVX2__)
+  #include <immintrin.h>
+  #define SCAN_USE_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define SCAN_USE_SSE2
+#endif
+
+#define SCAN_FP                   16
+#define SCAN_ONE                  (1 << SCAN_FP)
+
+// polygons with fewer rows are rendered by the calling thread only
+#define SCAN_PARALLEL_MIN_ROWS    64
 
 CScanRender scanRender;
 
+// 8 bit weight of the fixed point fraction
+static inline int scanFrac(int f)
+{
+  return (f >> (SCAN_FP - 8)) & 0xff;
+}
+
+// bilinear filter of one ARGB32 texel, ix + 1 and iy + 1 must be inside texture
+////////////////////////////////////////////////////////////////////////////////////
+static inline quint32 scanBilinear(const quint32 *src, int stride, int fu, int fv)
+////////////////////////////////////////////////////////////////////////////////////
+{
+  const quint32 *p = src + (fu >> SCAN_FP) + (fv >> SCAN_FP) * stride;
+  int fx = scanFrac(fu);
+  int fy = scanFrac(fv);
+  quint32 a = p[0];
+  quint32 b = p[1];
+  quint32 c = p[stride];
+  quint32 d = p[stride + 1];
+  quint32 out = 0;
+
+  for (int sh = 0; sh < 32; sh += 8)
+  {
+    int top = (((a >> sh) & 0xff) * (256 - fx) + ((b >> sh) & 0xff) * fx) >> 8;
+    int bottom = (((c >> sh) & 0xff) * (256 - fx) + ((d >> sh) & 0xff) * fx) >> 8;
+
+    out |= (quint32)((top * (256 - fy) + bottom * fy) >> 8) << sh;
+  }
+
+  return(out);
+}
+
+// dst = lerp(dst, src, srcAlpha * opacity), result is opaque
+////////////////////////////////////////////////////////////////
+static inline quint32 scanBlend(quint32 s, quint32 d, int op256)
+////////////////////////////////////////////////////////////////
+{
+  int a = ((s >> 24) * op256) >> 8;
+
+  if (a == 0)
+  {
+    return(d);
+  }
+
+  quint32 out = 0xFF000000;
+
+  for (int sh = 0; sh < 24; sh += 8)
+  {
+    out |= (quint32)((((d >> sh) & 0xff) * (256 - a) + ((s >> sh) & 0xff) * a) >> 8) << sh;
+  }
+
+  return(out);
+}
+
+#ifdef SCAN_USE_SSE2
+
+// load four texels by index
+////////////////////////////////////////////////////////////////////
+static inline __m128i scanFetch4(const quint32 *src, const int *idx)
+////////////////////////////////////////////////////////////////////
+{
+#ifdef SCAN_USE_AVX2
+  return _mm_i32gather_epi32((const int *)src, _mm_loadu_si128((const __m128i *)idx), 4);
+#else
+  return _mm_set_epi32(src[idx[3]], src[idx[2]], src[idx[1]], src[idx[0]]);
+#endif
+}
+
+// spread four 32 bit weights (0..256) to 16 bit channel weights of pixels 0,1 and 2,3
+/////////////////////////////////////////////////////////////////////////////
+static inline void scanSplatWeights(__m128i w, __m128i &lo, __m128i &hi)
+/////////////////////////////////////////////////////////////////////////////
+{
+  __m128i w16 = _mm_packs_epi32(w, w);
+
+  w16 = _mm_unpacklo_epi16(w16, w16);
+  lo = _mm_unpacklo_epi32(w16, w16);
+  hi = _mm_unpackhi_epi32(w16, w16);
+}
+
+// (p * (256 - f) + q * f) >> 8 for 16 bit channels
+//////////////////////////////////////////////////////////////////
+static inline __m128i scanLerp16(__m128i p, __m128i q, __m128i f)
+//////////////////////////////////////////////////////////////////
+{
+  const __m128i w256 = _mm_set1_epi16(256);
+
+  return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(p, _mm_sub_epi16(w256, f)),
+                                      _mm_mullo_epi16(q, f)), 8);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+static inline __m128i scanBilinear4(__m128i a, __m128i b, __m128i c, __m128i d, __m128i fx, __m128i fy)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i fxLo, fxHi;
+  __m128i fyLo, fyHi;
+
+  scanSplatWeights(fx, fxLo, fxHi);
+  scanSplatWeights(fy, fyLo, fyHi);
+
+  __m128i lo = scanLerp16(scanLerp16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), fxLo),
+                          scanLerp16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero), fxLo), fyLo);
+
+  __m128i hi = scanLerp16(scanLerp16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), fxHi),
+                          scanLerp16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero), fxHi), fyHi);
+
+  return _mm_packus_epi16(lo, hi);
+}
+
+///////////////////////////////////////////////////////////////////
+static inline __m128i scanBlend4(__m128i s, __m128i d, int op256)
+///////////////////////////////////////////////////////////////////
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i aLo, aHi;
+  __m128i a = _mm_srli_epi32(_mm_mullo_epi16(_mm_srli_epi32(s, 24), _mm_set1_epi32(op256)), 8);
+
+  scanSplatWeights(a, aLo, aHi);
+
+  __m128i lo = scanLerp16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero), aLo);
+  __m128i hi = scanLerp16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero), aHi);
+  __m128i out = _mm_or_si128(_mm_packus_epi16(lo, hi), _mm_set1_epi32((int)0xFF000000));
+  __m128i keep = _mm_cmpeq_epi32(a, zero); // transparent texels leave dst untouched
+
+  return _mm_or_si128(_mm_and_si128(keep, d), _mm_andnot_si128(keep, out));
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+static void scanSpanNI(quint32 *pDst, const quint32 *src, int stride, int count, int *fuv, int *fduv)
+////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  int fu = fuv[0];
+  int fv = fuv[1];
+  int x = 0;
+
+#ifdef SCAN_USE_SSE2
+  const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+
+  for (; x + 4 <= count; x += 4)
+  {
+    int idx[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+      idx[i] = (fu >> SCAN_FP) + (fv >> SCAN_FP) * stride;
+      fu += fduv[0];
+      fv += fduv[1];
+    }
+    _mm_storeu_si128((__m128i *)(pDst + x), _mm_or_si128(scanFetch4(src, idx), alpha));
+  }
+#endif
+
+  for (; x < count; x++)
+  {
+    pDst[x] = src[(fu >> SCAN_FP) + (fv >> SCAN_FP) * stride] | 0xFF000000;
+    fu += fduv[0];
+    fv += fduv[1];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+static void scanSpanBI(quint32 *pDst, const quint32 *src, int stride, int count, int *fuv, int *fduv)
+////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  int fu = fuv[0];
+  int fv = fuv[1];
+  int x = 0;
+
+#ifdef SCAN_USE_SSE2
+  const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+
+  for (; x + 4 <= count; x += 4)
+  {
+    int idx[4];
+    int idxB[4];
+    int idxC[4];
+    int idxD[4];
+    int wx[4];
+    int wy[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+      idx[i] = (fu >> SCAN_FP) + (fv >> SCAN_FP) * stride;
+      idxB[i] = idx[i] + 1;
+      idxC[i] = idx[i] + stride;
+      idxD[i] = idx[i] + stride + 1;
+      wx[i] = scanFrac(fu);
+      wy[i] = scanFrac(fv);
+      fu += fduv[0];
+      fv += fduv[1];
+    }
+
+    __m128i out = scanBilinear4(scanFetch4(src, idx), scanFetch4(src, idxB),
+                                scanFetch4(src, idxC), scanFetch4(src, idxD),
+                                _mm_loadu_si128((const __m128i *)wx), _mm_loadu_si128((const __m128i *)wy));
+
+    _mm_storeu_si128((__m128i *)(pDst + x), _mm_or_si128(out, alpha));
+  }
+#endif
+
+  for (; x < count; x++)
+  {
+    pDst[x] = scanBilinear(src, stride, fu, fv) | 0xFF000000;
+    fu += fduv[0];
+    fv += fduv[1];
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void scanSpanAlphaNI(quint32 *pDst, const quint32 *src, int stride, int count, int *fuv, int *fduv, int op256)
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  int fu = fuv[0];
+  int fv = fuv[1];
+  int x = 0;
+
+#ifdef SCAN_USE_SSE2
+  for (; x + 4 <= count; x += 4)
+  {
+    int idx[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+      idx[i] = (fu >> SCAN_FP) + (fv >> SCAN_FP) * stride;
+      fu += fduv[0];
+      fv += fduv[1];
+    }
+
+    __m128i d = _mm_loadu_si128((const __m128i *)(pDst + x));
+    _mm_storeu_si128((__m128i *)(pDst + x), scanBlend4(scanFetch4(src, idx), d, op256));
+  }
+#endif
+
+  for (; x < count; x++)
+  {
+    pDst[x] = scanBlend(src[(fu >> SCAN_FP) + (fv >> SCAN_FP) * stride], pDst[x], op256);
+    fu += fduv[0];
+    fv += fduv[1];
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void scanSpanAlphaBI(quint32 *pDst, const quint32 *src, int stride, int count, int *fuv, int *fduv, int op256)
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  int fu = fuv[0];
+  int fv = fuv[1];
+  int x = 0;
+
+#ifdef SCAN_USE_SSE2
+  for (; x + 4 <= count; x += 4)
+  {
+    int idx[4];
+    int idxB[4];
+    int idxC[4];
+    int idxD[4];
+    int wx[4];
+    int wy[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+      idx[i] = (fu >> SCAN_FP) + (fv >> SCAN_FP) * stride;
+      idxB[i] = idx[i] + 1;
+      idxC[i] = idx[i] + stride;
+      idxD[i] = idx[i] + stride + 1;
+      wx[i] = scanFrac(fu);
+      wy[i] = scanFrac(fv);
+      fu += fduv[0];
+      fv += fduv[1];
+    }
+
+    __m128i s = scanBilinear4(scanFetch4(src, idx), scanFetch4(src, idxB),
+                              scanFetch4(src, idxC), scanFetch4(src, idxD),
+                              _mm_loadu_si128((const __m128i *)wx), _mm_loadu_si128((const __m128i *)wy));
+    __m128i d = _mm_loadu_si128((const __m128i *)(pDst + x));
+
+    _mm_storeu_si128((__m128i *)(pDst + x), scanBlend4(s, d, op256));
+  }
+#endif
+
+  for (; x < count; x++)
+  {
+    pDst[x] = scanBlend(scanBilinear(src, stride, fu, fv), pDst[x], op256);
+    fu += fduv[0];
+    fv += fduv[1];
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+static void scanSpanNI8(quint32 *pDst, const uchar *src, int stride, int count, int *fuv, int *fduv)
+///////////////////////////////////////////////////////////////////////////////////////////////
+{
+  int fu = fuv[0];
+  int fv = fuv[1];
+
+  for (int x = 0; x < count; x++)
+  {
+    uchar c = src[(fu >> SCAN_FP) + (fv >> SCAN_FP) * stride];
+
+    pDst[x] = qRgb(c, c, c);
+    fu += fduv[0];
+    fv += fduv[1];
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+static void scanSpanBI8(quint32 *pDst, const uchar *src, int stride, int count, int *fuv, int *fduv)
+///////////////////////////////////////////////////////////////////////////////////////////////
+{
+  int fu = fuv[0];
+  int fv = fuv[1];
+
+  for (int x = 0; x < count; x++)
+  {
+    const uchar *p = src + (fu >> SCAN_FP) + (fv >> SCAN_FP) * stride;
+    int fx = scanFrac(fu);
+    int fy = scanFrac(fv);
+    int top = (p[0] * (256 - fx) + p[1] * fx) >> 8;
+    int bottom = (p[stride] * (256 - fx) + p[stride + 1] * fx) >> 8;
+    int c = (top * (256 - fy) + bottom * fy) >> 8;
+
+    pDst[x] = qRgb(c, c, c);
+    fu += fduv[0];
+    fv += fduv[1];
+  }
+}
+
+// clip span to screen and convert uv to fixed point texel coordinates,
+// both span ends are clamped to <0, maxUV> so every texel fetch stays inside
+////////////////////////////////////////////////////////////////////////////////////////////
+static bool scanPrepareSpan(bkScan_t *scan, int w, float tsx, float tsy, int maxU, int maxV,
+                            int &px1, int &count, int *fuv, int *fduv)
+////////////////////////////////////////////////////////////////////////////////////////////
+{
+  if (scan->scan[0] > scan->scan[1])
+  {
+    qSwap(scan->scan[0], scan->scan[1]);
+    qSwap(scan->uv[0][0], scan->uv[1][0]);
+    qSwap(scan->uv[0][1], scan->uv[1][1]);
+  }
+
+  px1 = scan->scan[0];
+  int px2 = scan->scan[1];
+
+  float dx = px2 - px1;
+  if (dx == 0)
+    return(false);
+
+  double duv[2];
+  double uv[2];
+
+  duv[0] = (scan->uv[1][0] - scan->uv[0][0]) / dx;
+  duv[1] = (scan->uv[1][1] - scan->uv[0][1]) / dx;
+
+  uv[0] = scan->uv[0][0];
+  uv[1] = scan->uv[0][1];
+
+  if (px1 < 0)
+  {
+    double m = -px1;
+
+    px1 = 0;
+    uv[0] += duv[0] * m;
+    uv[1] += duv[1] * m;
+  }
+
+  if (px2 >= w)
+    px2 = w - 1;
+
+  count = px2 - px1;
+  if (count <= 0)
+    return(false);
+
+  double ts[2] = {tsx * (double)SCAN_ONE, tsy * (double)SCAN_ONE};
+  int    maxF[2] = {maxU, maxV};
+
+  for (int k = 0; k < 2; k++)
+  {
+    double start = CLAMP(uv[k] * ts[k], 0, maxF[k]);
+    double end = CLAMP((uv[k] + duv[k] * (count - 1)) * ts[k], 0, maxF[k]);
+
+    fuv[k] = (int)start;
+    fduv[k] = (count > 1) ? (int)((end - start) / (count - 1)) : 0;
+  }
+
+  return(true);
+}
+
 //////////////////////////////
 CScanRender::CScanRender(void)
 //////////////////////////////
@@ -41,10 +446,23 @@ void CScanRender::resetScanPoly(int sx, int sy)
     return;
   }
 
+  if (scLR.count() < sy)
+  {
+    scLR.resize(sy);
+  }
+
   m_sx = sx;
   m_sy = sy;
 }
 
+// large polygons are split into scanline bands across threads
+/////////////////////////////////////////
+bool CScanRender::isParallel(void) const
+/////////////////////////////////////////
+{
+  return(plMaxY - plMinY >= SCAN_PARALLEL_MIN_ROWS && !omp_in_parallel());
+}
+
 //////////////////////////////////////////////////////////
 void CScanRender::scanLine(int x1, int y1, int x2, int y2)
 //////////////////////////////////////////////////////////
@@ -112,24 +530,27 @@ void CScanRender::scanLine(int x1, int y1, int x2, int y2)
 
   int fx = (int)(x * (float)(1 << FP));
   int fdx = (int)(dx * (float)(1 << FP));
+  bkScan_t *scan = scLR.data();
 
   for (y = y1; y <= y2; y++)
   {
-    scLR[y].scan[side] = fx >> FP;
+    scan[y].scan[side] = fx >> FP;
     fx += fdx;
   }
 
 #else
 
+  bkScan_t *scan = scLR.data();
+
   for (y = y1; y <= y2; y++)
   {
     if (side == 1)
     { // side left
-      scLR[y].scan[0] = float2int(x);
+      scan[y].scan[0] = float2int(x);
     }
     else
     { // side right
-      scLR[y].scan[1] = float2int(x);
+      scan[y].scan[1] = float2int(x);
     }
     x += dx;
   }
@@ -199,11 +620,13 @@ void CScanRender::scanLine(int x1, int y1, int x2, int y2, float u1, float v1, f
   if (maxY > plMaxY)
     plMaxY = maxY;
 
+  bkScan_t *scan = scLR.data();
+
   for (y = y1; y <= y2; y++)
   {
-    scLR[y].scan[side] = (int)x;
-    scLR[y].uv[side][0] = uv[0];
-    scLR[y].uv[side][1] = uv[1];
+    scan[y].scan[side] = (int)x;
+    scan[y].uv[side][0] = uv[0];
+    scan[y].uv[side][1] = uv[1];
 
     x += dx;
 
@@ -220,8 +643,9 @@ void CScanRender::renderPolygon(QColor col, QImage *dst)
   quint32   c = col.rgb();
   quint32  *bits = (quint32 *)dst->bits();
   int       dw = dst->width();
-  bkScan_t *scan = scLR;
+  bkScan_t *scan = scLR.data();
 
+  #pragma omp parallel for if (isParallel())
   for (int y = plMinY; y <= plMaxY; y++)
   {
     int px1 = scan[y].scan[0];
@@ -267,12 +691,13 @@ void CScanRender::renderPolygonAlpha(QColor col, QImage *dst)
   quint32   c = col.rgba();
   quint32  *bits = (quint32 *)dst->bits();
   int       dw = dst->width();
-  bkScan_t *scan = scLR;
+  bkScan_t *scan = scLR.data();
   float     a = qAlpha(c) / 256.0f;
   int       rc = qRed(c);
   int       gc = qGreen(c);
   int       bc = qBlue(c);
 
+  #pragma omp parallel for if (isParallel())
   for (int y = plMinY; y <= plMaxY; y++)
   {
     int px1 = scan[y].scan[0];
@@ -397,98 +822,32 @@ void CScanRender::renderPolygonNI(QImage *dst, QImage *src)
   int w = dst->width();
   int sw = src->width();
   int sh = src->height();
-  float tsx = src->width() - 1;
-  float tsy = src->height() - 1;
-  const quint32 *bitsSrc = (quint32 *)src->constBits();
+  float tsx = sw - 1;
+  float tsy = sh - 1;
+  const uchar *bitsSrc = src->constBits();
   quint32 *bitsDst = (quint32 *)dst->bits();
-  bkScan_t *scan = scLR;
-  bool bw = src->format() == QImage::Format_Indexed8 || src->format() == QImage::Format_Grayscale8;      
+  bkScan_t *scan = scLR.data();
+  bool bw = src->format() == QImage::Format_Indexed8 || src->format() == QImage::Format_Grayscale8;
+  int stride = bw ? src->bytesPerLine() : src->bytesPerLine() / 4;
+  int maxU = (sw - 1) << SCAN_FP;
+  int maxV = (sh - 1) << SCAN_FP;
 
-  //#pragma omp parallel for
+  #pragma omp parallel for if (isParallel())
   for (int y = plMinY; y <= plMaxY; y++)
-  {   
-    if (scan[y].scan[0] > scan[y].scan[1])
-    {
-      qSwap(scan[y].scan[0], scan[y].scan[1]);
-      qSwap(scan[y].uv[0][0], scan[y].uv[1][0]);
-      qSwap(scan[y].uv[0][1], scan[y].uv[1][1]);
-    }    
-
-    int px1 = scan[y].scan[0];
-    int px2 = scan[y].scan[1];
-
-    float dx = px2 - px1;
-    if (dx == 0)
-      continue;
-
-    float duv[2];
-    float uv[2];
-
-    duv[0] = (float)(scan[y].uv[1][0] - scan[y].uv[0][0]) / dx;
-    duv[1] = (float)(scan[y].uv[1][1] - scan[y].uv[0][1]) / dx;
-
-    uv[0] = scan[y].uv[0][0];
-    uv[1] = scan[y].uv[0][1];
-
-    if (px1 < 0)
-    {
-      float m = (float)-px1;
-
-      px1 = 0;
-      uv[0] += duv[0] * m;
-      uv[1] += duv[1] * m;
-    }
-
-    if (px2 >= w)
-      px2 = w - 1;
-
-    uv[0] *= tsx;
-    uv[1] *= tsy;
-
-    duv[0] *= tsx;
-    duv[1] *= tsy;
-
-    quint32 *pDst = bitsDst + (y * w) + px1;
-
+  {
+    int px1, count;
     int fuv[2];
     int fduv[2];
 
-    fuv[0] = uv[0] * 65536;
-    fuv[1] = uv[1] * 65536;
-
-    fduv[0] = duv[0] * 65536;    
-    fduv[1] = duv[1] * 65536;
+    if (!scanPrepareSpan(&scan[y], w, tsx, tsy, maxU, maxV, px1, count, fuv, fduv))
+      continue;
 
-    fuv[0] = CLAMP(fuv[0], 0, (sw - 1) * 65536.);
-    fuv[1] = CLAMP(fuv[1], 0, (sh - 1) * 65536.);
+    quint32 *pDst = bitsDst + (y * w) + px1;
 
     if (bw)
-    {
-      for (int x = px1; x < px2; x++)
-      {
-        const uchar *pSrc = (uchar *)bitsSrc + (fuv[0] >> 16) + ((fuv[1] >> 16) * sw);
-        *pDst = qRgb(*pSrc, *pSrc, *pSrc);
-        pDst++;
-
-        fuv[0] += fduv[0];
-        fuv[1] += fduv[1];
-      }      
-    }
+      scanSpanNI8(pDst, bitsSrc, stride, count, fuv, fduv);
     else
-    {                  
-      for (int x = px1; x < px2; x++)
-      {        
-        int offset = (fuv[0] >> 16) + ((fuv[1] >> 16) * sw);        
-
-        const quint32 *pSrc = bitsSrc + offset;
-        *pDst = (*pSrc) | (0xFF << 24);
-
-        pDst++;
-
-        fuv[0] += fduv[0];
-        fuv[1] += fduv[1];
-      }
-    }
+      scanSpanNI(pDst, (const quint32 *)bitsSrc, stride, count, fuv, fduv);
   }
 }
 
@@ -497,133 +856,42 @@ void CScanRender::renderPolygonNI(QImage *dst, QImage *src)
 void CScanRender::renderPolygonBI(QImage *dst, QImage *src)
 ///////////////////////////////////////////////////////////
 {
-  int w = dst->width();
   int sw = src->width();
   int sh = src->height();
-  float tsx = src->width() - 1;
-  float tsy = src->height() - 1;
-  const quint32 *bitsSrc = (quint32 *)src->constBits();
-  const uchar *bitsSrc8 = (uchar *)src->constBits();
+
+  if (sw < 2 || sh < 2)
+  {
+    renderPolygonNI(dst, src);
+    return;
+  }
+
+  int w = dst->width();
+  float tsx = sw - 1;
+  float tsy = sh - 1;
+  const uchar *bitsSrc = src->constBits();
   quint32 *bitsDst = (quint32 *)dst->bits();
-  bkScan_t *scan = scLR;
+  bkScan_t *scan = scLR.data();
   bool bw = src->format() == QImage::Format_Indexed8 || src->format() == QImage::Format_Grayscale8;
+  int stride = bw ? src->bytesPerLine() : src->bytesPerLine() / 4;
+  int maxU = ((sw - 1) << SCAN_FP) - 1;
+  int maxV = ((sh - 1) << SCAN_FP) - 1;
 
-#ifdef PARALLEL_OMP
-  #pragma omp parallel for
-#endif
+  #pragma omp parallel for if (isParallel())
   for (int y = plMinY; y <= plMaxY; y++)
   {
-    if (scan[y].scan[0] > scan[y].scan[1])
-    {
-      qSwap(scan[y].scan[0], scan[y].scan[1]);
-      qSwap(scan[y].uv[0][0], scan[y].uv[1][0]);
-      qSwap(scan[y].uv[0][1], scan[y].uv[1][1]);
-    }
-
-    int px1 = scan[y].scan[0];
-    int px2 = scan[y].scan[1];
+    int px1, count;
+    int fuv[2];
+    int fduv[2];
 
-    float dx = px2 - px1;
-    if (dx == 0)
+    if (!scanPrepareSpan(&scan[y], w, tsx, tsy, maxU, maxV, px1, count, fuv, fduv))
       continue;
 
-    float duv[2];
-    float uv[2];
-
-    duv[0] = (float)(scan[y].uv[1][0] - scan[y].uv[0][0]) / dx;
-    duv[1] = (float)(scan[y].uv[1][1] - scan[y].uv[0][1]) / dx;
-
-    uv[0] = scan[y].uv[0][0];
-    uv[1] = scan[y].uv[0][1];
-
-    if (px1 < 0)
-    {
-      float m = (float)-px1;
-
-      px1 = 0;
-      uv[0] += duv[0] * m;
-      uv[1] += duv[1] * m;
-    }
-
-    if (px2 >= w)
-      px2 = w - 1;
-
-    uv[0] *= tsx;
-    uv[1] *= tsy;
-
-    duv[0] *= tsx;
-    duv[1] *= tsy;
-
-    int size = sw * sh;
-
     quint32 *pDst = bitsDst + (y * w) + px1;
-    if (bw)
-    {
-      for (int x = px1; x < px2; x++)
-      {
-        float x_diff = uv[0] - static_cast<int>(uv[0]);
-        float y_diff = uv[1] - static_cast<int>(uv[1]);
-        float x_1diff = 1 - x_diff;
-        float y_1diff = 1 - y_diff;
-
-        int index = ((int)uv[0] + ((int)uv[1] * sw));
-
-        uchar a = bitsSrc8[index];
-        uchar b = bitsSrc8[(index + 1) % size];
-        uchar c = bitsSrc8[(index + sw) % size];
-        uchar d = bitsSrc8[(index + sw + 1) % size];
-
-        int val = (a&0xff)*(x_1diff)*(y_1diff) + (b&0xff)*(x_diff)*(y_1diff) +
-                  (c&0xff)*(y_diff)*(x_1diff)   + (d&0xff)*(x_diff*y_diff);
 
-        *pDst = 0xff000000 |
-                ((((int)val)<<16)&0xff0000) |
-                ((((int)val)<<8)&0xff00) |
-                ((int)val) ;
-        pDst++;
-
-        uv[0] += duv[0];
-        uv[1] += duv[1];
-      }
-    }
+    if (bw)
+      scanSpanBI8(pDst, bitsSrc, stride, count, fuv, fduv);
     else
-    {
-      for (int x = px1; x < px2; x++)
-      {
-        float x_diff = uv[0] - static_cast<int>(uv[0]);
-        float y_diff = uv[1] - static_cast<int>(uv[1]);
-        float x_1diff = 1 - x_diff;
-        float y_1diff = 1 - y_diff;
-
-        int index = ((int)uv[0] + ((int)uv[1] * sw));
-
-        quint32 a = bitsSrc[index];
-        quint32 b = bitsSrc[(index + 1) % size];
-        quint32 c = bitsSrc[(index + sw) % size];
-        quint32 d = bitsSrc[(index + sw + 1) % size];
-
-        int qxy1 = (x_1diff * y_1diff) * 65536;
-        int qxy2 =(x_diff * y_1diff) * 65536;
-        int qxy = (x_diff * y_diff) * 65536;
-        int qyx1 = (y_diff * x_1diff) * 65536;
-
-        // blue element
-        int blue = ((a&0xff)*(qxy1) + (b&0xff)*(qxy2) + (c&0xff)*(qyx1)  + (d&0xff)*(qxy)) >> 16;
-
-        // green element
-        int green = (((a>>8)&0xff)*(qxy1) + ((b>>8)&0xff)*(qxy2) + ((c>>8)&0xff)*(qyx1)  + ((d>>8)&0xff)*(qxy)) >> 16;
-
-        // red element
-        int red = (((a>>16)&0xff)*(qxy1) + ((b>>16)&0xff)*(qxy2) +((c>>16)&0xff)*(qyx1)  + ((d>>16)&0xff)*(qxy)) >> 16;
-
-        *pDst = 0xff000000 | (((red)<<16)&0xff0000) | (((green)<<8)&0xff00) | (blue);
-
-        pDst++;
-
-        uv[0] += duv[0];
-        uv[1] += duv[1];
-      }
-    }
+      scanSpanBI(pDst, (const quint32 *)bitsSrc, stride, count, fuv, fduv);
   }
 }
 
@@ -638,149 +906,42 @@ void CScanRender::renderPolygonAlpha(QImage *dst, QImage *src)
 
 void CScanRender::renderPolygonAlphaBI(QImage *dst, QImage *src)
 {
-  int w = dst->width();
+  if (src->format() == QImage::Format_Indexed8)
+  {
+    return;
+  }
+
   int sw = src->width();
   int sh = src->height();
-  float tsx = src->width() - 1;
-  float tsy = src->height() - 1;
-  const quint32 *bitsSrc = (quint32 *)src->constBits();  
+
+  if (sw < 2 || sh < 2)
+  {
+    renderPolygonAlphaNI(dst, src);
+    return;
+  }
+
+  int w = dst->width();
+  float tsx = sw - 1;
+  float tsy = sh - 1;
+  const quint32 *bitsSrc = (quint32 *)src->constBits();
   quint32 *bitsDst = (quint32 *)dst->bits();
-  bkScan_t *scan = scLR;
-  bool bw = src->format() == QImage::Format_Indexed8;
-  float opacity = (m_opacity / 65536.) * 0.00390625f;
+  bkScan_t *scan = scLR.data();
+  int stride = src->bytesPerLine() / 4;
+  int maxU = ((sw - 1) << SCAN_FP) - 1;
+  int maxV = ((sh - 1) << SCAN_FP) - 1;
+  int op256 = CLAMP((int)(m_opacity * 256), 0, 256);
 
-#ifdef PARALLEL_OMP
-  #pragma omp parallel for shared(bitsDst, bitsSrc, scan, tsx, tsy, w, sw)
-#endif
+  #pragma omp parallel for if (isParallel())
   for (int y = plMinY; y <= plMaxY; y++)
   {
-    if (scan[y].scan[0] > scan[y].scan[1])
-    {
-      qSwap(scan[y].scan[0], scan[y].scan[1]);
-      qSwap(scan[y].uv[0][0], scan[y].uv[1][0]);
-      qSwap(scan[y].uv[0][1], scan[y].uv[1][1]);
-    }
-
-    int px1 = scan[y].scan[0];
-    int px2 = scan[y].scan[1];
+    int px1, count;
+    int fuv[2];
+    int fduv[2];
 
-    float dx = px2 - px1;
-    if (dx == 0)
+    if (!scanPrepareSpan(&scan[y], w, tsx, tsy, maxU, maxV, px1, count, fuv, fduv))
       continue;
 
-    float duv[2];
-    float uv[2];
-
-    duv[0] = (float)(scan[y].uv[1][0] - scan[y].uv[0][0]) / dx;
-    duv[1] = (float)(scan[y].uv[1][1] - scan[y].uv[0][1]) / dx;
-
-    uv[0] = scan[y].uv[0][0];
-    uv[1] = scan[y].uv[0][1];
-
-    if (px1 < 0)
-    {
-      float m = (float)-px1;
-
-      px1 = 0;
-      uv[0] += duv[0] * m;
-      uv[1] += duv[1] * m;
-    }
-
-    if (px2 >= w)
-      px2 = w - 1;
-
-    uv[0] *= tsx;
-    uv[1] *= tsy;
-
-    duv[0] *= tsx;
-    duv[1] *= tsy;
-
-    int size = sw * sh;
-
-    quint32 *pDst = bitsDst + (y * w) + px1;
-    if (bw)
-    {
-      /*
-      for (int x = px1; x < px2; x++)
-      {
-        float x_diff = uv[0] - static_cast<int>(uv[0]);
-        float y_diff = uv[1] - static_cast<int>(uv[1]);
-        float x_1diff = 1 - x_diff;
-        float y_1diff = 1 - y_diff;
-
-        int index = ((int)uv[0] + ((int)uv[1] * sw));
-
-        uchar a = bitsSrc8[index];
-        uchar b = bitsSrc8[(index + 1) % size];
-        uchar c = bitsSrc8[(index + sw) % size];
-        uchar d = bitsSrc8[(index + sw + 1) % size];
-
-        int val = (a&0xff)*(x_1diff)*(y_1diff) + (b&0xff)*(x_diff)*(y_1diff) +
-                  (c&0xff)*(y_diff)*(x_1diff)   + (d&0xff)*(x_diff*y_diff);
-
-
-        *pDst = 0xff000000 |
-                ((((int)val)<<16)&0xff0000) |
-                ((((int)val)<<8)&0xff00) |
-                ((int)val) ;
-        pDst++;
-
-        uv[0] += duv[0];
-        uv[1] += duv[1];
-      }
-      */
-    }
-    else
-    {      
-      for (int x = px1; x < px2; x++)
-      {
-        float x_diff = uv[0] - static_cast<int>(uv[0]);
-        float y_diff = uv[1] - static_cast<int>(uv[1]);
-        float x_1diff = 1 - x_diff;
-        float y_1diff = 1 - y_diff;
-
-        int index = ((int)uv[0] + ((int)uv[1] * sw));
-
-        quint32 a = bitsSrc[index];
-        quint32 b = bitsSrc[(index + 1) % size];
-        quint32 c = bitsSrc[(index + sw) % size];
-        quint32 d = bitsSrc[(index + sw + 1) % size];
-
-        int x1y1 = (x_1diff * y_1diff) * 65536;
-        int xy = (x_diff * y_diff) * 65536;
-        int x1y = (y_diff * x_1diff) * 65536;
-        int xy1 = (x_diff *y_1diff) * 65536;
-
-        float alpha = ((((a>>24)&0xff)*(x1y1) + ((b>>24)&0xff)*(xy1) +
-                        ((c>>24)&0xff)*(x1y) + ((d>>24)&0xff)*(xy)) * opacity);
-
-        if (alpha > 0.00390625f) // > 1 / 256.
-        {
-          // blue element
-          int blue = ((a&0xff)*(x1y1) + (b&0xff)* (xy1) +
-                     (c&0xff)*(x1y)  + (d&0xff)*(xy)) >> 16;
-
-          // green element
-          int green = (((a>>8)&0xff)*(x1y1) + ((b>>8)&0xff)*(xy1) +
-                      ((c>>8)&0xff)*(x1y)  + ((d>>8)&0xff)*(xy)) >> 16;
-
-          // red element
-          int red = (((a>>16)&0xff)*(x1y1) + ((b>>16)&0xff)*(xy1) +
-                    ((c>>16)&0xff)*(x1y)  + ((d>>16)&0xff)*(xy)) >> 16;
-
-          int rd = qRed(*pDst);
-          int gd = qGreen(*pDst);
-          int bd = qBlue(*pDst);
-
-          *pDst = qRgb(LERP(alpha, rd,  red), LERP(alpha, gd, green),  LERP(alpha, bd, blue));
-        }
-
-        pDst++;
-
-        uv[0] += duv[0];
-        uv[1] += duv[1];
-      }
-    }
+    scanSpanAlphaBI(bitsDst + (y * w) + px1, bitsSrc, stride, count, fuv, fduv, op256);
   }
 }
 
@@ -791,80 +952,27 @@ void CScanRender::renderPolygonAlphaNI(QImage *dst, QImage *src)
 {
   int w = dst->width();
   int sw = src->width();
-  float tsx = src->width() - 1;
-  float tsy = src->height() - 1;
+  int sh = src->height();
+  float tsx = sw - 1;
+  float tsy = sh - 1;
   const quint32 *bitsSrc = (quint32 *)src->constBits();
   quint32 *bitsDst = (quint32 *)dst->bits();
-  bkScan_t *scan = scLR;
-  float opacity = 0.00390625f * m_opacity;    
+  bkScan_t *scan = scLR.data();
+  int stride = src->bytesPerLine() / 4;
+  int maxU = (sw - 1) << SCAN_FP;
+  int maxV = (sh - 1) << SCAN_FP;
+  int op256 = CLAMP((int)(m_opacity * 256), 0, 256);
 
-#ifdef PARALLEL_OMP
-  #pragma omp parallel for shared(bitsDst, bitsSrc, scan, tsx, tsy, w, sw)
-#endif
+  #pragma omp parallel for if (isParallel())
   for (int y = plMinY; y <= plMaxY; y++)
   {
-    if (scan[y].scan[0] > scan[y].scan[1])
-    {
-      qSwap(scan[y].scan[0], scan[y].scan[1]);
-      qSwap(scan[y].uv[0][0], scan[y].uv[1][0]);
-      qSwap(scan[y].uv[0][1], scan[y].uv[1][1]);
-    }
-
-    int px1 = scan[y].scan[0];
-    int px2 = scan[y].scan[1];
+    int px1, count;
+    int fuv[2];
+    int fduv[2];
 
-    float dx = px2 - px1;
-    if (dx == 0)
+    if (!scanPrepareSpan(&scan[y], w, tsx, tsy, maxU, maxV, px1, count, fuv, fduv))
       continue;
 
-    float duv[2];
-    float uv[2];
-
-    duv[0] = (float)(scan[y].uv[1][0] - scan[y].uv[0][0]) / dx;
-    duv[1] = (float)(scan[y].uv[1][1] - scan[y].uv[0][1]) / dx;
-
-    uv[0] = scan[y].uv[0][0];
-    uv[1] = scan[y].uv[0][1];
-
-    if (px1 < 0)
-    {
-      float m = (float)-px1;
-
-      px1 = 0;
-      uv[0] += duv[0] * m;
-      uv[1] += duv[1] * m;
-    }
-
-    if (px2 >= w)
-      px2 = w - 1;
-
-    quint32 *pDst = bitsDst + (y * w) + px1;
-
-    uv[0] *= tsx;
-    uv[1] *= tsy;
-
-    duv[0] *= tsx;
-    duv[1] *= tsy;
-
-    for (int x = px1; x < px2; x++)
-    {
-      const quint32 *pSrc = bitsSrc + ((int)(uv[0])) + ((int)(uv[1]) * sw);
-      QRgb rgbs = *pSrc;
-      QRgb rgbd = *pDst;
-      float a = qAlpha(*pSrc) * opacity;
-
-      if (a > 0.00390625f)
-      {
-        *pDst = qRgb(LERP(a, qRed(rgbd), qRed(rgbs)),
-                     LERP(a, qGreen(rgbd), qGreen(rgbs)),
-                     LERP(a, qBlue(rgbd), qBlue(rgbs))
-                     );        
-      }
-      pDst++;
-
-      uv[0] += duv[0];
-      uv[1] += duv[1];
-    }
-  }  
+    scanSpanAlphaNI(bitsDst + (y * w) + px1, bitsSrc, stride, count, fuv, fduv, op256);
+  }
 }
-
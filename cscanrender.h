@@ -40,12 +40,14 @@ class CScanRender
     void setOpacity(float opacity);
 
 private:
+    bool isParallel(void) const;
+
     float    m_opacity;
     int      plMinY;
     int      plMaxY;
     int      m_sx;
     int      m_sy;
-    bkScan_t scLR[MAX_BK_SCANLINES];
+    QVector <bkScan_t> scLR;  // grows to the height of the target image
     bool     bBilinear;
 };
 
@@ -12,6 +12,37 @@
 #include "gcvs.h"
 #include "vocatalogmanager.h"
 
+///////////////////////////////////////////////////////////////////////////////////
+// candidate list for the "\bstr\b" / exact name test in ascending order
+// returns false when the pattern can't be answered from the index
+static bool minorBodyCandidates(const CNameIndex *index, const QString &str, QList <int> &list)
+///////////////////////////////////////////////////////////////////////////////////
+{
+  QStringList words = CNameIndex::words(str);
+
+  if (words.isEmpty() || QRegExp::escape(str) != str)
+  {
+    return false;
+  }
+
+  QSet <int> set;
+
+  foreach (int id, index->find(str))
+  {
+    set.insert(index->data(id));
+  }
+
+  foreach (int id, index->findWord(words.first()))
+  {
+    set.insert(index->data(id));
+  }
+
+  list = set.toList();
+  qSort(list);
+
+  return true;
+}
+
 //////////////////
 CSearch::CSearch()
 //////////////////
@@ -309,35 +340,29 @@ bool CSearch::search(mapView_t *mapView, QString str, double &ra, double &dec, d
   if (SS_CHECK_OR(SS_STAR_NAME, what))
   {
     // star names
-    for (int i = 0; i < cTYC.tNames.count(); i++)
+    foreach (int id, cTYC.tNameIndex.find(str))
     {
-      int offs = cTYC.tNames[i]->supIndex;
-      QString name = cTYC.getStarName(&cTYC.pSupplement[offs]);
-
-      if (!str.compare(name, Qt::CaseInsensitive))
-      {        
-        int reg, index;
-
-        if (cTYC.findStar(NULL, TS_TYC, 0, 0, 0, 0, cTYC.tNames[i]->tyc1, cTYC.tNames[i]->tyc2, cTYC.tNames[i]->tyc3, 0, reg, index))
-        {          
-          tychoStar_t *star;
-          radec_t rdpm;
+      if (!str.compare(cTYC.tNameIndex.name(id), Qt::CaseInsensitive))
+      {
+        int reg = cTYC.tNameIndex.data(id) >> 32;
+        int index = cTYC.tNameIndex.data(id) & 0xffffffff;
+        tychoStar_t *star;
+        radec_t rdpm;
 
-          cTYC.getStar(&star, reg, index);
-          cTYC.getStarPos(rdpm, star, yr);
+        cTYC.getStar(&star, reg, index);
+        cTYC.getStarPos(rdpm, star, yr);
 
-          ra = rdpm.Ra;
-          dec = rdpm.Dec;
+        ra = rdpm.Ra;
+        dec = rdpm.Dec;
 
-          precess(&ra, &dec, JD2000, mapView->jd);
-          fov = D2R(30);
+        precess(&ra, &dec, JD2000, mapView->jd);
+        fov = D2R(30);
 
-          obj.type = MO_TYCSTAR;
-          obj.par1 = reg;
-          obj.par2 = index;
+        obj.type = MO_TYCSTAR;
+        obj.par1 = reg;
+        obj.par2 = index;
 
-          return(true);
-        }        
+        return(true);
       }
     }
   }
@@ -424,27 +449,24 @@ bool CSearch::search(mapView_t *mapView, QString str, double &ra, double &dec, d
 
     sgp4.setObserver(mapView);
 
-    for (int i = 0; i < sgp4.count(); i++)
+    foreach (int i, sgp4.findName(satName))
     {
       satellite_t out;
       radec_t rd;
 
-      if (sgp4.getName(i).compare(satName, Qt::CaseInsensitive) == 0)
+      if (sgp4.tleItem(i)->used && sgp4.solve(i, mapView, &out))
       {
-        if (sgp4.tleItem(i)->used && sgp4.solve(i, mapView, &out))
-        {
-          cAstro.convAA2RDRef(out.azimuth, out.elevation, &rd.Ra, &rd.Dec);
+        cAstro.convAA2RDRef(out.azimuth, out.elevation, &rd.Ra, &rd.Dec);
 
-          ra = rd.Ra;
-          dec = rd.Dec;
-          fov = getOptObjFov(0, 0, D2R(2.5));
+        ra = rd.Ra;
+        dec = rd.Dec;
+        fov = getOptObjFov(0, 0, D2R(2.5));
 
-          obj.type = MO_SATELLITE;
-          obj.par1 = i;
-          obj.par2 = 0;
+        obj.type = MO_SATELLITE;
+        obj.par1 = i;
+        obj.par2 = 0;
 
-          return true;
-        }
+        return true;
       }
     }
   }
@@ -454,8 +476,13 @@ bool CSearch::search(mapView_t *mapView, QString str, double &ra, double &dec, d
   if (SS_CHECK_OR(SS_ASTER, what))
   {
     // asteroids
-    for (int i = 0; i < tAsteroids.count(); i++)
+    QList <int> list;
+    bool useIndex = minorBodyCandidates(astNameIndex(), str, list);
+    int  count = useIndex ? list.count() : tAsteroids.count();
+
+    for (int c = 0; c < count; c++)
     {
+      int i = useIndex ? list[c] : c;
       asteroid_t *a = &tAsteroids[i];
 
       if (!a->selected)
@@ -482,8 +509,13 @@ bool CSearch::search(mapView_t *mapView, QString str, double &ra, double &dec, d
   if (SS_CHECK_OR(SS_COMET, what))
   {
     // comets
-    for (int i = 0; i < tComets.count(); i++)
+    QList <int> list;
+    bool useIndex = minorBodyCandidates(comNameIndex(), str, list);
+    int  count = useIndex ? list.count() : tComets.count();
+
+    for (int c = 0; c < count; c++)
     {
+      int i = useIndex ? list[c] : c;
       comet_t *a = &tComets[i];
 
       if (!a->selected)
@@ -1,10 +1,14 @@
 #include "csgp4.h"
 #include "castro.h"
 
+#include "Globals.h"
+#include "Util.h"
+
 #include <QFile>
 #include <QTextStream>
 #include <QDateTime>
 #include <QDebug>
+#include "clazyload.h"
 
 CSGP4 sgp4;
 
@@ -25,6 +29,8 @@ static bool compFnc(const tleItem_t &i1, const tleItem_t &i2)
 
 bool CSGP4::loadTLEData(const QString &fileName)
 {
+  g_lazySatellites.ensure();
+
   QFile f(fileName);
   QTextStream s(&f);
 
@@ -86,6 +92,14 @@ bool CSGP4::loadTLEData(const QString &fileName)
       item.inclination = elem.Inclination();
       item.period = elem.Period();
       item.epoch = tle->Epoch().ToJulian();
+      item.elem.mo = elem.MeanAnomoly();
+      item.elem.omegao = elem.ArgumentPerigee();
+      item.elem.xnodeo = elem.AscendingNode();
+      item.elem.ecco = elem.Eccentricity();
+      item.elem.xincl = elem.Inclination();
+      item.elem.bstar = elem.BStar();
+      item.elem.xnodp = elem.RecoveredMeanMotion();
+      item.elem.aodp = elem.RecoveredSemiMajorAxis();
 
       m_data.append(item);
       row = 0;
@@ -102,24 +116,456 @@ bool CSGP4::loadTLEData(const QString &fileName)
 
   qSort(m_data.begin(), m_data.end(), compFnc);
 
+  for (int i = 0; i < m_data.count(); i++)
+  {
+    m_nameIndex.add(m_data[i].name, i);
+  }
+
+  buildBatch();
+
   return true;
 }
 
+////////////////////////////////////////////
+DateTime CSGP4::jdToDateTime(double jd)
+////////////////////////////////////////////
+{
+  // microsecond ticks since 0001-01-01
+  return DateTime((unsigned long long)((jd - 1721425.5) * TicksPerDay + 0.5));
+}
+
+/////////////////////////////////////
+void CSGP4::resizeBatch(int count)
+/////////////////////////////////////
+{
+  sgp4Batch_t &b = m_batch;
+
+  b.index.resize(count);
+  b.epoch.resize(count);
+
+  QVector <double> *vec[] = { &b.mo, &b.omegao, &b.xnodeo, &b.ecco, &b.xincl, &b.bstar, &b.xnodp, &b.aodp,
+                              &b.cosio, &b.sinio, &b.eta, &b.t2cof, &b.x1mth2, &b.x3thm1, &b.x7thm1,
+                              &b.aycof, &b.xlcof, &b.xnodcf, &b.c1, &b.c4, &b.omgdot, &b.xnodot, &b.xmdot,
+                              &b.c5, &b.omgcof, &b.xmcof, &b.delmo, &b.sinmo, &b.d2, &b.d3, &b.d4,
+                              &b.t3cof, &b.t4cof, &b.t5cof };
+
+  for (unsigned i = 0; i < sizeof(vec) / sizeof(vec[0]); i++)
+  {
+    vec[i]->resize(count);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+// near space constants (same as SGP4::Initialise()), deep space
+// objects (period >= 225 min.) stay with libsgp4
+void CSGP4::buildBatch()
+//////////////////////////////////////////////////////////////////////
+{
+  int n = 0;
+
+  m_deepSpace.clear();
+  resizeBatch(m_data.count());
+
+  for (int i = 0; i < m_data.count(); i++)
+  {
+    const tleItem_t  &item = m_data[i];
+    const sgp4Elem_t &el = item.elem;
+    sgp4Batch_t      &b = m_batch;
+
+    if (item.period >= 225.0)
+    {
+      m_deepSpace.append(i);
+      continue;
+    }
+
+    const double cosio = cos(el.xincl);
+    const double sinio = sin(el.xincl);
+    const double theta2 = cosio * cosio;
+    const double theta4 = theta2 * theta2;
+    const double x3thm1 = 3.0 * theta2 - 1.0;
+    const double eosq = el.ecco * el.ecco;
+    const double betao2 = 1.0 - eosq;
+    const double betao = sqrt(betao2);
+
+    double s4 = kS;
+    double qoms24 = kQOMS2T;
+
+    if (item.perigee < 156.0)
+    {
+      s4 = item.perigee - 78.0;
+      if (item.perigee < 98.0)
+      {
+        s4 = 20.0;
+      }
+      qoms24 = pow((120.0 - s4) * kAE / kXKMPER, 4.0);
+      s4 = s4 / kXKMPER + kAE;
+    }
+
+    const double pinvsq = 1.0 / (el.aodp * el.aodp * betao2 * betao2);
+    const double tsi = 1.0 / (el.aodp - s4);
+    const double eta = el.aodp * el.ecco * tsi;
+    const double etasq = eta * eta;
+    const double eeta = el.ecco * eta;
+    const double psisq = fabs(1.0 - etasq);
+    const double coef = qoms24 * pow(tsi, 4.0);
+    const double coef1 = coef / pow(psisq, 3.5);
+    const double c2 = coef1 * el.xnodp * (el.aodp * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) +
+                      0.75 * kCK2 * tsi / psisq * x3thm1 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+    const double c1 = el.bstar * c2;
+    const double a3ovk2 = -kXJ3 / kCK2 * kAE * kAE * kAE;
+    const double x1mth2 = 1.0 - theta2;
+    const double c4 = 2.0 * el.xnodp * coef1 * el.aodp * betao2 *
+                      (eta * (2.0 + 0.5 * etasq) + el.ecco * (0.5 + 2.0 * etasq) -
+                      2.0 * kCK2 * tsi / (el.aodp * psisq) *
+                      (-3.0 * x3thm1 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) +
+                      0.75 * x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * cos(2.0 * el.omegao)));
+    const double temp1 = 3.0 * kCK2 * pinvsq * el.xnodp;
+    const double temp2 = temp1 * kCK2 * pinvsq;
+    const double temp3 = 1.25 * kCK4 * pinvsq * pinvsq * el.xnodp;
+    const double xhdot1 = -temp1 * cosio;
+
+    b.index[n] = i;
+    b.epoch[n] = item.epoch;
+
+    b.mo[n] = el.mo;
+    b.omegao[n] = el.omegao;
+    b.xnodeo[n] = el.xnodeo;
+    b.ecco[n] = el.ecco;
+    b.xincl[n] = el.xincl;
+    b.bstar[n] = el.bstar;
+    b.xnodp[n] = el.xnodp;
+    b.aodp[n] = el.aodp;
+
+    b.cosio[n] = cosio;
+    b.sinio[n] = sinio;
+    b.eta[n] = eta;
+    b.t2cof[n] = 1.5 * c1;
+    b.x1mth2[n] = x1mth2;
+    b.x3thm1[n] = x3thm1;
+    b.x7thm1[n] = 7.0 * theta2 - 1.0;
+    b.aycof[n] = 0.25 * a3ovk2 * sinio;
+    b.xlcof[n] = 0.125 * a3ovk2 * sinio * (3.0 + 5.0 * cosio) / qMax(1.5e-12, fabs(1.0 + cosio));
+    b.xnodcf[n] = 3.5 * betao2 * xhdot1 * c1;
+    b.c1[n] = c1;
+    b.c4[n] = c4;
+    b.xmdot[n] = el.xnodp + 0.5 * temp1 * betao * x3thm1 + 0.0625 * temp2 * betao * (13.0 - 78.0 * theta2 + 137.0 * theta4);
+    b.omgdot[n] = -0.5 * temp1 * (1.0 - 5.0 * theta2) + 0.0625 * temp2 * (7.0 - 114.0 * theta2 + 395.0 * theta4) +
+                  temp3 * (3.0 - 36.0 * theta2 + 49.0 * theta4);
+    b.xnodot[n] = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * theta2) + 2.0 * temp3 * (3.0 - 7.0 * theta2)) * cosio;
+
+    // simple model (perigee < 220 km) drops these terms, zero makes them no-op
+    b.c5[n] = b.omgcof[n] = b.xmcof[n] = 0;
+    b.d2[n] = b.d3[n] = b.d4[n] = b.t3cof[n] = b.t4cof[n] = b.t5cof[n] = 0;
+    b.delmo[n] = pow(1.0 + eta * cos(el.mo), 3.0);
+    b.sinmo[n] = sin(el.mo);
+
+    if (item.perigee >= 220.0)
+    {
+      double c3 = 0.0;
+
+      if (el.ecco > 1.0e-4)
+      {
+        c3 = coef * tsi * a3ovk2 * el.xnodp * kAE * sinio / el.ecco;
+        b.xmcof[n] = -kTWOTHIRD * coef * el.bstar * kAE / eeta;
+      }
+
+      b.c5[n] = 2.0 * coef1 * el.aodp * betao2 * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+      b.omgcof[n] = el.bstar * c3 * cos(el.omegao);
+
+      const double c1sq = c1 * c1;
+      const double d2 = 4.0 * el.aodp * tsi * c1sq;
+      const double temp = d2 * tsi * c1 / 3.0;
+      const double d3 = (17.0 * el.aodp + s4) * temp;
+      const double d4 = 0.5 * temp * el.aodp * tsi * (221.0 * el.aodp + 31.0 * s4) * c1;
+
+      b.d2[n] = d2;
+      b.d3[n] = d3;
+      b.d4[n] = d4;
+      b.t3cof[n] = d2 + 2.0 * c1sq;
+      b.t4cof[n] = 0.25 * (3.0 * d3 + c1 * (12.0 * d2 + 10.0 * c1sq));
+      b.t5cof[n] = 0.2 * (3.0 * d4 + 12.0 * c1 * d3 + 6.0 * d2 * d2 + 15.0 * c1sq * (2.0 * d2 + c1sq));
+    }
+    n++;
+  }
+
+  resizeBatch(n);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// topocentric look angle (same as Observer::GetLookAngle())
+void CSGP4::lookAngle(const double *pos, const double *obs, double sinLat, double cosLat,
+                      double sinTheta, double cosTheta, satPos_t *out)
+//////////////////////////////////////////////////////////////////////////////////////////
+{
+  double rx = pos[0] - obs[0];
+  double ry = pos[1] - obs[1];
+  double rz = pos[2] - obs[2];
+  double range = sqrt(rx * rx + ry * ry + rz * rz);
+
+  double top_s = sinLat * cosTheta * rx + sinLat * sinTheta * ry - cosLat * rz;
+  double top_e = -sinTheta * rx + cosTheta * ry;
+  double top_z = cosLat * cosTheta * rx + cosLat * sinTheta * ry + sinLat * rz;
+  double az = atan(-top_e / top_s);
+
+  if (top_s > 0.0)
+  {
+    az += kPI;
+  }
+
+  if (az < 0.0)
+  {
+    az += kTWOPI;
+  }
+
+  out->azimuth = az;
+  out->elevation = asin(top_z / range);
+  out->range = range;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// near space SGP4 for batch item i, returns TEME position in km
+int CSGP4::propagate(const sgp4Batch_t &b, int i, double jd, double *pos)
+/////////////////////////////////////////////////////////////////////////////
+{
+  const double tsince = (jd - b.epoch[i]) * kMINUTES_PER_DAY;
+
+  const double xmdf = b.mo[i] + b.xmdot[i] * tsince;
+  const double omgadf = b.omegao[i] + b.omgdot[i] * tsince;
+  const double xnoddf = b.xnodeo[i] + b.xnodot[i] * tsince;
+
+  const double tsq = tsince * tsince;
+  const double tcube = tsq * tsince;
+  const double tfour = tsince * tcube;
+  const double xnode = xnoddf + b.xnodcf[i] * tsq;
+
+  const double delm = b.xmcof[i] * (pow(1.0 + b.eta[i] * cos(xmdf), 3.0) - b.delmo[i]);
+  const double temp = b.omgcof[i] * tsince + delm;
+  const double xmp = xmdf + temp;
+  const double omega = omgadf - temp;
+
+  const double tempa = 1.0 - b.c1[i] * tsince - b.d2[i] * tsq - b.d3[i] * tcube - b.d4[i] * tfour;
+  const double tempe = b.bstar[i] * (b.c4[i] * tsince + b.c5[i] * (sin(xmp) - b.sinmo[i]));
+  const double templ = b.t2cof[i] * tsq + b.t3cof[i] * tcube + tfour * (b.t4cof[i] + tsince * b.t5cof[i]);
+
+  const double a = b.aodp[i] * tempa * tempa;
+  const double xl = xmp + omega + xnode + b.xnodp[i] * templ;
+  double       e = b.ecco[i] - tempe;
+
+  if (e <= -0.001)
+  {
+    return SGP4_ERROR;
+  }
+  e = CLAMP(e, 1.0e-6, 1.0 - 1.0e-6);
+
+  // long period periodics
+  const double beta2 = 1.0 - e * e;
+  const double axn = e * cos(omega);
+  const double temp11 = 1.0 / (a * beta2);
+  const double xlt = xl + temp11 * b.xlcof[i] * axn;
+  const double ayn = e * sin(omega) + temp11 * b.aycof[i];
+  const double elsq = axn * axn + ayn * ayn;
+
+  if (elsq >= 1.0)
+  {
+    return SGP4_ERROR;
+  }
+
+  // Kepler's equation
+  const double capu = fmod(xlt - xnode, kTWOPI);
+  const double maxNR = 1.25 * sqrt(elsq);
+  double       epw = capu;
+  double       sinepw = 0, cosepw = 0, ecose = 0, esine = 0;
+
+  for (int k = 0; k < 10; k++)
+  {
+    sinepw = sin(epw);
+    cosepw = cos(epw);
+    ecose = axn * cosepw + ayn * sinepw;
+    esine = axn * sinepw - ayn * cosepw;
+
+    double f = capu - epw + esine;
+
+    if (fabs(f) < 1.0e-12)
+    {
+      break;
+    }
+
+    double fdot = 1.0 - ecose;
+    double delta = f / fdot;
+
+    if (k == 0)
+    {
+      delta = CLAMP(delta, -maxNR, maxNR);
+    }
+    else
+    {
+      delta = f / (fdot + 0.5 * esine * delta);
+    }
+    epw += delta;
+  }
+
+  // short period preliminary quantities
+  const double temp21 = 1.0 - elsq;
+  const double pl = a * temp21;
+
+  if (pl < 0.0)
+  {
+    return SGP4_ERROR;
+  }
+
+  const double r = a * (1.0 - ecose);
+  const double temp31 = 1.0 / r;
+  const double temp32 = a * temp31;
+  const double betal = sqrt(temp21);
+  const double temp33 = 1.0 / (1.0 + betal);
+  const double cosu = temp32 * (cosepw - axn + ayn * esine * temp33);
+  const double sinu = temp32 * (sinepw - ayn - axn * esine * temp33);
+  const double u = atan2(sinu, cosu);
+  const double sin2u = 2.0 * sinu * cosu;
+  const double cos2u = 2.0 * cosu * cosu - 1.0;
+
+  // short periodics
+  const double temp41 = 1.0 / pl;
+  const double temp42 = kCK2 * temp41;
+  const double temp43 = temp42 * temp41;
+
+  const double rk = r * (1.0 - 1.5 * temp43 * betal * b.x3thm1[i]) + 0.5 * temp42 * b.x1mth2[i] * cos2u;
+  const double uk = u - 0.25 * temp43 * b.x7thm1[i] * sin2u;
+  const double xnodek = xnode + 1.5 * temp43 * b.cosio[i] * sin2u;
+  const double xinck = b.xincl[i] + 1.5 * temp43 * b.cosio[i] * b.sinio[i] * cos2u;
+
+  if (rk < 1.0)
+  {
+    return SGP4_DECAYED;
+  }
+
+  const double sinuk = sin(uk);
+  const double cosuk = cos(uk);
+  const double sinik = sin(xinck);
+  const double cosik = cos(xinck);
+  const double sinnok = sin(xnodek);
+  const double cosnok = cos(xnodek);
+  const double xmx = -sinnok * cosik;
+  const double xmy = cosnok * cosik;
+
+  pos[0] = rk * (xmx * sinuk + cosnok * cosuk) * kXKMPER;
+  pos[1] = rk * (xmy * sinuk + sinnok * cosuk) * kXKMPER;
+  pos[2] = rk * (sinik * sinuk) * kXKMPER;
+
+  return SGP4_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+// propagate all satellites for view->jd, out is indexed as m_data
+// below horizon objects are culled before refraction (status SGP4_BELOW_HORIZON)
+void CSGP4::solveAll(const mapView_t *view, QVector<satPos_t> &out, bool cullBelowHorizon)
+///////////////////////////////////////////////////////////////////////////////////////
+{
+  g_lazySatellites.ensure();
+
+  CoordGeodetic geo(R2D(view->geo.lat), R2D(view->geo.lon), view->geo.alt / 1000.0);
+  DateTime      time = jdToDateTime(view->jd);
+  Eci           obsEci(time, geo);
+  double        obs[3] = { obsEci.Position().x, obsEci.Position().y, obsEci.Position().z };
+  double        theta = time.ToLocalMeanSiderealTime(geo.longitude);
+  double        sinLat = sin(geo.latitude);
+  double        cosLat = cos(geo.latitude);
+  double        sinTheta = sin(theta);
+  double        cosTheta = cos(theta);
+  double        minElev = cullBelowHorizon ? -D2R(1) : -R90 - 1;  // refraction margin
+  int           count = m_batch.index.count();
+  int           deepCount = m_deepSpace.count();
+
+  out.resize(m_data.count());
+  satPos_t *data = out.data();
+
+  #pragma omp parallel for if (count > 256)
+  for (int i = 0; i < count; i++)
+  {
+    int       index = m_batch.index[i];
+    satPos_t *pos = &data[index];
+    double    xyz[3];
+
+    if (!m_data.at(index).used)
+    {
+      pos->status = SGP4_NOT_USED;
+      continue;
+    }
+
+    pos->status = propagate(m_batch, i, view->jd, xyz);
+    if (pos->status == SGP4_OK)
+    {
+      lookAngle(xyz, obs, sinLat, cosLat, sinTheta, cosTheta, pos);
+      if (pos->elevation < minElev)
+      {
+        pos->status = SGP4_BELOW_HORIZON;
+      }
+    }
+  }
+
+  #pragma omp parallel for if (deepCount > 64)
+  for (int i = 0; i < deepCount; i++)
+  {
+    int       index = m_deepSpace[i];
+    satPos_t *pos = &data[index];
+
+    if (!m_data.at(index).used)
+    {
+      pos->status = SGP4_NOT_USED;
+      continue;
+    }
+
+    try
+    {
+      Eci    eci = m_data.at(index).sgp4->FindPosition(time);
+      double xyz[3] = { eci.Position().x, eci.Position().y, eci.Position().z };
+
+      pos->status = SGP4_OK;
+      lookAngle(xyz, obs, sinLat, cosLat, sinTheta, cosTheta, pos);
+      if (pos->elevation < minElev)
+      {
+        pos->status = SGP4_BELOW_HORIZON;
+      }
+    }
+
+    catch (DecayedException &)
+    {
+      pos->status = SGP4_DECAYED;
+    }
+
+    catch (...)
+    {
+      pos->status = SGP4_ERROR;
+    }
+  }
+
+  // refraction (CAstro is not thread safe)
+  for (int i = 0; i < out.count(); i++)
+  {
+    satPos_t *pos = &data[i];
+
+    if (pos->status == SGP4_OK)
+    {
+      pos->elevation += cAstro.getAtmRef(pos->elevation);
+      if (cullBelowHorizon && pos->elevation < 0)
+      {
+        pos->status = SGP4_BELOW_HORIZON;
+      }
+    }
+  }
+}
+
 bool CSGP4::solve(int index, const mapView_t *view, satellite_t *out)
 {
+  g_lazySatellites.ensure();
+
   SGP4 *sgp4 = m_data[index].sgp4;
-  QDateTime dt;
 
   out->name = m_data[index].name;
 
-  jdConvertJDTo_DateTime(view->jd, &dt);
-
-  //qDebug() << dt;
-
   try
   {
-    DateTime time = DateTime(dt.date().year(), dt.date().month(), dt.date().day(),
-                             dt.time().hour(), dt.time().minute(), dt.time().second());
+    DateTime time = jdToDateTime(view->jd);
 
     Eci eci = sgp4->FindPosition(time);
     CoordTopocentric topo;
@@ -167,24 +613,60 @@ void CSGP4::setObserver(mapView_t *view)
 
 tleItem_t *CSGP4::tleItem(int index)
 {
+  g_lazySatellites.ensure();
   return &m_data[index];
 }
 
 QString CSGP4::getName(int index)
 {
+  g_lazySatellites.ensure();
   return m_data[index].name;
 }
 
+// returns indices of satellites with the same name (case insensitive)
+QList<int> CSGP4::findName(const QString &name)
+{
+  g_lazySatellites.ensure();
+
+  QList <int> list;
+
+  foreach (int id, m_nameIndex.find(name))
+  {
+    int i = m_nameIndex.data(id);
+
+    if (m_data[i].name.compare(name, Qt::CaseInsensitive) == 0)
+    {
+      list.append(i);
+    }
+  }
+
+  return list;
+}
+
 QString CSGP4::getID(int index)
 {
+  g_lazySatellites.ensure();
   return m_data[index].id;
 }
 
 int CSGP4::count()
 {
+  g_lazySatellites.ensure();
   return m_data.count();
 }
 
+const sgp4Batch_t &CSGP4::batch()
+{
+  g_lazySatellites.ensure();
+  return m_batch;
+}
+
+const QVector<int> &CSGP4::deepSpace()
+{
+  g_lazySatellites.ensure();
+  return m_deepSpace;
+}
+
 void CSGP4::removeAll()
 {
   foreach (const tleItem_t &item, m_data)
@@ -193,4 +675,7 @@ void CSGP4::removeAll()
   }
 
   m_data.clear();
+  m_nameIndex.clear();
+  m_deepSpace.clear();
+  resizeBatch(0);
 }
@@ -7,9 +7,29 @@
 #include "SGP4.h"
 
 #include "cmapview.h"
+#include "cnameindex.h"
 
 #include <QList>
 #include <QString>
+#include <QVector>
+
+#define SGP4_OK             0
+#define SGP4_BELOW_HORIZON  1
+#define SGP4_DECAYED        2
+#define SGP4_ERROR          3
+#define SGP4_NOT_USED       4
+
+typedef struct
+{
+  double mo;
+  double omegao;
+  double xnodeo;
+  double ecco;
+  double xincl;
+  double bstar;
+  double xnodp;          // recovered mean motion
+  double aodp;           // recovered semi major axis
+} sgp4Elem_t;
 
 typedef struct
 {
@@ -21,6 +41,7 @@ typedef struct
   double   inclination;
   double   perigee;
   double   epoch;
+  sgp4Elem_t elem;
   QString  data[3];
 } tleItem_t;
 
@@ -38,21 +59,56 @@ typedef struct
 
 } satellite_t;
 
+typedef struct
+{
+  int    status;         // SGP4_xxx
+  double azimuth;
+  double elevation;      // with refraction
+  double range;
+} satPos_t;
+
+// near space SGP4 coefficients (structure of arrays)
+typedef struct
+{
+  QVector <int>    index;    // to m_data
+  QVector <double> epoch;
+  QVector <double> mo, omegao, xnodeo, ecco, xincl, bstar, xnodp, aodp;
+  QVector <double> cosio, sinio, eta, t2cof, x1mth2, x3thm1, x7thm1;
+  QVector <double> aycof, xlcof, xnodcf, c1, c4, omgdot, xnodot, xmdot;
+  QVector <double> c5, omgcof, xmcof, delmo, sinmo, d2, d3, d4, t3cof, t4cof, t5cof;
+} sgp4Batch_t;
+
 class CSGP4
 {
 public:
   CSGP4();
   bool loadTLEData(const QString &fileName);
   bool solve(int index, const mapView_t *view, satellite_t *out);
+  void solveAll(const mapView_t *view, QVector <satPos_t> &out, bool cullBelowHorizon);
   void setObserver(mapView_t *view);
   tleItem_t *tleItem(int index);
   QString getName(int index);
+  QList <int> findName(const QString &name);
   QString getID(int index);
   int count();
   void removeAll();
 
+  const sgp4Batch_t   &batch();
+  const QVector <int> &deepSpace();
+
+  static DateTime jdToDateTime(double jd);
+  static int  propagate(const sgp4Batch_t &b, int i, double jd, double *pos);
+  static void lookAngle(const double *pos, const double *obs, double sinLat, double cosLat,
+                        double sinTheta, double cosTheta, satPos_t *out);
+
 private:
+  void buildBatch();
+  void resizeBatch(int count);
+
   QList <tleItem_t> m_data;
+  sgp4Batch_t       m_batch;
+  QVector <int>     m_deepSpace;
+  CNameIndex        m_nameIndex;
   Observer m_obs;
 };
 
@@ -1,11 +1,62 @@
 #include "cstarrenderer.h"
+#include "omp.h"
 
 #include <QDebug>
 
+#if defined(__AVX2__)
+  #include <immintrin.h>
+  #define SR_USE_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define SR_USE_SSE2
+#endif
+
 CStarRenderer   cStarRenderer;
 
+////////////////////////////////////////////////////////////////////////
+static inline void addSaturate(quint32 *dst, const quint32 *src, int count)
+////////////////////////////////////////////////////////////////////////
+{
+  int i = 0;
+
+#ifdef SR_USE_AVX2
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+    __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+    _mm256_storeu_si256((__m256i *)(dst + i), _mm256_adds_epu8(d, s));
+  }
+#endif
+
+#ifdef SR_USE_SSE2
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+    __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+    _mm_storeu_si128((__m128i *)(dst + i), _mm_adds_epu8(d, s));
+  }
+#endif
+
+  for (; i < count; i++)
+  {
+    quint32 d = dst[i];
+    quint32 s = src[i];
+    quint32 r = 0;
+
+    for (int sh = 0; sh < 32; sh += 8)
+    {
+      quint32 c = ((d >> sh) & 0xff) + ((s >> sh) & 0xff);
+      r |= qMin(c, 255u) << sh;
+    }
+    dst[i] = r;
+  }
+}
+
 CStarRenderer::CStarRenderer() :
-  m_halo(0)
+  m_halo(0),
+  m_batchImg(0)
 {
 }
 
@@ -91,9 +142,85 @@ bool CStarRenderer::open(QString filename)
     }
   }
 
+  buildAtlas();
+
   return(true);
 }
 
+// pack all star bitmaps and halos into one premultiplied buffer
+///////////////////////////////////
+void CStarRenderer::buildAtlas(void)
+///////////////////////////////////
+{
+  m_atlas.clear();
+  m_sprites.clear();
+
+  for (int sp = 0; sp < 8; sp++)
+  {
+    for (int i = 0; i < pStars[sp].count(); i++)
+    {
+      QImage img = pStars[sp][i].toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+      starSprite_t sprite;
+
+      sprite.offset = m_atlas.count();
+      sprite.w = img.width();
+      sprite.h = img.height();
+
+      for (int y = 0; y < img.height(); y++)
+      {
+        const quint32 *line = (const quint32 *)img.constScanLine(y);
+        for (int x = 0; x < img.width(); x++)
+        {
+          m_atlas.append(line[x]);
+        }
+      }
+      m_sprites.append(sprite);
+    }
+  }
+
+  // halo sprites (opacity is baked in, rotation is fixed per star size)
+  for (int i = 0; i < pStars[0].count(); i++)
+  {
+    starSprite_t sprite;
+    float op = (1 - CLAMP(i / (float)(numStars * 0.5f), 0, 1)) * m_haloFactor;
+
+    sprite.offset = m_atlas.count();
+    sprite.w = 0;
+    sprite.h = 0;
+
+    if (m_halo && op > 0.01)
+    {
+      int w = pStars[0][i].width();
+      int h = pStars[0][i].height();
+      int size = qMax(w, h) * 3;
+      QImage img(size, size, QImage::Format_ARGB32_Premultiplied);
+
+      img.fill(Qt::transparent);
+
+      QPainter p(&img);
+      p.setRenderHint(QPainter::SmoothPixmapTransform, true);
+      p.translate(size * 0.5, size * 0.5);
+      p.rotate(i * 20.);
+      p.setOpacity(op);
+      p.drawPixmap(-w * 1.5, -w * 1.5, w * 3, h * 3, *m_halo);
+      p.end();
+
+      sprite.w = size;
+      sprite.h = size;
+
+      for (int y = 0; y < img.height(); y++)
+      {
+        const quint32 *line = (const quint32 *)img.constScanLine(y);
+        for (int x = 0; x < img.width(); x++)
+        {
+          m_atlas.append(line[x]);
+        }
+      }
+    }
+    m_sprites.append(sprite);
+  }
+}
+
 /////////////////////////////////////////
 void CStarRenderer::setMaxMag(float mMag)
 /////////////////////////////////////////
@@ -140,6 +267,32 @@ int CStarRenderer::renderStar(SKPOINT *pt, int spt, float mag, QPainter *p)
     spt = 0;
   }
 
+  if (m_batchImg)
+  {
+    const starSprite_t &sprite = m_sprites[spt * numStars + s];
+    starBatchItem_t item;
+
+    if (m_showHalo)
+    {
+      const starSprite_t &halo = m_sprites[8 * numStars + s];
+
+      if (halo.w > 0)
+      {
+        item.x = pt->sx - (halo.w >> 1);
+        item.y = pt->sy - (halo.h >> 1);
+        item.sprite = 8 * numStars + s;
+        m_batch.append(item);
+      }
+    }
+
+    item.x = pt->sx - (sprite.w >> 1);
+    item.y = pt->sy - (sprite.h >> 1);
+    item.sprite = spt * numStars + s;
+    m_batch.append(item);
+
+    return(sprite.w >> 1);
+  }
+
   int w = pStars[spt][s].width();
   int h = pStars[spt][s].height();
 
@@ -194,7 +347,12 @@ void CStarRenderer::setConfig(setting_t *set)
   m_useSpectralTp = set->map.star.useSpectralTp;
   m_starSizeFactor = set->map.star.starSizeFactor;
   m_showHalo = set->map.star.showGlow;
-  m_haloFactor = set->map.star.glowAlpha;
+
+  if (m_haloFactor != set->map.star.glowAlpha)
+  {
+    m_haloFactor = set->map.star.glowAlpha;
+    buildAtlas();
+  }
 
   if (m_saturation != set->map.star.saturation)
   {
@@ -228,6 +386,100 @@ void CStarRenderer::setConfig(setting_t *set)
         pStars[sp][i] = QPixmap::fromImage(img);
       }
     }
+    buildAtlas();
+  }
+}
+
+// start collecting stars for direct rendering into dst ///
+bool CStarRenderer::beginBatch(QImage *dst)
+///////////////////////////////////////////////////////////
+{
+  m_batch.clear();
+  m_batchImg = NULL;
+
+  if (dst == NULL || m_sprites.count() != 9 * numStars)
+  {
+    return(false);
+  }
+
+  if (dst->format() != QImage::Format_ARGB32_Premultiplied &&
+      dst->format() != QImage::Format_RGB32)
+  {
+    return(false);
+  }
+
+  m_batchImg = dst;
+
+  return(true);
+}
+
+/////////////////////////////////////
+bool CStarRenderer::isBatch(void) const
+/////////////////////////////////////
+{
+  return(m_batchImg != NULL);
+}
+
+// additive blend is order independent, so the image is split into row bands
+// and every thread writes only into its own band
+/////////////////////////////////////
+void CStarRenderer::flushBatch(void)
+/////////////////////////////////////
+{
+  if (m_batchImg == NULL)
+  {
+    return;
+  }
+
+  quint32 *bits = (quint32 *)m_batchImg->bits();
+  int      dw = m_batchImg->bytesPerLine() / 4;
+  int      dh = m_batchImg->height();
+  int      bands = qMax(1, omp_get_max_threads());
+  int      bandHeight = (dh + bands - 1) / bands;
+
+  #pragma omp parallel for
+  for (int b = 0; b < bands; b++)
+  {
+    int minY = b * bandHeight;
+    int maxY = qMin(dh, minY + bandHeight);
+
+    for (int i = 0; i < m_batch.count(); i++)
+    {
+      blitSprite(bits, dw, m_batchImg->width(), minY, maxY, m_batch[i]);
+    }
+  }
+
+  m_batch.clear();
+  m_batchImg = NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void CStarRenderer::blitSprite(quint32 *bits, int stride, int width, int minY, int maxY, const starBatchItem_t &item) const
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  const starSprite_t &sprite = m_sprites[item.sprite];
+
+  int y1 = qMax(item.y, minY);
+  int y2 = qMin(item.y + sprite.h, maxY);
+
+  if (y1 >= y2)
+  {
+    return;
+  }
+
+  int x1 = qMax(item.x, 0);
+  int x2 = qMin(item.x + sprite.w, width);
+
+  if (x1 >= x2)
+  {
+    return;
+  }
+
+  const quint32 *src = m_atlas.constData() + sprite.offset + (x1 - item.x);
+
+  for (int y = y1; y < y2; y++)
+  {
+    addSaturate(bits + y * stride + x1, src + (y - item.y) * sprite.w, x2 - x1);
   }
 }
 
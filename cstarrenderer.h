@@ -7,6 +7,20 @@
 #include "skcore.h"
 #include "csetting.h"
 
+typedef struct
+{
+  int offset;   // first pixel in atlas
+  int w;
+  int h;
+} starSprite_t;
+
+typedef struct
+{
+  int x;        // top left corner
+  int y;
+  int sprite;   // index to m_sprites
+} starBatchItem_t;
+
 class CStarRenderer
 {
 public:
@@ -19,9 +33,17 @@ public:
     QPixmap getExampleStar(void);
     void setConfig(setting_t *set); // call before open
 
+    // direct framebuffer rendering (additive blend)
+    bool beginBatch(QImage *dst);
+    void flushBatch(void);
+    bool isBatch(void) const;
+
     static uchar getSPIndex(float bvIndex);
 
 protected:
+    void buildAtlas(void);
+    void blitSprite(quint32 *bits, int stride, int width, int minY, int maxY, const starBatchItem_t &item) const;
+
     QPixmap  *m_halo;
     QList <QPixmap> pStars[8];
     QList <QPixmap> pStarsOrig[8];
@@ -33,6 +55,11 @@ protected:
     bool     m_useSpectralTp;
     bool     m_showHalo;
     float    m_haloFactor;
+
+    QVector <quint32>         m_atlas;    // premultiplied ARGB32 sprites
+    QVector <starSprite_t>    m_sprites;  // [spt * numStars + size] + halo [8 * numStars + size]
+    QVector <starBatchItem_t> m_batch;
+    QImage                   *m_batchImg;
 };
 
 extern CStarRenderer   cStarRenderer;
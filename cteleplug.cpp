@@ -6,6 +6,96 @@ extern bool bParkTelescope;
 
 CTelePluginInterface   *g_pTelePlugin = NULL;
 QPluginLoader          *tpLoader = NULL;
+CTeleState              g_teleState;
+
+////////////////////////
+CTeleState::CTeleState()
+////////////////////////
+{
+  m_clock.start();
+  reset();
+}
+
+/////////////////////////
+void CTeleState::reset()
+/////////////////////////
+{
+  m_valid = false;
+  m_time = 0;
+  m_interval = 0;
+  m_dRa = 0;
+  m_dDec = 0;
+}
+
+/////////////////////////////////////////////
+void CTeleState::update(const radec_t &rd)
+/////////////////////////////////////////////
+{
+  qint64 now = m_clock.elapsed();
+
+  if (m_valid && now > m_time && now - m_time < TS_MAX_GAP)
+  {
+    double dRa = rd.Ra - m_rd.Ra;
+
+    if (dRa > R180) dRa -= R360;
+    if (dRa < -R180) dRa += R360;
+
+    m_interval = now - m_time;
+    m_dRa = dRa / m_interval;
+    m_dDec = (rd.Dec - m_rd.Dec) / m_interval;
+  }
+  else
+  {
+    m_interval = 0;
+    m_dRa = 0;
+    m_dDec = 0;
+  }
+
+  m_rd = rd;
+  m_time = now;
+  m_valid = true;
+}
+
+///////////////////////////////////
+bool CTeleState::isValid() const
+///////////////////////////////////
+{
+  return m_valid;
+}
+
+////////////////////////////////////
+bool CTeleState::isMoving() const
+////////////////////////////////////
+{
+  if (!m_valid || m_interval == 0)
+  {
+    return false;
+  }
+
+  // still between polls and faster than 1"/s
+  return (m_clock.elapsed() - m_time < m_interval * TS_MAX_EXTRAPOL) &&
+         (qAbs(m_dRa) + qAbs(m_dDec)) * 1000 > D2R(1 / 3600.0);
+}
+
+///////////////////////////////////////
+radec_t CTeleState::position() const
+///////////////////////////////////////
+{
+  radec_t rd = m_rd;
+
+  if (m_interval == 0)
+  {
+    return rd;
+  }
+
+  double dt = qMin((double)(m_clock.elapsed() - m_time), m_interval * TS_MAX_EXTRAPOL);
+
+  rd.Ra += m_dRa * dt;
+  rd.Dec = CLAMP(rd.Dec + m_dDec * dt, -R90, R90);
+  rangeDbl(&rd.Ra, R360);
+
+  return rd;
+}
 
 double tpGetTelePluginSpeed(const QString &value, QVector <double> list)
 {
@@ -168,4 +258,5 @@ void tpUnloadDriver(QWidget *parent)
   tpLoader = NULL;
   g_pTelePlugin = NULL;
   pcMapView->m_lastTeleRaDec.Ra = CM_UNDEF;
+  g_teleState.reset();
 }
@@ -4,6 +4,34 @@
 #include <QtCore>
 
 #include "cteleplugininterface.h"
+#include "skcore.h"
+
+#define TS_MAX_GAP        2000    // ms, older samples are not used for the rate
+#define TS_MAX_EXTRAPOL   1.5     // extrapolate up to 1.5 x poll interval
+#define TS_OVERLAY_MS     33      // marker refresh while moving
+#define TS_RECENTER_PX    16      // held telescope moves the map after leaving the center
+
+// Timestamped telescope position (at date) with the slew rate from the
+// last two polls. position() extrapolates between polls.
+class CTeleState
+{
+public:
+  CTeleState();
+  void    reset();
+  void    update(const radec_t &rd);
+  bool    isValid() const;
+  bool    isMoving() const;
+  radec_t position() const;
+
+private:
+  QElapsedTimer m_clock;
+  radec_t       m_rd;
+  qint64        m_time;       // ms of the last sample
+  qint64        m_interval;   // ms between the last two samples
+  double        m_dRa;        // rad/ms
+  double        m_dDec;
+  bool          m_valid;
+};
 
 QString tpGetDriverName(QString libName);
 bool tpLoadDriver(QWidget *parent, QString libName);
@@ -15,5 +43,6 @@ double tpGetTelePluginRateValue(double value, QVector <double> list);
 
 extern CTelePluginInterface *g_pTelePlugin;
 extern QPluginLoader        *tpLoader;
+extern CTeleState            g_teleState;
 
 #endif // CTELEPLUG_H
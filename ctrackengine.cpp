@@ -0,0 +1,506 @@
+#include "ctrackengine.h"
+#include "csgp4.h"
+#include "skcore.h"
+#include "mapobj.h"
+#include "vsop87.h"
+
+#include <QCryptographicHash>
+
+extern int  g_ephType;
+extern int  g_ephMoonType;
+extern bool g_useJPLEphem;
+extern bool g_geocentric;
+
+typedef struct
+{
+  trackPos_t pos;
+  double     v[3];      // unit vector
+  bool       open;      // segment to the next node is not accepted yet
+} teNode_t;
+
+static void teSetVector(teNode_t *node)
+{
+  double cd = cos(node->pos.rd.Dec);
+
+  node->v[0] = cd * cos(node->pos.rd.Ra);
+  node->v[1] = cd * sin(node->pos.rd.Ra);
+  node->v[2] = sin(node->pos.rd.Dec);
+}
+
+static double teAngle(const double *a, const double *b)
+{
+  double c[3] = {a[1] * b[2] - a[2] * b[1],
+                 a[2] * b[0] - a[0] * b[2],
+                 a[0] * b[1] - a[1] * b[0]};
+
+  return atan2(sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]), a[0] * b[0] + a[1] * b[1] + a[2] * b[2]);
+}
+
+// angular distance of m from the great circle through a and b
+static double teDeviation(const double *a, const double *b, const double *m)
+{
+  double n[3] = {a[1] * b[2] - a[2] * b[1],
+                 a[2] * b[0] - a[0] * b[2],
+                 a[0] * b[1] - a[1] * b[0]};
+  double len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+  if (len < 1e-12)
+  {
+    return teAngle(a, m);
+  }
+
+  return qAbs(asin(CLAMP((n[0] * m[0] + n[1] * m[1] + n[2] * m[2]) / len, -1, 1)));
+}
+
+// direction change at node k
+static double teTurn(const QVector <teNode_t> &nodes, int k)
+{
+  if (k <= 0 || k >= nodes.count() - 1)
+  {
+    return 0;
+  }
+
+  const double *p = nodes[k - 1].v;
+  const double *c = nodes[k].v;
+  const double *n = nodes[k + 1].v;
+  double u[3] = {c[0] - p[0], c[1] - p[1], c[2] - p[2]};
+  double w[3] = {n[0] - c[0], n[1] - c[1], n[2] - c[2]};
+
+  if (u[0] * u[0] + u[1] * u[1] + u[2] * u[2] < 1e-24 ||
+      w[0] * w[0] + w[1] * w[1] + w[2] * w[2] < 1e-24)
+  {
+    return 0;
+  }
+
+  return teAngle(u, w);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+CTrackEngine::CTrackEngine(const mapView_t *view, const ofiItem_t *item, double jdFrom, double jdTo, double jdStep,
+                           int labelStep, int markStep)
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  m_view = *view;
+  m_type = item->type;
+  m_par1 = item->par1;
+  m_jdFrom = jdFrom;
+  m_jdTo = jdTo;
+  m_jdStep = jdStep;
+  m_labelStep = qMax(1, labelStep);
+  m_markStep = qMax(1, markStep);
+  m_end = false;
+
+  // the catalogues may change while running
+  if (m_type == MO_COMET)
+  {
+    m_comet = *(const comet_t *)item->par2;
+  }
+  else
+  if (m_type == MO_ASTER)
+  {
+    m_aster = *(const asteroid_t *)item->par2;
+  }
+  else
+  if (m_type == MO_SATELLITE)
+  {
+    tleItem_t *tle = sgp4.tleItem(m_par1);
+
+    m_sat.append(*tle->sgp4);
+    for (int i = 0; i < 3; i++)
+    {
+      m_tle[i] = tle->data[i];
+    }
+  }
+}
+
+//////////////////////////
+void CTrackEngine::stop()
+//////////////////////////
+{
+  m_end = true;
+}
+
+////////////////////////////////////////////
+QVector<trackPos_t> CTrackEngine::positions()
+////////////////////////////////////////////
+{
+  return m_pos;
+}
+
+//////////////////////////////////////////
+// loads the track from the cache
+bool CTrackEngine::isCached()
+//////////////////////////////////////////
+{
+  SkFile f(cacheFile());
+
+  if (!f.open(SkFile::ReadOnly))
+  {
+    return false;
+  }
+
+  return unpack(f.readAll(), m_pos) && m_pos.count() > 1;
+}
+
+////////////////////////////////////////////////////////////////
+QByteArray CTrackEngine::pack(const QVector<trackPos_t> &pos)
+////////////////////////////////////////////////////////////////
+{
+  QByteArray        data;
+  trackFileHeader_t head;
+
+  data.resize(sizeof(head) + pos.count() * sizeof(trackRec_t));
+
+  memset(&head, 0, sizeof(head));
+  memcpy(head.magic, TE_MAGIC, sizeof(head.magic));
+  head.count = pos.count();
+  memcpy(data.data(), &head, sizeof(head));
+
+  trackRec_t *rec = (trackRec_t *)(data.data() + sizeof(head));
+
+  for (int i = 0; i < pos.count(); i++)
+  {
+    rec[i].jd = pos[i].jd;
+    rec[i].ra = pos[i].rd.Ra;
+    rec[i].dec = pos[i].rd.Dec;
+    rec[i].mag = pos[i].mag;
+    rec[i].index = pos[i].index;
+  }
+
+  return data;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+bool CTrackEngine::unpack(const QByteArray &data, QVector<trackPos_t> &pos)
+/////////////////////////////////////////////////////////////////////////////
+{
+  trackFileHeader_t head;
+
+  pos.clear();
+
+  if (data.size() < (int)sizeof(head))
+  {
+    return false;
+  }
+
+  memcpy(&head, data.constData(), sizeof(head));
+
+  if (memcmp(head.magic, TE_MAGIC, sizeof(head.magic)) ||
+      head.count < 0 ||
+      data.size() != (int)(sizeof(head) + head.count * sizeof(trackRec_t)))
+  {
+    return false;
+  }
+
+  const trackRec_t *rec = (const trackRec_t *)(data.constData() + sizeof(head));
+
+  pos.resize(head.count);
+  for (int i = 0; i < head.count; i++)
+  {
+    pos[i].jd = rec[i].jd;
+    pos[i].rd.Ra = rec[i].ra;
+    pos[i].rd.Dec = rec[i].dec;
+    pos[i].mag = rec[i].mag;
+    pos[i].index = rec[i].index;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////
+// key is the object, time span and location
+QString CTrackEngine::cacheFile() const
+////////////////////////////////////////////
+{
+  QByteArray  key;
+  QDataStream s(&key, QIODevice::WriteOnly);
+
+  s << QString(TE_MAGIC) << m_type << m_par1;
+  s << m_jdFrom << m_jdTo << m_jdStep << m_labelStep << m_markStep;
+  s << m_view.geo.lon << m_view.geo.lat << m_view.geo.alt;
+  s << m_view.geo.temp << m_view.geo.press << m_view.geo.useAtmRefraction;
+  s << m_view.deltaT << m_view.deltaTAlg;
+  s << g_ephType << g_ephMoonType << g_useJPLEphem << g_geocentric;
+
+  switch (m_type)
+  {
+    case MO_COMET:
+      s << m_comet.name << m_comet.H << m_comet.G << m_comet.perihelionDate;
+      s << m_comet.q << m_comet.e << m_comet.W << m_comet.w << m_comet.i;
+      break;
+
+    case MO_ASTER:
+      s << m_aster.name << m_aster.H << m_aster.G << m_aster.epoch << m_aster.M;
+      s << m_aster.peri << m_aster.node << m_aster.inc << m_aster.e << m_aster.n << m_aster.a;
+      break;
+
+    case MO_SATELLITE:
+      s << m_tle[0] << m_tle[1] << m_tle[2];
+      break;
+  }
+
+  return QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/data/tracking/cache/" +
+         QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex() + ".trk";
+}
+
+//////////////////////////////
+void CTrackEngine::saveCache()
+//////////////////////////////
+{
+  QString   name = cacheFile();
+  QFileInfo fi(name);
+  QDir      dir(fi.absolutePath());
+
+  checkAndCreateFolder(fi.absolutePath());
+
+  // remove the oldest ones
+  QFileInfoList list = dir.entryInfoList(QStringList("*.trk"), QDir::Files, QDir::Time);
+
+  for (int i = TE_CACHE_FILES - 1; i < list.count(); i++)
+  {
+    QFile::remove(list[i].absoluteFilePath());
+  }
+
+  SkFile f(name);
+
+  if (f.open(SkFile::WriteOnly))
+  {
+    QByteArray data = pack(m_pos);
+
+    if (f.write(data) != data.size())
+    {
+      f.close();
+      f.remove();
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// reentrant (own CAstro per thread)
+void CTrackEngine::calcPos(CAstro *astro, mapView_t *view, double jd, int index, trackPos_t *pos) const
+///////////////////////////////////////////////////////////////////////////////////////////////////
+{
+  orbit_t     o;
+  orbit_t     o1;
+  orbit_t     sun;
+
+  view->jd = jd;
+  astro->setParam(view);
+
+  pos->jd = jd;
+  pos->index = index;
+  pos->mag = CM_UNDEF;
+
+  switch (m_type)
+  {
+    case MO_PLANET:
+      astro->calcPlanet(m_par1, &o);
+      pos->rd = o.lRD;
+      pos->mag = o.mag;
+      break;
+
+    case MO_EARTH_SHD:
+      astro->calcPlanet(PT_MOON, &o1);
+      astro->calcEarthShadow(&o, &o1);
+      pos->rd = o.lRD;
+      break;
+
+    case MO_COMET:
+      astro->calcPlanet(PT_EARTH, &sun, true, true, false);
+      comSolve(&m_comet, jd, astro, &sun, &o);
+      pos->rd = o.lRD;
+      pos->mag = o.mag;
+      break;
+
+    case MO_ASTER:
+      astro->calcPlanet(PT_EARTH, &sun, true, true, false);
+      astSolve(&m_aster, jd, astro, &sun, &o);
+      pos->rd = o.lRD;
+      pos->mag = o.mag;
+      break;
+
+    case MO_SATELLITE:
+    {
+      // local observer, GetLookAngle() updates its cached position
+      Observer         obs(R2D(view->geo.lat), R2D(view->geo.lon), view->geo.alt / 1000.0);
+      CoordTopocentric topo(0, -R90, 0, 0);
+
+      try
+      {
+        topo = obs.GetLookAngle(m_sat.first().FindPosition(CSGP4::jdToDateTime(jd)));
+      }
+
+      catch (...)
+      {
+        // decayed, keep it at nadir
+      }
+
+      astro->convAA2RDRef(topo.azimuth, topo.elevation + astro->getAtmRef(topo.elevation), &pos->rd.Ra, &pos->rd.Dec);
+      break;
+    }
+  }
+}
+
+///////////////////////
+void CTrackEngine::run()
+///////////////////////
+{
+  QVector <teNode_t> nodes;
+  QVector <int>      grid;
+  int                last = (int)floor((m_jdTo - m_jdFrom) / m_jdStep + 1e-9);
+  double             minStep = m_jdStep / TE_SUBDIV;
+  double             span = qMax(last * m_jdStep, minStep);
+  double             done = 0;
+
+  m_pos.clear();
+
+  // labels and marks are at the user step
+  for (int k = 0; k <= last; k++)
+  {
+    if (k == 0 || k == last || (k % m_labelStep) == 0 || (k % m_markStep) == 0)
+    {
+      grid.append(k);
+    }
+  }
+
+  nodes.resize(grid.count());
+
+  int        count = grid.count();
+  const int *idx = grid.constData();
+  teNode_t  *node = nodes.data();
+
+  #pragma omp parallel
+  {
+    CAstro    astro;
+    mapView_t view = m_view;
+
+    astro.setAccuracy(VSOP87_ACC_1SEC);
+
+    #pragma omp for schedule(dynamic, 64)
+    for (int i = 0; i < count; i++)
+    {
+      calcPos(&astro, &view, m_jdFrom + idx[i] * m_jdStep, idx[i], &node[i].pos);
+      teSetVector(&node[i]);
+      node[i].open = true;
+    }
+  }
+
+  nodes.last().open = false;
+
+  // split the open segments until they are short and straight enough
+  while (!m_end)
+  {
+    QVector <int>      split;
+    QVector <bool>     verify;
+    QVector <teNode_t> mids;
+
+    for (int i = 0; i < nodes.count() - 1; i++)
+    {
+      if (!nodes[i].open)
+      {
+        continue;
+      }
+
+      const teNode_t &a = nodes[i];
+      const teNode_t &b = nodes[i + 1];
+      int             gap = (a.pos.index >= 0 && b.pos.index >= 0) ? b.pos.index - a.pos.index : 0;
+      teNode_t        mid;
+
+      if (gap > 1)
+      { // skipped grid points must be checked
+        mid.pos.index = (a.pos.index + b.pos.index) / 2;
+        mid.pos.jd = m_jdFrom + mid.pos.index * m_jdStep;
+        verify.append(true);
+      }
+      else
+      {
+        double sep = teAngle(a.v, b.v);
+        double turn = qMax(teTurn(nodes, i), teTurn(nodes, i + 1));
+
+        // sagitta of the arc
+        if (b.pos.jd - a.pos.jd < 2 * minStep || (sep <= TE_MAX_SEG && sep * turn / 8.0 <= TE_MAX_DEV))
+        {
+          nodes[i].open = false;
+          done += b.pos.jd - a.pos.jd;
+          continue;
+        }
+
+        mid.pos.index = -1;
+        mid.pos.jd = 0.5 * (a.pos.jd + b.pos.jd);
+        verify.append(false);
+      }
+
+      split.append(i);
+      mids.append(mid);
+    }
+
+    if (split.isEmpty())
+    {
+      break;
+    }
+
+    int       midCount = mids.count();
+    teNode_t *mid = mids.data();
+
+    #pragma omp parallel
+    {
+      CAstro    astro;
+      mapView_t view = m_view;
+
+      astro.setAccuracy(VSOP87_ACC_1SEC);
+
+      #pragma omp for schedule(dynamic, 16)
+      for (int i = 0; i < midCount; i++)
+      {
+        calcPos(&astro, &view, mid[i].pos.jd, mid[i].pos.index, &mid[i].pos);
+        teSetVector(&mid[i]);
+        mid[i].open = true;
+      }
+    }
+
+    QVector <teNode_t> next;
+    int                s = 0;
+
+    next.reserve(nodes.count() + mids.count());
+
+    for (int i = 0; i < nodes.count(); i++)
+    {
+      next.append(nodes[i]);
+
+      if (s < split.count() && split[s] == i)
+      {
+        const teNode_t &a = nodes[i];
+        const teNode_t &b = nodes[i + 1];
+
+        if (verify[s] &&
+            teAngle(a.v, b.v) <= TE_MAX_SEG &&
+            teDeviation(a.v, b.v, mids[s].v) <= TE_MAX_DEV)
+        {
+          next.last().open = false;
+          done += b.pos.jd - a.pos.jd;
+        }
+        else
+        {
+          next.append(mids[s]);
+        }
+        s++;
+      }
+    }
+
+    nodes = next;
+    emit sigProgress((int)(100 * qMin(1.0, done / span)));
+  }
+
+  if (!m_end)
+  {
+    m_pos.reserve(nodes.count());
+    for (int i = 0; i < nodes.count(); i++)
+    {
+      m_pos.append(nodes[i].pos);
+    }
+
+    saveCache();
+  }
+
+  emit sigDone();
+}
@@ -0,0 +1,80 @@
+#ifndef CTRACKENGINE_H
+#define CTRACKENGINE_H
+
+#include <QtCore>
+
+#include "castro.h"
+#include "cmapview.h"
+#include "cobjtracking.h"
+#include "casterdlg.h"
+#include "ccomdlg.h"
+#include "csgp4.h"
+
+#define TE_MAX_SEG        D2R(1)              // max. segment length (rate)
+#define TE_MAX_DEV        D2R(0.5 / 60.0)     // max. deviation from a segment (curvature)
+#define TE_SUBDIV         64                  // min. step = user step / TE_SUBDIV
+#define TE_CACHE_FILES    256
+
+#define TE_MAGIC          "SKTRK01"
+
+typedef struct
+{
+  char    magic[8];
+  qint32  count;
+  qint32  reserved;
+} trackFileHeader_t;
+
+typedef struct
+{
+  double  jd;
+  float   ra;
+  float   dec;
+  float   mag;
+  qint32  index;
+} trackRec_t;
+
+// samples the track at the user step only where labels or marks are drawn,
+// the rest is sampled adaptively by the rate and curvature of the motion.
+// tracks are cached on disk by object and time span.
+class CTrackEngine : public QThread
+{
+  Q_OBJECT
+
+public:
+  CTrackEngine(const mapView_t *view, const ofiItem_t *item, double jdFrom, double jdTo, double jdStep,
+               int labelStep, int markStep);
+
+  void                  stop();
+  bool                  isCached();
+  QVector <trackPos_t>  positions();
+
+  static QByteArray     pack(const QVector <trackPos_t> &pos);
+  static bool           unpack(const QByteArray &data, QVector <trackPos_t> &pos);
+
+signals:
+  void sigProgress(int percent);
+  void sigDone(void);
+
+protected:
+  void run();
+  void calcPos(CAstro *astro, mapView_t *view, double jd, int index, trackPos_t *pos) const;
+  QString cacheFile() const;
+  void saveCache();
+
+  mapView_t             m_view;
+  int                   m_type;
+  int                   m_par1;
+  comet_t               m_comet;
+  asteroid_t            m_aster;
+  QList <SGP4>          m_sat;        // own copy, the GUI may reload the TLEs
+  QString               m_tle[3];
+  double                m_jdFrom;
+  double                m_jdTo;
+  double                m_jdStep;
+  int                   m_labelStep;
+  int                   m_markStep;
+  QVector <trackPos_t>  m_pos;
+  volatile bool         m_end;
+};
+
+#endif // CTRACKENGINE_H
@@ -2,6 +2,7 @@
 #include "dsoplug.h"
 
 #include <QApplication>
+#include "clazyload.h"
 
 QStringList g_pluginErrorList;
 CDSOPluginInterface *dsoPlug = NULL;
@@ -55,6 +56,8 @@ void loadDSOPlugins()
 QList <CDSOPluginInterface::dsoPlgOut_t> dsoGetPluginDesc(const QString name1, const QString name2)
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 {
+  g_lazyDSOPlugins.ensure();
+
   QList <CDSOPluginInterface::dsoPlgOut_t> lst;
 
   for (int i = 0; i < dsoPlugins.count(); i++)
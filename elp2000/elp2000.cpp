@@ -38149,175 +38149,262 @@ const ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient g_ELP36[] =
  {  0, {  4, -1, -1,  0 },     90.00000,   0.00003,     0.028 },
 };
 
-//Handle the main problem calculation
-static double ELP2000Accumulate(double* pT, const ELP2000MainProblemCoefficient* pCoefficients, int nCoefficients, double pTrigFunction(double))
+#define ELP_COUNT(table)   (int)(sizeof(table) / sizeof(table[0]))
+#define ELP_BLOCK          64        // epochs evaluated per batch
+
+//Series with precomputed argument polynomials
+//term = amp * sin(arg[0] + arg[1] * t + ... + arg[degree] * t^degree)
+typedef struct
 {
-  //What will be the return value from this function
-  double fResult = 0;
+  int               degree;
+  QVector <double>  amp;
+  QVector <double>  arg[5];
+} elpSeries_t;
 
+static void elpAddTerm(elpSeries_t &series, double amp, const double *arg)
+{
+  series.amp.append(amp);
+  for (int k=0; k<=series.degree; k++)
+  {
+    series.arg[k].append(arg[k]);
+  }
+}
+
+//Main problem
+static void elpAddMain(elpSeries_t &series, const ELP2000MainProblemCoefficient* pCoefficients, int nCoefficients, bool bCos)
+{
   for (int j=0; j<nCoefficients; j++)
   {
     double tgv = pCoefficients[j].m_B[0] + DTASM * pCoefficients[j].m_B[4];
     double x = pCoefficients[j].m_A + tgv * (g_DELNP - AM * g_DELNU) + pCoefficients[j].m_B[1] * g_DELG + pCoefficients[j].m_B[2] * g_DELE + pCoefficients[j].m_B[3] * g_DELEP;
-    double y = 0;
+    double arg[5];
+
     for (int k=0; k<5; k++)
     {
+      arg[k] = 0;
       for (int i=0; i<4; i++)
-        y += pCoefficients[j].m_I[i] * g_DEL[i][k] * pT[k];
+        arg[k] += pCoefficients[j].m_I[i] * g_DEL[i][k];
     }
-    fResult += x * pTrigFunction(y);
-  }
 
-  return fResult;
+    if (bCos)
+    { // cos(y) = sin(y + PI/2)
+      arg[0] += CPI / 2;
+    }
+
+    elpAddTerm(series, x, arg);
+  }
 }
 
-//Handle the Earth figure perturbations, Tidal Effects, Moon figure & Relativistic perturbations calculation
-static double ELP2000Accumulate(double* pT, const ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient* pCoefficients, int nCoefficients)
+//Earth figure perturbations, Tidal Effects, Moon figure & Relativistic perturbations
+static void elpAddPert(elpSeries_t &series, const ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient* pCoefficients, int nCoefficients)
 {
-  //What will be the return value from this function
-  double fResult = 0;
-
   for (int j=0; j<nCoefficients; j++)
   {
-    double y = D2R(pCoefficients[j].m_O);
+    double arg[2] = {D2R(pCoefficients[j].m_O), 0};
+
     for (int k=0; k<2; k++)
     {
-      y += pCoefficients[j].m_IZ * g_ZETA[k] * pT[k];
+      arg[k] += pCoefficients[j].m_IZ * g_ZETA[k];
       for (int i=0; i<4; i++)
-        y += pCoefficients[j].m_I[i] * g_DEL[i][k] * pT[k];
+        arg[k] += pCoefficients[j].m_I[i] * g_DEL[i][k];
     }
-    fResult += pCoefficients[j].m_A * sin(y);
-  }
 
-  return fResult;
+    elpAddTerm(series, pCoefficients[j].m_A, arg);
+  }
 }
 
-//Handle the Earth figure perturbations & Tidal Effects /t calculation
-static double ELP2000Accumulate_2(double* pT, const ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient* pCoefficients, int nCoefficients)
+//Planetary perturbations Table 1
+static void elpAddTable1(elpSeries_t &series, const ELP2000PlanetPertCoefficient* pCoefficients, int nCoefficients)
 {
-  //What will be the return value from this function
-  double fResult = 0;
-
   for (int j=0; j<nCoefficients; j++)
   {
-    double y = D2R(pCoefficients[j].m_O);
+    double arg[2] = {D2R(pCoefficients[j].m_theta), 0};
+
     for (int k=0; k<2; k++)
     {
-      y += pCoefficients[j].m_IZ * g_ZETA[k] * pT[k];
-      for (int i=0; i<4; i++)
-        y += pCoefficients[j].m_I[i] * g_DEL[i][k] * pT[k];
+      arg[k] += (pCoefficients[j].m_ip[8] * g_DEL[0][k]) + (pCoefficients[j].m_ip[9] * g_DEL[2][k]) + (pCoefficients[j].m_ip[10] * g_DEL[3][k]);
+      for (int i=0; i<8; i++)
+        arg[k] += pCoefficients[j].m_ip[i] * g_P[i][k];
     }
-    fResult += pCoefficients[j].m_A * pT[1] * sin(y);
-  }
 
-  return fResult;
+    elpAddTerm(series, pCoefficients[j].m_O, arg);
+  }
 }
 
-//Handle the Planetary perturbations Table 1 calculation
-static double ELP2000AccumulateTable1(double* pT, const ELP2000PlanetPertCoefficient* pCoefficients, int nCoefficients)
+//Planetary perturbations Table 2
+static void elpAddTable2(elpSeries_t &series, const ELP2000PlanetPertCoefficient* pCoefficients, int nCoefficients)
 {
-  //What will be the return value from this function
-  double fResult = 0;
-
   for (int j=0; j<nCoefficients; j++)
   {
-    double y = D2R(pCoefficients[j].m_theta);
+    double arg[2] = {D2R(pCoefficients[j].m_theta), 0};
+
     for (int k=0; k<2; k++)
     {
-      y += (((pCoefficients[j].m_ip[8] * g_DEL[0][k]) + (pCoefficients[j].m_ip[9] * g_DEL[2][k]) + (pCoefficients[j].m_ip[10] * g_DEL[3][k])) * pT[k]);
-      for (int i=0; i<8; i++)
-        y += pCoefficients[j].m_ip[i] * g_P[i][k] * pT[k];
+      for (int i=0; i<4; i++)
+        arg[k] += pCoefficients[j].m_ip[i + 7] * g_DEL[i][k];
+      for (int i=0; i<7; i++)
+        arg[k] += pCoefficients[j].m_ip[i] * g_P[i][k];
     }
-    fResult += pCoefficients[j].m_O * sin(y);
-  }
 
-  return fResult;
+    elpAddTerm(series, pCoefficients[j].m_O, arg);
+  }
 }
 
-//Handle the Planetary perturbations Table 1 /t calculation
-static double ELP2000AccumulateTable1_2(double* pT, const ELP2000PlanetPertCoefficient* pCoefficients, int nCoefficients)
+//All series, built once (after the tables above are initialized)
+class ELP2000Tables
 {
-  //What will be the return value from this function
-  double fResult = 0;
-
-  for (int j=0; j<nCoefficients; j++)
+public:
+  ELP2000Tables()
   {
-    double y = D2R(pCoefficients[j].m_theta);
-    for (int k=0; k<2; k++)
+    for (int c=0; c<3; c++)
     {
-      y += (((pCoefficients[j].m_ip[8] * g_DEL[0][k]) + (pCoefficients[j].m_ip[9] * g_DEL[2][k]) + (pCoefficients[j].m_ip[10] * g_DEL[3][k])) * pT[k]);
-      for (int i=0; i<8; i++)
-        y += pCoefficients[j].m_ip[i] * g_P[i][k] * pT[k];
+      m_main[c].degree = 4;
+      for (int p=0; p<3; p++)
+        m_pert[c][p].degree = 1;
     }
-    fResult += pCoefficients[j].m_O * pT[1] * sin(y);
+
+    //Longitude
+    elpAddMain(m_main[0], g_ELP1, ELP_COUNT(g_ELP1), false);
+    elpAddPert(m_pert[0][0], g_ELP4, ELP_COUNT(g_ELP4));
+    elpAddPert(m_pert[0][1], g_ELP7, ELP_COUNT(g_ELP7));
+    elpAddTable1(m_pert[0][0], g_ELP10, ELP_COUNT(g_ELP10));
+    elpAddTable1(m_pert[0][1], g_ELP13, ELP_COUNT(g_ELP13));
+    elpAddTable2(m_pert[0][0], g_ELP16, ELP_COUNT(g_ELP16));
+    elpAddTable2(m_pert[0][1], g_ELP19, ELP_COUNT(g_ELP19));
+    elpAddPert(m_pert[0][0], g_ELP22, ELP_COUNT(g_ELP22));
+    elpAddPert(m_pert[0][1], g_ELP25, ELP_COUNT(g_ELP25));
+    elpAddPert(m_pert[0][0], g_ELP28, ELP_COUNT(g_ELP28));
+    elpAddPert(m_pert[0][0], g_ELP31, ELP_COUNT(g_ELP31));
+    elpAddPert(m_pert[0][2], g_ELP34, ELP_COUNT(g_ELP34));
+
+    //Latitude
+    elpAddMain(m_main[1], g_ELP2, ELP_COUNT(g_ELP2), false);
+    elpAddPert(m_pert[1][0], g_ELP5, ELP_COUNT(g_ELP5));
+    elpAddPert(m_pert[1][1], g_ELP8, ELP_COUNT(g_ELP8));
+    elpAddTable1(m_pert[1][0], g_ELP11, ELP_COUNT(g_ELP11));
+    elpAddTable1(m_pert[1][1], g_ELP14, ELP_COUNT(g_ELP14));
+    elpAddTable2(m_pert[1][0], g_ELP17, ELP_COUNT(g_ELP17));
+    elpAddTable2(m_pert[1][1], g_ELP20, ELP_COUNT(g_ELP20));
+    elpAddPert(m_pert[1][0], g_ELP23, ELP_COUNT(g_ELP23));
+    elpAddPert(m_pert[1][1], g_ELP26, ELP_COUNT(g_ELP26));
+    elpAddPert(m_pert[1][0], g_ELP29, ELP_COUNT(g_ELP29));
+    elpAddPert(m_pert[1][0], g_ELP32, ELP_COUNT(g_ELP32));
+    elpAddPert(m_pert[1][2], g_ELP35, ELP_COUNT(g_ELP35));
+
+    //Radius vector
+    elpAddMain(m_main[2], g_ELP3, ELP_COUNT(g_ELP3), true);
+    elpAddPert(m_pert[2][0], g_ELP6, ELP_COUNT(g_ELP6));
+    elpAddPert(m_pert[2][1], g_ELP9, ELP_COUNT(g_ELP9));
+    elpAddTable1(m_pert[2][0], g_ELP12, ELP_COUNT(g_ELP12));
+    elpAddTable1(m_pert[2][1], g_ELP15, ELP_COUNT(g_ELP15));
+    elpAddTable2(m_pert[2][0], g_ELP18, ELP_COUNT(g_ELP18));
+    elpAddTable2(m_pert[2][1], g_ELP21, ELP_COUNT(g_ELP21));
+    elpAddPert(m_pert[2][0], g_ELP24, ELP_COUNT(g_ELP24));
+    elpAddPert(m_pert[2][1], g_ELP27, ELP_COUNT(g_ELP27));
+    elpAddPert(m_pert[2][0], g_ELP30, ELP_COUNT(g_ELP30));
+    elpAddPert(m_pert[2][0], g_ELP33, ELP_COUNT(g_ELP33));
+    elpAddPert(m_pert[2][2], g_ELP36, ELP_COUNT(g_ELP36));
   }
 
-  return fResult;
+  elpSeries_t m_main[3];     // longitude, latitude, radius vector
+  elpSeries_t m_pert[3][3];  // amplitude multiplied by t^0, t^1, t^2
+};
+
+static ELP2000Tables s_elp;
+
+static void elpPowers(double jd, double *t)
+{
+  t[0] = 1;
+  t[1] = (jd - 2451545.0) / 36525.0;
+  t[2] = t[1] * t[1];
+  t[3] = t[2] * t[1];
+  t[4] = t[3] * t[1];
 }
 
-//Handle the Planetary perturbations Table 2 calculation
-static double ELP2000AccumulateTable2(double* pT, const ELP2000PlanetPertCoefficient* pCoefficients, int nCoefficients)
+//Sum of the series for one epoch
+static double elpSum(const elpSeries_t &series, const double *t)
 {
-  //What will be the return value from this function
-  double fResult = 0;
+  const int     n = series.amp.count();
+  const double *amp = series.amp.constData();
+  const double *a0 = series.arg[0].constData();
+  const double *a1 = series.arg[1].constData();
+  double        sum = 0;
 
-  for (int j=0; j<nCoefficients; j++)
+  if (series.degree == 1)
   {
-    double y = D2R(pCoefficients[j].m_theta);
-    for (int k=0; k<2; k++)
-    {
-      for (int i=0; i<4; i++)
-        y += pCoefficients[j].m_ip[i + 7] * g_DEL[i][k] * pT[k];
-      for (int i=0; i<7; i++)
-        y += pCoefficients[j].m_ip[i] * g_P[i][k] * pT[k];
-    }
-    fResult += pCoefficients[j].m_O * sin(y);
+    for (int j=0; j<n; j++)
+      sum += amp[j] * sin(a0[j] + a1[j] * t[1]);
   }
+  else
+  {
+    const double *a2 = series.arg[2].constData();
+    const double *a3 = series.arg[3].constData();
+    const double *a4 = series.arg[4].constData();
 
-  return fResult;
+    for (int j=0; j<n; j++)
+      sum += amp[j] * sin(a0[j] + a1[j] * t[1] + a2[j] * t[2] + a3[j] * t[3] + a4[j] * t[4]);
+  }
+
+  return sum;
 }
 
-//Handle the Planetary perturbations Table 2 /t calculation
-static double ELP2000AccumulateTable2_2(double* pT, const ELP2000PlanetPertCoefficient* pCoefficients, int nCoefficients)
+//Sum of the series for more epochs (epochs in the inner loop)
+static void elpSumBatch(const elpSeries_t &series, double t[5][ELP_BLOCK], int count, double *sum)
 {
-  //What will be the return value from this function
-  double fResult = 0;
+  const int n = series.amp.count();
 
-  for (int j=0; j<nCoefficients; j++)
+  for (int e=0; e<count; e++)
+    sum[e] = 0;
+
+  for (int j=0; j<n; j++)
   {
-    double y = D2R(pCoefficients[j].m_theta);
-    for (int k=0; k<2; k++)
+    const double amp = series.amp[j];
+    const double a0 = series.arg[0][j];
+    const double a1 = series.arg[1][j];
+
+    if (series.degree == 1)
     {
-      for (int i=0; i<4; i++)
-        y += pCoefficients[j].m_ip[i + 7] * g_DEL[i][k] * pT[k];
-      for (int i=0; i<7; i++)
-        y += pCoefficients[j].m_ip[i] * g_P[i][k] * pT[k];
+      for (int e=0; e<count; e++)
+        sum[e] += amp * sin(a0 + a1 * t[1][e]);
+    }
+    else
+    {
+      const double a2 = series.arg[2][j];
+      const double a3 = series.arg[3][j];
+      const double a4 = series.arg[4][j];
+
+      for (int e=0; e<count; e++)
+        sum[e] += amp * sin(a0 + a1 * t[1][e] + a2 * t[2][e] + a3 * t[3][e] + a4 * t[4][e]);
     }
-    fResult += pCoefficients[j].m_O * pT[1] * sin(y);
   }
+}
+
+//Series sums (arcsec, arcsec, km) to the longitude, latitude (rad) and radius vector (km)
+static void elpCoords(const double *t, const double *sum, double *lbr)
+{
+  lbr[0] = sum[0]/SECOND_2_RAD + g_W[0] + g_W[3]*t[1] + g_W[6]*t[2] + g_W[9]*t[3] + g_W[12]*t[4];
+  rangeDbl(&lbr[0], R360);
+
+  lbr[1] = sum[1] / SECOND_2_RAD;
+  lbr[1] = CLAMP(lbr[1], -R90, R90);
 
-  return fResult;
+  lbr[2] = sum[2] * A0 / ATH;
 }
 
-//Handle the Planetary perturbations /t squared calculation
-static double ELP2000Accumulate_3(double* pT, const ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient* pCoefficients, int nCoefficients)
+//Geocentric ecliptic longitude, latitude & radius vector of the Moon (all coordinates share the arguments)
+static void elpCompute(double JD, double *t, double *lbr)
 {
-  //What will be the return value from this function
-  double fResult = 0;
+  double sum[3];
 
-  for (int j=0; j<nCoefficients; j++)
+  elpPowers(JD, t);
+
+  for (int c=0; c<3; c++)
   {
-    double y = D2R(pCoefficients[j].m_O);
-    for (int k=0; k<2; k++)
-    {
-      y += pCoefficients[j].m_IZ * g_ZETA[k] * pT[k];
-      for (int i=0; i<4; i++)
-        y += pCoefficients[j].m_I[i] * g_DEL[i][k] * pT[k];
-    }
-    fResult += pCoefficients[j].m_A * pT[2] * sin(y);
+    sum[c] = elpSum(s_elp.m_main[c], t) + elpSum(s_elp.m_pert[c][0], t) +
+             elpSum(s_elp.m_pert[c][1], t) * t[1] + elpSum(s_elp.m_pert[c][2], t) * t[2];
   }
 
-  return fResult;
+  elpCoords(t, sum, lbr);
 }
 
 ELP2000::ELP2000()
@@ -38328,143 +38415,52 @@ ELP2000::ELP2000()
 //Calculate the geocentric ecliptic longitude of the Moon in radians referred to standard equinox of J2000
 double ELP2000::EclipticLongitude(double JD)
 {
-  static double lastJD = -1;
-  static double lastResult;
-
-  if (lastJD == JD)
-  {
-    return lastResult;
-  }
-
-  //Calculate Julian centuries
   double t[5];
-  t[0] = 1;
-  t[1] = (JD - 2451545.0) / 36525.0;
-  t[2] = t[1] * t[1];
-  t[3] = t[2] * t[1];
-  t[4] = t[3] * t[1];
-
-  //Calculate the Longitude
-  double fELP1  = ELP2000Accumulate        (t, g_ELP1,  sizeof(g_ELP1)/sizeof(ELP2000MainProblemCoefficient), sin);
-  double fELP4  = ELP2000Accumulate        (t, g_ELP4,  sizeof(g_ELP4)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP7  = ELP2000Accumulate_2      (t, g_ELP7,  sizeof(g_ELP7)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP10 = ELP2000AccumulateTable1  (t, g_ELP10, sizeof(g_ELP10)/sizeof(ELP2000PlanetPertCoefficient));
-  double fELP13 = ELP2000AccumulateTable1_2(t, g_ELP13, sizeof(g_ELP13)/sizeof(ELP2000PlanetPertCoefficient));
-  double fELP16 = ELP2000AccumulateTable2  (t, g_ELP16, sizeof(g_ELP16)/sizeof(ELP2000PlanetPertCoefficient));
-  double fELP19 = ELP2000AccumulateTable2_2(t, g_ELP19, sizeof(g_ELP19)/sizeof(ELP2000PlanetPertCoefficient));
-  double fELP22 = ELP2000Accumulate        (t, g_ELP22, sizeof(g_ELP22)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP25 = ELP2000Accumulate_2      (t, g_ELP25, sizeof(g_ELP25)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP28 = ELP2000Accumulate        (t, g_ELP28, sizeof(g_ELP28)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP31 = ELP2000Accumulate        (t, g_ELP31, sizeof(g_ELP31)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP34 = ELP2000Accumulate_3      (t, g_ELP34, sizeof(g_ELP34)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double A = fELP1 + fELP4 + fELP7 + fELP10 + fELP13 + fELP16 + fELP19 + fELP22 + fELP25 + fELP28 + fELP31 + fELP34;
-
-  double res = A/SECOND_2_RAD + g_W[0] + g_W[3]*t[1] + g_W[6]*t[2] + g_W[9]*t[3] + g_W[12]*t[4];
+  double lbr[3];
 
-  rangeDbl(&res, R360);
+  elpCompute(JD, t, lbr);
 
-  lastResult = res;
-  lastJD = JD;
-
-  return res;
+  return lbr[0];
 }
 
 //Calculate the geocentric ecliptic latitude of the Moon in radians referred to standard equinox of J2000
-  double ELP2000::EclipticLatitude(double JD)
+double ELP2000::EclipticLatitude(double JD)
 {
-  static double lastJD = -1;
-  static double lastResult;
-
-  if (lastJD == JD)
-  {
-    return lastResult;
-  }
-
-  //Calculate Julian centuries
   double t[5];
-  t[0] = 1;
-  t[1] = (JD - 2451545.0) / 36525.0;
-  t[2] = t[1] * t[1];
-  t[3] = t[2] * t[1];
-  t[4] = t[3] * t[1];
+  double lbr[3];
 
-  //Calculate the Longitude
-  double fELP2  = ELP2000Accumulate        (t, g_ELP2,  sizeof(g_ELP2)/sizeof(ELP2000MainProblemCoefficient), sin);
-  double fELP5  = ELP2000Accumulate        (t, g_ELP5,  sizeof(g_ELP5)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP8  = ELP2000Accumulate_2      (t, g_ELP8,  sizeof(g_ELP8)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP11 = ELP2000AccumulateTable1  (t, g_ELP11, sizeof(g_ELP11)/sizeof(ELP2000PlanetPertCoefficient));
-  double fELP14 = ELP2000AccumulateTable1_2(t, g_ELP14, sizeof(g_ELP14)/sizeof(ELP2000PlanetPertCoefficient));
-  double fELP17 = ELP2000AccumulateTable2  (t, g_ELP17, sizeof(g_ELP17)/sizeof(ELP2000PlanetPertCoefficient));
-  double fELP20 = ELP2000AccumulateTable2_2(t, g_ELP20, sizeof(g_ELP20)/sizeof(ELP2000PlanetPertCoefficient));
-  double fELP23 = ELP2000Accumulate        (t, g_ELP23, sizeof(g_ELP23)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP26 = ELP2000Accumulate_2      (t, g_ELP26, sizeof(g_ELP26)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP29 = ELP2000Accumulate        (t, g_ELP29, sizeof(g_ELP29)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP32 = ELP2000Accumulate        (t, g_ELP32, sizeof(g_ELP32)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP35 = ELP2000Accumulate_3      (t, g_ELP35, sizeof(g_ELP35)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double B = fELP2 + fELP5 + fELP8 + fELP11 + fELP14 + fELP17 + fELP20 + fELP23 + fELP26 + fELP29 + fELP32 + fELP35;
+  elpCompute(JD, t, lbr);
 
-  double res = B / SECOND_2_RAD;
-  res = CLAMP(res, -R90, R90);
-
-  lastResult = res;
-  lastJD = JD;
-
-  return res;
+  return lbr[1];
 }
 
 //Calculate the radius vector Moon in Kilometers
 double ELP2000::RadiusVector(double JD)
 {
-  static double lastJD = -1;
-  static double lastResult;
-
-  if (lastJD == JD)
-  {
-    return lastResult;
-  }
-
-  //Calculate Julian centuries
   double t[5];
-  t[0] = 1;
-  t[1] = (JD - 2451545.0) / 36525.0;
-  t[2] = t[1] * t[1];
-  t[3] = t[2] * t[1];
-  t[4] = t[3] * t[1];
+  double lbr[3];
 
-  //Calculate the Longitude
-  double fELP3  = ELP2000Accumulate        (t, g_ELP3,  sizeof(g_ELP3)/sizeof(ELP2000MainProblemCoefficient), cos);
-  double fELP6  = ELP2000Accumulate        (t, g_ELP6,  sizeof(g_ELP6)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP9  = ELP2000Accumulate_2      (t, g_ELP9,  sizeof(g_ELP9)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP12 = ELP2000AccumulateTable1  (t, g_ELP12, sizeof(g_ELP12)/sizeof(ELP2000PlanetPertCoefficient));
-  double fELP15 = ELP2000AccumulateTable1_2(t, g_ELP15, sizeof(g_ELP15)/sizeof(ELP2000PlanetPertCoefficient));
-  double fELP18 = ELP2000AccumulateTable2  (t, g_ELP18, sizeof(g_ELP18)/sizeof(ELP2000PlanetPertCoefficient));
-  double fELP21 = ELP2000AccumulateTable2_2(t, g_ELP21, sizeof(g_ELP21)/sizeof(ELP2000PlanetPertCoefficient));
-  double fELP24 = ELP2000Accumulate        (t, g_ELP24, sizeof(g_ELP24)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP27 = ELP2000Accumulate_2      (t, g_ELP27, sizeof(g_ELP27)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP30 = ELP2000Accumulate        (t, g_ELP30, sizeof(g_ELP30)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP33 = ELP2000Accumulate        (t, g_ELP33, sizeof(g_ELP33)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
-  double fELP36 = ELP2000Accumulate_3      (t, g_ELP36, sizeof(g_ELP36)/sizeof(ELP2000EarthTidaltMoonRelativisticSolarEccentricityCoefficient));
+  elpCompute(JD, t, lbr);
 
-  double res = (fELP3 + fELP6 + fELP9 + fELP12 + fELP15 + fELP18 + fELP21 + fELP24 + fELP27 + fELP30 + fELP33 + fELP36) * A0 / ATH;
+  return lbr[2];
+}
 
-  lastResult = res;
-  lastJD = JD;
+static void elpRectangular(const double *lbr, double *data)
+{
+  double fCosLat = cos(lbr[1]);
 
-  return res;
+  data[0] = lbr[2] * cos(lbr[0]) * fCosLat;
+  data[1] = lbr[2] * sin(lbr[0]) * fCosLat;
+  data[2] = lbr[2] * sin(lbr[1]);
 }
 
-
 void ELP2000::EclipticRectangularCoordinates(double JD, double *data)
 {
-  double fLongitude = EclipticLongitude(JD);
-  double fLatitude = EclipticLatitude(JD);
-  double fR = RadiusVector(JD);
-
-  double fCosLat = cos(fLatitude);
+  double t[5];
+  double lbr[3];
 
-  data[0] = fR * cos(fLongitude) * fCosLat;
-  data[1] = fR * sin(fLongitude) * fCosLat;
-  data[2] = fR * sin(fLatitude);
+  elpCompute(JD, t, lbr);
+  elpRectangular(lbr, data);
 }
 
 
@@ -38494,15 +38490,9 @@ static void xyzToSph(double x, double y, double z, double &l, double &b, double
   }
 }
 
-
-void ELP2000::solve(double jd, double *data)
+//Ecliptic coordinates to the J2000 frame and then to the equinox of date (lon, lat, AU)
+static void elpToDate(double jd, const double *t, const double *lbr, double *data)
 {
-  double t[5];
-  t[0] = 1;
-  t[1] = (jd - 2451545.0) / 36525.0;
-  t[2] = t[1] * t[1];
-  t[3] = t[2] * t[1];
-  t[4] = t[3] * t[1];
   double P = (g_P1 + g_P2*t[1] + g_P3*t[2] + g_P4*t[3] + g_P5*t[4]) * t[1];
   double Q = (g_Q1 + g_Q2*t[1] + g_Q3*t[2] + g_Q4*t[3] + g_Q5*t[4]) * t[1];
   double TwoP = 2*P;
@@ -38514,7 +38504,7 @@ void ELP2000::solve(double jd, double *data)
 
   double Ecliptic[3];
 
-  EclipticRectangularCoordinates(jd, Ecliptic);
+  elpRectangular(lbr, Ecliptic);
 
   double J2000[3];
   J2000[0] = OneMinus2P2*Ecliptic[0]          + TwoPQ*Ecliptic[1]               + P*Twosqrt1MinusPart*Ecliptic[2];
@@ -38529,3 +38519,64 @@ void ELP2000::solve(double jd, double *data)
 }
 
 
+void ELP2000::solve(double jd, double *data)
+{
+  double t[5];
+  double lbr[3];
+
+  elpCompute(jd, t, lbr);
+  elpToDate(jd, t, lbr, data);
+}
+
+//Same as solve() for count epochs (data has 3 values per epoch)
+void ELP2000::solveBatch(const double *jd, int count, double *data)
+{
+  for (int i=0; i<count; i+=ELP_BLOCK)
+  {
+    int    n = qMin(ELP_BLOCK, count - i);
+    double t[5][ELP_BLOCK];
+    double sum[3][ELP_BLOCK];
+    double part[ELP_BLOCK];
+
+    for (int e=0; e<n; e++)
+    {
+      double te[5];
+
+      elpPowers(jd[i + e], te);
+      for (int k=0; k<5; k++)
+        t[k][e] = te[k];
+    }
+
+    for (int c=0; c<3; c++)
+    {
+      elpSumBatch(s_elp.m_main[c], t, n, sum[c]);
+
+      elpSumBatch(s_elp.m_pert[c][0], t, n, part);
+      for (int e=0; e<n; e++)
+        sum[c][e] += part[e];
+
+      elpSumBatch(s_elp.m_pert[c][1], t, n, part);
+      for (int e=0; e<n; e++)
+        sum[c][e] += part[e] * t[1][e];
+
+      elpSumBatch(s_elp.m_pert[c][2], t, n, part);
+      for (int e=0; e<n; e++)
+        sum[c][e] += part[e] * t[2][e];
+    }
+
+    for (int e=0; e<n; e++)
+    {
+      double te[5];
+      double s[3];
+      double lbr[3];
+
+      for (int k=0; k<5; k++)
+        te[k] = t[k][e];
+      for (int c=0; c<3; c++)
+        s[c] = sum[c][e];
+
+      elpCoords(te, s, lbr);
+      elpToDate(jd[i + e], te, lbr, data + (i + e) * 3);
+    }
+  }
+}
@@ -30,6 +30,7 @@ public:
   void EclipticRectangularCoordinates(double JD, double *data);
 
   void solve(double jd, double *data);
+  void solveBatch(const double *jd, int count, double *data);
 };
 
 #endif // ELP2000_H
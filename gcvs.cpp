@@ -5,6 +5,7 @@
 #include <QFile>
 #include <QDataStream>
 #include <QDebug>
+#include "clazyload.h"
 
 GCVS g_GCVS;
 
@@ -135,6 +136,8 @@ void GCVS::load()
 
 gcvs_t *GCVS::getStar(qint16 tyc1, qint16 tyc2, qint8 tyc3)
 {    
+  g_lazyGCVS.ensure();
+
   qint64 tyc = MAKE_TYC(tyc1, tyc2, tyc3);
 
   if (m_map.contains(tyc))
@@ -147,6 +150,8 @@ gcvs_t *GCVS::getStar(qint16 tyc1, qint16 tyc2, qint8 tyc3)
 
 bool GCVS::findStar(const QString &name, gcvs_t *star)
 {  
+  g_lazyGCVS.ensure();
+
   foreach (const gcvs_t &item, m_list)
   {        
     if (name.compare(item.name, Qt::CaseInsensitive) == 0)
@@ -161,6 +166,8 @@ bool GCVS::findStar(const QString &name, gcvs_t *star)
 
 QStringList GCVS::nameList()
 {
+  g_lazyGCVS.ensure();
+
   QStringList list;
 
   foreach (const gcvs_t &item, m_list)
@@ -184,6 +191,7 @@ double GCVS::solveNextMinimum(double epoch, double period, double jd)
 
 QList<gcvs_t> GCVS::getList() const
 {
-    return m_list;
+  g_lazyGCVS.ensure();
+  return m_list;
 }
 
@@ -82,6 +82,8 @@
 #include "cinsertfinder.h"
 #include "dssheaderdialog.h"
 #include "moonlessnightsdlg.h"
+#include "cobsplannerdlg.h"
+#include "csatpassesdlg.h"
 #include "xmlattrparser.h"
 #include "clunarfeaturessearch.h"
 #include "cplanetsize.h"
@@ -107,6 +109,9 @@
 #include "planetreport.h"
 #include "lunarphase.h"
 #include "cdssopendialog.h"
+#include "clazyload.h"
+#include "vsop87.h"
+#include "csatxyz.h"
 
 #include <QPrintPreviewDialog>
 #include <QPrinter>
@@ -360,6 +365,8 @@ MainWindow::MainWindow(QWidget *parent) :
   m_search->setFixedWidth(150);
   m_search->setPlaceholderText(tr("[Enter object name]"));
   m_search->addWords(cDSO.getCommonNameList());
+  m_search->addIndex(cDSO.nameIndex());
+  m_search->addIndex(&cTYC.tNameIndex);
   ui->tb_search->insertWidget(ui->actionSearch, m_search);
   m_search->setToolTip(tr("Search"));
   connect(m_search, SIGNAL(returnPressed()), this, SLOT(slotSearchDone()));
@@ -701,9 +708,7 @@ MainWindow::MainWindow(QWidget *parent) :
 
   ui->widget->setFocus();
 
-#if DEBUG
-  QTimer::singleShot(100, this, SLOT(slotPluginError()));
-#endif
+  QTimer::singleShot(1000, this, SLOT(slotWarmUp()));
 
   QTimer::singleShot(100, this, SLOT(slotCheckFirstTime()));
 
@@ -1224,6 +1229,31 @@ void MainWindow::onTreeViewDSSContextMenuRequested(QPoint pos)
   ui->widget->repaintMap();
 }
 
+void MainWindow::slotWarmUp()
+{
+  QSettings set;
+
+  if (set.value("lazy_warm_up", true).toBool())
+  {
+    CLazyLoad::warmUpAll();
+  }
+
+#if DEBUG
+  g_lazyDSOPlugins.ensure();
+  slotPluginError();
+
+  if (!vsop87Check())
+  {
+    qDebug() << "VSOP87 tables differ from the series";
+  }
+
+  if (!CPlanetSatellite::check())
+  {
+    qDebug() << "Planet moon interpolation differs from the theory";
+  }
+#endif
+}
+
 void MainWindow::slotPluginError()
 {
   foreach (const QString& string, g_pluginErrorList)
@@ -3483,7 +3513,7 @@ void MainWindow::slotRealTime()
 {  
   ui->widget->m_mapView.jd = jdGetCurrentJD();
   recenterHoldObject(ui->widget, false);
-  ui->widget->repaintMap();
+  ui->widget->refreshMap();
 }
 
 ////////////////////////////////////
@@ -3492,7 +3522,7 @@ void MainWindow::slotRealTimeLapse()
 {
   ui->widget->m_mapView.jd += JD1SEC * (m_realElapsedTimerLapse.elapsed() / 1000.0) * (double)m_timeLapseMul->value();
   recenterHoldObject(ui->widget, false);
-  ui->widget->repaintMap();
+  ui->widget->refreshMap();
   m_realElapsedTimerLapse.restart();
 }
 
@@ -3854,6 +3884,7 @@ void MainWindow::on_actionConnect_device_triggered()
 
       ui->widget->m_lastTeleRaDec.Ra = CM_UNDEF;
       ui->widget->m_lastTeleRaDec.Dec = CM_UNDEF;
+      g_teleState.reset();
       g_soundManager.play(MC_CONNECT);
 
       g_pTelePlugin->getAxisRates(m_raRates, m_decRates);      
@@ -6589,6 +6620,46 @@ void MainWindow::on_actionMoonless_nights_triggered()
   }
 }
 
+void MainWindow::on_actionObservation_planner_triggered()
+{
+  CObsPlannerDlg dlg(this, &ui->widget->m_mapView);
+
+  if (dlg.exec() == DL_OK)
+  {
+    ui->widget->m_mapView.jd = dlg.m_jd;
+    precess(&dlg.m_rd.Ra, &dlg.m_rd.Dec, JD2000, ui->widget->m_mapView.jd);
+
+    if (dlg.m_mapObj.type != MO_EMPTY)
+    {
+      CObjFillInfo info;
+      ofiItem_t    item;
+
+      info.fillInfo(&ui->widget->m_mapView, &dlg.m_mapObj, &item);
+      fillQuickInfo(&item);
+    }
+
+    ui->widget->centerMap(dlg.m_rd.Ra, dlg.m_rd.Dec, dlg.m_fov);
+  }
+}
+
+void MainWindow::on_actionSatellite_passes_triggered()
+{
+  CSatPassesDlg dlg(this, &ui->widget->m_mapView);
+
+  if (dlg.exec() == DL_OK)
+  {
+    ui->widget->m_mapView.jd = dlg.m_jd;
+
+    CObjFillInfo info;
+    ofiItem_t    item;
+
+    info.fillInfo(&ui->widget->m_mapView, &dlg.m_mapObj, &item);
+    fillQuickInfo(&item);
+
+    ui->widget->centerMap(dlg.m_ra, dlg.m_dec, dlg.m_fov);
+  }
+}
+
 void MainWindow::on_pushButton_34_clicked()
 {
   ofiItem_t *info = getQuickInfo();
@@ -608,6 +608,10 @@ private slots:
 
   void on_actionMoonless_nights_triggered();
 
+  void on_actionObservation_planner_triggered();
+
+  void on_actionSatellite_passes_triggered();
+
   void on_pushButton_34_clicked();
 
   void on_actionSearch_help_triggered();
@@ -760,6 +764,7 @@ signals:
 
 protected slots:
   void slotPluginError();  
+  void slotWarmUp();
   void slotHIPS();
   void slotHIPSPropertiesDone(QNetworkReply::NetworkError error, const QString &errorString);
 };
@@ -19,6 +19,10 @@
 extern MainWindow *pcMainWnd;
 extern CMapView   *pcMapView;
 static QList      <mapObj_t> tObj;
+static QList      <mapObj_t> tObjSave;
+static QList      <mapObj_t> tObjOverlay;      // added by smRenderOverlay()
+static QList      <mapObj_t> tObjOverlaySave;
+static bool                  bObjOverlay = false;
 
 typedef struct
 {
@@ -38,6 +42,13 @@ void holdObject(int type, int id, const QString &name)
   g_HoldObject.objType = type;
 }
 
+///////////////////////////
+bool isHoldObject(int type)
+///////////////////////////
+{
+  return g_bHoldObject && g_HoldObject.objType == type;
+}
+
 ////////////////////////////////
 // -1 = remove any
 void releaseHoldObject(int type)
@@ -151,6 +162,41 @@ void mapObjReset(void)
 //////////////////////
 {
   tObj.clear();
+  tObjOverlay.clear();
+}
+
+/////////////////////
+void mapObjSave(void)
+/////////////////////
+{
+  tObjSave = tObj;
+  tObjOverlaySave = tObjOverlay;
+}
+
+////////////////////////
+void mapObjRestore(void)
+////////////////////////
+{
+  tObj = tObjSave;
+  tObjOverlay = tObjOverlaySave;
+  tObjSave.clear();
+  tObjOverlaySave.clear();
+}
+
+/////////////////////////////
+// following objects replace the previous overlay objects
+void mapObjOverlayBegin(void)
+/////////////////////////////
+{
+  tObjOverlay.clear();
+  bObjOverlay = true;
+}
+
+///////////////////////////
+void mapObjOverlayEnd(void)
+///////////////////////////
+{
+  bObjOverlay = false;
 }
 
 
@@ -170,7 +216,14 @@ void addMapObj(const radec_t &rd, int x, int y, int type, int selType, int size,
   o.par2 = par2;
   o.mag = mag;
 
-  tObj.append(o);
+  if (bObjOverlay)
+  {
+    tObjOverlay.append(o);
+  }
+  else
+  {
+    tObj.append(o);
+  }
 }
 
 /////////////////////////////////////////////////////
@@ -222,21 +275,38 @@ static bool sortObj(mapObj_t &o1, mapObj_t &o2)
   return(false);
 }
 
+///////////////////////////////////////
+// map and overlay objects sorted by sortObj()
+static QList <mapObj_t> sortedObj(void)
+///////////////////////////////////////
+{
+  QList <mapObj_t> list = tObj + tObjOverlay;
+
+  qSort(list.begin(), list.end(), sortObj);
+
+  return(list);
+}
+
 ////////////////////////////////////////////////////////
 bool mapObjSnapAll(int x, int y, radec_t *rd, int &type)
 ////////////////////////////////////////////////////////
 {
-  for (int i = 0; i < tObj.count(); i++)
+  const QList <mapObj_t> *lists[2] = {&tObj, &tObjOverlay};
+
+  for (int l = 0; l < 2; l++)
   {
-    mapObj_t o = tObj[i];
+    for (int i = 0; i < lists[l]->count(); i++)
+    {
+      mapObj_t o = lists[l]->at(i);
 
-    if (o.type != MO_INSERT && checkMapObjPos(QPoint(x, y), &tObj[i]))
-    {      
-      rd->Ra = o.rd.Ra;
-      rd->Dec = o.rd.Dec;            
-      type = o.type;
+      if (o.type != MO_INSERT && checkMapObjPos(QPoint(x, y), &o))
+      {
+        rd->Ra = o.rd.Ra;
+        rd->Dec = o.rd.Dec;
+        type = o.type;
 
-      return(true);
+        return(true);
+      }
     }
   }
 
@@ -273,14 +343,13 @@ bool mapObjSnap(int x, int y, radec_t *rd)
 bool mapObjSearch(int x, int y, mapObj_t *obj)
 //////////////////////////////////////////////
 {
-  mapObj_t o;
-  QPoint   wpos = QPoint(x, y);
-
-  qSort(tObj.begin(), tObj.end(), sortObj);
+  mapObj_t         o;
+  QPoint           wpos = QPoint(x, y);
+  QList <mapObj_t> list = sortedObj();
 
-  for (int i = 0; i < tObj.count(); i++)
+  for (int i = 0; i < list.count(); i++)
   {
-    o = tObj[i];
+    o = list[i];
     if (checkMapObjPos(wpos, &o))
     {
       *obj = o;
@@ -308,9 +377,7 @@ void mapObjContextMenu(CMapView *map)
 
   QString cHoldObj = QObject::tr("  Hold object ");
 
-  tObjTmp = tObj;
-
-  qSort(tObjTmp.begin(), tObjTmp.end(), sortObj);
+  tObjTmp = sortedObj();
 
   a = myMenu.addAction(QIcon(":res/ico_center.png"), QObject::tr("Center map"));
   a->setData(-1);
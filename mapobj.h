@@ -49,6 +49,10 @@ typedef struct
 } mapObj_t;
 
 void mapObjReset(void);
+void mapObjSave(void);
+void mapObjRestore(void);
+void mapObjOverlayBegin(void);
+void mapObjOverlayEnd(void);
 void addMapObj(const radec_t &rd, int x, int y, int type, int selType, int size, qint64 par1, qint64 par2, double mag = 255);
 void mapObjContextMenu(CMapView *map);
 bool mapObjSnapAll(int x, int y, radec_t *rd, int &type);
@@ -57,6 +61,7 @@ bool mapObjSearch(int x, int y, mapObj_t *obj);
 void recenterHoldObject(CMapView *p, bool bRepaint = true);
 void releaseHoldObject(int type);
 void holdObject(int type, int id, const QString &name);
+bool isHoldObject(int type);
 QString checkObjOnMap(const QPoint &pos);
 
 #endif // MAPOBJ_H
@@ -7,6 +7,8 @@
 #define mods3600(x)  ((x) - 1296000.0 * floor((x) / 1296000.0))
 #define SCHAR         short
 
+#define ML_CACHE_SIZE 16     // cached epochs (LRU)
+
 struct plantbl {
   char max_harmonic[14];
   char max_power_of_t;
@@ -35,6 +37,19 @@ class CMLibration
 
 static double STR = 4.8481368110953599359e-6; // radians per arc second
 
+typedef struct
+{
+  double  jd;
+  double  lat;
+  double  lon;
+  qint64  lastUse;
+  bool    valid;
+} mlCacheItem_t;
+
+static QMutex        mlMutex;
+static mlCacheItem_t mlCache[ML_CACHE_SIZE];
+static qint64        mlUse = 0;
+
 CMLibration::CMLibration()
 {
   Jlast = -1.0e38;
@@ -2044,6 +2059,9 @@ int CMLibration::dargs (double J, struct plantbl *plan)
   w = mods3600 (4399609.65932 * T + 180278.89694);
   w += ((4.475946e-8 * T - 6.874806E-5) * T + 7.56161437443E-1) * T2;
   sscc (5, STR * w, plan->max_harmonic[5]);
+
+  // the arguments are shared by liblon and liblat
+  Jlast = J;
   return 0;
 }
 
@@ -2148,15 +2166,53 @@ double CMLibration::gplan (double J, struct plantbl *plan)
 
 
 //////////////////////////////////////////////////////
+// thread safe, results are cached by date
 void mLibration(double JD,double *llatp,double *llonp)
 //////////////////////////////////////////////////////
 {
   double lon, lat;	/* arc seconds */
   CMLibration ml;
 
+  mlMutex.lock();
+  for (int i = 0; i < ML_CACHE_SIZE; i++)
+  {
+    if (mlCache[i].valid && mlCache[i].jd == JD)
+    {
+      mlCache[i].lastUse = ++mlUse;
+      *llatp = mlCache[i].lat;
+      *llonp = mlCache[i].lon;
+      mlMutex.unlock();
+      return;
+    }
+  }
+  mlMutex.unlock();
+
   lon = ml.gplan(JD, &liblon);
   lat = ml.gplan(JD, &liblat);
 
   *llonp = DEG2RAD(lon/3600.0);
   *llatp = DEG2RAD(lat/3600.0);
+
+  QMutexLocker locker(&mlMutex);
+  int old = 0;
+
+  for (int i = 0; i < ML_CACHE_SIZE; i++)
+  {
+    if (!mlCache[i].valid)
+    {
+      old = i;
+      break;
+    }
+
+    if (mlCache[i].lastUse < mlCache[old].lastUse)
+    {
+      old = i;
+    }
+  }
+
+  mlCache[old].jd = JD;
+  mlCache[old].lat = *llatp;
+  mlCache[old].lon = *llonp;
+  mlCache[old].lastUse = ++mlUse;
+  mlCache[old].valid = true;
 }
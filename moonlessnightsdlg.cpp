@@ -1,6 +1,7 @@
 #include "moonlessnightsdlg.h"
 #include "ui_moonlessnightsdlg.h"
 #include "skutils.h"
+#include "calmanac.h"
 
 MoonlessNightsDlg::MoonlessNightsDlg(QWidget *parent, mapView_t *view) :
   QDialog(parent),
@@ -8,9 +9,11 @@ MoonlessNightsDlg::MoonlessNightsDlg(QWidget *parent, mapView_t *view) :
 {
   ui->setupUi(this);
   m_view = *view;  
+  m_waiting = false;
   m_startJD = m_jd = getStartOfDay(view->jd, view->geo.tz);
   fillList();
 
+  connect(&g_almanac, SIGNAL(sigReady()), this, SLOT(slotAlmanacReady()));
   connect(ui->widget, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(on_pushButton_2_clicked()));
 }
 
@@ -21,24 +24,41 @@ MoonlessNightsDlg::~MoonlessNightsDlg()
 
 void MoonlessNightsDlg::fillList()
 {
-  CAstro ast;
-  double jd = m_startJD;
+  QList <double> list;
 
   ui->widget->removeAll();
+  g_almanac.request(&m_view, m_startJD, 90, AL_PHASE);
 
   for (int i = 0; i < 90; i++)
   {
-    orbit_t moon;
+    almanacDay_t day;
 
-    m_view.jd = jd + i;
-    ast.setParam(&m_view);
-    ast.calcPlanet(PT_MOON, &moon);
+    if (!g_almanac.get(&m_view, m_startJD + i, AL_PHASE, &day))
+    { // filled on sigReady()
+      m_waiting = true;
+      return;
+    }
 
-    if ((moon.phase * 100.) < ui->spinBox->value())
+    if ((day.moonPhase * 100.) < ui->spinBox->value())
     {
-      ui->widget->addRow(getStrDate(m_view.jd, m_view.geo.tz) + " " + getTimeZone(m_view.geo.tz), m_view.jd);
+      list.append(day.jd);
     }
   }
+
+  m_waiting = false;
+
+  foreach (double jd, list)
+  {
+    ui->widget->addRow(getStrDate(jd, m_view.geo.tz) + " " + getTimeZone(m_view.geo.tz), jd);
+  }
+}
+
+void MoonlessNightsDlg::slotAlmanacReady()
+{
+  if (m_waiting)
+  {
+    fillList();
+  }
 }
 
 void MoonlessNightsDlg::on_pushButton_3_clicked()
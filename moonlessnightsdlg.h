@@ -29,10 +29,13 @@ private slots:
 
   void on_pushButton_5_clicked();
 
+  void slotAlmanacReady();
+
 private:
   Ui::MoonlessNightsDlg *ui;
   mapView_t m_view;
   double m_startJD;
+  bool m_waiting;
 
   void fillList();
 };
@@ -199,7 +199,8 @@ void earthVelocity(double JD, double &X, double &Y, double &Z)
 }
 
 
-double nutationInLongitude(double JD)
+// nutation in longitude and obliquity (rad), both from one pass of the series
+void nutation(double JD, double &nutLon, double &nutObl)
 {
   double T = (JD - 2451545) / 36525;
   double Tsquared = T * T;
@@ -221,52 +222,38 @@ double nutationInLongitude(double JD)
   rangeDbl(&omega, 360);
 
   int nCoefficients = sizeof(g_NutationCoefficients) / sizeof(NutationCoefficient);
-  double value = 0;
+  double lon = 0;
+  double obl = 0;
   for (int i=0; i<nCoefficients; i++)
   {
     double argument = g_NutationCoefficients[i].D * D + g_NutationCoefficients[i].M * M +
                       g_NutationCoefficients[i].Mprime * Mprime + g_NutationCoefficients[i].F * F +
                       g_NutationCoefficients[i].omega * omega;
     double radargument = D2R(argument);
-    value += (g_NutationCoefficients[i].sincoeff1 + g_NutationCoefficients[i].sincoeff2 * T) * sin(radargument) * 0.0001;
+    lon += (g_NutationCoefficients[i].sincoeff1 + g_NutationCoefficients[i].sincoeff2 * T) * sin(radargument) * 0.0001;
+    obl += (g_NutationCoefficients[i].coscoeff1 + g_NutationCoefficients[i].coscoeff2 * T) * cos(radargument) * 0.0001;
   }
 
-  return D2R(value / 3600.0);
+  nutLon = D2R(lon / 3600.0);
+  nutObl = D2R(obl / 3600.0);
 }
 
-double nutationInObliquity(double JD)
+double nutationInLongitude(double JD)
 {
-  double T = (JD - 2451545) / 36525;
-  double Tsquared = T*T;
-  double Tcubed = Tsquared*T;
-
-  double D = 297.85036 + 445267.111480*T - 0.0019142*Tsquared + Tcubed / 189474;
-  rangeDbl(&D, 360);
-
-  double M = 357.52772 + 35999.050340*T - 0.0001603*Tsquared - Tcubed / 300000;
-  rangeDbl(&M, 360);
+  double nutLon, nutObl;
 
-  double Mprime = 134.96298 + 477198.867398*T + 0.0086972*Tsquared + Tcubed / 56250;
-  rangeDbl(&Mprime, 360);
+  nutation(JD, nutLon, nutObl);
 
-  double F = 93.27191 + 483202.017538*T - 0.0036825*Tsquared + Tcubed / 327270;
-  rangeDbl(&F, 360);
+  return nutLon;
+}
 
-  double omega = 125.04452 - 1934.136261*T + 0.0020708*Tsquared + Tcubed / 450000;
-  rangeDbl(&omega, 360);
+double nutationInObliquity(double JD)
+{
+  double nutLon, nutObl;
 
-  int nCoefficients = sizeof(g_NutationCoefficients) / sizeof(NutationCoefficient);
-  double value = 0;
-  for (int i=0; i<nCoefficients; i++)
-  {
-    double argument = g_NutationCoefficients[i].D * D + g_NutationCoefficients[i].M * M +
-                      g_NutationCoefficients[i].Mprime * Mprime + g_NutationCoefficients[i].F * F +
-                      g_NutationCoefficients[i].omega * omega;
-    double radargument = D2R(argument);
-    value += (g_NutationCoefficients[i].coscoeff1 + g_NutationCoefficients[i].coscoeff2 * T) * cos(radargument) * 0.0001;
-  }
+  nutation(JD, nutLon, nutObl);
 
-  return D2R(value / 3600.0);
+  return nutObl;
 }
 
 double nutationInRightAscension(double Alpha, double Delta, double Obliquity, double NutationInLongitude, double NutationInObliquity)
@@ -280,16 +267,16 @@ double nutationInDeclination(double Alpha, double Obliquity, double NutationInLo
 }
 
 
-radec_t equatorialAberration(double Alpha, double Delta, double JD)
+static radec_t equatorialAberration(double Alpha, double Delta, const double *vel)
 {
   double cosAlpha = cos(Alpha);
   double sinAlpha = sin(Alpha);
   double cosDelta = cos(Delta);
   double sinDelta = sin(Delta);
 
-  double X, Y, Z;
-
-  earthVelocity(JD, X, Y, Z);
+  double X = vel[0];
+  double Y = vel[1];
+  double Z = vel[2];
 
   //What is the return value
   //CAA2DCoordinate aberration;
@@ -308,16 +295,17 @@ radec_t equatorialAberration(double Alpha, double Delta, double JD)
 
 void nutationAndAberation(radec_t &rd, double jd)
 {
-  double nutLon = nutationInLongitude(jd);
-  double nutObl = nutationInObliquity(jd);
-  double obl = CAstro::getEclObl(jd);
-
   double ra = rd.Ra;
   double dec = rd.Dec;
+  double eclObl = CAstro::getEclObl(jd);
+  double nutLon, nutObl;
+  double vel[3];
 
-  rd.Ra += nutationInRightAscension(ra, dec, obl, nutLon, nutObl);
-  rd.Dec += nutationInDeclination(ra, obl, nutLon, nutObl);
+  nutation(jd, nutLon, nutObl);
+  earthVelocity(jd, vel[0], vel[1], vel[2]);
 
-  rd = equatorialAberration(rd.Ra, rd.Dec, jd);
-}
+  rd.Ra += nutationInRightAscension(ra, dec, eclObl, nutLon, nutObl);
+  rd.Dec += nutationInDeclination(ra, eclObl, nutLon, nutObl);
 
+  rd = equatorialAberration(rd.Ra, rd.Dec, vel);
+}
@@ -2,6 +2,10 @@
 #define NUTATION_H
 
 #include "const.h"
+#include "precess.h"
+
+void nutation(double JD, double &nutLon, double &nutObl);
+void earthVelocity(double JD, double &X, double &Y, double &Z);
 
 double nutationInLongitude(double JD);
 double nutationInObliquity(double JD);
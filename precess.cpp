@@ -5,6 +5,8 @@
 #include "precess.h"
 #include <castro.h>
 
+#include <QThreadStorage>
+
 #define	DCOS(x)		cos(DEG2RAD(x))
 #define	DSIN(x)		sin(DEG2RAD(x))
 #define	DASIN(x)	RAD2DEG(asin(x))
@@ -19,6 +21,84 @@ X =  -3.4781454 AU   Y =  -9.3876653 AU   Z =  +0.3025034 AU (mean eq.)
 
 */
 
+typedef struct
+{
+  skFrame_t frame;
+  qint64    lastUse;
+  bool      valid;
+} pfCacheItem_t;
+
+typedef struct
+{
+  pfCacheItem_t item[PF_CACHE_SIZE];
+  qint64        use;
+} pfCache_t;
+
+// one cache per thread (no locking in the render loops)
+static QThreadStorage <pfCache_t *> pfCache;
+
+static void precessMatrixCalc(double jdFrom, double jdTo, SKMATRIX *m);
+
+// rotation part of the matrix only
+static inline void pfRotate(const SKMATRIX *mat, const double *v, double *out)
+{
+  out[0] = v[0] * mat->m_11 + v[1] * mat->m_21 + v[2] * mat->m_31;
+  out[1] = v[0] * mat->m_12 + v[1] * mat->m_22 + v[2] * mat->m_32;
+  out[2] = v[0] * mat->m_13 + v[1] * mat->m_23 + v[2] * mat->m_33;
+}
+
+//////////////////////////////////////////////
+// thread safe, frames are cached by date
+void precessFrame(double jd, skFrame_t *frame)
+//////////////////////////////////////////////
+{
+  pfCache_t *c = pfCache.hasLocalData() ? pfCache.localData() : NULL;
+  int        lru = 0;
+
+  if (c == NULL)
+  {
+    c = new pfCache_t;
+    for (int i = 0; i < PF_CACHE_SIZE; i++)
+    {
+      c->item[i].valid = false;
+    }
+    c->use = 0;
+    pfCache.setLocalData(c);
+  }
+
+  for (int i = 0; i < PF_CACHE_SIZE; i++)
+  {
+    pfCacheItem_t *item = &c->item[i];
+
+    if (item->valid && item->frame.jd == jd)
+    {
+      item->lastUse = ++c->use;
+      *frame = item->frame;
+      return;
+    }
+
+    if (!item->valid)
+    {
+      lru = i;
+    }
+    else if (c->item[lru].valid && item->lastUse < c->item[lru].lastUse)
+    {
+      lru = i;
+    }
+  }
+
+  skFrame_t *f = &c->item[lru].frame;
+
+  f->jd = jd;
+  precessMatrixCalc(JD2000, jd, &f->toDate);
+  precessMatrixCalc(jd, JD2000, &f->toJ2000);
+
+  c->item[lru].lastUse = ++c->use;
+  c->item[lru].valid = true;
+
+  *frame = *f;
+}
+
 ////////////////////////////////////////////////////////////////////
 void precess(radec_t *src, radec_t *dst, double jdFrom, double jdTo)
 ////////////////////////////////////////////////////////////////////
@@ -68,18 +148,25 @@ void precess(double *ra, double *dec, double jdFrom, double jdTo)
   SKMATRIX mat;
 
   precessMatrix(jdFrom, jdTo, &mat);
+  precessMat(ra, dec, &mat);
+}
 
+///////////////////////////////////////////////////////////
+void precessMat(double *ra, double *dec, const SKMATRIX *m)
+///////////////////////////////////////////////////////////
+{
   double cDec = cos(-*dec);
-  SKVECTOR r;
+  double r[3];
+  double v[3];
 
-  r.x = cDec * sin(-*ra);
-  r.y = sin(-*dec);
-  r.z = cDec * cos(-*ra);
+  v[0] = cDec * sin(-*ra);
+  v[1] = sin(-*dec);
+  v[2] = cDec * cos(-*ra);
 
-  SKVECTransform(&r, &r, &mat);
+  pfRotate(m, v, r);
 
-  *ra  = atan2(r.z, r.x) - R90;
-  *dec = -atan2(r.y, sqrt(r.x * r.x + r.z * r.z));
+  *ra  = atan2(r[2], r[0]) - R90;
+  *dec = -atan2(r[1], sqrt(r[0] * r[0] + r[2] * r[2]));
   rangeDbl(ra, R360);
 }
 
@@ -87,40 +174,51 @@ void precess(double *ra, double *dec, double jdFrom, double jdTo)
 void precessRect(double *r, double jdFrom, double jdTo)
 ///////////////////////////////////////////////////////
 {
-  double ra, dec;
-
-  double dist = sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+  SKMATRIX mat;
+  double   v[3];
+  double   out[3];
 
-  ra  = atan2(r[1], r[0]);
-  dec = atan2(r[2], sqrt(r[0] * r[0] + r[1] * r[1]));
+  precessMatrix(jdFrom, jdTo, &mat);
 
-  precess(&ra, &dec, jdFrom, jdTo);
+  // same axes as precess()
+  v[0] = -r[1];
+  v[1] = -r[2];
+  v[2] =  r[0];
 
-  double cDec = cos(dec);
+  pfRotate(&mat, v, out);
 
-  r[0] = cDec * cos(ra) * dist;
-  r[1] = cDec * sin(ra) * dist;
-  r[2] = sin(dec) * dist;
+  r[0] =  out[2];
+  r[1] = -out[0];
+  r[2] = -out[1];
 }
 
 ///////////////////////////////////////////////////////////
 void precessMatrix(double jdFrom, double jdTo, SKMATRIX *m)
 ///////////////////////////////////////////////////////////
 {
-  static SKMATRIX lastMat;
-  static double lastFrom = -1;
-  static double lastTo = -1;
+  skFrame_t frame;
 
-  if (jdFrom == lastFrom &&
-      jdTo == lastTo)
+  if (jdFrom == JD2000)
   {
-    *m = lastMat;
+    precessFrame(jdTo, &frame);
+    *m = frame.toDate;
     return;
   }
 
-  lastFrom = jdFrom;
-  lastTo = lastTo;
+  if (jdTo == JD2000)
+  {
+    precessFrame(jdFrom, &frame);
+    *m = frame.toJ2000;
+    return;
+  }
+
+  precessMatrixCalc(jdFrom, jdTo, m);
+}
 
+//////////////////////////////////////////////////////////////////////
+static void precessMatrixCalc(double jdFrom, double jdTo, SKMATRIX *m)
+//////////////////////////////////////////////////////////////////////
+{
   jdFrom = (jdFrom - JD2000) / 36525.0;
   jdTo = (jdTo - JD2000) / 36525.0;
 
@@ -3,6 +3,18 @@
 
 #include "skcore.h"
 
+#define PF_CACHE_SIZE   8   // cached frames (LRU)
+
+// frame of the date (J2000 <-> mean equator and equinox of date)
+typedef struct
+{
+  double   jd;
+  SKMATRIX toDate;       // J2000 -> date
+  SKMATRIX toJ2000;      // date -> J2000
+} skFrame_t;
+
+void precessFrame(double jd, skFrame_t *frame);
+void precessMat(double *ra, double *dec, const SKMATRIX *m);
 void precess(radec_t *src, radec_t *dst, double jdFrom, double jdTo);
 void precess(double *ra, double *dec, double jdFrom, double jdTo);
 void precessRect(double *r, double jdFrom, double jdTo);
@@ -2,20 +2,82 @@
 #include "mainwindow.h"
 #include "cdrawing.h"
 #include "build.h"
+#include "skymap.h"
+#include "transform.h"
+#include "castro.h"
+#include "precess.h"
 
 #include <QMessageBox>
+#include <QThreadPool>
+#include <QTimer>
+#include <QtEndian>
+#include <QBuffer>
 #include <QDebug>
 
 SkServer g_skServer;
 
+class CScrEncoder : public QRunnable
+{
+public:
+  CScrEncoder(int id, bool push, const QImage &image, const skScrParams_t &par) :
+    m_id(id), m_push(push), m_image(image), m_par(par)
+  {
+  }
+
+  void run()
+  {
+    QImage     img = m_image;
+    QByteArray data;
+
+    if (m_par.rect.isValid())
+    {
+      img = img.copy(m_par.rect);
+    }
+
+    if (m_par.scale != 1)
+    {
+      img = img.scaled(qMax(1, qRound(img.width() * m_par.scale)), qMax(1, qRound(img.height() * m_par.scale)),
+                       Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    if (m_par.format == SKS_IMG_RAW)
+    {
+      img = img.convertToFormat(QImage::Format_RGB888);
+      data.reserve(img.width() * img.height() * 3);
+      for (int y = 0; y < img.height(); y++)
+      {
+        data.append((const char *)img.constScanLine(y), img.width() * 3);
+      }
+    }
+    else
+    {
+      QBuffer buffer(&data);
+
+      buffer.open(QIODevice::WriteOnly);
+      img.save(&buffer, m_par.format == SKS_IMG_PNG ? "PNG" : "JPG", m_par.format == SKS_IMG_PNG ? -1 : 85);
+    }
+
+    QMetaObject::invokeMethod(&g_skServer, "slotImageReady", Qt::QueuedConnection,
+                              Q_ARG(int, m_id), Q_ARG(bool, m_push), Q_ARG(int, m_par.format),
+                              Q_ARG(int, img.width()), Q_ARG(int, img.height()), Q_ARG(QByteArray, data));
+  }
+
+private:
+  int           m_id;
+  bool          m_push;
+  QImage        m_image;
+  skScrParams_t m_par;
+};
+
 SkServer::SkServer(QObject *parent) : QObject(parent),
-  m_server(0), m_client(0), m_mainWin(0)
+  m_nextId(0), m_server(0), m_client(0), m_mainWin(0)
 {
 }
 
 void SkServer::setMainWindow(MainWindow *main)
 {
   m_mainWin = main;
+  connect(m_mainWin->getView(), SIGNAL(sigMapChanged()), this, SLOT(slotMapChanged()));
 }
 
 void SkServer::setPort(int port)
@@ -32,6 +94,7 @@ void SkServer::start()
 {
   if (m_server)
   {
+    removeAll();
     delete m_server;
   }
 
@@ -49,7 +112,6 @@ void SkServer::start()
   }
   else
   {
-    m_server->setMaxPendingConnections(1);
     qDebug() << "listening" << m_server->isListening();
   }
 
@@ -60,6 +122,7 @@ void SkServer::start()
 
 void SkServer::stop()
 {
+  removeAll();
   m_server->close();
   delete m_server;
   m_server = NULL;
@@ -67,6 +130,20 @@ void SkServer::stop()
   stateChange();
 }
 
+void SkServer::removeAll()
+{
+  foreach (skClient_t *client, m_clients)
+  {
+    client->socket->disconnect(this);
+    client->socket->abort();
+    client->socket->deleteLater();
+    delete client;
+  }
+
+  m_clients.clear();
+  m_client = NULL;
+}
+
 bool SkServer::isRunning()
 {
   if (!m_server)
@@ -79,177 +156,298 @@ bool SkServer::isRunning()
 
 bool SkServer::isConnected(QString &addr)
 {
-  if (!m_client || !m_server)
+  if (!m_server)
   {
     return false;
   }
 
-  if (m_client->isValid() && (m_client->state() == QAbstractSocket::ConnectedState))
+  QStringList list;
+
+  foreach (skClient_t *client, m_clients)
   {
-    addr = m_client->peerAddress().toString();
-    return true;
+    if (client->socket->isValid() && (client->socket->state() == QAbstractSocket::ConnectedState))
+    {
+      list.append(client->socket->peerAddress().toString());
+    }
+  }
+
+  addr = list.join(", ");
+
+  return list.count() > 0;
+}
+
+skClient_t *SkServer::findClient(QObject *socket)
+{
+  foreach (skClient_t *client, m_clients)
+  {
+    if (client->socket == socket)
+    {
+      return client;
+    }
+  }
+
+  return NULL;
+}
+
+skClient_t *SkServer::findClient(int id)
+{
+  foreach (skClient_t *client, m_clients)
+  {
+    if (client->id == id)
+    {
+      return client;
+    }
   }
 
-  return false;
+  return NULL;
 }
 
 void SkServer::slotConnected()
 {
-  if (m_client)
+  QTcpSocket *socket;
+
+  while ((socket = m_server->nextPendingConnection()) != NULL)
   {
-    QTcpSocket *client = m_server->nextPendingConnection();
-    if (client)
+    if (m_clients.count() >= SKS_MAX_CLIENTS)
     {
-      qDebug() << client->peerAddress() << "reject";
+      qDebug() << socket->peerAddress() << "reject";
 
       QByteArray data;
 
       data.append(SKS_REJECT);
       data += "\r\n";
 
-      qDebug() << data;
+      socket->write(data);
+      socket->flush();
+      socket->disconnectFromHost();
+      connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+      continue;
+    }
 
-      client->write(data);
-      client->flush();
+    qDebug() << "connected" << socket->peerAddress() << socket->peerName() << socket->peerPort();
 
-      client->disconnectFromHost();
-    }
-    return;
-  }
+    skClient_t *client = new skClient_t;
 
-  m_client = m_server->nextPendingConnection();
-  if (m_client)
-  {
-    qDebug() << "connected" << m_client->peerAddress() << m_client->peerName() << m_client->peerPort();
+    client->id = m_nextId++;
+    client->socket = socket;
+    client->binary = false;
+    client->subscribe = 0;
+    client->encoding = false;
+    m_clients.append(client);
 
-    connect(m_client, SIGNAL(readyRead()), this, SLOT(dataReady()));
-    connect(m_client, SIGNAL(disconnected()), this, SLOT(slotDisconnect()));
+    connect(socket, SIGNAL(readyRead()), this, SLOT(dataReady()));
+    connect(socket, SIGNAL(disconnected()), this, SLOT(slotDisconnect()));
 
+    m_client = client;
     sendData(SKS_OK);
+    m_client = NULL;
   }
   stateChange();
 }
 
 void SkServer::dataReady()
 {
-  QByteArray data;
-
-  data = m_client->readAll();
+  skClient_t *client = findClient(sender());
 
-  qDebug() << data;
+  if (client == NULL)
+  {
+    return;
+  }
 
   QStringList commands;
-  QString str;
 
-  for (int i = 0; i < data.count(); i++)
+  client->buffer += client->socket->readAll();
+
+  if (client->binary)
   {
-    if ((data.mid(i, 3) == "\r\n\n") || (data.mid(i, 3) == "\r\n"))
+    // quint32 length (big endian) + command
+    while (client->buffer.size() >= 4)
     {
-      commands.append(str);
-      i += 2;
-      str.clear();
-    }
-    else
-    {
-      str += data[i];
+      const uchar *p = (const uchar *)client->buffer.constData();
+      quint32 len = qFromBigEndian<quint32>(p);
+
+      if (len > 65536)
+      {
+        client->buffer.clear();
+        client->socket->disconnectFromHost();
+        return;
+      }
+
+      if ((quint32)client->buffer.size() < 4 + len)
+      {
+        break;
+      }
+
+      commands.append(QString::fromUtf8(client->buffer.mid(4, len)));
+      client->buffer.remove(0, 4 + len);
     }
   }
-
-  if (commands.count() == 0)
+  else
   {
-    sendData(SKS_INVALID);
-    return;
+    int i;
+
+    while ((i = client->buffer.indexOf('\n')) >= 0)
+    {
+      QByteArray line = client->buffer.left(i);
+
+      client->buffer.remove(0, i + 1);
+      if (line.endsWith('\r'))
+      {
+        line.chop(1);
+      }
+
+      if (!line.isEmpty())
+      {
+        commands.append(QString::fromLocal8Bit(line));
+      }
+    }
   }
 
   foreach (const QString &command, commands)
   {
-    if (command.startsWith("Echo ", Qt::CaseInsensitive))
-    {
-      sendData(command.mid(5).toLocal8Bit());
-    }
-    else
-    if (command.startsWith("SetPos ", Qt::CaseInsensitive))
-    {
-      setRA_Dec(command.mid(6));
-    }
-    else
-    if (!command.compare("GetPos", Qt::CaseInsensitive))
-    {
-      getPos();
-    }
-    else
-    if (!command.compare("GetJD", Qt::CaseInsensitive))
-    {
-      getJD();
-    }
-    else
-    if (command.startsWith("SetJD ", Qt::CaseInsensitive))
-    {
-      setJD(command.mid(5));
-    }
-    else
-    if (!command.compare("ZoomIn", Qt::CaseInsensitive))
-    {
-      zoom(1);
-    }
-    else
-    if (!command.compare("ZoomOut", Qt::CaseInsensitive))
+    // the client can be removed by a command
+    if (!m_clients.contains(client))
     {
-      zoom(-1);
-    }
-    else
-    if (command.startsWith("SetMode ", Qt::CaseInsensitive))
-    {
-      setMode(command.mid(8));
-    }
-    else
-    if (!command.compare("ServerVer", Qt::CaseInsensitive))
-    {
-      sendData(SK_SERVER_VERSION);
-    }
-    else
-    if (!command.compare("SwVer", Qt::CaseInsensitive))
-    {
-      sendData(SK_VERSION);
-    }
-    else
-    if (command.startsWith("SetExtFrame ", Qt::CaseInsensitive))
-    {
-      setExtFrame(command.mid(11));
-    }
-    else
-    if (!command.compare("GetExtFrame", Qt::CaseInsensitive))
-    {
-      getExtFrame();
-    }
-    else
-    if (command.startsWith("SetRTC ", Qt::CaseInsensitive))
-    {
-      setRTC(command.mid(7));
-    }
-    else
-    if (!command.compare("GetRTC", Qt::CaseInsensitive))
-    {
-      getRTC();
-    }
-    else
-    if (!command.compare("Redraw", Qt::CaseInsensitive))
-    {
-      m_mainWin->getView()->repaintMap();
-      sendData(SKS_OK);
-    }
-    else
-    {
-      sendData(SKS_UNKNOWN);
+      break;
     }
+
+    m_client = client;
+    execute(command);
+  }
+
+  m_client = NULL;
+}
+
+void SkServer::execute(const QString &command)
+{
+  qDebug() << command;
+
+  if (command.startsWith("Echo ", Qt::CaseInsensitive))
+  {
+    sendData(command.mid(5).toLocal8Bit());
+  }
+  else
+  if (command.startsWith("SetPos ", Qt::CaseInsensitive))
+  {
+    setRA_Dec(command.mid(6));
+  }
+  else
+  if (!command.compare("GetPos", Qt::CaseInsensitive))
+  {
+    getPos();
+  }
+  else
+  if (!command.compare("GetJD", Qt::CaseInsensitive))
+  {
+    getJD();
+  }
+  else
+  if (command.startsWith("SetJD ", Qt::CaseInsensitive))
+  {
+    setJD(command.mid(5));
+  }
+  else
+  if (!command.compare("ZoomIn", Qt::CaseInsensitive))
+  {
+    zoom(1);
+  }
+  else
+  if (!command.compare("ZoomOut", Qt::CaseInsensitive))
+  {
+    zoom(-1);
+  }
+  else
+  if (command.startsWith("SetMode ", Qt::CaseInsensitive))
+  {
+    setMode(command.mid(8));
+  }
+  else
+  if (!command.compare("ServerVer", Qt::CaseInsensitive))
+  {
+    sendData(SK_SERVER_VERSION);
+  }
+  else
+  if (!command.compare("SwVer", Qt::CaseInsensitive))
+  {
+    sendData(SK_VERSION);
+  }
+  else
+  if (command.startsWith("SetExtFrame ", Qt::CaseInsensitive))
+  {
+    setExtFrame(command.mid(11));
+  }
+  else
+  if (!command.compare("GetExtFrame", Qt::CaseInsensitive))
+  {
+    getExtFrame();
+  }
+  else
+  if (command.startsWith("SetRTC ", Qt::CaseInsensitive))
+  {
+    setRTC(command.mid(7));
+  }
+  else
+  if (!command.compare("GetRTC", Qt::CaseInsensitive))
+  {
+    getRTC();
+  }
+  else
+  if (!command.compare("Redraw", Qt::CaseInsensitive))
+  {
+    m_mainWin->getView()->repaintMap();
+    sendData(SKS_OK);
+  }
+  else
+  if (!command.compare("GetScr", Qt::CaseInsensitive) || command.startsWith("GetScr ", Qt::CaseInsensitive))
+  {
+    getScr(command.mid(6));
+  }
+  else
+  if (command.startsWith("Subscribe ", Qt::CaseInsensitive))
+  {
+    subscribe(command.mid(10), true);
+  }
+  else
+  if (command.startsWith("Unsubscribe ", Qt::CaseInsensitive))
+  {
+    subscribe(command.mid(12), false);
+  }
+  else
+  if (!command.compare("Binary", Qt::CaseInsensitive))
+  {
+    setBinary();
+  }
+  else
+  if (command.startsWith("Render ", Qt::CaseInsensitive))
+  {
+    render(command.mid(7));
+  }
+  else
+  {
+    sendData(SKS_UNKNOWN);
   }
 }
 
 void SkServer::slotDisconnect()
 {
-  qDebug() << "disc" << m_client->isValid() << m_client->state();
+  skClient_t *client = findClient(sender());
+
+  if (client == NULL)
+  {
+    return;
+  }
+
+  qDebug() << "disc" << client->socket->isValid() << client->socket->state();
+
+  m_clients.removeOne(client);
+  if (m_client == client)
+  {
+    m_client = NULL;
+  }
+  client->socket->deleteLater();
+  delete client;
+
   stateChange();
-  m_client = NULL;
 }
 
 void SkServer::sendData(const QByteArray &data)
@@ -259,6 +457,12 @@ void SkServer::sendData(const QByteArray &data)
     return;
   }
 
+  if (m_client->binary)
+  {
+    sendFrame(m_client, SKF_REPLY, data);
+    return;
+  }
+
   QByteArray buff;
 
   buff += data;
@@ -266,8 +470,18 @@ void SkServer::sendData(const QByteArray &data)
 
   qDebug() << "send" << buff;
 
-  m_client->write(buff);
-  m_client->flush();
+  m_client->socket->write(buff);
+}
+
+void SkServer::sendFrame(skClient_t *client, int type, const QByteArray &data)
+{
+  uchar header[5];
+
+  qToBigEndian<quint32>(data.size() + 1, header);
+  header[4] = type;
+
+  client->socket->write((const char *)header, sizeof(header));
+  client->socket->write(data);
 }
 
 void SkServer::setRA_Dec(const QString &data)
@@ -430,7 +644,7 @@ void SkServer::getExtFrame()
   sendData(SKS_NOT_FOUND);
 }
 
-void SkServer::getPos()
+QByteArray SkServer::posString()
 {
   QByteArray data;
 
@@ -448,7 +662,12 @@ void SkServer::getPos()
   data.append(",");
   data.append(QString::number(R2D(dec), 'f'));
 
-  sendData(data);
+  return data;
+}
+
+void SkServer::getPos()
+{
+  sendData(posString());
 }
 
 void SkServer::getJD()
@@ -520,42 +739,488 @@ void SkServer::getRTC()
   sendData(data);
 }
 
-void SkServer::getScr()
+// format[,scale[,x,y,w,h]]
+bool SkServer::parseScrParams(const QString &data, skScrParams_t &par)
 {
-  QPixmap pixmap = m_mainWin->getView()->grab();
+  QStringList args = data.trimmed().split(",", QString::SkipEmptyParts);
 
-  //QBuffer buffer(&data);
+  par.format = SKS_IMG_PNG;
+  par.scale = 1;
+  par.rect = QRect();
 
-  QByteArray data;
-  QBuffer buffer(&data);
+  if (args.count() == 0)
+  {
+    return true;
+  }
 
-  if (buffer.open(QIODevice::ReadWrite))
+  if (args.count() != 1 && args.count() != 2 && args.count() != 6)
   {
-    qDebug() << pixmap.save(&buffer, "PNG");
+    return false;
+  }
+
+  QString format = args[0].trimmed().toUpper();
+
+  if (format == "RAW")
+  {
+    par.format = SKS_IMG_RAW;
   }
   else
+  if (format == "PNG")
+  {
+    par.format = SKS_IMG_PNG;
+  }
+  else
+  if (format == "JPG" || format == "JPEG")
+  {
+    par.format = SKS_IMG_JPG;
+  }
+  else
+  {
+    return false;
+  }
+
+  if (args.count() >= 2)
+  {
+    par.scale = args[1].toDouble();
+    if (par.scale <= 0 || par.scale > 4)
+    {
+      return false;
+    }
+  }
+
+  if (args.count() == 6)
+  {
+    par.rect = QRect(args[2].toInt(), args[3].toInt(), args[4].toInt(), args[5].toInt());
+    if (!par.rect.isValid())
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// grabs on the GUI thread, crops, scales and encodes in the thread pool
+void SkServer::encodeImage(skClient_t *client, bool push, const QImage &image, const skScrParams_t &par)
+{
+  skScrParams_t tmp = par;
+
+  if (tmp.rect.isValid())
+  {
+    tmp.rect &= image.rect();
+    if (tmp.rect.isEmpty())
+    {
+      tmp.rect = image.rect();
+    }
+  }
+
+  if (push)
+  {
+    client->encoding = true;
+  }
+
+  QThreadPool::globalInstance()->start(new CScrEncoder(client->id, push, image, tmp));
+}
+
+void SkServer::getScr(const QString &data)
+{
+  skScrParams_t par;
+
+  if (!parseScrParams(data, par))
+  {
+    sendData(SKS_INVALID);
+    return;
+  }
+
+  encodeImage(m_client, false, m_mainWin->getView()->grab().toImage(), par);
+}
+
+void SkServer::slotImageReady(int id, bool push, int format, int width, int height, const QByteArray &data)
+{
+  skClient_t *client = findClient(id);
+
+  if (client == NULL)
   {
+    return;
+  }
+
+  if (push)
+  {
+    client->encoding = false;
+  }
+
+  if (data.isEmpty())
+  {
+    m_client = client;
     sendData(SKS_ERROR);
+    m_client = NULL;
+    return;
   }
 
-  qint32 size = data.size();
+  if (client->binary)
+  {
+    // quint8 format, quint32 width, quint32 height, image data
+    QByteArray  payload;
+    QDataStream ds(&payload, QIODevice::WriteOnly);
 
-  //QByteArray header;
+    ds << (quint8)format << (quint32)width << (quint32)height;
+    payload += data;
 
-  //header = "IMG";
-  //header.append(QByteArray::number(size));
+    sendFrame(client, SKF_IMAGE, payload);
+    return;
+  }
 
-  //data = header + data + "\r\n";
+  static const char *formats[] = {"RAW", "PNG", "JPG"};
 
+  QByteArray header = QString("IMG %1 %2 %3 %4\r\n").arg(formats[format]).arg(width).arg(height).arg(data.size()).toLatin1();
 
-  QByteArray header;
-  QTextStream hdr(&header, QIODevice::ReadWrite);
+  client->socket->write(header);
+  client->socket->write(data);
+  client->socket->write("\r\n");
+}
 
-  hdr << "IMG" << size << data;
+// Pos | JD | Frame [format[,scale[,x,y,w,h]]] | All (unsubscribe only)
+void SkServer::subscribe(const QString &data, bool enable)
+{
+  QString what = data.trimmed().section(' ', 0, 0);
+  int     flag;
 
-  qDebug() << header.size() << header;
+  if (!what.compare("Pos", Qt::CaseInsensitive))
+  {
+    flag = SKS_SUB_POS;
+  }
+  else
+  if (!what.compare("JD", Qt::CaseInsensitive))
+  {
+    flag = SKS_SUB_JD;
+  }
+  else
+  if (!what.compare("Frame", Qt::CaseInsensitive))
+  {
+    flag = SKS_SUB_FRAME;
+  }
+  else
+  if (!what.compare("All", Qt::CaseInsensitive) && !enable)
+  {
+    flag = SKS_SUB_POS | SKS_SUB_JD | SKS_SUB_FRAME;
+  }
+  else
+  {
+    sendData(SKS_INVALID);
+    return;
+  }
 
-  sendData(header);
+  if (!enable)
+  {
+    m_client->subscribe &= ~flag;
+    sendData(SKS_OK);
+    return;
+  }
+
+  if (flag == SKS_SUB_FRAME && !parseScrParams(data.trimmed().section(' ', 1), m_client->frame))
+  {
+    sendData(SKS_INVALID);
+    return;
+  }
+
+  m_client->subscribe |= flag;
+  sendData(SKS_OK);
+
+  // current state first
+  m_client->lastPos.clear();
+  m_client->lastJD.clear();
+  slotMapChanged();
+}
+
+// switches the client to length-prefixed binary frames (after OK! reply)
+void SkServer::setBinary()
+{
+  sendData(SKS_OK);
+  m_client->binary = true;
 }
 
+void SkServer::slotMapChanged()
+{
+  QByteArray pos;
+  QByteArray jd;
+  QImage     image;
+
+  foreach (skClient_t *client, m_clients)
+  {
+    if (client->subscribe == 0)
+    {
+      continue;
+    }
+
+    if (client->subscribe & SKS_SUB_POS)
+    {
+      if (pos.isEmpty())
+      {
+        pos = posString();
+      }
+
+      if (pos != client->lastPos)
+      {
+        client->lastPos = pos;
+        if (client->binary)
+        {
+          sendFrame(client, SKF_EVENT, "POS " + pos);
+        }
+        else
+        {
+          client->socket->write("EVT POS " + pos + "\r\n");
+        }
+      }
+    }
+
+    if (client->subscribe & SKS_SUB_JD)
+    {
+      if (jd.isEmpty())
+      {
+        jd = QByteArray::number(m_mainWin->getView()->m_mapView.jd, 'f', 8);
+      }
+
+      if (jd != client->lastJD)
+      {
+        client->lastJD = jd;
+        if (client->binary)
+        {
+          sendFrame(client, SKF_EVENT, "JD " + jd);
+        }
+        else
+        {
+          client->socket->write("EVT JD " + jd + "\r\n");
+        }
+      }
+    }
+
+    if ((client->subscribe & SKS_SUB_FRAME) && !client->encoding && client->socket->bytesToWrite() < SKS_MAX_PENDING)
+    {
+      if (image.isNull())
+      {
+        image = m_mainWin->getView()->grab().toImage();
+      }
+
+      encodeImage(client, true, image, client->frame);
+    }
+  }
+}
+
+static const struct
+{
+  const char *name;
+  int         flag;
+} g_renderLayers[] =
+{
+  {"stars",       SML_STARS},
+  {"dso",         SML_DSO},
+  {"const_lines", SML_CONST_LINES},
+  {"const_bnd",   SML_CONST_BND},
+  {"grids",       SML_GRIDS},
+  {"milky_way",   SML_MILKY_WAY},
+  {"solar",       SML_SOLAR_SYSTEM},
+  {"asteroids",   SML_ASTEROIDS},
+  {"comets",      SML_COMETS},
+  {"satellites",  SML_SATELLITES},
+  {"horizon",     SML_HORIZON},
+  {"labels",      SML_LABELS},
+  {"drawings",    SML_DRAWINGS},
+  {"legends",     SML_LEGENDS},
+};
+
+// key=value,... (ra, dec in J2000 degrees, fov in degrees)
+// ra, dec, fov, jd, width, height, coord (radec|altazm|ecl), epoch (j2000|date),
+// layers (name+name... | current), star_mag, dso_mag, format (raw|png|jpg)
+// missing keys are taken from the interactive map
+bool SkServer::parseRender(const QString &data, skRenderJob_t &job)
+{
+  CMapView *view = m_mainWin->getView();
+  double    ra, dec;
+
+  job.view = view->m_mapView;
+  job.layers = SML_CURRENT;
+  job.size = view->size();
+  job.par.format = SKS_IMG_PNG;
+  job.par.scale = 1;
+  job.par.rect = QRect();
+
+  trfConvScrPtToXY(view->width() / 2., view->height() / 2., ra, dec);
+  precess(&ra, &dec, view->m_mapView.jd, JD2000);
+
+  foreach (const QString &arg, data.split(",", QString::SkipEmptyParts))
+  {
+    QString key = arg.section('=', 0, 0).trimmed().toLower();
+    QString value = arg.section('=', 1).trimmed();
+    bool    ok = true;
+
+    if (key == "ra") ra = D2R(value.toDouble(&ok));
+    else
+    if (key == "dec") dec = D2R(value.toDouble(&ok));
+    else
+    if (key == "fov") job.view.fov = D2R(value.toDouble(&ok));
+    else
+    if (key == "jd") job.view.jd = value.toDouble(&ok);
+    else
+    if (key == "width") job.size.setWidth(value.toInt(&ok));
+    else
+    if (key == "height") job.size.setHeight(value.toInt(&ok));
+    else
+    if (key == "star_mag") job.view.starMag = value.toDouble(&ok);
+    else
+    if (key == "dso_mag") job.view.dsoMag = value.toDouble(&ok);
+    else
+    if (key == "coord")
+    {
+      if (!value.compare("radec", Qt::CaseInsensitive)) job.view.coordType = SMCT_RA_DEC;
+      else
+      if (!value.compare("altazm", Qt::CaseInsensitive)) job.view.coordType = SMCT_ALT_AZM;
+      else
+      if (!value.compare("ecl", Qt::CaseInsensitive)) job.view.coordType = SMCT_ECL;
+      else ok = false;
+    }
+    else
+    if (key == "epoch")
+    {
+      if (!value.compare("j2000", Qt::CaseInsensitive)) job.view.epochJ2000 = true;
+      else
+      if (!value.compare("date", Qt::CaseInsensitive)) job.view.epochJ2000 = false;
+      else ok = false;
+    }
+    else
+    if (key == "layers")
+    {
+      if (!value.compare("current", Qt::CaseInsensitive))
+      {
+        job.layers = SML_CURRENT;
+        continue;
+      }
+
+      job.layers = 0;
+      foreach (const QString &name, value.split("+", QString::SkipEmptyParts))
+      {
+        int i;
+
+        for (i = 0; i < (int)(sizeof(g_renderLayers) / sizeof(g_renderLayers[0])); i++)
+        {
+          if (!name.compare(g_renderLayers[i].name, Qt::CaseInsensitive))
+          {
+            job.layers |= g_renderLayers[i].flag;
+            break;
+          }
+        }
+        ok &= i < (int)(sizeof(g_renderLayers) / sizeof(g_renderLayers[0]));
+      }
+    }
+    else
+    if (key == "format")
+    {
+      ok = parseScrParams(value, job.par);
+    }
+    else
+    {
+      ok = false;
+    }
+
+    if (!ok)
+    {
+      return false;
+    }
+  }
+
+  if (job.size.width() < 1 || job.size.height() < 1 ||
+      job.size.width() > SKS_MAX_RENDER_SIZE || job.size.height() > SKS_MAX_RENDER_SIZE)
+  {
+    return false;
+  }
+
+  job.view.jd = CLAMP(job.view.jd, MIN_JD, MAX_JD);
+  job.view.fov = CLAMP(job.view.fov, MIN_MAP_FOV, MAX_MAP_FOV);
+  rangeDbl(&ra, R360);
+  dec = CLAMP(dec, -R90, R90);
+
+  // same conversion as CMapView::centerMap()
+  cAstro.setParam(&job.view);
+
+  if (!(job.view.epochJ2000 && job.view.coordType == SMCT_RA_DEC))
+  {
+    precess(&ra, &dec, JD2000, job.view.jd);
+  }
+
+  if (job.view.coordType == SMCT_ALT_AZM)
+  {
+    double azm, alt;
+
+    cAstro.convRD2AANoRef(ra, dec, &azm, &alt);
+    ra = -azm;
+    dec = alt;
+  }
+  else
+  if (job.view.coordType == SMCT_ECL)
+  {
+    double lon, lat;
+
+    cAstro.convRD2Ecl(ra, dec, &lon, &lat);
+    ra = lon;
+    dec = lat;
+  }
+
+  cAstro.setParam(&view->m_mapView);
+
+  job.view.x = ra;
+  job.view.y = dec;
+  rangeDbl(&job.view.x, R360);
+
+  return true;
+}
+
+// renders are queued and done one by one between GUI events,
+// encoding of the results runs in the thread pool
+void SkServer::render(const QString &data)
+{
+  skRenderJob_t job;
+
+  if (m_renderQueue.count() >= SKS_MAX_RENDER_QUEUE)
+  {
+    sendData(SKS_ERROR);
+    return;
+  }
+
+  if (!parseRender(data, job))
+  {
+    sendData(SKS_INVALID);
+    return;
+  }
+
+  job.clientId = m_client->id;
+  m_renderQueue.enqueue(job);
+
+  if (m_renderQueue.count() == 1)
+  {
+    QTimer::singleShot(0, this, SLOT(slotRenderNext()));
+  }
+}
+
+void SkServer::slotRenderNext()
+{
+  if (m_renderQueue.isEmpty())
+  {
+    return;
+  }
+
+  skRenderJob_t job = m_renderQueue.dequeue();
+  skClient_t   *client = findClient(job.clientId);
+
+  if (client)
+  {
+    QImage image(job.size, QImage::Format_ARGB32_Premultiplied);
+
+    smRenderOffscreen(&job.view, &image, job.layers);
+    encodeImage(client, false, image, job.par);
+  }
+
+  if (!m_renderQueue.isEmpty())
+  {
+    QTimer::singleShot(0, this, SLOT(slotRenderNext()));
+  }
+}
 
@@ -4,6 +4,10 @@
 #include <QObject>
 #include <QTcpServer>
 #include <QTcpSocket>
+#include <QImage>
+#include <QQueue>
+
+#include "cmapview.h"
 
 class MainWindow;
 
@@ -11,11 +15,61 @@ class MainWindow;
 #define SKS_INVALID     "Invalid! Cannot parse"
 #define SKS_UNKNOWN     "Failed! Invalid command"
 #define SKS_NOT_FOUND   "NF! Not found"
-#define SKS_REJECT      "RJ! Already connected"
+#define SKS_REJECT      "RJ! Too many clients"
 #define SKS_ERROR       "ERR! Other error"
 
 #define SK_SERVER_DEFAULT_PORT  2055
-#define SK_SERVER_VERSION       "1.00"
+#define SK_SERVER_VERSION       "1.10"
+
+#define SKS_MAX_CLIENTS         32
+#define SKS_MAX_PENDING         (8 * 1024 * 1024)   // skip pushed frames when the client is slower
+#define SKS_MAX_RENDER_SIZE     8192
+#define SKS_MAX_RENDER_QUEUE    64
+
+// binary frame: quint32 length (big endian, type + payload), quint8 type, payload
+#define SKF_REPLY       0
+#define SKF_IMAGE       1
+#define SKF_EVENT       2
+
+// subscriptions
+#define SKS_SUB_POS     0x01
+#define SKS_SUB_JD      0x02
+#define SKS_SUB_FRAME   0x04
+
+// screenshot formats
+#define SKS_IMG_RAW     0   // RGB888 rows without padding
+#define SKS_IMG_PNG     1
+#define SKS_IMG_JPG     2
+
+typedef struct
+{
+  int    format;       // SKS_IMG_xxx
+  double scale;
+  QRect  rect;         // region (widget coordinates, invalid = whole map)
+} skScrParams_t;
+
+// headless render request (Render command)
+typedef struct
+{
+  int            clientId;
+  mapView_t      view;
+  int            layers;      // SML_xxx
+  QSize          size;
+  skScrParams_t  par;
+} skRenderJob_t;
+
+typedef struct
+{
+  int            id;
+  QTcpSocket    *socket;
+  QByteArray     buffer;      // incomplete input
+  bool           binary;      // length-prefixed frames
+  int            subscribe;   // SKS_SUB_xxx
+  skScrParams_t  frame;       // pushed frame parameters
+  bool           encoding;    // pushed frame is being encoded
+  QByteArray     lastPos;
+  QByteArray     lastJD;
+} skClient_t;
 
 class SkServer : public QObject
 {
@@ -40,13 +94,24 @@ private slots:
   void slotConnected();
   void dataReady();
   void slotDisconnect();
+  void slotMapChanged();
+  void slotImageReady(int id, bool push, int format, int width, int height, const QByteArray &data);
+  void slotRenderNext();
 
 private:
+  skClient_t *findClient(QObject *socket);
+  skClient_t *findClient(int id);
+  void removeAll();
+  void execute(const QString &command);
   void sendData(const QByteArray &data);
+  void sendFrame(skClient_t *client, int type, const QByteArray &data);
+  bool parseScrParams(const QString &data, skScrParams_t &par);
+  void encodeImage(skClient_t *client, bool push, const QImage &image, const skScrParams_t &par);
 
   void setRA_Dec(const QString &data);
   void setExtFrame(const QString &data);
   void getExtFrame();
+  QByteArray posString();
   void getPos();
   void getJD();
   void setJD(const QString &data);
@@ -54,13 +119,20 @@ private:
   void setMode(const QString &data);
   void setRTC(const QString &data);
   void getRTC();
-  void getScr();
+  void getScr(const QString &data);
+  void subscribe(const QString &data, bool enable);
+  bool parseRender(const QString &data, skRenderJob_t &job);
+  void render(const QString &data);
+  void setBinary();
 
   int m_port;
+  int m_nextId;
 
-  QTcpServer *m_server;
-  QTcpSocket *m_client;
-  MainWindow *m_mainWin;
+  QTcpServer          *m_server;
+  QList <skClient_t *> m_clients;
+  skClient_t          *m_client;   // client of the executed command
+  QQueue <skRenderJob_t> m_renderQueue;
+  MainWindow          *m_mainWin;
 };
 
 extern SkServer g_skServer;
@@ -650,11 +650,17 @@ static void smRenderGSCRegions(mapView_t *, CSkPainter *pPainter, int region)
 
 
 /////////////////////////////////////////////////////////////////////////////
-static void smRenderStars(mapView_t *mapView, CSkPainter *pPainter, QImage *)
-/////////////////////////////////////////////////////////////////////////////
+static void smRenderStars(mapView_t *mapView, CSkPainter *pPainter, QImage *pImg)
+/////////////////////////////////////////////////////////////////////////////////
 {
   memset(cGSCReg.rendered, 0, sizeof(cGSCReg.rendered));
 
+  // additive sprites are written straight into the image on dark sky only
+  if (!g_onPrinterBW && qGray(currentSkyColor.rgb()) < 128)
+  {
+    cStarRenderer.beginBatch(pImg);
+  }
+
   g_numStars = 0;
   g_numRegions = 0;
 
@@ -706,6 +712,8 @@ static void smRenderStars(mapView_t *mapView, CSkPainter *pPainter, QImage *)
     smRenderGSCStars(mapView, pPainter, region);
     smRenderTychoStars(mapView, pPainter, region);  // Prop. mot.
   }
+
+  cStarRenderer.flushBatch();
 }
 
 /////////////////////////////////////////
@@ -1333,7 +1341,9 @@ static void renderTelescope(mapView_t *mapView, CSkPainter *pPainter)
       }
     }
 
-    precess(&pcMapView->m_lastTeleRaDec, &rd, mapView->jd, JD2000);        
+    radec_t tele = g_teleState.isValid() ? g_teleState.position() : pcMapView->m_lastTeleRaDec;
+
+    precess(&tele, &rd, mapView->jd, JD2000);
     r = g_cDrawing.drawCircle(pt, pPainter, &rd, -10, nullptr, isLinked ? "" : g_pTelePlugin->getTelescope());
     if (r > 0)
       addMapObj(rd, pt.x(), pt.y(), MO_TELESCOPE, MO_CIRCLE, r, 0, 0);
@@ -1344,53 +1354,51 @@ static void renderTelescope(mapView_t *mapView, CSkPainter *pPainter)
 static void renderSatellites(mapView_t *mapView, CSkPainter *pPainter)
 //////////////////////////////////////////////////////////////////////
 {
-  sgp4.setObserver(mapView);
+  QVector <satPos_t> pos;
+
+  sgp4.solveAll(mapView, pos, g_showHorizon);
 
-  for (int i = 0; i < sgp4.count(); i++)
+  for (int i = 0; i < pos.count(); i++)
   {
-    satellite_t out;
     radec_t rd;
 
-    if (sgp4.tleItem(i)->used)
+    if (pos[i].status == SGP4_OK)
     {
-      if (sgp4.solve(i, mapView, &out))
-      {
-        cAstro.convAA2RDRef(out.azimuth, out.elevation, &rd.Ra, &rd.Dec);
+      cAstro.convAA2RDRef(pos[i].azimuth, pos[i].elevation, &rd.Ra, &rd.Dec);
 
-        SKPOINT pt;
+      SKPOINT pt;
 
-        trfRaDecToPointCorrectFromTo(&rd, &pt, mapView->jd, JD2000);
-        if (trfProjectPoint(&pt))
-        {
-          pPainter->setPen(g_skSet.map.satellite.color);
-          pPainter->setBrush(QColor(g_skSet.map.satellite.color));
+      trfRaDecToPointCorrectFromTo(&rd, &pt, mapView->jd, JD2000);
+      if (trfProjectPoint(&pt))
+      {
+        pPainter->setPen(g_skSet.map.satellite.color);
+        pPainter->setBrush(QColor(g_skSet.map.satellite.color));
 
-          QRect rc1 = QRect(-5, -5, 10, 10);
-          QRect rc2 = QRect(-5, -8, 10, -20);
-          QRect rc3 = QRect(-5, 8, 10, 20);
+        QRect rc1 = QRect(-5, -5, 10, 10);
+        QRect rc2 = QRect(-5, -8, 10, -20);
+        QRect rc3 = QRect(-5, 8, 10, 20);
 
-          pPainter->save();
-          pPainter->translate(pt.sx, pt.sy);
-          pPainter->scale(0.5 * g_skSet.map.satellite.size, 0.5 * g_skSet.map.satellite.size);
-          pPainter->rotate(-45);
+        pPainter->save();
+        pPainter->translate(pt.sx, pt.sy);
+        pPainter->scale(0.5 * g_skSet.map.satellite.size, 0.5 * g_skSet.map.satellite.size);
+        pPainter->rotate(-45);
 
-          pPainter->drawRect(rc1);
-          pPainter->drawRect(rc2);
-          pPainter->drawRect(rc3);
-          pPainter->drawEllipse(QPoint(8, 0), 5, 5);
-          pPainter->drawLine(10, 0, 25, 0);
+        pPainter->drawRect(rc1);
+        pPainter->drawRect(rc2);
+        pPainter->drawRect(rc3);
+        pPainter->drawEllipse(QPoint(8, 0), 5, 5);
+        pPainter->drawLine(10, 0, 25, 0);
 
-          pPainter->restore();
+        pPainter->restore();
 
-          //pPainter->setBrush(QColor(255, 0, 0));
-          //pPainter->drawEllipse(QPoint(pt.sx, pt.sy), 5, 5);
+        //pPainter->setBrush(QColor(255, 0, 0));
+        //pPainter->drawEllipse(QPoint(pt.sx, pt.sy), 5, 5);
 
-          if (g_showLabels)
-          {
-            g_labeling.addLabel(QPoint(pt.sx, pt.sy), 15 * g_skSet.map.satellite.size, out.name, FONT_SATELLITE, SL_AL_BOTTOM_RIGHT, SL_AL_ALL);
-          }
-          addMapObj(rd, pt.sx, pt.sy, MO_SATELLITE, MO_CIRCLE, 10, i, 0);
+        if (g_showLabels)
+        {
+          g_labeling.addLabel(QPoint(pt.sx, pt.sy), 15 * g_skSet.map.satellite.size, sgp4.getName(i), FONT_SATELLITE, SL_AL_BOTTOM_RIGHT, SL_AL_ALL);
         }
+        addMapObj(rd, pt.sx, pt.sy, MO_SATELLITE, MO_CIRCLE, 10, i, 0);
       }
     }
   }
@@ -1570,17 +1578,122 @@ bool smRenderSkyMap(mapView_t *mapView, CSkPainter *pPainter, QImage *pImg)
     }
   }  
 
+  if (g_showLegends)
+  {
+    smRenderLegends(mapView, pPainter, pImg);
+  }
+
+  return(false);
+}
+
+
+////////////////////////////////////
+// color of the red night palette
+static QRgb smNightColor(QRgb color)
+////////////////////////////////////
+{
+  return qRgba(qGray(color), 0, 0, qAlpha(color));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// drawings and the telescope marker, drawn over the cached map
+// (CMapView::paintEvent) so editing them needs no repaintMap()
+// night = draw with the night palette (the cached map is filtered as a whole)
+void smRenderOverlay(mapView_t *mapView, CSkPainter *pPainter, bool night)
+//////////////////////////////////////////////////////////////////////////
+{
+  QRgb drawColor = g_skSet.map.drawing.color;
+  QRgb fontColor = g_skSet.fonst[FONT_DRAWING].color;
+
+  if (night)
+  {
+    g_skSet.map.drawing.color = smNightColor(drawColor);
+    g_skSet.fonst[FONT_DRAWING].color = smNightColor(fontColor);
+  }
+
+  mapObjOverlayBegin();
+
   if (g_showDrawings)
   {
     g_cDrawing.drawObjects(pPainter);
   }
 
-  renderTelescope(mapView, pPainter);  
+  renderTelescope(mapView, pPainter);
 
-  if (g_showLegends)
+  mapObjOverlayEnd();
+
+  g_skSet.map.drawing.color = drawColor;
+  g_skSet.fonst[FONT_DRAWING].color = fontColor;
+}
+
+////////////////////////////////////////////////////////////////////////
+// renders into pImg and keeps the projection and the objects of the
+// interactive map (call from the GUI thread only)
+bool smRenderOffscreen(mapView_t *mapView, QImage *pImg, int layers)
+////////////////////////////////////////////////////////////////////////
+{
+  bool *flags[] = {&g_showStars, &g_showDSO, &g_showConstLines, &g_showConstBnd, &g_showGrids,
+                   &g_showMW, &g_showSS, &g_showAsteroids, &g_showComets, &g_showSatellites,
+                   &g_showHorizon, &g_showLabels, &g_showDrawings, &g_showLegends};
+  const int count = sizeof(flags) / sizeof(flags[0]);
+  bool saved[count];
+
+  Q_ASSERT(count == SML_COUNT);
+
+  for (int i = 0; i < count; i++)
   {
-    smRenderLegends(mapView, pPainter, pImg);
+    saved[i] = *flags[i];
+    if (layers != SML_CURRENT)
+    {
+      *flags[i] = (layers & (1 << i)) != 0;
+    }
   }
 
-  return(false);
+  trfSave();
+  mapObjSave();
+
+  CSkPainter p;
+
+  p.begin(pImg);
+  p.setRenderHint(QPainter::Antialiasing, g_antialiasing);
+  p.setRenderHint(QPainter::SmoothPixmapTransform, g_antialiasing);
+
+  mapView->mapEpoch = (mapView->epochJ2000 || !g_skSet.map.star.useProperMotion) ? JD2000 : mapView->jd;
+  bool ret = smRenderSkyMap(mapView, &p, pImg);
+  smRenderOverlay(mapView, &p);
+
+  p.end();
+
+  mapObjRestore();
+  trfRestore();
+
+  for (int i = 0; i < count; i++)
+  {
+    *flags[i] = saved[i];
+  }
+
+  cAstro.setParam(&pcMapView->m_mapView);
+
+  return ret;
+}
+
+///////////////////////////
+// SML_xxx of the shown layers
+int smCurrentLayers(void)
+///////////////////////////
+{
+  bool flags[] = {g_showStars, g_showDSO, g_showConstLines, g_showConstBnd, g_showGrids,
+                  g_showMW, g_showSS, g_showAsteroids, g_showComets, g_showSatellites,
+                  g_showHorizon, g_showLabels, g_showDrawings, g_showLegends};
+  int layers = 0;
+
+  for (int i = 0; i < SML_COUNT; i++)
+  {
+    if (flags[i])
+    {
+      layers |= 1 << i;
+    }
+  }
+
+  return layers;
 }
@@ -4,6 +4,27 @@
 #include "cmapview.h"
 #include "cskpainter.h"
 
+// layers of smRenderOffscreen()
+#define SML_STARS          0x0001
+#define SML_DSO            0x0002
+#define SML_CONST_LINES    0x0004
+#define SML_CONST_BND      0x0008
+#define SML_GRIDS          0x0010
+#define SML_MILKY_WAY      0x0020
+#define SML_SOLAR_SYSTEM   0x0040
+#define SML_ASTEROIDS      0x0080
+#define SML_COMETS         0x0100
+#define SML_SATELLITES     0x0200
+#define SML_HORIZON        0x0400
+#define SML_LABELS         0x0800
+#define SML_DRAWINGS       0x1000
+#define SML_LEGENDS        0x2000
+#define SML_COUNT          14
+#define SML_CURRENT        -1       // layers of the interactive map
+
 bool smRenderSkyMap(mapView_t *mapView, CSkPainter *pPainter, QImage *pImg);
+bool smRenderOffscreen(mapView_t *mapView, QImage *pImg, int layers);
+void smRenderOverlay(mapView_t *mapView, CSkPainter *pPainter, bool night = false);
+int  smCurrentLayers(void);
 
 #endif // SKYMAP_H
@@ -157,12 +157,14 @@ SOURCES += main.cpp\
     crestoretm.cpp \
     casteredit.cpp \
     clineeditcomp.cpp \
+    cnameindex.cpp \
     cdailyev.cpp \
     cwposmap.cpp \
     earthtools/cparse.cpp \
     earthtools/cearthtools.cpp \
     mlibration.cpp \
     csatevents.cpp \
+    csateventsolver.cpp \
     cgalery.cpp \
     cdb.cpp \
     ctychosearch.cpp \
@@ -196,6 +198,9 @@ SOURCES += main.cpp\
     cinsertcircle.cpp \
     cephlist.cpp \
     cephtable.cpp \
+    cephengine.cpp \
+    calmanac.cpp \
+    ctrackengine.cpp \
     dsoplug.cpp \
     cgeohash.cpp \
     cpolarishourangle.cpp \
@@ -265,6 +270,11 @@ SOURCES += main.cpp\
     dssheaderdialog.cpp \
     cdownloadfile.cpp \
     moonlessnightsdlg.cpp \
+    cobsplanner.cpp \
+    cobsplannerdlg.cpp \
+    csatpasses.cpp \
+    csatpassesdlg.cpp \
+    clazyload.cpp \
     systemsettings.cpp \
     xmlattrparser.cpp \
     nutation.cpp \
@@ -283,6 +293,7 @@ SOURCES += main.cpp\
     skprogressdialog.cpp \
     vsop87/venus_vsop87.cpp \
     vsop87/vsop87.cpp \
+    vsop87/vsop87_tables.cpp \
     vsop87/earth_vsop87.cpp \
     vsop87/mercury_vsop87.cpp \
     vsop87/jupiter_vsop87.cpp \
@@ -404,11 +415,13 @@ HEADERS  += mainwindow.h \
     crestoretm.h \
     casteredit.h \
     clineeditcomp.h \
+    cnameindex.h \
     cdailyev.h \
     cwposmap.h \
     earthtools/cparse.h \
     earthtools/cearthtools.h \
     csatevents.h \
+    csateventsolver.h \
     cgalery.h \
     cdb.h \
     ctychosearch.h \
@@ -441,6 +454,9 @@ HEADERS  += mainwindow.h \
     cinsertcircle.h \
     cephlist.h \
     cephtable.h \
+    cephengine.h \
+    calmanac.h \
+    ctrackengine.h \
     dsoplug.h \
     cgeohash.h \
     cpolarishourangle.h \
@@ -516,6 +532,11 @@ HEADERS  += mainwindow.h \
     dssheaderdialog.h \
     cdownloadfile.h \
     moonlessnightsdlg.h \
+    cobsplanner.h \
+    cobsplannerdlg.h \
+    csatpasses.h \
+    csatpassesdlg.h \
+    clazyload.h \
     systemsettings.h \
     xmlattrparser.h \
     nutation.h \
@@ -660,6 +681,8 @@ FORMS    += mainwindow.ui \
     dssheaderdialog.ui \
     cdownloadfile.ui \
     moonlessnightsdlg.ui \
+    cobsplannerdlg.ui \
+    csatpassesdlg.ui \
     clunarfeaturessearch.ui \
     cplanetsize.ui \
     cadvsearch.ui \
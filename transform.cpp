@@ -39,6 +39,18 @@ static mapView_t currentMapView;
 
 int m_numFrustums;
 
+// rest of the state for trfSave()/trfRestore()
+static SKMATRIX  m_rotSave;
+static double    scrxFullSave;
+static double    scryFullSave;
+static bool      bFlipXSave;
+static bool      bFlipYSave;
+static double    dxArcSecSave;
+static double    m_jdSave;
+static double    mapEpochSave;
+static mapView_t currentMapViewSave;
+static int       m_numFrustumsSave;
+
 //////////////////
 void trfSave(void)
 //////////////////
@@ -51,6 +63,17 @@ void trfSave(void)
 
   for (int i = 0; i < 5; i++)
     m_frustumSave[i] = m_frustum[i];
+
+  m_rotSave = m_rot;
+  scrxFullSave = scrx;
+  scryFullSave = scry;
+  bFlipXSave = bFlipX;
+  bFlipYSave = bFlipY;
+  dxArcSecSave = dxArcSec;
+  m_jdSave = m_jd;
+  mapEpochSave = mapEpoch;
+  currentMapViewSave = currentMapView;
+  m_numFrustumsSave = m_numFrustums;
 }
 
 /////////////////////
@@ -65,6 +88,17 @@ void trfRestore(void)
 
   for (int i = 0; i < 5; i++)
     m_frustum[i] = m_frustumSave[i];
+
+  m_rot = m_rotSave;
+  scrx = scrxFullSave;
+  scry = scryFullSave;
+  bFlipX = bFlipXSave;
+  bFlipY = bFlipYSave;
+  dxArcSec = dxArcSecSave;
+  m_jd = m_jdSave;
+  mapEpoch = mapEpochSave;
+  currentMapView = currentMapViewSave;
+  m_numFrustums = m_numFrustumsSave;
 }
 
 /////////////////////////////////
@@ -354,17 +388,20 @@ void trfCreateMatrixView(CAstro *ast, mapView_t *mapView, double w, double h)
 void trfRaDecToPointCorrectFromTo(const radec_t *rd, SKPOINT *p, double jdFrom, double jdTo)
 ////////////////////////////////////////////////////////////////////////////////////////////
 {
-  double cd;
-  double ra = rd->Ra;
-  double dec = rd->Dec;
+  double   cd;
+  SKMATRIX mat;
+  SKVECTOR v;
 
-  precess(&ra, &dec, jdFrom, jdTo);
+  // same as precess() and back to the vector (one matrix-vector product)
+  precessMatrix(jdFrom, jdTo, &mat);
 
-  cd = cos(-dec);
+  cd = cos(-rd->Dec);
+
+  v.x = cd * sin(-rd->Ra);
+  v.y = sin(-rd->Dec);
+  v.z = cd * cos(-rd->Ra);
 
-  p->w.x = cd * sin(-ra);
-  p->w.y = sin(-dec);
-  p->w.z = cd * cos(-ra);
+  SKVECTransform3(&p->w, &v, &mat);
 }
 
 
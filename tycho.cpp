@@ -157,6 +157,7 @@ bool CTycho::load()
         if (pSupplement[supp].pnOffs != 0xffff)
         {
           tNames.append(&m_region[i].stars[j]);
+          tNameIndex.add(getStarName(&pSupplement[supp]), ((qint64)i << 32) | j);
         }
       }
     }
@@ -164,6 +165,7 @@ bool CTycho::load()
   }
 
   cGSCReg.createOcTree();
+  tNameIndex.build();
 
   f.close();
 
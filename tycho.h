@@ -2,6 +2,7 @@
 #define TYCHO_H
 
 #include "skcore.h"
+#include "cnameindex.h"
 
 #include <QtCore>
 #include <QtGui>
@@ -102,6 +103,7 @@ class CTycho : public QObject
 
     tychoSupp_t             *pSupplement;
     QList   <tychoStar_t *>  tNames;         // list ptrs. to stars with proper name
+    CNameIndex               tNameIndex;     // proper names -> (reg << 32) | index
 
     static QString getGreekChar(int i);
     static QString getGreekString(int i);
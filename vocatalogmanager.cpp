@@ -22,6 +22,7 @@ along with SkytechX.  If not, see <http://www.gnu.org/licenses/>.
 #include <QStandardPaths>
 #include <QDebug>
 #include <QtGlobal>
+#include "clazyload.h"
 
 VOCatalogManager g_voCatalogManager;
 
@@ -63,6 +64,8 @@ void VOCatalogManager::scanDir(QDir dir)
 
 void VOCatalogManager::renderAll(mapView_t *mapView, CSkPainter *pPainter)
 {    
+  g_lazyVOCatalogs.ensure();
+
   foreach (VOCatalogRenderer *item, m_list)
   {
     item->render(mapView, pPainter);
@@ -71,6 +74,8 @@ void VOCatalogManager::renderAll(mapView_t *mapView, CSkPainter *pPainter)
 
 void VOCatalogManager::removeAll()
 {
+  g_lazyVOCatalogs.ensure();
+
   QDir dir(QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/vo_tables/");
 
   dir.removeRecursively();
@@ -85,6 +90,8 @@ void VOCatalogManager::removeAll()
 
 void VOCatalogManager::remove(const QString &path)
 {
+  g_lazyVOCatalogs.ensure();
+
   QDir dir(path);
 
   dir.removeRecursively();
@@ -102,6 +109,8 @@ void VOCatalogManager::remove(const QString &path)
 
 void VOCatalogManager::setShow(bool show, const QString &path)
 {
+  g_lazyVOCatalogs.ensure();
+
   foreach (VOCatalogRenderer *item, m_list)
   {
     if (item->m_path == path)
@@ -114,6 +123,8 @@ void VOCatalogManager::setShow(bool show, const QString &path)
 
 VOCatalogRenderer *VOCatalogManager::get(const QString &path)
 {
+  g_lazyVOCatalogs.ensure();
+
   foreach (VOCatalogRenderer *item, m_list)
   {
     if (item->m_path == path)
@@ -149,6 +160,8 @@ void VOCatalogManager::loadAll()
 
 void VOCatalogManager::load(const QString &path)
 {
+  g_lazyVOCatalogs.ensure();
+
   VOCatalogRenderer *renderer = new VOCatalogRenderer;
 
   if (!renderer->load(path))
@@ -163,6 +176,8 @@ void VOCatalogManager::load(const QString &path)
 
 bool VOCatalogManager::findObject(const QString &name, VOItem_t **objectPtr, VOCatalogRenderer **renderer)
 {
+  g_lazyVOCatalogs.ensure();
+
   QByteArray nameArray = name.toLatin1();
 
   foreach (VOCatalogRenderer *item, m_list)
@@ -28,6 +28,7 @@ along with SkytechX.  If not, see <http://www.gnu.org/licenses/>.
 #include "curlfile.h"
 
 #include "QStandardItemModel"
+#include "clazyload.h"
 
 QString g_vizierUrl;
 
@@ -109,6 +110,8 @@ void VOCatalogManagerDialog::closeEvent(QCloseEvent *event)
 
 void VOCatalogManagerDialog::fillList()
 {
+  g_lazyVOCatalogs.ensure();
+
   QStandardItemModel *model = dynamic_cast<QStandardItemModel *>(ui->treeView->model());
 
   model->removeRows(0, model->rowCount());
@@ -1,49 +1,128 @@
+#include <QVector>
+#include <QElapsedTimer>
+#include <QDebug>
+
 #include "vsop87.h"
 #include "castro.h"
 
-void vsop87(int planet, double jd, double *polar)
+#define VSOP87_CHECK_DATES   128
+
+// bound of the dropped terms (tail[k] = sum of |a[j]| for j >= k)
+class CVsop87Tail
 {
-  switch (planet)
+public:
+  CVsop87Tail()
   {
-    case PT_SUN:
-      earth_VSOP87(jd, polar);
-      break;
+    for (int p = 0; p < VSOP87_PLANETS; p++)
+    {
+      for (int c = 0; c < 3; c++)
+      {
+        for (int o = 0; o < 6; o++)
+        {
+          const vsop87Series_t &s = g_vsop87Series[p][c][o];
+          QVector <double> &tail = m_tail[p][c][o];
+          double sum = 0;
 
-    case PT_MERCURY:
-      mercury_VSOP87(jd, polar);
-      break;
+          tail.resize(s.count + 1);
+          tail[s.count] = 0;
+          for (int i = s.count - 1; i >= 0; i--)
+          {
+            sum += fabs(s.a[i]);
+            tail[i] = sum;
+          }
+        }
+      }
+    }
+  }
 
-    case PT_VENUS:
-      venus_VSOP87(jd, polar);
-      break;
+  QVector <double> m_tail[VSOP87_PLANETS][3][6];
+};
 
-    case PT_MARS:
-      mars_VSOP87(jd, polar);
-      break;
+static CVsop87Tail s_tail;
 
-    case PT_JUPITER:
-      jupiter_VSOP87(jd, polar);
-      break;
+// number of terms needed for the accuracy (tm = max. |t|)
+static int vsopTerms(int planet, int coord, int order, double tm, double accuracy)
+{
+  const vsop87Series_t &s = g_vsop87Series[planet][coord][order];
+
+  if (accuracy <= 0)
+  {
+    return s.count;
+  }
 
-    case PT_SATURN:
-      saturn_VSOP87(jd, polar);
-      break;
+  double scale = pow(tm, order);
 
-    case PT_URANUS:
-      uranus_VSOP87(jd, polar);
-      break;
+  if (scale == 0)
+  {
+    return 0;
+  }
 
-    case PT_NEPTUNE:
-      neptune_VSOP87(jd, polar);
-      break;
+  // error is split between the 6 series, radius is taken at the mean distance
+  double limit = accuracy / (6 * scale);
 
-    default:
-      polar[0] = 0;
-      polar[1] = 0;
-      polar[2] = 1;
-      return;
+  if (coord == 2)
+  {
+    limit *= g_vsop87Series[planet][2][0].a[0];
   }
 
+  const QVector <double> &tail = s_tail.m_tail[planet][coord][order];
+  int lo = 0;
+  int hi = s.count;
+
+  while (lo < hi)
+  {
+    int mid = (lo + hi) / 2;
+
+    if (tail[mid] <= limit)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+
+  return lo;
+}
+
+static double vsopSum(const vsop87Series_t &s, int count, double t)
+{
+  double arg[VSOP87_BLOCK];
+  double sum = 0;
+
+  for (int i = 0; i < count; i += VSOP87_BLOCK)
+  {
+    const double *a = s.a + i;
+    const double *b = s.b + i;
+    const double *c = s.c + i;
+    int n = qMin(VSOP87_BLOCK, count - i);
+
+    // separate loops, so the compiler can vectorize the cosines
+    for (int j = 0; j < n; j++)
+    {
+      arg[j] = b[j] + c[j] * t;
+    }
+
+    for (int j = 0; j < n; j++)
+    {
+      arg[j] = cos(arg[j]);
+    }
+
+    for (int j = 0; j < n; j++)
+    {
+      sum += a[j] * arg[j];
+    }
+  }
+
+  return sum;
+}
+
+static void vsopFinish(int planet, double jd, double *polar)
+{
+  if (planet == PT_SUN)
+  {
+    polar[0] += R180; // to Sun coords.
+  }
+
+  rangeDbl(&polar[0], R360);
+
   if (planet == PT_SUN)
   {
     double rec[3];
@@ -64,3 +143,216 @@ void vsop87(int planet, double jd, double *polar)
     polar[5] = rec[2];
   }
 }
+
+static bool vsopValid(int planet, double *polar)
+{
+  if (planet >= PT_SUN && planet <= PT_NEPTUNE)
+  {
+    return true;
+  }
+
+  polar[0] = 0;
+  polar[1] = 0;
+  polar[2] = 1;
+  return false;
+}
+
+// accuracy in rad (VSOP87_ACC_xxx), only the terms needed are evaluated
+void vsop87(int planet, double jd, double *polar, double accuracy)
+{
+  if (!vsopValid(planet, polar))
+  {
+    return;
+  }
+
+  double t = (jd - 2451545) / 365250;
+
+  for (int c = 0; c < 3; c++)
+  {
+    double value = 0;
+    double tn = 1;
+
+    for (int o = 0; o < 6; o++)
+    {
+      int count = vsopTerms(planet, c, o, qAbs(t), accuracy);
+
+      value += vsopSum(g_vsop87Series[planet][c][o], count, t) * tn;
+      tn *= t;
+    }
+    polar[c] = value;
+  }
+
+  vsopFinish(planet, jd, polar);
+}
+
+static void vsopBlock(int planet, const double *jd, int count, double *polar, double accuracy)
+{
+  double t[VSOP87_BLOCK];
+  double tn[VSOP87_BLOCK];
+  double sum[VSOP87_BLOCK];
+  double value[3][VSOP87_BLOCK];
+  double tm = 0;
+
+  for (int j = 0; j < count; j++)
+  {
+    t[j] = (jd[j] - 2451545) / 365250;
+    tm = qMax(tm, qAbs(t[j]));
+  }
+
+  for (int c = 0; c < 3; c++)
+  {
+    for (int j = 0; j < count; j++)
+    {
+      value[c][j] = 0;
+      tn[j] = 1;
+    }
+
+    for (int o = 0; o < 6; o++)
+    {
+      const vsop87Series_t &s = g_vsop87Series[planet][c][o];
+      int terms = vsopTerms(planet, c, o, tm, accuracy);
+
+      for (int j = 0; j < count; j++)
+      {
+        sum[j] = 0;
+      }
+
+      // inner loop over the times (vectorized)
+      for (int k = 0; k < terms; k++)
+      {
+        const double a = s.a[k];
+        const double b = s.b[k];
+        const double f = s.c[k];
+
+        for (int j = 0; j < count; j++)
+        {
+          sum[j] += a * cos(b + f * t[j]);
+        }
+      }
+
+      for (int j = 0; j < count; j++)
+      {
+        value[c][j] += sum[j] * tn[j];
+        tn[j] *= t[j];
+      }
+    }
+  }
+
+  for (int j = 0; j < count; j++)
+  {
+    double *out = polar + j * 6;
+
+    out[0] = value[0][j];
+    out[1] = value[1][j];
+    out[2] = value[2][j];
+    vsopFinish(planet, jd[j], out);
+  }
+}
+
+// time series, polar has 6 values per time (same as vsop87())
+void vsop87Batch(int planet, const double *jd, int count, double *polar, double accuracy)
+{
+  if (planet < PT_SUN || planet > PT_NEPTUNE)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      vsopValid(planet, polar + i * 6);
+    }
+    return;
+  }
+
+  for (int i = 0; i < count; i += VSOP87_BLOCK)
+  {
+    vsopBlock(planet, jd + i, qMin(VSOP87_BLOCK, count - i), polar + i * 6, accuracy);
+  }
+}
+
+static double vsopAngleDiff(double a, double b)
+{
+  double d = qAbs(a - b);
+
+  if (d > MPI)
+  {
+    d = R360 - d;
+  }
+  return d;
+}
+
+// compares the tables with the generated functions (regression check)
+bool vsop87Check()
+{
+  typedef void (*vsopFunc_t)(double, double *);
+
+  static const vsopFunc_t func[VSOP87_PLANETS] = {earth_VSOP87, mercury_VSOP87, venus_VSOP87, mars_VSOP87,
+                                                  jupiter_VSOP87, saturn_VSOP87, uranus_VSOP87, neptune_VSOP87};
+  static const double acc[4] = {VSOP87_ACC_FULL, VSOP87_ACC_1SEC, VSOP87_ACC_10SEC, VSOP87_ACC_1MIN};
+
+  QVector <double> jd(VSOP87_CHECK_DATES);
+  QVector <double> ref(VSOP87_CHECK_DATES * 6);
+  QVector <double> out(VSOP87_CHECK_DATES * 6);
+  QVector <double> batch(VSOP87_CHECK_DATES * 6);
+  QElapsedTimer    timer;
+  bool             ok = true;
+
+  // 1000 AD .. 3000 AD
+  for (int i = 0; i < VSOP87_CHECK_DATES; i++)
+  {
+    jd[i] = 2086308.0 + i * (730485.0 / VSOP87_CHECK_DATES);
+  }
+
+  for (int p = 0; p < VSOP87_PLANETS; p++)
+  {
+    double dist = g_vsop87Series[p][2][0].a[0];
+
+    timer.start();
+    for (int i = 0; i < VSOP87_CHECK_DATES; i++)
+    {
+      func[p](jd[i], &ref[i * 6]);
+    }
+    qint64 refTime = timer.nsecsElapsed();
+
+    for (int a = 0; a < 4; a++)
+    {
+      double maxErr = 0;
+      double maxBatch = 0;
+
+      timer.start();
+      for (int i = 0; i < VSOP87_CHECK_DATES; i++)
+      {
+        vsop87(p, jd[i], &out[i * 6], acc[a]);
+      }
+      qint64 time = timer.nsecsElapsed();
+
+      timer.start();
+      vsop87Batch(p, jd.constData(), VSOP87_CHECK_DATES, batch.data(), acc[a]);
+      qint64 batchTime = timer.nsecsElapsed();
+
+      for (int i = 0; i < VSOP87_CHECK_DATES; i++)
+      {
+        const double *r = &ref[i * 6];
+        const double *o = &out[i * 6];
+        const double *b = &batch[i * 6];
+
+        maxErr = qMax(maxErr, vsopAngleDiff(o[0], r[0]) * cos(r[1]));
+        maxErr = qMax(maxErr, qAbs(o[1] - r[1]));
+        maxErr = qMax(maxErr, qAbs(o[2] - r[2]) / dist);
+
+        maxBatch = qMax(maxBatch, vsopAngleDiff(b[0], r[0]) * cos(r[1]));
+        maxBatch = qMax(maxBatch, qAbs(b[1] - r[1]));
+        maxBatch = qMax(maxBatch, qAbs(b[2] - r[2]) / dist);
+      }
+
+      double limit = (acc[a] > 0) ? acc[a] : 1e-11;
+
+      if (maxErr > limit || maxBatch > limit)
+      {
+        ok = false;
+      }
+
+      qDebug() << "vsop87" << p << "acc" << R2D(acc[a]) * 3600 << "err" << R2D(maxErr) * 3600 << R2D(maxBatch) * 3600
+               << "speed up" << refTime / (double)qMax(time, (qint64)1) << refTime / (double)qMax(batchTime, (qint64)1);
+    }
+  }
+
+  return ok;
+}
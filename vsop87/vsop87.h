@@ -18,7 +18,30 @@ along with SkytechX.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef VSOP87
 #define VSOP87
 
-void vsop87(int planet, double jd, double *polar);
+#define VSOP87_PLANETS    8           // PT_SUN (Earth) .. PT_NEPTUNE
+
+// target accuracy (rad, heliocentric)
+#define VSOP87_ACC_FULL   0.0         // all terms
+#define VSOP87_ACC_1SEC   4.84813681109536e-6
+#define VSOP87_ACC_10SEC  4.84813681109536e-5
+#define VSOP87_ACC_1MIN   2.90888208665722e-4
+
+#define VSOP87_BLOCK      64          // terms/times evaluated per batch
+
+// one series (term = a * cos(b + c * t)), sorted by amplitude
+typedef struct
+{
+  int           count;
+  const double *a;
+  const double *b;
+  const double *c;
+} vsop87Series_t;
+
+extern const vsop87Series_t g_vsop87Series[VSOP87_PLANETS][3][6]; // [planet][L,B,R][order]
+
+void vsop87(int planet, double jd, double *polar, double accuracy = VSOP87_ACC_FULL);
+void vsop87Batch(int planet, const double *jd, int count, double *polar, double accuracy = VSOP87_ACC_FULL);
+bool vsop87Check();
 
 void mercury_VSOP87(double jd, double *polar);
 void venus_VSOP87(double jd, double *polar);